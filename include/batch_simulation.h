@@ -0,0 +1,149 @@
+#pragma once
+// Standard libraries
+#include <memory>
+#include <stdint.h>
+#include <string>
+#include <utility>
+#include <vector>
+
+// External libraries
+
+// Internal libraries
+#include "buffer.h"
+#include "log.h"
+#include "random_field.h"
+#include "shader_program.h"
+#include "simulation.h"
+#include "texture.h"
+
+// Encapsulates a batch of independent 2D trials that are evolved together. Each field is a texture array with one layer per trial,
+// so every pass covers the whole batch in a single dispatch and the string and wall counts of every trial are read back at once.
+// The fields are evolved by the same compute shaders as the 2D simulation, so each layer gives the same counts as a single
+// simulation started from the same seed. The model parameters are read from a buffer indexed by layer, so each trial can run at
+// its own point of a parameter sweep.
+class BatchSimulation
+{
+public:
+    // Run flag
+    bool runFlag = false;
+    // End time of the simulation in timesteps.
+    int maxTimesteps = 1000;
+    // Number of timesteps between string and wall count samples. The first timestep is always sampled.
+    int stringCountCadence = 1;
+    // Power spectrum that random fields are drawn from. Fields that are not a power of two in size are always white noise.
+    InitialSpectrum initialSpectrum;
+
+    // Destructor
+    ~BatchSimulation();
+
+    // Creates a batch simulation of the given model from the names and values of its parameters as given by
+    // Simulation::getParameters. Returns nullptr if the shaders fail to compile.
+    static BatchSimulation *create(
+        SimulationModel model, const std::vector<std::pair<std::string, float>> &parameters, float dx, float dt, int era);
+
+    // Sets the parameter values of each trial, in the order of Simulation::getParameters. Trials without their own values use the
+    // values the batch was created with. This takes effect when the fields are next randomised.
+    void setTrialParameters(const std::vector<std::vector<float>> &trialParameters);
+    // Randomises the fields of one trial per seed. Each trial starts from the same fields as a simulation randomised with its seed.
+    void randomiseFields(uint32_t width, uint32_t height, const std::vector<uint32_t> &seeds);
+    // Updates every trial by one timestep
+    void update();
+
+    // Returns the current simulation timestep
+    inline int getCurrentSimulationTimestep() const
+    {
+        return m_CurrentTimestep;
+    }
+    // Returns the number of trials in the batch
+    inline uint32_t getNumTrials() const
+    {
+        return m_NumTrials;
+    }
+    // Returns the string count samples of each pair of fields of each trial
+    inline const std::vector<std::vector<std::vector<int>>> &getStringNumbers() const
+    {
+        return m_StringNumbers;
+    }
+    // Returns the wall count samples of each field with walls of each trial
+    inline const std::vector<std::vector<std::vector<int>>> &getWallNumbers() const
+    {
+        return m_WallNumbers;
+    }
+    // Returns the number of bytes of texture memory taken up by the fields and their Laplacians
+    uint64_t getFieldMemoryUsage() const;
+
+private:
+    // Constructor
+    BatchSimulation(
+        uint32_t numFields,
+        ComputeShaderProgram *evolveFieldPass,
+        ComputeShaderProgram *evolveVelocityPass,
+        ComputeShaderProgram *calculateAccelerationPass,
+        ComputeShaderProgram *updateAccelerationPass,
+        ComputeShaderProgram *calculateLaplacianPass,
+        ComputeShaderProgram *countStringsPass,
+        ComputeShaderProgram *countWallsPass,
+        ComputeShaderProgram *randomiseFieldPass);
+
+    // Calculates the Laplacian of each field into a separate texture.
+    void calculateLaplacian();
+    // Calculates the acceleration and stores it in the fourth component of each field.
+    void calculateAcceleration();
+    // Counts the strings and walls of every trial if the current timestep is sampled.
+    void sampleDefects();
+    // Runs a pass that takes a single field and dispatches it over every trial
+    void dispatchFieldPass(ComputeShaderProgram *pass, size_t fieldIndex);
+
+    // Fields being simulated
+    std::vector<Texture2DArray> m_Fields;
+    // Laplacians of each field
+    std::vector<Texture2DArray> m_LaplacianTextures;
+    // String counts of each pair of fields followed by the wall counts of each field with walls, with one count per trial
+    std::unique_ptr<ShaderStorageBuffer> m_DefectCountBuffer;
+    // Parameter values of each trial
+    std::unique_ptr<ShaderStorageBuffer> m_ParameterBuffer;
+    // Seed of each trial
+    std::unique_ptr<ShaderStorageBuffer> m_SeedBuffer;
+    // Filters random fields to the initial spectrum
+    RandomFieldFilter *m_RandomFieldFilter = nullptr;
+    bool m_HasCreatedRandomFieldFilter = false;
+    // String count samples of each pair of fields of each trial
+    std::vector<std::vector<std::vector<int>>> m_StringNumbers;
+    // Wall count samples of each field with walls of each trial
+    std::vector<std::vector<std::vector<int>>> m_WallNumbers;
+
+    // Calculate and update field
+    ComputeShaderProgram *m_EvolveFieldPass;
+    // Calculate and update the velocity
+    ComputeShaderProgram *m_EvolveVelocityPass;
+    // Calculate acceleration
+    ComputeShaderProgram *m_CalculateAccelerationPass;
+    // Update acceleration
+    ComputeShaderProgram *m_UpdateAccelerationPass;
+    // Calculate Laplacian into new texture
+    ComputeShaderProgram *m_CalculateLaplacianPass;
+    // Count the strings. This is nullptr if the model has no strings.
+    ComputeShaderProgram *m_CountStringsPass;
+    // Count the walls. This is nullptr if the model has no walls.
+    ComputeShaderProgram *m_CountWallsPass;
+    // Generate random fields
+    ComputeShaderProgram *m_RandomiseFieldPass;
+
+    // Universal parameters
+    float m_Dx = 1.0f;
+    float m_Dt = 0.1f;
+    int m_Era = 1;
+    // Parameter values of trials without their own values
+    std::vector<float> m_Parameters;
+    // Parameter values of each trial
+    std::vector<std::vector<float>> m_TrialParameters;
+
+    // Keep track of time
+    int m_CurrentTimestep = 1;
+    uint32_t m_NumFields = 0;
+    uint32_t m_NumStringChannels = 0;
+    uint32_t m_NumWallChannels = 0;
+    uint32_t m_NumTrials = 0;
+    uint32_t m_XNumGroups = 0;
+    uint32_t m_YNumGroups = 0;
+};
\ No newline at end of file
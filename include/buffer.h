@@ -220,7 +220,7 @@ public:
     // Getter method that returns the vector of buffer elements
     inline const std::vector<BufferElement> &getElements() const { return m_Elements; };
     // Getter method that returns the stride
-    inline const uint32_t getStride() const { return m_Stride; };
+    inline uint32_t getStride() const { return m_Stride; };
 
 private:
     // List of buffer elements associated with the vertex buffer.
@@ -316,4 +316,67 @@ public:
 private:
     // Index that tracks the current vertex buffer index
     uint32_t m_VertexBufferIndex = 0;
+};
+
+// Wraps a OpenGL shader storage buffer
+class ShaderStorageBuffer
+{
+public:
+    // OpenGL buffer ID
+    uint32_t bufferID = 0;
+    // Size of the buffer in bytes
+    uint32_t size = 0;
+
+    // Constructor that takes in the size of the buffer in bytes. The buffer is zero initialised.
+    ShaderStorageBuffer(uint32_t size, BufferUsageType usageType);
+    // Destructor
+    ~ShaderStorageBuffer();
+
+    // Disallow copy constructor
+    ShaderStorageBuffer(const ShaderStorageBuffer &) = delete;
+    // Disallow copy assignment
+    ShaderStorageBuffer &operator=(const ShaderStorageBuffer &) = delete;
+
+    // Binds the buffer to the given shader storage binding point
+    void bindBase(uint32_t binding);
+    // Zeroes a range of the buffer
+    void clear(uint32_t offset, uint32_t numBytes);
+    // Reads a range of the buffer back into the given destination. This blocks until the data is available.
+    void read(uint32_t offset, uint32_t numBytes, void *destination);
+    // Writes the given data to a range of the buffer
+    void write(uint32_t offset, uint32_t numBytes, const void *source);
+};
+
+// Wraps a OpenGL pixel pack buffer that reads back texture data asynchronously. A fence marks when the data has arrived.
+class ReadbackBuffer
+{
+public:
+    // OpenGL buffer ID
+    uint32_t bufferID = 0;
+    // Size of the buffer in bytes
+    uint32_t size = 0;
+
+    // Constructor
+    ReadbackBuffer();
+    // Destructor
+    ~ReadbackBuffer();
+
+    // Disallow copy constructor
+    ReadbackBuffer(const ReadbackBuffer &) = delete;
+    // Disallow copy assignment
+    ReadbackBuffer &operator=(const ReadbackBuffer &) = delete;
+
+    // Starts reading back the base level of the given texture, growing the buffer if necessary. The format and type are OpenGL
+    // pixel formats and types.
+    void readTexture(uint32_t textureID, uint32_t format, uint32_t type, uint32_t numBytes);
+    // Starts reading back a range of the given buffer, growing the readback buffer if necessary.
+    void readBuffer(uint32_t sourceBufferID, uint32_t offset, uint32_t numBytes);
+    // Returns true if the last read has arrived. This does not block.
+    bool isReady();
+    // Waits for the last read to arrive and copies it into the given destination.
+    void copyTo(void *destination, uint32_t numBytes);
+
+private:
+    // Fence that is signalled once the last read has arrived
+    void *m_Fence = nullptr;
 };
\ No newline at end of file
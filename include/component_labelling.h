@@ -0,0 +1,125 @@
+#pragma once
+// Standard libraries
+#include <memory>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+// External libraries
+
+// Internal libraries
+#include "buffer.h"
+#include "log.h"
+#include "shader_program.h"
+#include "texture.h"
+
+// How cells are grouped into components. Neighbouring cells of the same class belong to the same component.
+enum class ComponentClassType
+{
+    // Every non-zero cell is in the same class and zero cells belong to no component. This groups strings into clusters.
+    NONZERO = 0,
+    // Cells are split by the sign of the value. This groups a real field into domains.
+    SIGN,
+    // Cells are split into sectors of the phase, which is stored in units of pi. This groups a complex field into domains.
+    PHASE_SECTOR,
+};
+
+// Helper function that converts a component class type to a string.
+static std::string convertComponentClassTypeToString(ComponentClassType classType)
+{
+    switch (classType)
+    {
+    case ComponentClassType::NONZERO:
+        return "NONZERO";
+    case ComponentClassType::SIGN:
+        return "SIGN";
+    case ComponentClassType::PHASE_SECTOR:
+        return "PHASE_SECTOR";
+    default:
+        return "UNKNOWN";
+    }
+}
+
+// Statistics of the connected components of a texture.
+struct ComponentStatistics
+{
+public:
+    // Number of components
+    uint32_t numComponents = 0;
+    // Number of cells in the largest component
+    uint32_t largestSize = 0;
+    // Number of components in each size bin. Bin b holds the components with 2^b to 2^(b + 1) - 1 cells.
+    std::vector<uint32_t> sizeBins;
+};
+
+// Labels the connected components of a texture on the GPU with a lock-free union-find. Components are merged in a single pass
+// with atomic minimums, flattened and counted in a second pass, and summarised in a third, so the number of passes does not
+// grow with the size of the grid. The grid is periodic and neighbours are the four adjacent cells. Only the summary is read
+// back.
+class ComponentLabelling
+{
+public:
+    // Number of component size bins
+    static constexpr uint32_t NUM_SIZE_BINS = 32;
+    // Number of values in a summary, which is (number of components, largest size, size bins)
+    static constexpr uint32_t NUM_SUMMARY_VALUES = 2 + NUM_SIZE_BINS;
+
+    // Destructor
+    ~ComponentLabelling();
+
+    // Disallow copy constructor
+    ComponentLabelling(const ComponentLabelling &) = delete;
+    // Disallow copy assignment
+    ComponentLabelling &operator=(const ComponentLabelling &) = delete;
+
+    // Starts labelling the components of the first channel of a texture and reading back their summary. The number of sectors is
+    // only used to split the phase.
+    void label(Texture2D *texture, ComponentClassType classType, uint32_t numSectors, ReadbackBuffer &result);
+    // Waits for a summary to arrive and returns it.
+    ComponentStatistics getResult(ReadbackBuffer &result);
+    // Labels the components of a texture and waits for the summary.
+    ComponentStatistics labelNow(Texture2D *texture, ComponentClassType classType, uint32_t numSectors);
+
+    // Returns the root of every cell from the last labelling, which is the smallest index of its component. Cells that belong to
+    // no component are their own root.
+    inline ShaderStorageBuffer *getLabels()
+    {
+        return m_ParentBuffer.get();
+    }
+
+    // Converts a summary to a flat list of values
+    static std::vector<int32_t> flattenStatistics(const ComponentStatistics &statistics);
+    // Converts a flat list of values back to a summary
+    static ComponentStatistics unflattenStatistics(const int32_t *values);
+
+    // Creates the labelling passes. Returns nullptr if a shader failed to compile.
+    static ComponentLabelling *create();
+
+private:
+    // Constructor
+    ComponentLabelling(
+        ComputeShaderProgram *initialisePass,
+        ComputeShaderProgram *mergePass,
+        ComputeShaderProgram *countPass,
+        ComputeShaderProgram *histogramPass);
+
+    // Classifies the cells and makes every cell its own component
+    ComputeShaderProgram *m_InitialisePass;
+    // Merges neighbouring cells of the same class
+    ComputeShaderProgram *m_MergePass;
+    // Links every cell to its root and counts the size of each component
+    ComputeShaderProgram *m_CountPass;
+    // Summarises the components
+    ComputeShaderProgram *m_HistogramPass;
+
+    // Union-find forest
+    std::unique_ptr<ShaderStorageBuffer> m_ParentBuffer;
+    // Class of each cell
+    std::unique_ptr<ShaderStorageBuffer> m_ClassBuffer;
+    // Size of each component
+    std::unique_ptr<ShaderStorageBuffer> m_SizeBuffer;
+    // Summary of the components
+    std::unique_ptr<ShaderStorageBuffer> m_SummaryBuffer;
+    // Readback used by the synchronous labelling
+    ReadbackBuffer m_ImmediateResult;
+};
\ No newline at end of file
@@ -0,0 +1,68 @@
+#pragma once
+// Standard libraries
+#include <fstream>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+// External libraries
+
+// Internal libraries
+#include "log.h"
+
+// The supported encodings of a channel written to a typed data file. Each encoding has a declared maximum error with respect to
+// the 32-bit float value it was encoded from.
+enum class ChannelEncoding
+{
+    // 32-bit float. Lossless.
+    FLOAT32 = 0,
+    // 16-bit float. Lossy with a maximum relative error of 2^-11.
+    FLOAT16,
+    // Phase in [-pi, pi] quantised to an unsigned 16-bit integer. Lossy with a maximum absolute error of pi / 65534.
+    PHASE_UINT16,
+    // String value in {-1, 0, +1} packed at 2 bits per cell. Lossless.
+    STRING_2BIT,
+};
+
+// Helper function that returns a string representation for the given channel encoding.
+static std::string convertChannelEncodingToString(ChannelEncoding encoding)
+{
+    switch (encoding)
+    {
+    case ChannelEncoding::FLOAT32:
+        return "FLOAT32";
+    case ChannelEncoding::FLOAT16:
+        return "FLOAT16";
+    case ChannelEncoding::PHASE_UINT16:
+        return "PHASE_UINT16";
+    case ChannelEncoding::STRING_2BIT:
+        return "STRING_2BIT";
+    default:
+        logError("Unknown channel encoding!");
+        return "UNKNOWN";
+    }
+}
+
+// Returns the declared maximum error of the given encoding. This is a relative error for FLOAT16 and an absolute error otherwise.
+float getChannelEncodingMaxError(ChannelEncoding encoding);
+
+// Converts a 32-bit float into a 16-bit float, rounding to nearest even.
+uint16_t convertFloatToHalf(float value);
+// Converts a 16-bit float into a 32-bit float.
+float convertHalfToFloat(uint16_t value);
+
+// Quantises a phase in [-pi, pi] into an unsigned 16-bit integer. This matches the precision of a R16_SNORM phase texture.
+uint16_t quantisePhase(float phase);
+// Recovers a phase in [-pi, pi] from its quantised value.
+float dequantisePhase(uint16_t quantisedPhase);
+
+// Encodes a list of values into bytes using the given encoding.
+std::vector<uint8_t> encodeChannel(const std::vector<float> &values, ChannelEncoding encoding);
+// Decodes a list of bytes into `numValues` values using the given encoding.
+std::vector<float> decodeChannel(const std::vector<uint8_t> &bytes, size_t numValues, ChannelEncoding encoding);
+
+// Writes a single channel of a typed data file (.ctdt). The layout of a channel is:
+// M (u32) -> N (u32) -> Simulation time (f32) -> Encoding (u32) -> Max error (f32) -> Number of bytes (u32) -> Encoded data
+void writeEncodedChannel(
+    std::ofstream &dataFile, uint32_t M, uint32_t N, float simulationTime, ChannelEncoding encoding,
+    const std::vector<float> &values);
\ No newline at end of file
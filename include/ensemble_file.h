@@ -0,0 +1,124 @@
+#pragma once
+// Standard libraries
+#include <fstream>
+#include <stdint.h>
+#include <string>
+#include <utility>
+#include <vector>
+
+// External libraries
+
+// Internal libraries
+#include "log.h"
+
+// The data type of the samples stored in an ensemble file.
+enum class EnsembleDataType
+{
+    // 32-bit signed integer
+    INT32 = 0,
+    // 32-bit float
+    FLOAT32,
+};
+
+// Helper function that returns a string representation for the given ensemble data type.
+static std::string convertEnsembleDataTypeToString(EnsembleDataType type)
+{
+    switch (type)
+    {
+    case EnsembleDataType::INT32:
+        return "INT32";
+    case EnsembleDataType::FLOAT32:
+        return "FLOAT32";
+    default:
+        logError("Unknown ensemble data type!");
+        return "UNKNOWN";
+    }
+}
+
+// Describes the contents of an ensemble file.
+struct EnsembleHeader
+{
+public:
+    // The data type of each value
+    EnsembleDataType dataType = EnsembleDataType::INT32;
+    // Number of channels, e.g. the number of field pairs for string counts
+    uint32_t numChannels = 0;
+    // Number of trials
+    uint32_t numTrials = 0;
+    // Number of samples per trial
+    uint32_t numSamples = 0;
+    // Number of values per sample
+    uint32_t valuesPerSample = 1;
+    // Number of timesteps between samples. The nth sample is taken at timestep 1 + n * cadence.
+    uint32_t cadence = 1;
+    // Number of timesteps run per trial
+    uint32_t maxTimesteps = 0;
+
+    // Simulation parameters
+    uint32_t width = 0;
+    uint32_t height = 0;
+    int32_t era = 1;
+    float dt = 0.0f;
+    float dx = 0.0f;
+    // The name of the simulated model
+    std::string modelName;
+    // List of the model's parameter names and values
+    std::vector<std::pair<std::string, float>> parameters;
+    // The seed of each trial
+    std::vector<uint32_t> seeds;
+};
+
+// A single file holding a time series for every trial of a run. The data block is laid out contiguously as
+// [channel][trial][sample][value] so that it can be read with a single memory map, and it fills in as trials are completed.
+//
+// The layout of the header is:
+// Magic "CTDE" -> Version (u32) -> Header size (u32) -> Number of completed trials (u32) -> Data type (u32) ->
+// Number of channels (u32) -> Number of trials (u32) -> Number of samples (u32) -> Values per sample (u32) -> Cadence (u32) ->
+// Max timesteps (u32) -> Width (u32) -> Height (u32) -> Era (i32) -> dt (f32) -> dx (f32) -> Model name (u32 length + chars) ->
+// Number of parameters (u32) -> Parameters (u32 length + chars + f32 value) -> Seeds (u32 per trial) -> Padding
+// The data block begins at the header size, which is a multiple of 64 bytes.
+class EnsembleFile
+{
+public:
+    // The header describing the file contents
+    EnsembleHeader header;
+    // The number of trials that have been completed so far
+    uint32_t numCompletedTrials = 0;
+
+    // Destructor
+    ~EnsembleFile();
+
+    // Disallow copy constructor
+    EnsembleFile(const EnsembleFile &) = delete;
+    // Disallow copy assignment
+    EnsembleFile &operator=(const EnsembleFile &) = delete;
+
+    // Writes the samples of a single trial for the given channel. The samples are padded with zeros or truncated to fit.
+    void writeSamples(uint32_t channelIndex, uint32_t trialIndex, const std::vector<int32_t> &samples);
+    // Writes the samples of a single trial for the given channel. The samples are padded with zeros or truncated to fit.
+    void writeSamples(uint32_t channelIndex, uint32_t trialIndex, const std::vector<float> &samples);
+    // Marks the next trial as completed and flushes the file.
+    void completeTrial();
+    // Reads the samples of a single trial for the given channel as floats. Returns false if the samples could not be read.
+    bool readSamples(uint32_t channelIndex, uint32_t trialIndex, std::vector<float> &samples);
+
+    // Creates a new ensemble file with a zeroed data block, overwriting any existing file. The file is first written to a
+    // temporary path and then renamed so that a partially written file never appears at the given path.
+    static EnsembleFile *create(const char *filePath, const EnsembleHeader &header);
+    // Opens an existing ensemble file to continue filling it in.
+    static EnsembleFile *open(const char *filePath);
+
+private:
+    // Constructor
+    EnsembleFile(const char *filePath, const EnsembleHeader &header, uint64_t dataOffset);
+
+    // Writes raw sample bytes into the data block
+    void writeSampleBytes(uint32_t channelIndex, uint32_t trialIndex, const char *data, size_t numBytes);
+
+    // Path to the file
+    std::string m_FilePath;
+    // File stream
+    std::fstream m_File;
+    // Offset of the data block in bytes
+    uint64_t m_DataOffset = 0;
+};
\ No newline at end of file
@@ -0,0 +1,94 @@
+#pragma once
+// Standard libraries
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+// External libraries
+
+// Internal libraries
+#include "log.h"
+
+// Estimates a single quantile of a stream of values with the P² algorithm of Jain and Chlamtac. Only five markers are kept
+// regardless of the number of values, and the estimate is exact until five values have been seen.
+class P2Quantile
+{
+public:
+    // Constructor that takes in the quantile to estimate, between 0 and 1
+    P2Quantile(double quantile = 0.5);
+
+    // Adds a value to the stream.
+    void add(double value);
+    // Returns the current estimate, or NaN if no values have been added
+    double getEstimate() const;
+
+private:
+    // The quantile being estimated
+    double m_Quantile;
+    // Number of values added so far
+    uint32_t m_Count = 0;
+    // Marker heights. These hold the raw values until five have been seen.
+    double m_Heights[5] = {};
+    // Actual and desired marker positions
+    int32_t m_Positions[5] = {};
+    double m_DesiredPositions[5] = {};
+};
+
+// Summarises an ensemble of sampled curves as trials complete. The mean and variance of each sample are kept with Welford's
+// algorithm alongside its extremes and P² quantile sketches, so memory only grows with the number of samples and not with the
+// number of trials.
+class EnsembleStatistics
+{
+public:
+    // Number of quantiles estimated for each sample
+    static constexpr uint32_t NUM_QUANTILES = 5;
+    // The estimated quantiles
+    static constexpr double QUANTILES[NUM_QUANTILES] = {0.05, 0.25, 0.5, 0.75, 0.95};
+
+    // Constructor that takes in the number of channels and samples, and the cadence and time step used to label the samples
+    EnsembleStatistics(uint32_t numChannels, uint32_t numSamples, uint32_t cadence, float dt);
+
+    // Adds the samples of a channel from the current trial. Every channel is added once before the trial is completed.
+    void addSamples(uint32_t channelIndex, const std::vector<int32_t> &samples);
+    void addSamples(uint32_t channelIndex, const std::vector<float> &samples);
+    // Marks the current trial as completed
+    void completeTrial();
+    // Atomically replaces the file at the given path with a csv of the summary. Returns false if the file could not be written.
+    bool write(const std::string &filePath) const;
+
+    // Returns the number of completed trials
+    inline uint32_t getNumTrials() const
+    {
+        return m_NumTrials;
+    }
+    // Returns the mean of a sample over the completed trials
+    double getMean(uint32_t channelIndex, uint32_t sampleIndex) const;
+    // Returns the unbiased variance of a sample over the completed trials
+    double getVariance(uint32_t channelIndex, uint32_t sampleIndex) const;
+    // Returns the estimated quantile with the given index into QUANTILES
+    double getQuantile(uint32_t channelIndex, uint32_t sampleIndex, uint32_t quantileIndex) const;
+
+private:
+    // Running summary of a single sample
+    struct SampleStatistics
+    {
+        double mean = 0.0;
+        // Sum of squared deviations from the mean
+        double squaredDeviations = 0.0;
+        double minimum = 0.0;
+        double maximum = 0.0;
+        P2Quantile quantiles[NUM_QUANTILES];
+    };
+
+    // Folds a value from the current trial into a sample's summary
+    void addValue(SampleStatistics &statistics, double value);
+
+    uint32_t m_NumChannels;
+    uint32_t m_NumSamples;
+    uint32_t m_Cadence;
+    float m_Dt;
+    // Number of completed trials
+    uint32_t m_NumTrials = 0;
+    // Summaries laid out channel by channel
+    std::vector<SampleStatistics> m_Statistics;
+};
\ No newline at end of file
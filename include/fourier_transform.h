@@ -0,0 +1,160 @@
+#pragma once
+// Standard libraries
+#include <memory>
+#include <stdint.h>
+#include <vector>
+
+// External libraries
+
+// Internal libraries
+#include "buffer.h"
+#include "log.h"
+#include "shader_program.h"
+#include "texture.h"
+
+// Two dimensional fast Fourier transform on the GPU. Each axis is transformed by log2(N) radix-2 Stockham passes that ping-pong
+// between two complex textures, so both dimensions must be powers of two.
+class FourierTransform
+{
+public:
+    // Destructor
+    ~FourierTransform();
+
+    // Disallow copy constructor
+    FourierTransform(const FourierTransform &) = delete;
+    // Disallow copy assignment
+    FourierTransform &operator=(const FourierTransform &) = delete;
+
+    // Resizes the complex buffers. Returns false if either dimension is not a power of two.
+    bool setSize(uint32_t width, uint32_t height);
+    // Loads the first channel of the given textures, multiplied by `scale`, as the real and imaginary parts. The imaginary
+    // texture can be nullptr for real data.
+    void load(Texture2D *realTexture, Texture2D *imagTexture, float scale = 1.0f);
+    // Transforms the loaded data in place. The inverse transform is not normalised, so a forward and inverse transform
+    // multiplies the data by width * height.
+    void transform(bool isInverse);
+    // Returns the texture holding the complex data as (real, imaginary) in RG32F.
+    Texture2D *getData();
+
+    // Returns the width of the transform
+    inline uint32_t getWidth() const
+    {
+        return m_Width;
+    }
+    // Returns the height of the transform
+    inline uint32_t getHeight() const
+    {
+        return m_Height;
+    }
+
+    // Creates the transform passes. Returns nullptr if a shader failed to compile.
+    static FourierTransform *create();
+
+private:
+    // Constructor
+    FourierTransform(ComputeShaderProgram *loadPass, ComputeShaderProgram *stockhamPass);
+
+    // Loads real data into a complex buffer
+    ComputeShaderProgram *m_LoadPass;
+    // A single radix-2 Stockham stage along one axis
+    ComputeShaderProgram *m_StockhamPass;
+
+    // Ping-pong complex buffers
+    Texture2D m_Buffers[2];
+    // Index of the buffer holding the current data
+    uint32_t m_CurrentBuffer = 0;
+    // Size of the transform
+    uint32_t m_Width = 0;
+    uint32_t m_Height = 0;
+};
+
+// Radially binned power spectrum of a field. Bin b holds the modes whose wavenumber is within half a bin of b in units of the
+// fundamental mode of the shorter side, i.e. k = 2 pi b / (min(width, height) dx). Modes beyond the Nyquist wavenumber of the
+// shorter side are not binned.
+class PowerSpectrum
+{
+public:
+    // Destructor
+    ~PowerSpectrum();
+
+    // Disallow copy constructor
+    PowerSpectrum(const PowerSpectrum &) = delete;
+    // Disallow copy assignment
+    PowerSpectrum &operator=(const PowerSpectrum &) = delete;
+
+    // Sets the size of the fields. Returns false if the size can not be transformed.
+    bool setSize(uint32_t width, uint32_t height);
+    // Returns the number of radial bins
+    inline uint32_t getNumBins() const
+    {
+        return m_ModeCounts.size();
+    }
+    // Returns the number of radial bins of fields of the given size. This is zero if the size can not be transformed.
+    static uint32_t calculateNumBins(uint32_t width, uint32_t height);
+
+    // Starts calculating the power spectrum of the given field into the readback buffer. The imaginary texture can be nullptr for
+    // real fields.
+    void calculate(Texture2D *realTexture, Texture2D *imagTexture, float scale, ReadbackBuffer &result);
+    // Waits for a power spectrum to arrive and returns the mean power per mode of each bin, |F(k)|^2 / (width * height).
+    std::vector<float> getResult(ReadbackBuffer &result);
+
+    // Creates the power spectrum passes. Returns nullptr if a shader failed to compile.
+    static PowerSpectrum *create();
+
+private:
+    // Constructor
+    PowerSpectrum(FourierTransform *transform, ComputeShaderProgram *binPass, ComputeShaderProgram *reducePass);
+
+    // Transforms the field
+    FourierTransform *m_Transform;
+    // Sums the power of each work group's modes per bin
+    ComputeShaderProgram *m_BinPass;
+    // Sums the work group windows into the final bins
+    ComputeShaderProgram *m_ReducePass;
+
+    // The first bin of each work group's window
+    std::unique_ptr<ShaderStorageBuffer> m_WindowStarts;
+    // The summed power of each work group's window
+    std::unique_ptr<ShaderStorageBuffer> m_WindowSums;
+    // The summed power of each bin
+    std::unique_ptr<ShaderStorageBuffer> m_Powers;
+    // Number of work groups of the bin pass
+    uint32_t m_XNumGroups = 0;
+    uint32_t m_YNumGroups = 0;
+    // Number of modes in each bin
+    std::vector<uint32_t> m_ModeCounts;
+};
+
+// Pseudo-spectral Laplacian of periodic fields. Each field is transformed, every mode is multiplied by -k^2 and the result is
+// transformed back, which is exact for every mode the lattice resolves. Both dimensions must be powers of two.
+class SpectralLaplacian
+{
+public:
+    // Destructor
+    ~SpectralLaplacian();
+
+    // Disallow copy constructor
+    SpectralLaplacian(const SpectralLaplacian &) = delete;
+    // Disallow copy assignment
+    SpectralLaplacian &operator=(const SpectralLaplacian &) = delete;
+
+    // Sets the size of the fields. Returns false if the size can not be transformed.
+    bool setSize(uint32_t width, uint32_t height);
+    // Calculates the Laplacian of the value of a field, or of a pair of fields at once, into the given R32F textures. The second
+    // field and its Laplacian can be nullptr.
+    void calculate(Texture2D *firstField, Texture2D *secondField, Texture2D *firstLaplacian, Texture2D *secondLaplacian, float dx);
+
+    // Creates the Laplacian passes. Returns nullptr if a shader failed to compile.
+    static SpectralLaplacian *create();
+
+private:
+    // Constructor
+    SpectralLaplacian(FourierTransform *transform, ComputeShaderProgram *multiplyPass, ComputeShaderProgram *storePass);
+
+    // Transforms the fields
+    FourierTransform *m_Transform;
+    // Multiplies each mode by -k^2
+    ComputeShaderProgram *m_MultiplyPass;
+    // Stores the Laplacians
+    ComputeShaderProgram *m_StorePass;
+};
\ No newline at end of file
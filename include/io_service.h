@@ -0,0 +1,79 @@
+#pragma once
+// Standard libraries
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <stdint.h>
+#include <thread>
+
+// External libraries
+
+// Internal libraries
+#include "log.h"
+
+// Metrics describing how often producers had to wait on the I/O thread.
+struct IOServiceMetrics
+{
+public:
+    // Number of jobs submitted so far
+    uint64_t numSubmittedJobs = 0;
+    // Number of jobs completed so far
+    uint64_t numCompletedJobs = 0;
+    // Number of submissions that had to wait for space in the queue
+    uint64_t numStalledSubmissions = 0;
+    // Total time spent waiting for space in the queue in milliseconds
+    double totalStallMilliseconds = 0.0;
+    // Current number of queued jobs
+    uint32_t queueDepth = 0;
+    // Largest number of queued jobs seen so far
+    uint32_t maxQueueDepth = 0;
+};
+
+// Runs file writes on a dedicated thread so that the simulation and render loop do not block on disk I/O. Jobs are run in the
+// order they are submitted. The queue is bounded so that a slow disk applies backpressure instead of growing memory without limit.
+class IOService
+{
+public:
+    // Constructor that takes in the maximum number of queued jobs
+    IOService(size_t capacity = 8);
+    // Destructor. Waits for all queued jobs to complete.
+    ~IOService();
+
+    // Disallow copy constructor
+    IOService(const IOService &) = delete;
+    // Disallow copy assignment
+    IOService &operator=(const IOService &) = delete;
+
+    // Queues a job to run on the I/O thread. Blocks while the queue is full.
+    void submit(std::function<void()> job);
+    // Waits until every job submitted so far has completed.
+    void flush();
+
+    // Returns the current backpressure metrics
+    IOServiceMetrics getMetrics();
+
+private:
+    // Runs queued jobs until the service is stopped
+    void run();
+
+    // Maximum number of queued jobs
+    size_t m_Capacity;
+    // Queued jobs
+    std::deque<std::function<void()>> m_Jobs;
+    // True while the I/O thread is running a job
+    bool m_IsBusy = false;
+    // True when the I/O thread should exit
+    bool m_IsStopping = false;
+    // Backpressure metrics
+    IOServiceMetrics m_Metrics;
+
+    // Guards the queue, flags and metrics
+    std::mutex m_Mutex;
+    // Signalled when a job is queued or the service is stopping
+    std::condition_variable m_JobQueued;
+    // Signalled when a job is taken off the queue or completed
+    std::condition_variable m_JobTaken;
+    // The I/O thread
+    std::thread m_Thread;
+};
\ No newline at end of file
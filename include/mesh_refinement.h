@@ -0,0 +1,116 @@
+#pragma once
+// Standard libraries
+#include <memory>
+#include <stdint.h>
+#include <vector>
+
+// External libraries
+
+// Internal libraries
+#include "buffer.h"
+#include "log.h"
+#include "shader_program.h"
+#include "texture.h"
+
+// A single level of block-structured mesh refinement over the fields of a simulation. The lattice is split into square tiles, and
+// tiles around strings and walls are covered by patches at a finer spacing. The patches of each field are packed into the rows of
+// an atlas texture so that the existing field passes evolve every patch in a single dispatch. Each patch has a border of ghost
+// cells that is filled from neighbouring patches, or prolonged from the coarse fields at the matching fraction of the coarse
+// timestep. The interior of each patch is restricted back onto the coarse fields after every coarse timestep. Only single
+// precision fields can be refined.
+class MeshRefinement
+{
+public:
+    // Width of a tile in coarse cells. Tiles are refined as a whole.
+    static constexpr uint32_t TILE_SIZE = 16;
+    // Number of fine cells along each side of a coarse cell, which is also the number of fine substeps in a coarse timestep
+    static constexpr uint32_t REFINEMENT_RATIO = 2;
+    // Width of the border of ghost cells around each patch. This covers the reach of the Laplacian stencil and keeps patches a
+    // multiple of the work group size.
+    static constexpr uint32_t GHOST_WIDTH = 4;
+    // Width of a patch in fine cells including its ghost cells
+    static constexpr uint32_t PATCH_SIZE = REFINEMENT_RATIO * TILE_SIZE + 2 * GHOST_WIDTH;
+    // Number of patches in each row of an atlas
+    static constexpr uint32_t PATCHES_PER_ROW = 8;
+    // Distance in coarse cells around each defect that is refined, so that defects stay inside the patches between regrids
+    static constexpr uint32_t DEFECT_MARGIN = 4;
+
+    // Destructor
+    ~MeshRefinement();
+
+    // Disallow copy constructor
+    MeshRefinement(const MeshRefinement &) = delete;
+    // Disallow copy assignment
+    MeshRefinement &operator=(const MeshRefinement &) = delete;
+
+    // Refines every tile within the defect margin of a nonzero cell of one of the defect textures. Patches of tiles that stay
+    // refined are kept and new patches are prolonged from the fields. Returns true if the refined tiles changed.
+    bool regrid(const std::vector<Texture2D *> &defectTextures, const std::vector<Texture2D> &fields);
+    // Removes every patch
+    void clear();
+    // Copies the fields at the start of a coarse timestep so that ghost cells can be interpolated in time
+    void storePreviousFields(const std::vector<Texture2D> &fields);
+    // Fills the ghost cells of every patch at the given fraction of the coarse timestep
+    void fillGhosts(const std::vector<Texture2D> &fields, float fraction);
+    // Replaces every refined coarse cell with the average of its fine cells
+    void restrictPatches(const std::vector<Texture2D> &fields);
+
+    // Returns the number of patches
+    inline uint32_t getNumPatches() const
+    {
+        return m_PatchTiles.size();
+    }
+    // Returns the number of tiles the lattice is split into
+    inline uint32_t getNumTiles() const
+    {
+        return m_NumXTiles * m_NumYTiles;
+    }
+    // Returns the atlas of the patches of each field
+    inline std::vector<Texture2D> &getPatchFields()
+    {
+        return m_PatchFields;
+    }
+    // Returns the atlas of the Laplacians of the patches of each field
+    inline std::vector<Texture2D> &getPatchLaplacians()
+    {
+        return m_PatchLaplacians;
+    }
+    // Returns the number of bytes of texture memory taken up by the patches and the fields at the start of the coarse timestep
+    uint64_t getMemoryUsage() const;
+
+    // Creates the refinement passes. Returns nullptr if a shader failed to compile.
+    static MeshRefinement *create();
+
+private:
+    // Constructor
+    MeshRefinement(ComputeShaderProgram *flagTilesPass, ComputeShaderProgram *prolongPass, ComputeShaderProgram *restrictPass);
+
+    // Prolongs the given range of patches from the fields, or only their ghost cells
+    void prolong(const std::vector<Texture2D> &fields, uint32_t firstPatch, uint32_t numPatches, float fraction, bool ghostsOnly);
+
+    // Flags the tiles that hold a defect
+    ComputeShaderProgram *m_FlagTilesPass;
+    // Prolongs patches or their ghost cells
+    ComputeShaderProgram *m_ProlongPass;
+    // Restricts patches onto the fields
+    ComputeShaderProgram *m_RestrictPass;
+
+    // Flag of each tile
+    std::unique_ptr<ShaderStorageBuffer> m_TileFlagBuffer;
+    // Tile covered by each patch
+    std::unique_ptr<ShaderStorageBuffer> m_PatchTileBuffer;
+    // Patch covering each tile, or -1 if the tile is not refined
+    std::unique_ptr<ShaderStorageBuffer> m_TilePatchBuffer;
+    // Atlas of the patches of each field
+    std::vector<Texture2D> m_PatchFields;
+    // Atlas of the Laplacians of the patches of each field
+    std::vector<Texture2D> m_PatchLaplacians;
+    // Fields at the start of the coarse timestep
+    std::vector<Texture2D> m_PreviousFields;
+
+    // Tile covered by each patch
+    std::vector<int32_t> m_PatchTiles;
+    // Number of tiles along each axis
+    uint32_t m_NumXTiles = 0;
+    uint32_t m_NumYTiles = 0;
+};
\ No newline at end of file
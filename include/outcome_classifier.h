@@ -0,0 +1,169 @@
+#pragma once
+// Standard libraries
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+// External libraries
+
+// Internal libraries
+#include "log.h"
+
+// The outcomes a trial is classified into. These follow the categories in model_classifications.csv.
+enum class TrialOutcome : uint32_t
+{
+    // Not enough evidence for any outcome yet
+    UNDECIDED = 0,
+    // Every string and wall has annihilated
+    ZERO,
+    // A small number of defects is left that has stopped decaying
+    CLOSE_TO_ZERO,
+    // One complex field has vanished while the other has not
+    ONE_FIELD_VANISHES,
+    // The strings have annihilated but walls remain
+    NO_STRINGS,
+    // The walls are decaying
+    UNSTABLE_WALLS,
+    // The walls are stable
+    STABLE_WALLS,
+    // The walls are stable and separate many alternating domains
+    STABLE_ALTERNATING_WALLS,
+};
+
+// Helper function that returns a string representation for the given trial outcome.
+static std::string convertTrialOutcomeToString(TrialOutcome outcome)
+{
+    switch (outcome)
+    {
+    case TrialOutcome::UNDECIDED:
+        return "UNDECIDED";
+    case TrialOutcome::ZERO:
+        return "ZERO";
+    case TrialOutcome::CLOSE_TO_ZERO:
+        return "CLOSE_TO_ZERO";
+    case TrialOutcome::ONE_FIELD_VANISHES:
+        return "ONE_FIELD_VANISHES";
+    case TrialOutcome::NO_STRINGS:
+        return "NO_STRINGS";
+    case TrialOutcome::UNSTABLE_WALLS:
+        return "UNSTABLE_WALLS";
+    case TrialOutcome::STABLE_WALLS:
+        return "STABLE_WALLS";
+    case TrialOutcome::STABLE_ALTERNATING_WALLS:
+        return "STABLE_ALTERNATING_WALLS";
+    default:
+        logError("Unknown trial outcome!");
+        return "UNKNOWN";
+    }
+}
+
+// Helper function that returns the code used for the given trial outcome in model_classifications.csv and todo.md.
+static std::string getTrialOutcomeCode(TrialOutcome outcome)
+{
+    switch (outcome)
+    {
+    case TrialOutcome::UNDECIDED:
+        return "?";
+    case TrialOutcome::ZERO:
+        return "Z";
+    case TrialOutcome::CLOSE_TO_ZERO:
+        return "C";
+    case TrialOutcome::ONE_FIELD_VANISHES:
+        return "H";
+    case TrialOutcome::NO_STRINGS:
+        return "Ne";
+    case TrialOutcome::UNSTABLE_WALLS:
+        return "U";
+    case TrialOutcome::STABLE_WALLS:
+        return "S";
+    case TrialOutcome::STABLE_ALTERNATING_WALLS:
+        return "Sa";
+    default:
+        logError("Unknown trial outcome!");
+        return "UNKNOWN";
+    }
+}
+
+// The cheap diagnostics of a trial at a single sample.
+struct OutcomeSample
+{
+public:
+    // Timestep and time of the sample
+    int32_t timestep = 0;
+    float time = 0.0f;
+    // Number of strings over every field
+    int32_t numStrings = 0;
+    // Number of links crossing a wall over every field
+    int32_t numWalls = 0;
+    // Largest number of domains of any field, or -1 if the domains have not been labelled
+    int32_t numDomains = -1;
+    // |A - B| / (A + B) of the root mean square amplitudes of the first two complex fields, or 0 if there are fewer
+    float amplitudeImbalance = 0.0f;
+};
+
+// Classifies a trial from its diagnostics as they are sampled. Each sample is given the outcome its diagnostics point to, and the
+// classification becomes confident once the same outcome has held for the confidence window. Slopes are measured as the change of
+// log(count + 1) per unit of log time so that they are comparable between power laws.
+class OutcomeClassifier
+{
+public:
+    // Samples before this timestep are not classified as the early evolution is dominated by the initial conditions
+    int minTimestep = 500;
+    // Number of timesteps over which slopes are measured
+    int slopeWindow = 500;
+    // Number of timesteps an outcome has to hold before it is confident
+    int confidenceWindow = 500;
+    // Few defects are left once the strings and walls drop below this fraction of their initial number
+    float closeToZeroFraction = 0.01f;
+    // Walls whose count decays faster than this slope are unstable
+    float unstableSlope = 0.5f;
+    // Counts whose slope is within this of zero are stable
+    float stableSlope = 0.1f;
+    // One complex field has vanished once the amplitude imbalance exceeds this
+    float imbalanceThreshold = 0.8f;
+    // Stable walls separate alternating domains if a field has at least this many domains
+    int alternatingDomains = 8;
+
+    // Forgets every sample
+    void reset();
+    // Classifies a new sample. Samples are added in order of their timestep.
+    void addSample(const OutcomeSample &sample);
+
+    // Returns the confident outcome, or UNDECIDED if there is none yet. A confident outcome does not change.
+    inline TrialOutcome getOutcome() const
+    {
+        return m_IsConfident ? m_Candidate : TrialOutcome::UNDECIDED;
+    }
+    // Returns the outcome of the latest sample
+    inline TrialOutcome getCandidate() const
+    {
+        return m_Candidate;
+    }
+    // Returns true if the outcome is confident
+    inline bool isConfident() const
+    {
+        return m_IsConfident;
+    }
+    // Returns the timestep the outcome became confident at
+    inline int32_t getConfidentTimestep() const
+    {
+        return m_ConfidentTimestep;
+    }
+
+private:
+    // Returns the outcome the latest sample points to
+    TrialOutcome classifyLatestSample() const;
+    // Returns the least squares slope of log(count + 1) against log time over the slope window, where the count is taken from each
+    // sample by the given function
+    template <typename CountFunction>
+    float getSlope(CountFunction getCount) const;
+
+    // Every sample so far
+    std::vector<OutcomeSample> m_Samples;
+    // Outcome of the latest sample and the timestep it first held at
+    TrialOutcome m_Candidate = TrialOutcome::UNDECIDED;
+    int32_t m_CandidateTimestep = 0;
+    // True once an outcome has held for the confidence window
+    bool m_IsConfident = false;
+    int32_t m_ConfidentTimestep = 0;
+};
\ No newline at end of file
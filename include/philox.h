@@ -0,0 +1,20 @@
+#pragma once
+// Standard libraries
+#include <array>
+#include <stdint.h>
+
+// External libraries
+
+// Internal libraries
+
+// Counter-based random numbers for initial conditions. Every value is a pure function of its seed, field and cell, so fields can be
+// generated in parallel in any order. The shader randomise_field.glsl mirrors these functions operation for operation. Its
+// transcendental functions are built from additions and multiplications only, which round the same way on the CPU and the GPU, so
+// both give bit identical fields.
+
+// Returns the four 32 bit words of the Philox4x32-10 generator for the given counter and key
+std::array<uint32_t, 4> generatePhilox4x32(std::array<uint32_t, 4> counter, std::array<uint32_t, 2> key);
+// Returns a standard normal value from two random 32 bit words with the Box-Muller transform
+float convertToNormal(uint32_t firstWord, uint32_t secondWord);
+// Returns the initial value of a field at a cell. The value is normally distributed around zero with a standard deviation of 0.1.
+float generateInitialFieldValue(uint32_t seed, uint32_t fieldIndex, uint32_t x, uint32_t y, uint32_t z);
\ No newline at end of file
@@ -0,0 +1,126 @@
+#pragma once
+// Standard libraries
+#include <limits>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+// External libraries
+
+// Internal libraries
+#include "log.h"
+
+// The quality of a fit to an ensemble.
+enum class FitQuality
+{
+    // The fit converged and every parameter is constrained
+    GOOD = 0,
+    // The fit of the ensemble mean did not converge
+    NOT_CONVERGED,
+    // A parameter sits on one of its bounds, e.g. a count that tends to zero
+    AT_BOUND,
+    // Half the width of a confidence interval is larger than the magnitude of the median of its parameter
+    UNCONSTRAINED,
+};
+
+// Helper function that returns a string representation for the given fit quality.
+static std::string convertFitQualityToString(FitQuality quality)
+{
+    switch (quality)
+    {
+    case FitQuality::GOOD:
+        return "GOOD";
+    case FitQuality::NOT_CONVERGED:
+        return "NOT_CONVERGED";
+    case FitQuality::AT_BOUND:
+        return "AT_BOUND";
+    case FitQuality::UNCONSTRAINED:
+        return "UNCONSTRAINED";
+    default:
+        logError("Unknown fit quality!");
+        return "UNKNOWN";
+    }
+}
+
+// Parameters of the power law y = a t^q + c.
+struct PowerLawParameters
+{
+public:
+    // Scale
+    double a = 0.0;
+    // Exponent
+    double q = 0.0;
+    // Offset
+    double c = 0.0;
+};
+
+// The result of fitting a single time series.
+struct PowerLawFit
+{
+public:
+    // Best fit parameters
+    PowerLawParameters parameters;
+    // Sum of squared residuals
+    double residual = 0.0;
+    // Number of iterations taken
+    uint32_t numIterations = 0;
+    // True if the fit converged before running out of iterations
+    bool hasConverged = false;
+};
+
+// The result of fitting an ensemble of trials.
+struct PowerLawEnsembleFit
+{
+public:
+    // Fit of the mean of every trial
+    PowerLawFit meanFit;
+    // Median and 68% confidence interval of the parameters over the bootstrap resamples
+    PowerLawParameters median;
+    PowerLawParameters lowerInterval;
+    PowerLawParameters upperInterval;
+    // Number of trials in the ensemble
+    uint32_t numTrials = 0;
+    // Number of bootstrap resamples
+    uint32_t numResamples = 0;
+    // Automatic quality flag
+    FitQuality quality = FitQuality::GOOD;
+};
+
+// Fits y = a t^q + c with a bounded Levenberg-Marquardt solver. The power law can not be fitted as a straight line in log space
+// because the offset does not separate, so the fit is done directly on the data. Each step is projected back into the bounds.
+// Ensembles are fitted through the mean of their trials, and confidence intervals come from bootstrap resamples of the trials
+// that are fitted in parallel.
+class PowerLawFitter
+{
+public:
+    // Lower bounds of the parameters. Counts are non-negative so by default the scale and offset are too.
+    PowerLawParameters lowerBounds = {0.0, -std::numeric_limits<double>::infinity(), 0.0};
+    // Upper bounds of the parameters
+    PowerLawParameters upperBounds = {
+        std::numeric_limits<double>::infinity(), std::numeric_limits<double>::infinity(), std::numeric_limits<double>::infinity()};
+    // Largest number of iterations per fit
+    uint32_t maxIterations = 200;
+    // The fit has converged once an accepted step changes the residual by less than this fraction
+    double tolerance = 1e-10;
+    // Number of bootstrap resamples per ensemble
+    uint32_t numResamples = 200;
+    // Number of threads used for the bootstrap. Zero uses every hardware thread.
+    uint32_t numThreads = 0;
+    // Seed of the bootstrap. Resample n always draws the same trials regardless of the number of threads.
+    uint32_t seed = 1;
+
+    // Returns a starting point by fixing the offset below the smallest value and fitting the rest as a line in log space.
+    PowerLawParameters guess(const std::vector<double> &times, const std::vector<double> &values) const;
+    // Fits a single time series starting from the given parameters.
+    PowerLawFit fit(const std::vector<double> &times, const std::vector<double> &values, PowerLawParameters initial) const;
+    // Fits a single time series starting from a guess.
+    PowerLawFit fit(const std::vector<double> &times, const std::vector<double> &values) const;
+    // Fits the mean of an ensemble of trials that share the given times and bootstraps its confidence intervals.
+    PowerLawEnsembleFit fitEnsemble(const std::vector<double> &times, const std::vector<std::vector<double>> &trials) const;
+
+private:
+    // Clamps parameters into the bounds
+    PowerLawParameters clamp(PowerLawParameters parameters) const;
+    // Returns true if the parameter is within a relative tolerance of one of its bounds
+    static bool isAtBound(double value, double lowerBound, double upperBound);
+};
\ No newline at end of file
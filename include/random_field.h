@@ -0,0 +1,96 @@
+#pragma once
+// Standard libraries
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+// External libraries
+
+// Internal libraries
+#include "fourier_transform.h"
+#include "log.h"
+#include "shader_program.h"
+#include "texture.h"
+
+// The shapes of power spectrum that random initial fields can be drawn from.
+enum class InitialSpectrumType : uint32_t
+{
+    // Uncorrelated noise with equal power in every mode
+    WHITE_NOISE = 0,
+    // P(k) = exp(-(k xi)^2 / 2), so the correlation function falls off as exp(-r^2 / (2 xi^2))
+    GAUSSIAN,
+    // P(k) = k^n, cut off by exp(-(k xi)^2 / 2) if the correlation length is non-zero. The mean mode has no power unless n = 0.
+    POWER_LAW,
+};
+
+// Helper function that returns a string representation for the given spectrum type.
+static std::string convertInitialSpectrumTypeToString(InitialSpectrumType type)
+{
+    switch (type)
+    {
+    case InitialSpectrumType::WHITE_NOISE:
+        return "WHITE_NOISE";
+    case InitialSpectrumType::GAUSSIAN:
+        return "GAUSSIAN";
+    case InitialSpectrumType::POWER_LAW:
+        return "POWER_LAW";
+    default:
+        logError("Unknown initial spectrum type!");
+        return "UNKNOWN";
+    }
+}
+
+// The target power spectrum of random initial fields. Wavenumbers and lengths are in lattice units, so that the same spectrum
+// gives the same fields whatever the spacing. Filtered fields are normalised so that their standard deviation is that of the white
+// noise they are filtered from.
+struct InitialSpectrum
+{
+public:
+    // Shape of the spectrum
+    InitialSpectrumType type = InitialSpectrumType::WHITE_NOISE;
+    // Correlation length xi in cells
+    float correlationLength = 4.0f;
+    // Power law index n
+    float spectralIndex = -2.0f;
+};
+
+// Returns the power of the given spectrum at a wavenumber in radians per cell. This is zero wherever the power is not finite.
+float calculateSpectrumPower(const InitialSpectrum &spectrum, float wavenumber);
+// Returns the mean power of the modes of a lattice of the given size, which normalises the filter so that the variance is kept.
+double calculateMeanSpectrumPower(const InitialSpectrum &spectrum, uint32_t width, uint32_t height);
+// Filters the values of the given (value, velocity, acceleration, next acceleration) data of each field on the CPU to the given
+// spectrum. Pairs of fields are filtered together as the real and imaginary parts of a single transform. Returns false and leaves
+// the data untouched if either dimension is not a power of two.
+bool filterRandomFieldData(std::vector<std::vector<float>> &fieldData, uint32_t width, uint32_t height, const InitialSpectrum &spectrum);
+
+// Filters random fields on the GPU to a target power spectrum. The noise is transformed, multiplied by the square root of the
+// spectrum and transformed back, so the filtered fields are Gaussian random fields with the target spectrum.
+class RandomFieldFilter
+{
+public:
+    // Destructor
+    ~RandomFieldFilter();
+
+    // Disallow copy constructor
+    RandomFieldFilter(const RandomFieldFilter &) = delete;
+    // Disallow copy assignment
+    RandomFieldFilter &operator=(const RandomFieldFilter &) = delete;
+
+    // Filters the values of a field, or of a pair of fields at once, in place to the given spectrum. The second field can be
+    // nullptr. Both must be RGBA32F textures of the same size. Returns false if either dimension is not a power of two.
+    bool filter(Texture2D *firstField, Texture2D *secondField, const InitialSpectrum &spectrum);
+
+    // Creates the filter passes. Returns nullptr if a shader failed to compile.
+    static RandomFieldFilter *create();
+
+private:
+    // Constructor
+    RandomFieldFilter(FourierTransform *transform, ComputeShaderProgram *filterPass, ComputeShaderProgram *storePass);
+
+    // Transforms the fields
+    FourierTransform *m_Transform;
+    // Multiplies each mode by the square root of its power
+    ComputeShaderProgram *m_FilterPass;
+    // Stores the filtered values back into the fields
+    ComputeShaderProgram *m_StorePass;
+};
\ No newline at end of file
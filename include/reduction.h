@@ -0,0 +1,163 @@
+#pragma once
+// Standard libraries
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <stdint.h>
+#include <vector>
+
+// External libraries
+
+// Internal libraries
+#include "buffer.h"
+#include "log.h"
+#include "shader_program.h"
+#include "texture.h"
+
+// Statistics of a single texture channel.
+struct ReductionResult
+{
+public:
+    // Sum of the values
+    float sum = 0.0f;
+    // Smallest value
+    float minValue = 0.0f;
+    // Largest value
+    float maxValue = 0.0f;
+    // Sum of the squared values
+    float sumOfSquares = 0.0f;
+    // Number of values reduced
+    uint32_t count = 0;
+
+    // Returns the mean value
+    inline float getMean() const
+    {
+        return count > 0 ? sum / count : 0.0f;
+    }
+    // Returns the variance of the values
+    inline float getVariance() const
+    {
+        float mean = getMean();
+        return count > 0 ? std::max(sumOfSquares / count - mean * mean, 0.0f) : 0.0f;
+    }
+    // Returns the largest absolute value
+    inline float getMaxAbsoluteValue() const
+    {
+        return std::max(std::fabs(minValue), std::fabs(maxValue));
+    }
+};
+
+// Histogram of a single texture channel.
+struct Histogram
+{
+public:
+    // Lower edge of the first bin
+    float minValue = 0.0f;
+    // Upper edge of the last bin
+    float maxValue = 0.0f;
+    // Number of values in each bin. Values outside of the range are counted in the edge bins.
+    std::vector<uint32_t> bins;
+};
+
+// The kinds of reduction a query can hold.
+enum class ReductionType
+{
+    NONE = 0,
+    STATISTICS,
+    HISTOGRAM,
+};
+
+// Holds the result of an asynchronous reduction until it has arrived on the CPU. Each query owns a small readback buffer so
+// that several reductions can be in flight at once.
+class ReductionQuery
+{
+public:
+    // Constructor
+    ReductionQuery() = default;
+
+    // Disallow copy constructor
+    ReductionQuery(const ReductionQuery &) = delete;
+    // Disallow copy assignment
+    ReductionQuery &operator=(const ReductionQuery &) = delete;
+
+    // Returns true if a reduction has been started and its result has not been collected yet.
+    inline bool isPending() const
+    {
+        return m_Type != ReductionType::NONE;
+    }
+    // Returns true if the result has arrived. This does not block.
+    bool isReady();
+    // Waits for the result of a statistics reduction and collects it.
+    ReductionResult getResult();
+    // Waits for the result of a histogram and collects it.
+    Histogram getHistogram();
+
+private:
+    friend class Reduction;
+
+    // Readback of the result
+    ReadbackBuffer m_Readback;
+    // The kind of reduction that was started
+    ReductionType m_Type = ReductionType::NONE;
+    // Number of values reduced
+    uint32_t m_Count = 0;
+    // Histogram range and number of bins
+    float m_MinValue = 0.0f;
+    float m_MaxValue = 0.0f;
+    uint32_t m_NumBins = 0;
+};
+
+// Hierarchical GPU reductions over a single channel of a texture. The texture is first reduced into one partial result per work
+// group, and the partials are then reduced in further passes until a single result remains. Only that result is read back, so
+// statistics of a field never require a full readback.
+class Reduction
+{
+public:
+    // Maximum number of histogram bins
+    static constexpr uint32_t MAX_HISTOGRAM_BINS = 256;
+
+    // Destructor
+    ~Reduction();
+
+    // Disallow copy constructor
+    Reduction(const Reduction &) = delete;
+    // Disallow copy assignment
+    Reduction &operator=(const Reduction &) = delete;
+
+    // Starts reducing the sum, minimum, maximum and sum of squares of a texture channel into the given query.
+    void reduce(Texture2D *texture, uint32_t channel, ReductionQuery &query);
+    // Starts binning a texture channel into a histogram with the given range and number of bins.
+    void histogram(Texture2D *texture, uint32_t channel, float minValue, float maxValue, uint32_t numBins, ReductionQuery &query);
+
+    // Reduces a texture channel and waits for the result.
+    ReductionResult reduceNow(Texture2D *texture, uint32_t channel);
+    // Bins a texture channel into a histogram and waits for the result.
+    Histogram histogramNow(Texture2D *texture, uint32_t channel, float minValue, float maxValue, uint32_t numBins);
+
+    // Creates the reduction passes. Returns nullptr if a shader failed to compile.
+    static Reduction *create();
+
+private:
+    // Constructor
+    Reduction(
+        ComputeShaderProgram *reduceTexturePass,
+        ComputeShaderProgram *reducePartialsPass,
+        ComputeShaderProgram *histogramTexturePass);
+
+    // Grows the scratch buffers so that they can hold the given number of partials
+    void reservePartials(uint32_t numPartials);
+
+    // Reduces a texture into one partial per work group
+    ComputeShaderProgram *m_ReduceTexturePass;
+    // Reduces partials into fewer partials
+    ComputeShaderProgram *m_ReducePartialsPass;
+    // Bins a texture into a histogram
+    ComputeShaderProgram *m_HistogramTexturePass;
+
+    // Ping-pong scratch buffers holding the partials
+    std::unique_ptr<ShaderStorageBuffer> m_PartialBuffers[2];
+    // Histogram bins
+    std::unique_ptr<ShaderStorageBuffer> m_BinBuffer;
+    // Query used by the synchronous reductions
+    ReductionQuery m_ImmediateQuery;
+};
\ No newline at end of file
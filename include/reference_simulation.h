@@ -0,0 +1,133 @@
+#pragma once
+// Standard libraries
+#include <stdint.h>
+#include <string>
+#include <utility>
+#include <vector>
+
+// External libraries
+
+// Internal libraries
+#include "log.h"
+#include "simulation.h"
+
+// The state of a single field of the reference simulation. Each channel of the field texture is held in its own array.
+struct ReferenceField
+{
+public:
+    std::vector<double> values;
+    std::vector<double> velocities;
+    std::vector<double> accelerations;
+    std::vector<double> nextAccelerations;
+    std::vector<double> laplacians;
+};
+
+// Evolves the fields of a model on the CPU in double precision. The integrator, Laplacian stencil, equations of motion and defect
+// counts mirror the compute shaders step for step, so a run from the same initial fields serves as a reference for the drift of
+// the single and half precision GPU runs. This is far slower than the GPU and is meant for spot checks of small fields. The
+// equations of motion are written out again here rather than shared with the model shaders, so Simulation::runPrecisionBenchmark
+// checks one step of each against the other before using the reference.
+class ReferenceSimulation
+{
+public:
+    // Number of timesteps between string and wall count samples. The first timestep is always sampled.
+    int stringCountCadence = 1;
+
+    // Creates a reference of the given model from the names and values of its parameters as given by Simulation::getParameters,
+    // so that both simulations share the same model definition. Returns nullptr if the model is missing a parameter.
+    static ReferenceSimulation *create(
+        SimulationModel model, const std::vector<std::pair<std::string, float>> &parameters, float dx, float dt, int era);
+
+    // Sets the fields from the (value, velocity, acceleration, next acceleration) data of each field and samples the counts of
+    // the first timestep
+    void setFields(uint32_t width, uint32_t height, const std::vector<std::vector<float>> &fieldData);
+    // Updates the simulation by one timestep
+    void update();
+
+    // Returns the current timestep
+    inline int getCurrentTimestep() const
+    {
+        return m_CurrentTimestep;
+    }
+    // Returns the string count samples of each pair of fields
+    inline const std::vector<std::vector<int>> &getStringNumbers() const
+    {
+        return m_StringNumbers;
+    }
+    // Returns the wall crossing link samples of each field with walls
+    inline const std::vector<std::vector<int>> &getWallNumbers() const
+    {
+        return m_WallNumbers;
+    }
+    // Returns the value of every cell of the given field
+    inline const std::vector<double> &getFieldValues(uint32_t fieldIndex) const
+    {
+        return m_Fields[fieldIndex].values;
+    }
+    // Returns every channel of the given field
+    inline const ReferenceField &getField(uint32_t fieldIndex) const
+    {
+        return m_Fields[fieldIndex];
+    }
+    // Returns the number of bytes taken up by the fields and their Laplacians
+    uint64_t getFieldMemoryUsage() const;
+
+private:
+    // Constructor that takes in the model and its universal parameters. Model parameters are set by create.
+    ReferenceSimulation(SimulationModel model, float dx, float dt, int era);
+
+    // Calculates the Laplacian of each field with the same fourth order stencil as the shaders
+    void calculateLaplacian();
+    // Calculates the next acceleration of each field from its equation of motion
+    void calculateAcceleration();
+    // Counts the strings and walls if the current timestep is sampled
+    void sampleDefects();
+    // Returns the number of cells next to a string of the given pair of fields
+    int countStrings(size_t stringIndex);
+    // Returns the number of links crossing a wall. The imaginary field index is ignored for real fields.
+    int countWalls(size_t realIndex, size_t imagIndex, bool isComplex);
+
+    // Returns the index of the cell offset from the given cell with periodic boundaries
+    inline size_t getNeighbourIndex(int32_t x, int32_t y, int32_t xOffset, int32_t yOffset) const
+    {
+        int32_t neighbourX = (x + xOffset + (int32_t)m_Width) % (int32_t)m_Width;
+        int32_t neighbourY = (y + yOffset + (int32_t)m_Height) % (int32_t)m_Height;
+        return (size_t)neighbourY * m_Width + neighbourX;
+    }
+
+    SimulationModel m_Model;
+    uint32_t m_NumFields = 0;
+    uint32_t m_Width = 0;
+    uint32_t m_Height = 0;
+    std::vector<ReferenceField> m_Fields;
+
+    // Universal parameters
+    double m_Dx = 1.0;
+    double m_Dt = 0.1;
+    int m_Era = 1;
+    // Model parameters. Only the ones used by the model are set.
+    double m_Eta = 0.0;
+    double m_Lambda = 0.0;
+    int m_ColorAnomaly = 0;
+    double m_AxionStrength = 0.0;
+    double m_GrowthScale = 1.0;
+    double m_GrowthLaw = 0.0;
+    double m_Kappa = 0.0;
+    double m_TGrowthScale = 1.0;
+    double m_TGrowthLaw = 0.0;
+    double m_SGrowthScale = 1.0;
+    double m_SGrowthLaw = 0.0;
+    double m_N = 0.0;
+    double m_NPrime = 0.0;
+    double m_M = 0.0;
+    double m_MPrime = 0.0;
+
+    // Keep track of time
+    int m_CurrentTimestep = 1;
+    bool m_HasStrings = false;
+    bool m_HasWalls = false;
+    // Number of strings for each pair of fields
+    std::vector<std::vector<int>> m_StringNumbers;
+    // Number of wall crossing links for each field with walls
+    std::vector<std::vector<int>> m_WallNumbers;
+};
\ No newline at end of file
@@ -21,8 +21,8 @@ public:
     // Shader type
     ShaderType type = ShaderType::UNKNOWN_SHADER;
 
-    // Constructor
-    Shader(const char *shaderPath, ShaderType type);
+    // Constructor. The preamble is inserted after the version directive so that shaders can be specialised with defines.
+    Shader(const char *shaderPath, ShaderType type, const char *preamble = nullptr);
     // Destructor
     ~Shader();
 
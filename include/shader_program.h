@@ -37,4 +37,7 @@ public:
 
     // Use the compute shader shader program
     void use();
+
+    // Compiles the compute shader at the given path with an optional preamble into a program. Returns nullptr on failure.
+    static ComputeShaderProgram *createFromFile(const char *shaderPath, const char *preamble = nullptr);
 };
\ No newline at end of file
@@ -1,5 +1,7 @@
 #pragma once
 // Standard libraries
+#include <functional>
+#include <memory>
 #include <vector>
 #include <string>
 
@@ -7,7 +9,18 @@
 
 // Internal libraries
 #include "buffer.h"
+#include "component_labelling.h"
+#include "encoding.h"
+#include "ensemble_file.h"
+#include "ensemble_statistics.h"
+#include "fourier_transform.h"
+#include "io_service.h"
+#include "mesh_refinement.h"
+#include "outcome_classifier.h"
+#include "random_field.h"
+#include "reduction.h"
 #include "shader_program.h"
+#include "string_tracker.h"
 #include "texture.h"
 
 // Supported data types for shader uniforms.
@@ -50,6 +63,119 @@ static std::string convertUniformDataTypeToString(UniformDataType type)
     }
 }
 
+// The models that can be simulated.
+enum class SimulationModel
+{
+    DOMAIN_WALLS = 0,
+    COSMIC_STRINGS,
+    SINGLE_AXION,
+    COMPANION_AXION,
+};
+
+// Helper function that returns a string representation for the given simulation model.
+static std::string convertSimulationModelToString(SimulationModel model)
+{
+    switch (model)
+    {
+    case SimulationModel::DOMAIN_WALLS:
+        return "DOMAIN_WALLS";
+    case SimulationModel::COSMIC_STRINGS:
+        return "COSMIC_STRINGS";
+    case SimulationModel::SINGLE_AXION:
+        return "SINGLE_AXION";
+    case SimulationModel::COMPANION_AXION:
+        return "COMPANION_AXION";
+    default:
+        logError("Unknown simulation model!");
+        return "UNKNOWN";
+    }
+}
+
+// The precisions the fields can be stored at. Arithmetic is always done in single precision.
+enum class FieldPrecision : uint32_t
+{
+    // Fields and Laplacians are stored as 32 bit floats
+    SINGLE = 0,
+    // Fields and Laplacians are stored as 16 bit floats. The field value and velocity are accumulated every step so their rounding
+    // errors are carried in a separate 16 bit compensation texture.
+    HALF,
+};
+
+// Helper function that returns a string representation for the given field precision.
+static std::string convertFieldPrecisionToString(FieldPrecision precision)
+{
+    switch (precision)
+    {
+    case FieldPrecision::SINGLE:
+        return "SINGLE";
+    case FieldPrecision::HALF:
+        return "HALF";
+    default:
+        logError("Unknown field precision!");
+        return "UNKNOWN";
+    }
+}
+
+// The operators that can calculate the Laplacians of the fields.
+enum class LaplacianOperator : uint32_t
+{
+    // Fourth order finite difference stencil
+    STENCIL = 0,
+    // Pseudo-spectral Laplacian, which multiplies the Fourier modes by -k^2 and is exact for every resolved mode
+    SPECTRAL,
+};
+
+// Helper function that returns a string representation for the given Laplacian operator.
+static std::string convertLaplacianOperatorToString(LaplacianOperator laplacianOperator)
+{
+    switch (laplacianOperator)
+    {
+    case LaplacianOperator::STENCIL:
+        return "STENCIL";
+    case LaplacianOperator::SPECTRAL:
+        return "SPECTRAL";
+    default:
+        logError("Unknown Laplacian operator!");
+        return "UNKNOWN";
+    }
+}
+
+// The reasons a trial of a campaign can stop.
+enum class TrialStopReason : uint32_t
+{
+    // The trial ran until the maximum number of timesteps
+    MAX_TIMESTEPS = 0,
+    // There were no strings or walls for the zero defect window
+    NO_DEFECTS,
+    // The number of strings and walls stayed on a plateau for the plateau window
+    PLATEAU,
+    // A field stopped being finite or exceeded the blow up threshold
+    BLOW_UP,
+    // The outcome of the trial was classified with confidence
+    CLASSIFIED,
+};
+
+// Helper function that returns a string representation for the given trial stop reason.
+static std::string convertTrialStopReasonToString(TrialStopReason reason)
+{
+    switch (reason)
+    {
+    case TrialStopReason::MAX_TIMESTEPS:
+        return "MAX_TIMESTEPS";
+    case TrialStopReason::NO_DEFECTS:
+        return "NO_DEFECTS";
+    case TrialStopReason::PLATEAU:
+        return "PLATEAU";
+    case TrialStopReason::BLOW_UP:
+        return "BLOW_UP";
+    case TrialStopReason::CLASSIFIED:
+        return "CLASSIFIED";
+    default:
+        logError("Unknown trial stop reason!");
+        return "UNKNOWN";
+    }
+}
+
 // Specifies the data type and range for a simulation parameter.
 struct SimulationElement
 {
@@ -79,6 +205,47 @@ public:
     SimulationLayout(const std::initializer_list<SimulationElement> &elements) : m_Elements(elements) {}
 };
 
+// Writes the texture data of a snapshot to disk. This runs on the I/O thread so it must only use the given data and values it
+// has captured by copy.
+typedef std::function<void(const std::vector<std::vector<float>> &)> SnapshotWriter;
+
+// A staging slot holding the asynchronous readbacks of a single snapshot.
+struct SnapshotStagingSlot
+{
+public:
+    // One readback buffer per texture
+    std::vector<std::unique_ptr<ReadbackBuffer>> readbackBuffers;
+    // Number of textures in the snapshot
+    uint32_t numTextures = 0;
+    // Number of floats read back per texture
+    uint32_t numValues = 0;
+    // Writes the snapshot once its data has arrived
+    SnapshotWriter writer;
+    // True while the snapshot has not been handed over to the I/O thread
+    bool isPending = false;
+};
+
+// Total energy of the fields split into its parts.
+struct EnergyBudget
+{
+public:
+    // Kinetic energy
+    float kinetic = 0.0f;
+    // Gradient energy
+    float gradient = 0.0f;
+    // Potential energy
+    float potential = 0.0f;
+
+    // Returns the total energy
+    inline float getTotal() const
+    {
+        return kinetic + gradient + potential;
+    }
+};
+
+// The description, progress and output files of a campaign of random trials.
+struct TrialCampaign;
+
 // Encapsulates a classical field simulation. Uses compute shaders to carry out the numerical simulation.
 class Simulation
 {
@@ -87,9 +254,64 @@ public:
     bool runFlag = false;
     // End time of the simulation in timesteps.
     int maxTimesteps = 1000;
+    // Number of timesteps between string and wall count samples. The first timestep is always sampled.
+    int stringCountCadence = 1;
+    // Number of timesteps between checkpoints of an in-flight trial. Checkpointing is disabled if this is zero.
+    int checkpointInterval = 1000;
+    // Number of timesteps between energy budget samples. The first timestep is always sampled. Energies are not sampled if this
+    // is zero, which is the default.
+    int energyCadence = 0;
+    // Number of timesteps between power spectrum samples. The first timestep is always sampled. Spectra are not sampled if this
+    // is zero, which is the default, or if the fields are not a power of two in size.
+    int spectrumCadence = 0;
+    // Number of timesteps between samples of the domains and string clusters. The first timestep is always sampled. Components
+    // are not sampled if this is zero, which is the default.
+    int componentCadence = 0;
+    // Number of vacua the phase is split into when labelling domains. Each sector is centred on a vacuum at 2 pi k / domainSectors.
+    int domainSectors = 3;
+    // True if strings are tracked between samples of the string number
+    bool trackStrings = false;
+    // Largest distance in cells a string can move between samples and still continue its track
+    float trackingRadius = 3.0f;
+    // Trials stop early once there have been no strings or walls for this many timesteps. Disabled if this is zero.
+    int zeroDefectWindow = 0;
+    // Trials stop early once the number of strings and walls has stayed within plateauTolerance of its latest value for this many
+    // timesteps. Disabled if this is zero.
+    int plateauWindow = 0;
+    // Largest change in the number of strings and walls relative to its latest value that still counts as a plateau
+    float plateauTolerance = 0.01f;
+    // Trials stop early once the root mean square of a field is not finite or exceeds this. Disabled if this is zero.
+    float blowUpThreshold = 0.0f;
+    // True if the outcome of each trial is classified as it runs. Alternating walls are only told apart from other walls if
+    // components are sampled.
+    bool classifyOutcomes = false;
+    // True if trials stop once their outcome has been classified with confidence
+    bool stopWhenClassified = true;
+    // True if the tiles around strings and walls are refined to a finer spacing and evolved in substeps. Only single precision
+    // fields whose sides are a multiple of the tile size are refined.
+    bool refineDefects = false;
+    // Number of timesteps between updates of the refined tiles
+    int regridInterval = 10;
+    // Power spectrum that random fields are drawn from. Fields that are not a power of two in size are always white noise.
+    InitialSpectrum initialSpectrum;
+    // Operator that calculates the Laplacians of the fields. The spectral operator needs single precision fields that are a power
+    // of two in size, and the stencil is used otherwise. Refined patches always use the stencil.
+    LaplacianOperator laplacianOperator = LaplacianOperator::STENCIL;
+    // True if each update takes the largest steps that the stability bounds of the current fields allow, rather than a single
+    // step of dt. Timesteps are split into substeps where dt would be unstable, and unsampled timesteps are merged where it is
+    // needlessly small. Updates always end on the next sampled timestep, so samples stay on the grid of dt and compare directly
+    // with fixed step runs. Batched and volume simulations always take fixed steps.
+    bool adaptiveTimestep = false;
+    // Fraction of the largest stable step that adaptive steps take
+    float courantNumber = 0.5f;
+    // Most substeps that a timestep is split into
+    int maxSubsteps = 64;
+    // Most timesteps that a single adaptive step can span
+    int maxTimestepStride = 8;
 
     // Constructor
     Simulation(
+        SimulationModel model,
         uint32_t numFields,
         ComputeShaderProgram *evolveFieldPass,
         ComputeShaderProgram *evolveVelocityPass,
@@ -100,27 +322,57 @@ public:
         bool requiresPhase,
         ComputeShaderProgram *detectStringsPass,
         bool hasStrings,
-        SimulationLayout layout)
-        : m_NumFields(numFields),
-          m_EvolveFieldPass(evolveFieldPass),
+        ComputeShaderProgram *detectWallsPass,
+        bool hasWalls,
+        ComputeShaderProgram *calculateEnergyPass,
+        SimulationLayout layout,
+        FieldPrecision precision)
+        : m_EvolveFieldPass(evolveFieldPass),
           m_EvolveVelocityPass(evolveVelocityPass),
           m_CalculateAccelerationPass(calculateAccelerationPass),
           m_UpdateAccelerationPass(updateAccelerationPass),
           m_CalculateLaplacianPass(calculateLaplacianPass),
           m_CalculatePhasePass(calculatePhasePass),
-          m_RequiresPhase(requiresPhase),
           m_DetectStringsPass(detectStringsPass),
+          m_DetectWallsPass(detectWallsPass),
+          m_CalculateEnergyPass(calculateEnergyPass),
+          m_Layout(layout),
+          m_Model(model),
+          m_NumFields(numFields),
+          m_Precision(precision),
+          m_RequiresPhase(requiresPhase),
           m_HasStrings(hasStrings),
-          m_Layout(layout)
+          m_HasWalls(hasWalls)
     {
+        // Writes are handed over to a background thread
+        m_IOService = new IOService();
+        // Statistics of the fields are computed on the GPU. The power spectra, spectral Laplacian, initial spectrum filter,
+        // component labelling and refined patches are only created once they are used.
+        m_Reduction = Reduction::create();
+
         // Resize vectors to the correct number of fields
         m_Fields.resize(m_NumFields);
         m_LaplacianTextures.resize(m_NumFields);
+        // Half precision fields are split from single precision ones and carry the rounding errors of their value and velocity
+        if (m_Precision == FieldPrecision::HALF)
+        {
+            m_SplitFieldPass = ComputeShaderProgram::createFromFile("shaders/split_field.glsl", getFieldShaderPreamble(m_Precision));
+            m_CompensationTextures.resize(m_NumFields);
+        }
+        // Random fields are generated on the GPU at single precision, before they are set
+        m_RandomiseFieldPass = ComputeShaderProgram::createFromFile(
+            "shaders/randomise_field.glsl", getFieldShaderPreamble(FieldPrecision::SINGLE));
         // These lists are only non-empty if there are two or more fields
         size_t numPhases = floor(m_NumFields / 2);
         m_PhaseTextures.resize(numPhases);
         m_StringTextures.resize(numPhases);
         m_StringNumbers.resize(numPhases);
+        m_StringRecordBuffers.resize(numPhases);
+        m_StringTrackers.resize(numPhases);
+        // A single real field has walls of its own, otherwise each pair of fields has walls in its phase
+        size_t numWallFields = m_HasWalls ? (m_NumFields == 1 ? 1 : numPhases) : 0;
+        m_WallTextures.resize(numWallFields);
+        m_WallNumbers.resize(numWallFields);
 
         // Push uniform values
         for (const auto &element : layout.m_Elements)
@@ -185,23 +437,111 @@ public:
     // Randomises fields
     void randomiseFields(uint32_t width, uint32_t height, uint32_t seed);
 
+    // The save functions below only start an asynchronous readback and return immediately. The file is written by the I/O thread.
     // Saves fields as ctdd files
     void saveFields(const char *filePath);
-    // Saves Laplacians as ctdd files
-    void saveLaplacians(const char *filePath);
-    // Saves phases as ctdd files
+    // Saves field values and velocities as typed data files using the given encoding
+    void saveTypedFields(const char *filePath, ChannelEncoding encoding);
+    // Saves Laplacians as typed data files using the given encoding
+    void saveLaplacians(const char *filePath, ChannelEncoding encoding = ChannelEncoding::FLOAT32);
+    // Saves phases as typed data files quantised to 16 bits
     void savePhases(const char *filePath);
+    // Saves strings as typed data files packed at 2 bits per cell
+    void saveStrings(const char *filePath);
     // Saves string numbers as a data file
     void saveStringNumbers(const char *filePath);
+    // Saves the energy budgets sampled so far as a single trial ensemble file (.ctde)
+    void saveEnergies(const char *filePath);
+    // Saves the power spectra sampled so far as a single trial ensemble file (.ctde)
+    void savePowerSpectra(const char *filePath);
+    // Starts streaming the sparse location of every string plaquette to a string location file (.ctds). A frame is written
+    // whenever the string number is sampled.
+    void startStringLocationStream(const char *filePath);
+    // Stops streaming string locations and closes the file.
+    void stopStringLocationStream();
+    // Returns true if string locations are being streamed.
+    inline bool isStreamingStringLocations() const
+    {
+        return m_StringLocationStream != nullptr;
+    }
+    // Starts tracking strings and streaming their tracks and births and annihilations to a string track file (.ctdk). A frame
+    // is written whenever the string number is sampled.
+    void startStringTrackStream(const char *filePath);
+    // Stops streaming string tracks and closes the file.
+    void stopStringTrackStream();
+    // Returns true if string tracks are being streamed.
+    inline bool isStreamingStringTracks() const
+    {
+        return m_StringTrackStream != nullptr;
+    }
+    // Returns the string tracker of each pair of fields
+    inline const std::vector<StringTracker> &getStringTrackers() const
+    {
+        return m_StringTrackers;
+    }
+    // Returns the outcome classifier of the current trial so that its thresholds can be configured
+    inline OutcomeClassifier &getOutcomeClassifier()
+    {
+        return m_OutcomeClassifier;
+    }
 
-    // Runs a number of random trials and saves the string numbers for each timestep to the data folder
+    // Saves the full field state, timestep and string numbers of the given trial as a checkpoint file
+    void saveCheckpoint(const char *filePath, uint32_t trialIndex, uint32_t seed);
+    // Restores the checkpoint of the given trial. Returns false if there is no checkpoint for the given trial.
+    bool loadCheckpoint(const char *filePath, uint32_t trialIndex, uint32_t seed);
+
+    // Waits until every staged snapshot and queued file write has completed
+    void flushIO();
+    // Returns the backpressure metrics of the I/O thread
+    IOServiceMetrics getIOMetrics();
+
+    // Evolves the same random fields at single and half precision on the GPU and at double precision on the CPU for the maximum
+    // number of timesteps. The time per step and field memory of each precision are logged, and the drift of the string and wall
+    // counts from the double precision reference is written to a csv file in the data folder. Passing the seed of a campaign trial
+    // spot checks that trial. The benchmark is abandoned if one step of the reference does not match one single precision step.
+    void runPrecisionBenchmark(uint32_t width, uint32_t height, uint32_t seed, std::string outFolder);
+    // Times the stencil and spectral Laplacians of the fields of this model at sizes from 256 x 256 to 4096 x 4096, and measures the
+    // error of each against the exact Laplacian of a plane wave. The results are logged and written to a csv file in the data
+    // folder.
+    void runLaplacianBenchmark(std::string outFolder);
+
+    // Evolves random fields of the same model and parameters on a 3D lattice for the maximum number of timesteps, and writes the
+    // string length and wall area samples to a csv file in the data folder.
+    void runVolumeTrial(uint32_t width, uint32_t height, uint32_t depth, uint32_t seed, std::string outFolder);
+
+    // Runs a number of random trials and saves the string numbers of every trial to a single ensemble file in the data folder.
+    // Rerunning the same campaign skips completed trials and resumes the interrupted trial from its last checkpoint.
     void runRandomTrials(uint32_t width, uint32_t height, uint32_t numTrials, uint32_t startSeed, std::string outFolder);
+    // Runs the same random trials as `runRandomTrials`, evolving up to the batch size of them at once in the layers of texture
+    // arrays. Only the string and wall counts are sampled, and every trial runs for the maximum number of timesteps.
+    void runBatchedTrials(
+        uint32_t width, uint32_t height, uint32_t numTrials, uint32_t batchSize, uint32_t startSeed, std::string outFolder);
+    // Runs the same random trials as `runBatchedTrials` for every configuration of a parameter sweep read from a csv file, whose
+    // first line names the swept parameters and whose other lines each hold the values of a configuration. Trials of different
+    // configurations share batches. The counts of each configuration are written to its own folder, and the values of every
+    // configuration are listed in the data folder.
+    void runParameterSweep(
+        uint32_t width,
+        uint32_t height,
+        uint32_t numTrials,
+        uint32_t batchSize,
+        uint32_t startSeed,
+        std::string sweepPath,
+        std::string outFolder);
 
     // Updates the simulation by one timestep
     void update();
 
     // Binds the simulation parameters as uniforms
     void bindUniforms();
+    // Binds the given values of the parameters of a layout as uniforms, starting after the universal parameters
+    static void bindUniforms(
+        const SimulationLayout &layout, const std::vector<float> &floatUniforms, const std::vector<int32_t> &intUniforms);
+    // Returns the (value, velocity, acceleration, next acceleration) data of the given number of random fields. The values are
+    // normally distributed around zero and the rest are zero. These are the same fields that randomiseFields generates on the GPU,
+    // which are bit identical for white noise and agree to rounding for filtered spectra.
+    static std::vector<std::vector<float>> generateRandomFieldData(
+        uint32_t numFields, uint32_t width, uint32_t height, uint32_t seed, const InitialSpectrum &spectrum = InitialSpectrum());
 
     // Renders a UI that allows users to change simulation parameters
     void onUIRender();
@@ -221,9 +561,22 @@ public:
     Texture2D *getCurrentPhase();
     // Returns the currently selected strings texture
     Texture2D *getCurrentStrings();
+    // Returns the currently selected walls texture
+    Texture2D *getCurrentWalls();
 
-    // Returns the maximum absolute value of the field. This is for plotting purposes.
+    // Returns the maximum absolute value of the currently selected field. This is for plotting purposes. The value is reduced
+    // asynchronously so it may lag behind the field by a frame.
     float getMaxValue();
+    // Returns the maximum absolute value of the currently selected Laplacian. This is for plotting purposes.
+    float getMaxLaplacianValue();
+    // Returns the GPU reduction passes. This is nullptr if they failed to compile.
+    inline Reduction *getReduction()
+    {
+        return m_Reduction;
+    }
+
+    // Returns the names and values of the model parameters. Vector parameters are split into one entry per component.
+    std::vector<std::pair<std::string, float>> getParameters();
 
     // Returns the current simulation time
     float getCurrentSimulationTime();
@@ -232,8 +585,9 @@ public:
 
     // Initialise the simulation by calculating and updating the acceleration.
     void initialiseSimulation();
-    // Calculates the acceleration and stores it in the fourth component of the texture.
-    void calculateAcceleration();
+    // Calculates the acceleration at the given time for a step of the given size and stores it in the fourth component of the
+    // texture.
+    void calculateAcceleration(float time, float stepDt);
     // Updates the acceleration.
     void updateAcceleration();
     // Calculates the Laplacian into a separate texture.
@@ -242,29 +596,195 @@ public:
     void calculatePhase();
     // Highlights locations on the field which is next to a cosmic string.
     void detectStrings();
-
-    // Returns the number of strings at the current timestep.
+    // Counts the links of each cell that cross a domain wall.
+    void detectWalls();
+    // Calculates the energy density and starts reducing it into an energy budget sample.
+    void calculateEnergy();
+    // Labels the domains of each field with walls and the clusters of each field with strings, and starts reading back their
+    // statistics.
+    void calculateComponents();
+    // Calculates the power spectrum of each complex field and its phase, or of the field if there is only one, and starts
+    // reading them back.
+    void calculatePowerSpectra();
+
+    // Returns the latest number of strings that has arrived. This does not block.
     std::vector<int> getCurrentStringNumber();
-    // Returns the number of strings at the given timestep.
-    int getStringNumber(size_t timestepIndex);
+    // Returns the latest number of wall crossing links of each field that has arrived. This does not block.
+    std::vector<int> getCurrentWallNumber();
+
+    // Returns the energy budget samples so far. Waits for the latest sample if it is still being reduced.
+    std::vector<EnergyBudget> getEnergyBudgets();
+    // Returns the latest energy budget sample that has arrived. This does not block.
+    EnergyBudget getCurrentEnergyBudget();
+
+    // Returns the number of component channels, which are the domains of each field with walls followed by the string clusters
+    // of each field with strings.
+    uint32_t getNumComponentChannels();
+    // Returns the component summaries so far as one list per channel. Each sample is flattened into
+    // ComponentLabelling::NUM_SUMMARY_VALUES values. Waits for the latest sample if it is still being read back.
+    std::vector<std::vector<int32_t>> getComponentSummaries();
+    // Returns the latest component statistics of each channel that have arrived. This does not block.
+    std::vector<ComponentStatistics> getCurrentComponentStatistics();
+
+    // Returns the number of power spectrum channels
+    uint32_t getNumPowerSpectrumChannels();
+    // Returns the number of radial bins of each power spectrum. This is zero if the fields can not be transformed.
+    uint32_t getNumPowerSpectrumBins();
+    // Returns the power spectrum samples so far as one list per channel, with the bins of each sample stored contiguously.
+    // Waits for the latest sample if it is still being read back.
+    std::vector<std::vector<float>> getPowerSpectra();
 
     // Simulation constructors
     // Standard Peccei-Quinn real scalar field (domain wall simulation).
-    static Simulation *createDomainWallSimulation();
+    static Simulation *createDomainWallSimulation(FieldPrecision precision = FieldPrecision::SINGLE);
     // Standard Peccei-Quinn complex scalar field (cosmic string simulation).
-    static Simulation *createCosmicStringSimulation();
+    static Simulation *createCosmicStringSimulation(FieldPrecision precision = FieldPrecision::SINGLE);
     // Standard QCD axion field (single axion simulation).
-    static Simulation *createSingleAxionSimulation();
+    static Simulation *createSingleAxionSimulation(FieldPrecision precision = FieldPrecision::SINGLE);
     // Companion axion field (companion axion simulation).
-    static Simulation *createCompanionAxionSimulation();
+    static Simulation *createCompanionAxionSimulation(FieldPrecision precision = FieldPrecision::SINGLE);
+    // Creates a simulation of the given model.
+    static Simulation *createSimulation(SimulationModel model, FieldPrecision precision = FieldPrecision::SINGLE);
+
+    // Returns the simulated model
+    inline SimulationModel getModel() const
+    {
+        return m_Model;
+    }
+    // Returns the precision the fields are stored at
+    inline FieldPrecision getPrecision() const
+    {
+        return m_Precision;
+    }
+    // Returns the number of bytes of texture memory taken up by the fields, their compensation and their Laplacians
+    uint64_t getFieldMemoryUsage();
 
     // Returns true if the simulation is detecting strings.
-    inline const bool hasStrings() const
+    inline bool hasStrings() const
     {
         return m_HasStrings;
     }
+    // Returns true if the simulation is detecting walls.
+    inline bool hasWalls() const
+    {
+        return m_HasWalls;
+    }
+    // Returns the refined patches, which is nullptr until defects are first refined or if their passes failed to compile.
+    inline const MeshRefinement *getMeshRefinement() const
+    {
+        return m_MeshRefinement;
+    }
 
 private:
+    // Starts an asynchronous readback of the given textures into the next staging slot. Once the data has arrived the writer is
+    // run on the I/O thread.
+    void stageSnapshot(const std::vector<uint32_t> &textureIDs, uint32_t numComponents, SnapshotWriter writer);
+    // Hands snapshots whose readbacks have arrived over to the I/O thread. If `wait` is true this blocks until every readback has
+    // arrived.
+    void collectSnapshots(bool wait);
+    // Queues a CPU side write on the I/O thread behind any staged snapshots so that writes stay in order.
+    void submitIO(std::function<void()> job);
+    // Starts counting the strings of the given pair of fields.
+    void startStringCount(size_t stringIndex);
+    // Starts counting the links crossing a wall of the given field. This is the wall length in units of dx up to a geometric
+    // factor of pi / 4 for isotropic walls.
+    void startWallCount(size_t wallIndex);
+    // Stores the string and wall counts once their reductions have arrived. If `wait` is true this blocks until they have
+    // arrived.
+    void collectDefectCounts(bool wait);
+    // Stores the energy budget sample once its reductions have arrived. If `wait` is true this blocks until they have arrived.
+    void collectEnergyBudget(bool wait);
+    // Stores the component sample once its readbacks have arrived. If `wait` is true this blocks until they have arrived.
+    void collectComponents(bool wait);
+    // Stores the power spectrum sample once its readbacks have arrived. If `wait` is true this blocks until they have arrived.
+    void collectPowerSpectra(bool wait);
+    // Each of these creates its passes on first use and returns nullptr if they failed to compile. Creation is only attempted
+    // once.
+    PowerSpectrum *ensurePowerSpectrum();
+    RandomFieldFilter *ensureRandomFieldFilter();
+    SpectralLaplacian *ensureSpectralLaplacian();
+    ComponentLabelling *ensureComponentLabelling();
+    MeshRefinement *ensureMeshRefinement();
+    // Returns the last collected maximum absolute value of the given texture and starts reducing it again. Only the first call
+    // waits for the result.
+    float getCachedMaxAbsoluteValue(Texture2D *texture, ReductionQuery &query, float &cachedValue);
+    // Returns true and sets the reason if a trial should stop before its maximum number of timesteps. The rules are only checked
+    // when the string and wall counts are sampled, and look at the samples before the current one so that the check does not
+    // stall.
+    bool shouldStopTrial(TrialStopReason &reason);
+    // Fills in the paths, ensemble headers and signature of a campaign of random trials.
+    void describeCampaign(
+        TrialCampaign &campaign, uint32_t width, uint32_t height, uint32_t numTrials, uint32_t startSeed,
+        const std::string &outFolder);
+    // Resumes the campaign from its folder if it holds an interrupted run of the same campaign, and otherwise starts it afresh.
+    // Returns false if the ensembles could not be opened.
+    bool openCampaign(TrialCampaign &campaign, const std::string &outFolder);
+    // Runs a single trial of a campaign until it stops, resuming it from its checkpoint if `canResume` is true.
+    TrialStopReason runTrial(TrialCampaign &campaign, size_t trialIndex, bool canResume);
+    // Records the trial that just stopped as completed and queues the write of its samples on the I/O thread.
+    void submitTrialOutput(TrialCampaign &campaign, size_t trialIndex, TrialStopReason stopReason);
+    // Logs the stop reasons and outcomes of the completed trials of a campaign.
+    void logCampaignSummary(const TrialCampaign &campaign);
+    // Returns the total number of strings and walls of the given count sample
+    int getDefectNumber(size_t sampleIndex);
+    // Returns true if the root mean square amplitude of each field is sampled alongside the string and wall counts
+    inline bool isSamplingFieldAmplitudes() const
+    {
+        return blowUpThreshold > 0.0f || classifyOutcomes;
+    }
+    // Starts reducing the amplitude of each field after collecting the previous sample
+    void calculateFieldAmplitudes();
+    // Stores the amplitude sample once its reductions have arrived. If `wait` is true this blocks until they have arrived.
+    void collectFieldAmplitudes(bool wait);
+    // Returns the defines that specialise the shaders reading and writing fields to the given precision
+    static const char *getFieldShaderPreamble(FieldPrecision precision);
+    // Binds the compensation texture of a field to the given image unit if the fields are stored at half precision
+    void bindCompensationTexture(size_t fieldIndex, uint32_t unit, uint32_t access);
+    // Reads back the value of every cell of each field. Half precision values include their compensation.
+    std::vector<std::vector<float>> readFieldValues();
+    // Reads back the (value, velocity, acceleration, next acceleration) data of each field in the layout taken by
+    // ReferenceSimulation::setFields. Compensation is not included.
+    std::vector<std::vector<float>> readFieldData();
+    // Creates a simulation at the given precision with the model, parameters and run length of this simulation that only samples
+    // the string and wall counts, and randomises its fields. Returns nullptr if the simulation could not be created.
+    Simulation *createBenchmarkSimulation(FieldPrecision precision, uint32_t width, uint32_t height, uint32_t seed);
+    // Returns true if the tiles around defects are refined
+    bool isRefiningDefects();
+    // Returns true if the Laplacians are calculated by the spectral operator
+    bool isLaplacianSpectral();
+    // Refines the tiles around the current strings and walls and initialises the accelerations of the new patches
+    void regridRefinedPatches();
+    // Evolves the refined patches over the last step, which started at the given time, in substeps and restricts them back onto
+    // the fields
+    void advanceRefinedPatches(float startTime, float stepDt);
+    // Returns the largest stable step for the current fields scaled by the Courant number, and sets the name of the bound that
+    // limits it. The bounds are the CFL condition of the Laplacian, the time a field takes to cross its amplitude at its largest
+    // velocity, the period of its stiffest oscillation and the Hubble damping time at the given time.
+    float calculateStableTimestep(float time, const char *&limitingBound);
+    // Starts reducing the value, velocity and acceleration of each field for the next stable step
+    void startTimestepReductions();
+    // Returns the number of timesteps until the next timestep that is sampled, regridded or checkpointed, or the last timestep
+    int getTimestepsToNextSample();
+    // Runs random trials of each configuration of parameter values in batches and writes the string and wall counts of each
+    // configuration to the matching folder
+    void runBatchedConfigurations(
+        uint32_t width,
+        uint32_t height,
+        uint32_t numTrials,
+        uint32_t batchSize,
+        uint32_t startSeed,
+        const std::vector<std::vector<std::pair<std::string, float>>> &configurations,
+        const std::vector<std::string> &folderPaths);
+    // Calculates the Laplacian and next acceleration of the refined patches at the given time
+    void calculatePatchAcceleration(float time, float patchDx, float patchDt);
+    // Runs a pass that takes a single field over the refined patches of every field
+    void dispatchPatchPass(ComputeShaderProgram *pass, float patchDt);
+
+    // Returns the diagnostics of the given count sample that the outcome classifier sees when the sample is taken. Only the
+    // amplitudes and components that are guaranteed to have arrived by then are used so that the diagnostics do not depend on the
+    // timing of readbacks.
+    OutcomeSample getOutcomeSample(size_t sampleIndex);
+
     // Field data
     // Save of the original fields before simulation for rewinding purposes.
     std::vector<std::shared_ptr<Texture2D>> m_FieldSnapshot;
@@ -272,12 +792,30 @@ private:
     std::vector<Texture2D> m_Fields;
     // Laplacians of each field
     std::vector<Texture2D> m_LaplacianTextures;
+    // Rounding errors of the value and velocity of each half precision field. This is empty at single precision.
+    std::vector<Texture2D> m_CompensationTextures;
     // Phase of each pair of fields
     std::vector<Texture2D> m_PhaseTextures;
     // Location of strings for each pair of fields
     std::vector<Texture2D> m_StringTextures;
+    // Number of wall crossing links of each cell for each field with walls
+    std::vector<Texture2D> m_WallTextures;
+    // Energy density holding (kinetic, gradient, potential, total). The gradient energy is in lattice units.
+    Texture2D m_EnergyTexture;
+    // Energy budget samples
+    std::vector<EnergyBudget> m_EnergyBudgets;
     // Number of strings for each pair of fields
     std::vector<std::vector<int>> m_StringNumbers;
+    // Number of wall crossing links for each field with walls
+    std::vector<std::vector<int>> m_WallNumbers;
+    // Sparse list of string plaquettes for each pair of fields. The first element is the number of records.
+    std::vector<std::unique_ptr<ShaderStorageBuffer>> m_StringRecordBuffers;
+    // Open string location file. This is only written to on the I/O thread.
+    std::shared_ptr<std::ofstream> m_StringLocationStream;
+    // Tracks the strings of each pair of fields between samples
+    std::vector<StringTracker> m_StringTrackers;
+    // Open string track file. This is only written to on the I/O thread.
+    std::shared_ptr<std::ofstream> m_StringTrackStream;
 
     // Calculate and update field
     ComputeShaderProgram *m_EvolveFieldPass;
@@ -297,6 +835,18 @@ private:
     // Detect the strings
     ComputeShaderProgram *m_DetectStringsPass;
 
+    // Detect the walls
+    ComputeShaderProgram *m_DetectWallsPass;
+
+    // Calculate the energy density
+    ComputeShaderProgram *m_CalculateEnergyPass;
+
+    // Splits single precision fields into half precision fields and their compensation. This is only compiled at half precision.
+    ComputeShaderProgram *m_SplitFieldPass = nullptr;
+
+    // Generates random fields from a counter-based generator. The fields are generated on the CPU if this failed to compile.
+    ComputeShaderProgram *m_RandomiseFieldPass = nullptr;
+
     // Universal parameters
     float dx = 1.0f;
     float dt = 0.1f;
@@ -304,6 +854,11 @@ private:
 
     // Keep track of time
     int m_CurrentTimestep = 1;
+    // Number of steps taken since the fields were set. This only differs from the timestep with adaptive stepping.
+    int m_NumSteps = 0;
+    // Timesteps spanned and substeps taken by the last adaptive update. The steps are logged whenever these change.
+    int m_TimestepStride = 1;
+    int m_NumSubsteps = 1;
 
     // Extra simulation parameters that are non-specific
     SimulationLayout m_Layout;
@@ -315,11 +870,80 @@ private:
     // Render field index
     int32_t m_RenderIndex = 0;
 
+    SimulationModel m_Model;
     uint32_t m_NumFields = 0;
+    // Precision the fields are stored at
+    FieldPrecision m_Precision = FieldPrecision::SINGLE;
 
     uint32_t m_XNumGroups = 0;
     uint32_t m_YNumGroups = 0;
 
     bool m_RequiresPhase = false;
     bool m_HasStrings = false;
+    bool m_HasWalls = false;
+
+    // Runs file writes in the background
+    IOService *m_IOService = nullptr;
+    // Double-buffered staging slots for snapshot readbacks
+    SnapshotStagingSlot m_StagingSlots[2];
+    // Index of the staging slot to use next
+    uint32_t m_NextStagingSlot = 0;
+
+    // GPU reductions over field channels
+    Reduction *m_Reduction = nullptr;
+    // In flight reduction of the plotted field
+    ReductionQuery m_MaxValueQuery;
+    // Last maximum absolute value of the plotted field. This is negative until the first reduction has completed.
+    float m_MaxValue = -1.0f;
+    // In flight reduction of the plotted Laplacian
+    ReductionQuery m_MaxLaplacianQuery;
+    // Last maximum absolute value of the plotted Laplacian
+    float m_MaxLaplacianValue = -1.0f;
+    // In flight reductions of the string count of each pair of fields
+    std::vector<std::unique_ptr<ReductionQuery>> m_StringCountQueries;
+    // In flight reductions of the wall count of each field with walls
+    std::vector<std::unique_ptr<ReductionQuery>> m_WallCountQueries;
+    // In flight reductions of the kinetic, gradient and potential energy
+    ReductionQuery m_EnergyQueries[3];
+    // In flight reductions of the amplitude of each field
+    std::vector<std::unique_ptr<ReductionQuery>> m_FieldAmplitudeQueries;
+    // Root mean square amplitude samples of each field
+    std::vector<std::vector<float>> m_FieldAmplitudes;
+    // In flight reductions of the value, velocity and acceleration of each field for the next adaptive step. This is empty if
+    // the fields have changed since they were started.
+    std::vector<std::unique_ptr<ReductionQuery>> m_TimestepQueries;
+    // Classifies the outcome of the current trial
+    OutcomeClassifier m_OutcomeClassifier;
+    // Area of a cell when the in flight energy sample was taken
+    float m_EnergyCellArea = 1.0f;
+
+    // Radially binned power spectra
+    PowerSpectrum *m_PowerSpectrum = nullptr;
+    bool m_HasCreatedPowerSpectrum = false;
+    // Filters random fields to the initial spectrum
+    RandomFieldFilter *m_RandomFieldFilter = nullptr;
+    bool m_HasCreatedRandomFieldFilter = false;
+    // Calculates the Laplacians spectrally. This is only created at single precision.
+    SpectralLaplacian *m_SpectralLaplacian = nullptr;
+    bool m_HasCreatedSpectralLaplacian = false;
+    // Power spectrum samples of each channel
+    std::vector<std::vector<float>> m_PowerSpectra;
+    // In flight readbacks of each power spectrum channel
+    std::vector<std::unique_ptr<ReadbackBuffer>> m_PowerSpectrumReadbacks;
+    // True if a power spectrum sample is being read back
+    bool m_IsPowerSpectrumPending = false;
+
+    // Connected component labelling
+    ComponentLabelling *m_ComponentLabelling = nullptr;
+    bool m_HasCreatedComponentLabelling = false;
+    // Component summaries of each channel
+    std::vector<std::vector<int32_t>> m_ComponentSummaries;
+    // In flight readbacks of each component channel
+    std::vector<std::unique_ptr<ReadbackBuffer>> m_ComponentReadbacks;
+    // True if a component sample is being read back
+    bool m_IsComponentPending = false;
+
+    // Refined patches around strings and walls
+    MeshRefinement *m_MeshRefinement = nullptr;
+    bool m_HasCreatedMeshRefinement = false;
 };
\ No newline at end of file
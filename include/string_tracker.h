@@ -0,0 +1,183 @@
+#pragma once
+// Standard libraries
+#include <stdint.h>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+// External libraries
+
+// Internal libraries
+#include "log.h"
+
+// The kind of string event.
+enum class StringEventType : uint32_t
+{
+    // A string appeared that does not continue any track
+    BIRTH = 0,
+    // A track ended because its string could not be found
+    ANNIHILATION,
+};
+
+// Helper function that returns a string representation for the given string event type.
+static std::string convertStringEventTypeToString(StringEventType type)
+{
+    switch (type)
+    {
+    case StringEventType::BIRTH:
+        return "BIRTH";
+    case StringEventType::ANNIHILATION:
+        return "ANNIHILATION";
+    default:
+        logError("Unknown string event type!");
+        return "UNKNOWN";
+    }
+}
+
+// A string followed across samples. Positions are in cells and velocities are in physical length per unit time, which is
+// cells times dx per unit time. Positions are quantised to cells, so velocities are only meaningful when strings move several
+// cells between samples.
+struct StringTrack
+{
+public:
+    // Unique identifier of the track
+    uint32_t id;
+    // +1 for a string and -1 for an anti-string
+    int32_t sign;
+    // Position of the string's plaquette
+    float x;
+    float y;
+    // Velocity estimated from the last two samples. This is zero for a newborn track.
+    float xVelocity;
+    float yVelocity;
+    // The timestep the track was born
+    int32_t birthTimestep;
+};
+
+// A birth or annihilation of a track. Strings are born and annihilate in string anti-string pairs so each event names the
+// nearest track of opposite sign that was born or annihilated with it, if there is one within the search radius.
+struct StringEvent
+{
+public:
+    // The kind of event
+    StringEventType type;
+    // The timestep of the sample the event was found in
+    int32_t timestep;
+    // The track that was born or annihilated
+    uint32_t trackID;
+    // The opposite sign track it was born or annihilated with, or StringTracker::NO_PARTNER
+    uint32_t partnerID;
+    // The timestep the track was born
+    int32_t birthTimestep;
+    // Position of the track when it was born or last seen
+    float x;
+    float y;
+};
+
+// Both records are written to disk as is, so they must not contain padding
+static_assert(sizeof(StringTrack) == 7 * sizeof(uint32_t));
+static_assert(sizeof(StringEvent) == 7 * sizeof(uint32_t));
+
+// Matches the string plaquettes of consecutive samples into tracks on the periodic grid. Each string continues the nearest
+// track of the same sign from the previous sample within the search radius, closest pairs first. Candidates are found with a
+// spatial hash of cells that are at least the search radius wide, so a sample costs time proportional to the number of strings
+// rather than the size of the grid, and the buffers are reused between samples.
+class StringTracker
+{
+public:
+    // Track identifier used when an event has no partner
+    static constexpr uint32_t NO_PARTNER = 0xFFFFFFFF;
+
+    // Clears every track and sets the size of the grid, the cell spacing and the search radius in cells.
+    void reset(uint32_t width, uint32_t height, float dx, float searchRadius);
+    // Sets the search radius in cells used by the following samples.
+    void setSearchRadius(float searchRadius);
+    // Matches the string records of a sample at the given timestep and time to the current tracks. Records pack x into bits
+    // 0-14, y into bits 15-29 and set bit 30 for an anti-string.
+    void update(int32_t timestep, float time, const uint32_t *records, uint32_t numRecords);
+
+    // Returns the live tracks
+    inline const std::vector<StringTrack> &getTracks() const
+    {
+        return m_Tracks;
+    }
+    // Returns the events found since the last call and clears them
+    std::vector<StringEvent> takeEvents();
+    // Returns the number of births since the last reset
+    inline uint32_t getNumBirths() const
+    {
+        return m_NumBirths;
+    }
+    // Returns the number of annihilations since the last reset
+    inline uint32_t getNumAnnihilations() const
+    {
+        return m_NumAnnihilations;
+    }
+    // Returns the mean speed of the tracks that were continued by the last sample
+    inline float getMeanSpeed() const
+    {
+        return m_MeanSpeed;
+    }
+
+private:
+    // A point that is being matched
+    struct Point
+    {
+        float x;
+        float y;
+        int32_t sign;
+    };
+
+    // Finds the closest pairs between `from` and `to` within the search radius, using each point at most once. If `isSameSign`
+    // is true only points of the same sign are paired, otherwise only points of opposite sign are. `to` can be the same list
+    // as `from`. Each match is (index into from, index into to).
+    void matchPoints(const std::vector<Point> &from, const std::vector<Point> &to, bool isSameSign,
+                     std::vector<std::pair<uint32_t, uint32_t>> &matches);
+    // Returns the periodic displacement from a to b along an axis of the given length
+    static float getPeriodicDisplacement(float a, float b, float length);
+
+    // Size of the grid
+    uint32_t m_Width = 0;
+    uint32_t m_Height = 0;
+    // Spacing of the grid
+    float m_Dx = 1.0f;
+    // Largest distance in cells a string can move between samples
+    float m_SearchRadius = 3.0f;
+    // Time of the last sample
+    float m_LastTime = 0.0f;
+    // True if a sample has been matched since the last reset
+    bool m_HasLastSample = false;
+
+    // Live tracks
+    std::vector<StringTrack> m_Tracks;
+    // Events that have not been taken yet
+    std::vector<StringEvent> m_Events;
+    // Identifier of the next track
+    uint32_t m_NextID = 0;
+    // Running totals
+    uint32_t m_NumBirths = 0;
+    uint32_t m_NumAnnihilations = 0;
+    float m_MeanSpeed = 0.0f;
+
+    // Buffers reused between samples
+    std::vector<Point> m_NewPoints;
+    std::vector<Point> m_TrackPoints;
+    std::vector<Point> m_UnmatchedPoints;
+    std::vector<uint32_t> m_UnmatchedIndices;
+    std::vector<std::pair<uint32_t, uint32_t>> m_Matches;
+    std::vector<std::pair<uint32_t, uint32_t>> m_Partners;
+    std::vector<uint32_t> m_PartnerIDs;
+    std::vector<int32_t> m_NewToTrack;
+    std::vector<uint8_t> m_IsTrackMatched;
+    std::vector<StringTrack> m_NextTracks;
+    // Spatial hash of the points being matched against, as a counting sort of point indices by bucket
+    std::vector<uint32_t> m_CellStarts;
+    std::vector<uint32_t> m_CellEntries;
+    std::vector<uint32_t> m_CellOffsets;
+    // Candidate pairs as (squared distance, from index, to index)
+    std::vector<std::tuple<float, uint32_t, uint32_t>> m_Candidates;
+    // True if the point has been used by a match
+    std::vector<uint8_t> m_IsFromUsed;
+    std::vector<uint8_t> m_IsToUsed;
+};
\ No newline at end of file
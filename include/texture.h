@@ -101,4 +101,121 @@ public:
     static std::vector<std::shared_ptr<Texture2D>> loadCTDD(const char *filePath);
     // Loads an image into a texture from a png file.
     static Texture2D *loadPNG(const char *filePath);
+};
+
+// A 3D texture with immutable storage. These hold the fields of volume simulations, and are only ever accessed as images so they
+// have no sampling state. Drivers store 3D textures in tiles, so neighbouring cells along every axis stay close in memory.
+class Texture3D
+{
+public:
+    // OpenGL texture ID. Default is 0 (null texture).
+    uint32_t textureID = 0;
+    // Texture width. Default is 0.
+    uint32_t width = 0;
+    // Texture height. Default is 0.
+    uint32_t height = 0;
+    // Texture depth. Default is 0.
+    uint32_t depth = 0;
+
+    // Default constructor
+    Texture3D() = default;
+    // Constructor that allocates storage of the given size and OpenGL internal format
+    Texture3D(uint32_t width, uint32_t height, uint32_t depth, uint32_t format);
+    // Destructor
+    ~Texture3D()
+    {
+        release();
+    }
+
+    // Disallow copy constructor
+    Texture3D(const Texture3D &) = delete;
+    // Disallow copy assignment
+    Texture3D &operator=(const Texture3D &) = delete;
+
+    // Move constructor
+    Texture3D(Texture3D &&other) : textureID(other.textureID), width(other.width), height(other.height), depth(other.depth)
+    {
+        // Set the texture ID of the old texture to null.
+        other.textureID = 0;
+    }
+
+    // Move assignment operator
+    Texture3D &operator=(Texture3D &&other)
+    {
+        // Check that not self assigning
+        if (this != &other)
+        {
+            // Release texture resource
+            release();
+            // Swap the texture IDs
+            std::swap(textureID, other.textureID);
+            width = other.width;
+            height = other.height;
+            depth = other.depth;
+        }
+
+        return *this;
+    }
+
+    // Release texture resource
+    void release();
+};
+
+// A 2D texture array with immutable storage. These hold the fields of batched simulations, where each layer is an independent
+// lattice, and are only ever accessed as images so they have no sampling state.
+class Texture2DArray
+{
+public:
+    // OpenGL texture ID. Default is 0 (null texture).
+    uint32_t textureID = 0;
+    // Texture width. Default is 0.
+    uint32_t width = 0;
+    // Texture height. Default is 0.
+    uint32_t height = 0;
+    // Number of layers. Default is 0.
+    uint32_t numLayers = 0;
+
+    // Default constructor
+    Texture2DArray() = default;
+    // Constructor that allocates storage of the given size and OpenGL internal format
+    Texture2DArray(uint32_t width, uint32_t height, uint32_t numLayers, uint32_t format);
+    // Destructor
+    ~Texture2DArray()
+    {
+        release();
+    }
+
+    // Disallow copy constructor
+    Texture2DArray(const Texture2DArray &) = delete;
+    // Disallow copy assignment
+    Texture2DArray &operator=(const Texture2DArray &) = delete;
+
+    // Move constructor
+    Texture2DArray(Texture2DArray &&other)
+        : textureID(other.textureID), width(other.width), height(other.height), numLayers(other.numLayers)
+    {
+        // Set the texture ID of the old texture to null.
+        other.textureID = 0;
+    }
+
+    // Move assignment operator
+    Texture2DArray &operator=(Texture2DArray &&other)
+    {
+        // Check that not self assigning
+        if (this != &other)
+        {
+            // Release texture resource
+            release();
+            // Swap the texture IDs
+            std::swap(textureID, other.textureID);
+            width = other.width;
+            height = other.height;
+            numLayers = other.numLayers;
+        }
+
+        return *this;
+    }
+
+    // Release texture resource
+    void release();
 };
\ No newline at end of file
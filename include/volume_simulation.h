@@ -0,0 +1,138 @@
+#pragma once
+// Standard libraries
+#include <memory>
+#include <stdint.h>
+#include <vector>
+
+// External libraries
+
+// Internal libraries
+#include "buffer.h"
+#include "log.h"
+#include "shader_program.h"
+#include "simulation.h"
+#include "texture.h"
+
+// Encapsulates a classical field simulation on a 3D lattice. The fields are evolved by the same compute shaders as the 2D
+// simulation, specialised to 3D textures, so every model behaves the same apart from the dimension. Strings are measured by their
+// length and walls by their area instead of being counted on a plane.
+class VolumeSimulation
+{
+public:
+    // Run flag
+    bool runFlag = false;
+    // End time of the simulation in timesteps.
+    int maxTimesteps = 1000;
+    // Number of timesteps between string length and wall area samples. The first timestep is always sampled.
+    int stringCountCadence = 1;
+
+    // Destructor
+    ~VolumeSimulation();
+
+    // Creates a volume simulation of the given model with the given parameter values for its layout. Returns nullptr if the shaders
+    // fail to compile.
+    static VolumeSimulation *create(
+        SimulationModel model,
+        const SimulationLayout &layout,
+        const std::vector<float> &floatUniforms,
+        const std::vector<int32_t> &intUniforms,
+        float dx,
+        float dt,
+        int era);
+
+    // Randomises fields. Each field matches the CPU fields of Simulation::generateRandomFieldData on its first slice.
+    void randomiseFields(uint32_t width, uint32_t height, uint32_t depth, uint32_t seed);
+    // Updates the simulation by one timestep
+    void update();
+
+    // Returns the current simulation timestep
+    inline int getCurrentSimulationTimestep() const
+    {
+        return m_CurrentTimestep;
+    }
+    // Returns the current simulation time
+    inline float getCurrentSimulationTime() const
+    {
+        return m_CurrentTimestep * m_Dt;
+    }
+    // Returns the string length samples of each pair of fields, in units of dx. This is the number of plaquettes a string pierces.
+    inline const std::vector<std::vector<uint32_t>> &getStringLengths() const
+    {
+        return m_StringLengths;
+    }
+    // Returns the wall area samples of each field with walls, in units of dx squared. This is the number of links crossing a wall.
+    inline const std::vector<std::vector<uint32_t>> &getWallAreas() const
+    {
+        return m_WallAreas;
+    }
+    // Returns the number of bytes of texture memory taken up by the fields and their Laplacians
+    uint64_t getFieldMemoryUsage() const;
+
+private:
+    // Constructor
+    VolumeSimulation(
+        uint32_t numFields,
+        ComputeShaderProgram *evolveFieldPass,
+        ComputeShaderProgram *evolveVelocityPass,
+        ComputeShaderProgram *calculateAccelerationPass,
+        ComputeShaderProgram *updateAccelerationPass,
+        ComputeShaderProgram *calculateLaplacianPass,
+        ComputeShaderProgram *detectStringsPass,
+        ComputeShaderProgram *detectWallsPass,
+        ComputeShaderProgram *randomiseFieldPass,
+        const SimulationLayout &layout);
+
+    // Calculates the Laplacian of each field into a separate texture.
+    void calculateLaplacian();
+    // Calculates the acceleration and stores it in the fourth component of each field.
+    void calculateAcceleration();
+    // Measures the string length and wall area if the current timestep is sampled.
+    void sampleDefects();
+    // Runs a pass that takes a single field and dispatches it over the lattice
+    void dispatchFieldPass(ComputeShaderProgram *pass, size_t fieldIndex);
+
+    // Fields being simulated
+    std::vector<Texture3D> m_Fields;
+    // Laplacians of each field
+    std::vector<Texture3D> m_LaplacianTextures;
+    // Counts of the pierced plaquettes of each pair of fields followed by the wall crossing links of each field with walls
+    std::unique_ptr<ShaderStorageBuffer> m_DefectCountBuffer;
+    // String length samples of each pair of fields
+    std::vector<std::vector<uint32_t>> m_StringLengths;
+    // Wall area samples of each field with walls
+    std::vector<std::vector<uint32_t>> m_WallAreas;
+
+    // Calculate and update field
+    ComputeShaderProgram *m_EvolveFieldPass;
+    // Calculate and update the velocity
+    ComputeShaderProgram *m_EvolveVelocityPass;
+    // Calculate acceleration
+    ComputeShaderProgram *m_CalculateAccelerationPass;
+    // Update acceleration
+    ComputeShaderProgram *m_UpdateAccelerationPass;
+    // Calculate Laplacian into new texture
+    ComputeShaderProgram *m_CalculateLaplacianPass;
+    // Measure the string length. This is nullptr if the model has no strings.
+    ComputeShaderProgram *m_DetectStringsPass;
+    // Measure the wall area. This is nullptr if the model has no walls.
+    ComputeShaderProgram *m_DetectWallsPass;
+    // Generate random fields
+    ComputeShaderProgram *m_RandomiseFieldPass;
+
+    // Universal parameters
+    float m_Dx = 1.0f;
+    float m_Dt = 0.1f;
+    int m_Era = 1;
+    // Extra simulation parameters that are non-specific
+    SimulationLayout m_Layout;
+    // Uniforms
+    std::vector<float> m_FloatUniforms;
+    std::vector<int32_t> m_IntUniforms;
+
+    // Keep track of time
+    int m_CurrentTimestep = 1;
+    uint32_t m_NumFields = 0;
+    uint32_t m_XNumGroups = 0;
+    uint32_t m_YNumGroups = 0;
+    uint32_t m_ZNumGroups = 0;
+};
\ No newline at end of file
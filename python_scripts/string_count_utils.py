@@ -1,4 +1,6 @@
 import glob
+import os
+import struct
 import numpy as np
 import numpy.typing as npt
 from tqdm import tqdm
@@ -12,6 +14,157 @@ import matplotlib.axes
 from plot_string_count import get_string_count_file_header, parse_sc_data_file
 
 
+def parse_ensemble_file(file_name: str) -> tuple[dict, np.memmap]:
+    """Returns the header and a read-only memory map of the [channel][trial][sample] data block of a .ctde file."""
+    header = {}
+    with open(file_name, "rb") as ensemble_file:
+        magic = ensemble_file.read(4)
+        if magic != b"CTDE":
+            raise ValueError(f"{file_name} is not an ensemble file!")
+        (
+            header["version"],
+            header["header_size"],
+            header["num_completed_trials"],
+            header["data_type"],
+            header["num_channels"],
+            header["num_trials"],
+            header["num_samples"],
+            header["values_per_sample"],
+            header["cadence"],
+            header["max_timesteps"],
+            header["width"],
+            header["height"],
+            header["era"],
+            header["dt"],
+            header["dx"],
+        ) = struct.unpack("<12Iiff", ensemble_file.read(60))
+
+        def read_string() -> str:
+            length = struct.unpack("<I", ensemble_file.read(4))[0]
+            return ensemble_file.read(length).decode("utf-8")
+
+        header["model"] = read_string()
+        num_parameters = struct.unpack("<I", ensemble_file.read(4))[0]
+        header["parameters"] = {}
+        for _ in range(num_parameters):
+            name = read_string()
+            header["parameters"][name] = struct.unpack("<f", ensemble_file.read(4))[0]
+        header["seeds"] = np.frombuffer(
+            ensemble_file.read(4 * header["num_trials"]), dtype="<u4"
+        )
+
+    shape = (header["num_channels"], header["num_trials"], header["num_samples"])
+    if header["values_per_sample"] > 1:
+        shape = shape + (header["values_per_sample"],)
+    dtype = "<i4" if header["data_type"] == 0 else "<f4"
+    data = np.memmap(
+        file_name, dtype=dtype, mode="r", offset=header["header_size"], shape=shape
+    )
+    return header, data
+
+
+def get_ensemble_time_range(header: dict) -> npt.NDArray[np.float32]:
+    """Returns the simulation time of each sample. The nth sample is taken at timestep 1 + n * cadence."""
+    timesteps = 1 + header["cadence"] * np.arange(header["num_samples"])
+    return header["dt"] * timesteps
+
+
+def get_power_spectrum_wavenumbers(header: dict) -> npt.NDArray[np.float32]:
+    """Returns the wavenumber of each radial bin of a power spectrum ensemble. Bin b is centred on 2 pi b / (min(width, height) dx)."""
+    shorter_side = min(header["width"], header["height"])
+    return 2 * np.pi * np.arange(header["values_per_sample"]) / (shorter_side * header["dx"])
+
+
+def parse_string_location_file(
+    file_name: str,
+) -> tuple[dict, list[tuple[int, list[npt.NDArray[np.int32]]]]]:
+    """Returns the header and a list of (timestep, [N x 3 array of (x, y, sign) per pair of fields]) frames of a .ctds file."""
+    frames = []
+    with open(file_name, "rb") as location_file:
+        num_pairs, M, N = struct.unpack("<3I", location_file.read(12))
+        dt = struct.unpack("<f", location_file.read(4))[0]
+        header = {"num_pairs": num_pairs, "M": M, "N": N, "dt": dt}
+
+        while True:
+            timestep_bytes = location_file.read(4)
+            if len(timestep_bytes) < 4:
+                break
+            timestep = struct.unpack("<i", timestep_bytes)[0]
+            pair_records = []
+            for _ in range(num_pairs):
+                num_records = struct.unpack("<I", location_file.read(4))[0]
+                records = np.frombuffer(location_file.read(4 * num_records), dtype="<u4")
+                # Records pack x into bits 0-14, y into bits 15-29 and set bit 30 for an anti-string
+                x = (records & 0x7FFF).astype(np.int32)
+                y = ((records >> 15) & 0x7FFF).astype(np.int32)
+                sign = np.where((records >> 30) & 1, -1, 1).astype(np.int32)
+                pair_records.append(np.stack([x, y, sign], axis=1))
+            frames.append((timestep, pair_records))
+    return header, frames
+
+
+def parse_string_track_file(
+    file_name: str,
+) -> tuple[dict, list[tuple[int, list[tuple[npt.NDArray, npt.NDArray]]]]]:
+    """Returns the header and a list of (timestep, [(tracks, events) per pair of fields]) frames of a .ctdk file.
+
+    Tracks are a structured array of (id, sign, x, y, x_velocity, y_velocity, birth_timestep) and events are a structured array
+    of (type, timestep, track_id, partner_id, birth_timestep, x, y). An event type of 0 is a birth and 1 is an annihilation. A
+    partner id of 0xFFFFFFFF means no partner was found.
+    """
+    track_dtype = np.dtype(
+        [
+            ("id", "<u4"),
+            ("sign", "<i4"),
+            ("x", "<f4"),
+            ("y", "<f4"),
+            ("x_velocity", "<f4"),
+            ("y_velocity", "<f4"),
+            ("birth_timestep", "<i4"),
+        ]
+    )
+    event_dtype = np.dtype(
+        [
+            ("type", "<u4"),
+            ("timestep", "<i4"),
+            ("track_id", "<u4"),
+            ("partner_id", "<u4"),
+            ("birth_timestep", "<i4"),
+            ("x", "<f4"),
+            ("y", "<f4"),
+        ]
+    )
+    frames = []
+    with open(file_name, "rb") as track_file:
+        num_pairs, M, N = struct.unpack("<3I", track_file.read(12))
+        dt, dx = struct.unpack("<2f", track_file.read(8))
+        header = {"num_pairs": num_pairs, "M": M, "N": N, "dt": dt, "dx": dx}
+
+        while True:
+            timestep_bytes = track_file.read(4)
+            if len(timestep_bytes) < 4:
+                break
+            timestep = struct.unpack("<i", timestep_bytes)[0]
+            pair_frames = []
+            for _ in range(num_pairs):
+                num_tracks = struct.unpack("<I", track_file.read(4))[0]
+                tracks = np.frombuffer(track_file.read(track_dtype.itemsize * num_tracks), dtype=track_dtype)
+                num_events = struct.unpack("<I", track_file.read(4))[0]
+                events = np.frombuffer(track_file.read(event_dtype.itemsize * num_events), dtype=event_dtype)
+                pair_frames.append((tracks, events))
+            frames.append((timestep, pair_frames))
+    return header, frames
+
+
+def parse_string_count_statistics(file_name: str) -> npt.NDArray:
+    """Returns the string count statistics written by a campaign as a structured array.
+
+    Each row holds the channel, timestep, time, number of completed trials, mean, variance, min, max and the 5%, 25%, 50%, 75%
+    and 95% quantiles of one sample. The file is rewritten after each trial so it can be read while the campaign runs.
+    """
+    return np.genfromtxt(file_name, delimiter=",", names=True)
+
+
 def get_string_count_from_folder_names(
     folder_names: list[str], identifier_length: int
 ) -> tuple[dict[str, npt.NDArray[np.float32]], npt.NDArray[np.float32]]:
@@ -29,6 +182,21 @@ def get_string_count_from_folder_names(
         for n in folder_name[-identifier_length:]:
             short_identifier += n
 
+        # Prefer the ensemble file if it exists
+        ensemble_file_name = f"{folder_name}/string_counts.ctde"
+        if os.path.exists(ensemble_file_name):
+            header, data = parse_ensemble_file(ensemble_file_name)
+            time_range = get_ensemble_time_range(header)[start_timestep:]
+            if len(time_range) < max_time_length:
+                max_time_length = len(time_range)
+                time_range_all = time_range
+            # Only completed trials hold valid data
+            string_count[short_identifier] = np.array(
+                data[:, : header["num_completed_trials"], start_timestep:],
+                dtype=np.float32,
+            )
+            continue
+
         # Glob all trial data files
         string_count_file_names = list(
             glob.glob(f"{folder_name}/string_count_trial*.ctdsd")
@@ -0,0 +1,61 @@
+import struct
+
+import numpy as np
+import numpy.typing as npt
+
+# Channel encodings. These must match the `ChannelEncoding` enum in `encoding.h`.
+FLOAT32 = 0
+FLOAT16 = 1
+PHASE_UINT16 = 2
+STRING_2BIT = 3
+
+# The largest magnitude of a quantised phase
+PHASE_QUANTISATION_SCALE = 32767.0
+
+
+def decode_channel(
+    data: bytes, num_values: int, encoding: int
+) -> npt.NDArray[np.float32]:
+    if encoding == FLOAT32:
+        return np.frombuffer(data, dtype="<f4", count=num_values).astype(np.float32)
+    elif encoding == FLOAT16:
+        return np.frombuffer(data, dtype="<f2", count=num_values).astype(np.float32)
+    elif encoding == PHASE_UINT16:
+        quantised_phase = np.frombuffer(data, dtype="<u2", count=num_values)
+        return (
+            (quantised_phase.astype(np.float32) - PHASE_QUANTISATION_SCALE)
+            * np.pi
+            / PHASE_QUANTISATION_SCALE
+        ).astype(np.float32)
+    elif encoding == STRING_2BIT:
+        packed = np.frombuffer(data, dtype=np.uint8)
+        # Unpack four cells per byte, lowest bits first
+        codes = np.stack([(packed >> (2 * shift)) & 0b11 for shift in range(4)], axis=1)
+        codes = codes.reshape(-1)[:num_values]
+        values = np.zeros(num_values, dtype=np.float32)
+        values[codes == 0b01] = +1.0
+        values[codes == 0b11] = -1.0
+        return values
+    else:
+        raise ValueError(f"Unknown channel encoding {encoding}!")
+
+
+def parse_typed_data_file(
+    file_name: str,
+) -> list[tuple[npt.NDArray[np.float32], float, float]]:
+    """Returns a list of (values, simulation time, max error) per channel of a .ctdt file."""
+    channels = []
+    with open(file_name, "rb") as save_file:
+        num_channels = struct.unpack("<I", save_file.read(4))[0]
+        for _ in range(num_channels):
+            M = struct.unpack("<I", save_file.read(4))[0]
+            N = struct.unpack("<I", save_file.read(4))[0]
+            time = struct.unpack("<f", save_file.read(4))[0]
+            encoding = struct.unpack("<I", save_file.read(4))[0]
+            max_error = struct.unpack("<f", save_file.read(4))[0]
+            num_bytes = struct.unpack("<I", save_file.read(4))[0]
+            data = save_file.read(num_bytes)
+
+            values = decode_channel(data, M * N, encoding).reshape((M, N))
+            channels.append((values, time, max_error))
+    return channels
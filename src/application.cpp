@@ -1,4 +1,5 @@
 // Standard libraries
+#include <algorithm>
 #include <sstream>
 #include <stdio.h>
 #define _USE_MATH_DEFINES
@@ -48,6 +49,28 @@ const uint32_t indices[] = {
     3, 2, 0  // second triangle
 };
 
+// Helper function that creates a simulation of the given model at the given precision and sets its default field.
+static Simulation *createDefaultSimulation(SimulationModel model, FieldPrecision precision)
+{
+    Simulation *simulation = Simulation::createSimulation(model, precision);
+    switch (model)
+    {
+    case SimulationModel::DOMAIN_WALLS:
+        simulation->setField(Texture2D::loadCTDD("data/default/domain_walls_M256_N256_np20228.ctdd"));
+        break;
+    case SimulationModel::COSMIC_STRINGS:
+        simulation->setField(Texture2D::loadCTDD("data/default/cosmic_strings_M256_N256_np20228.ctdd"));
+        break;
+    case SimulationModel::SINGLE_AXION:
+        simulation->setField(Texture2D::loadCTDD("data/default/single_axion_M256_N256_np20228.ctdd"));
+        break;
+    case SimulationModel::COMPANION_AXION:
+        simulation->setField(Texture2D::loadCTDD("data/default/companion_axion_M256_N256_np20228.ctdd"));
+        break;
+    }
+    return simulation;
+}
+
 // Processes user input
 void processInput(GLFWwindow *window)
 {
@@ -357,8 +380,10 @@ void Application::onRender()
     // Plot the field
     if (m_currentPlottingProcedureIndex == 0)
     {
+        // The reduction uses its own program so it must run before the plot program is bound
+        float maxValue = m_Simulation->getMaxValue();
         m_PlotFieldProgram->use();
-        glUniform1f(0, m_Simulation->getMaxValue());
+        glUniform1f(0, maxValue);
         m_FieldColorMap->bindUnit(0);
         m_Simulation->getCurrentRenderTexture()->bindUnit(1);
     }
@@ -366,8 +391,9 @@ void Application::onRender()
     else if (m_currentPlottingProcedureIndex == 1 && phaseAvailable)
     {
 
+        // The phase texture is normalised by pi
         m_PlotFieldProgram->use();
-        glUniform1f(0, M_PI);
+        glUniform1f(0, 1.0f);
         m_PhaseColorMap->bindUnit(0);
         m_Simulation->getCurrentPhase()->bindUnit(1);
     }
@@ -382,8 +408,9 @@ void Application::onRender()
     // Plot the Laplacian
     else if (m_currentPlottingProcedureIndex == 3)
     {
+        float maxValue = m_Simulation->getMaxLaplacianValue();
         m_PlotFieldProgram->use();
-        glUniform1f(0, m_Simulation->getMaxValue());
+        glUniform1f(0, maxValue);
         m_FieldColorMap->bindUnit(0);
         m_Simulation->getCurrentLaplacian()->bindUnit(1);
     }
@@ -400,8 +427,9 @@ void Application::onRender()
     // For undefined indices or if the phase is unavailable, just plot the phase
     else
     {
+        float maxValue = m_Simulation->getMaxValue();
         m_PlotFieldProgram->use();
-        glUniform1f(0, m_Simulation->getMaxValue());
+        glUniform1f(0, maxValue);
         m_FieldColorMap->bindUnit(0);
         m_Simulation->getCurrentRenderTexture()->bindUnit(1);
     }
@@ -507,7 +535,50 @@ void Application::onImGuiRender()
             {
                 ImGui::Text("Pair %d: %d", stringIndex++, currentStringNumber);
             }
+            // String tracks
+            if (m_Simulation->trackStrings || m_Simulation->isStreamingStringTracks())
+            {
+                ImGui::Text("String tracks, births, annihilations and mean speed:");
+                int trackerIndex = 1;
+                for (const auto &stringTracker : m_Simulation->getStringTrackers())
+                {
+                    ImGui::Text("Pair %d: %d, %d, %d, %.3f", trackerIndex++, (int)stringTracker.getTracks().size(),
+                                stringTracker.getNumBirths(), stringTracker.getNumAnnihilations(), stringTracker.getMeanSpeed());
+                }
+            }
+        }
+        if (m_Simulation->hasWalls())
+        {
+            // Number of links crossing a wall
+            std::vector<int> wallNumbers = m_Simulation->getCurrentWallNumber();
+            ImGui::Text("Number of wall links:");
+            int wallIndex = 1;
+            for (const auto &currentWallNumber : wallNumbers)
+            {
+                ImGui::Text("Field %d: %d", wallIndex++, currentWallNumber);
+            }
         }
+        // Number of domains and string clusters
+        std::vector<ComponentStatistics> componentStatistics = m_Simulation->getCurrentComponentStatistics();
+        if (componentStatistics.size() > 0)
+        {
+            ImGui::Text("Number of domains and string clusters (largest):");
+            int componentIndex = 1;
+            for (const auto &currentStatistics : componentStatistics)
+            {
+                ImGui::Text("Channel %d: %d (%d)", componentIndex++, currentStatistics.numComponents, currentStatistics.largestSize);
+            }
+        }
+
+        // Latest energy budget
+        EnergyBudget energyBudget = m_Simulation->getCurrentEnergyBudget();
+        ImGui::Text("Energy: %f", energyBudget.getTotal());
+        ImGui::Text("Kinetic: %f, Gradient: %f, Potential: %f", energyBudget.kinetic, energyBudget.gradient, energyBudget.potential);
+
+        // Background file writes
+        IOServiceMetrics ioMetrics = m_Simulation->getIOMetrics();
+        ImGui::Text("Queued writes: %d (max %d)", ioMetrics.queueDepth, ioMetrics.maxQueueDepth);
+        ImGui::Text("Write stalls: %lld (%.1f ms)", ioMetrics.numStalledSubmissions, ioMetrics.totalStallMilliseconds);
     }
     ImGui::End();
     if (ImGui::Begin("Right hand Window"))
@@ -562,7 +633,7 @@ void Application::onImGuiRender()
         if (ImGui::Button("Save phase as"))
         {
             nfdchar_t *outPath;
-            nfdfilteritem_t filterItem[1] = {{"cosmotd Data Files", "ctdd"}};
+            nfdfilteritem_t filterItem[1] = {{"cosmotd Typed Data Files", "ctdt"}};
             nfdresult_t result = NFD_SaveDialog(&outPath, filterItem, 1, nullptr, nullptr);
             if (result == NFD_OKAY)
             {
@@ -584,7 +655,7 @@ void Application::onImGuiRender()
         if (ImGui::Button("Save Laplacian as"))
         {
             nfdchar_t *outPath;
-            nfdfilteritem_t filterItem[1] = {{"cosmotd Data Files", "ctdd"}};
+            nfdfilteritem_t filterItem[1] = {{"cosmotd Typed Data Files", "ctdt"}};
             nfdresult_t result = NFD_SaveDialog(&outPath, filterItem, 1, nullptr, nullptr);
             if (result == NFD_OKAY)
             {
@@ -603,6 +674,108 @@ void Application::onImGuiRender()
                 logError("Save file dialog error: %s", NFD_GetError());
             }
         }
+        if (ImGui::Button("Save strings as"))
+        {
+            nfdchar_t *outPath;
+            nfdfilteritem_t filterItem[1] = {{"cosmotd Typed Data Files", "ctdt"}};
+            nfdresult_t result = NFD_SaveDialog(&outPath, filterItem, 1, nullptr, nullptr);
+            if (result == NFD_OKAY)
+            {
+                m_Simulation->saveStrings(outPath);
+                logDebug("Saving strings at path %s", outPath);
+
+                // Free file path after use
+                NFD_FreePath(outPath);
+            }
+            else if (result == NFD_CANCEL)
+            {
+                logDebug("Cancelling save file dialog...");
+            }
+            else
+            {
+                logError("Save file dialog error: %s", NFD_GetError());
+            }
+        }
+        if (m_Simulation->hasStrings() && m_Simulation->isStreamingStringLocations())
+        {
+            if (ImGui::Button("Stop streaming string locations"))
+            {
+                m_Simulation->stopStringLocationStream();
+            }
+        }
+        else if (m_Simulation->hasStrings() && ImGui::Button("Stream string locations to"))
+        {
+            nfdchar_t *outPath;
+            nfdfilteritem_t filterItem[1] = {{"cosmotd String Location Files", "ctds"}};
+            nfdresult_t result = NFD_SaveDialog(&outPath, filterItem, 1, nullptr, nullptr);
+            if (result == NFD_OKAY)
+            {
+                m_Simulation->startStringLocationStream(outPath);
+                logDebug("Streaming string locations to path %s", outPath);
+
+                // Free file path after use
+                NFD_FreePath(outPath);
+            }
+            else if (result == NFD_CANCEL)
+            {
+                logDebug("Cancelling save file dialog...");
+            }
+            else
+            {
+                logError("Save file dialog error: %s", NFD_GetError());
+            }
+        }
+        if (m_Simulation->hasStrings() && m_Simulation->isStreamingStringTracks())
+        {
+            if (ImGui::Button("Stop streaming string tracks"))
+            {
+                m_Simulation->stopStringTrackStream();
+            }
+        }
+        else if (m_Simulation->hasStrings() && ImGui::Button("Stream string tracks to"))
+        {
+            nfdchar_t *outPath;
+            nfdfilteritem_t filterItem[1] = {{"cosmotd String Track Files", "ctdk"}};
+            nfdresult_t result = NFD_SaveDialog(&outPath, filterItem, 1, nullptr, nullptr);
+            if (result == NFD_OKAY)
+            {
+                m_Simulation->startStringTrackStream(outPath);
+                logDebug("Streaming string tracks to path %s", outPath);
+
+                // Free file path after use
+                NFD_FreePath(outPath);
+            }
+            else if (result == NFD_CANCEL)
+            {
+                logDebug("Cancelling save file dialog...");
+            }
+            else
+            {
+                logError("Save file dialog error: %s", NFD_GetError());
+            }
+        }
+        if (ImGui::Button("Save half precision field as"))
+        {
+            nfdchar_t *outPath;
+            nfdfilteritem_t filterItem[1] = {{"cosmotd Typed Data Files", "ctdt"}};
+            nfdresult_t result = NFD_SaveDialog(&outPath, filterItem, 1, nullptr, nullptr);
+            if (result == NFD_OKAY)
+            {
+                m_Simulation->saveTypedFields(outPath, ChannelEncoding::FLOAT16);
+                logDebug("Saving half precision field at path %s", outPath);
+
+                // Free file path after use
+                NFD_FreePath(outPath);
+            }
+            else if (result == NFD_CANCEL)
+            {
+                logDebug("Cancelling save file dialog...");
+            }
+            else
+            {
+                logError("Save file dialog error: %s", NFD_GetError());
+            }
+        }
         if (ImGui::Button("Save string counts as"))
         {
             nfdchar_t *outPath;
@@ -625,6 +798,50 @@ void Application::onImGuiRender()
                 logError("Save file dialog error: %s", NFD_GetError());
             }
         }
+        if (ImGui::Button("Save energies as"))
+        {
+            nfdchar_t *outPath;
+            nfdfilteritem_t filterItem[1] = {{"cosmotd Ensemble Files", "ctde"}};
+            nfdresult_t result = NFD_SaveDialog(&outPath, filterItem, 1, nullptr, nullptr);
+            if (result == NFD_OKAY)
+            {
+                m_Simulation->saveEnergies(outPath);
+                logDebug("Saving energies at path %s", outPath);
+
+                // Free file path after use
+                NFD_FreePath(outPath);
+            }
+            else if (result == NFD_CANCEL)
+            {
+                logDebug("Cancelling save file dialog...");
+            }
+            else
+            {
+                logError("Save file dialog error: %s", NFD_GetError());
+            }
+        }
+        if (ImGui::Button("Save power spectra as"))
+        {
+            nfdchar_t *outPath;
+            nfdfilteritem_t filterItem[1] = {{"cosmotd Ensemble Files", "ctde"}};
+            nfdresult_t result = NFD_SaveDialog(&outPath, filterItem, 1, nullptr, nullptr);
+            if (result == NFD_OKAY)
+            {
+                m_Simulation->savePowerSpectra(outPath);
+                logDebug("Saving power spectra at path %s", outPath);
+
+                // Free file path after use
+                NFD_FreePath(outPath);
+            }
+            else if (result == NFD_CANCEL)
+            {
+                logDebug("Cancelling save file dialog...");
+            }
+            else
+            {
+                logError("Save file dialog error: %s", NFD_GetError());
+            }
+        }
 
         // NOTE: The field dimensions should always be a multiple of 8 in order for the simulation to run properly, and also
         // power of 2. This means the supported values are 8, 16, 32, 64, 128, 256, 512, 1024
@@ -634,6 +851,25 @@ void Application::onImGuiRender()
         ImGui::SliderInt("Field width", &fieldWidth, 0, 1000);
         ImGui::SliderInt("Field height", &fieldHeight, 0, 1000);
         ImGui::InputInt("Seed", &seed);
+        // Random fields are white noise unless they are filtered to a correlated spectrum
+        const char *availableSpectra[] = {"White noise", "Gaussian", "Power law"};
+        InitialSpectrum &initialSpectrum = m_Simulation->initialSpectrum;
+        int currentSpectrum = (int)initialSpectrum.type;
+        if (ImGui::Combo("Initial spectrum", &currentSpectrum, availableSpectra, IM_ARRAYSIZE(availableSpectra)))
+        {
+            initialSpectrum.type = (InitialSpectrumType)currentSpectrum;
+        }
+        if (initialSpectrum.type != InitialSpectrumType::WHITE_NOISE)
+        {
+            if (ImGui::InputFloat("Correlation length", &initialSpectrum.correlationLength))
+            {
+                initialSpectrum.correlationLength = std::max(initialSpectrum.correlationLength, 0.0f);
+            }
+        }
+        if (initialSpectrum.type == InitialSpectrumType::POWER_LAW)
+        {
+            ImGui::InputFloat("Spectral index", &initialSpectrum.spectralIndex);
+        }
         if (ImGui::Button("Randomise Fields"))
         {
             m_Simulation->randomiseFields((uint32_t)fieldWidth, (uint32_t)fieldHeight, (uint32_t)seed);
@@ -718,32 +954,10 @@ void Application::onImGuiRender()
                 {
                     m_currentSimulationProcedure = availableSimulationProcedures[n];
 
-                    // Set new simulation
+                    // Set new simulation at the same precision
+                    FieldPrecision precision = m_Simulation->getPrecision();
                     delete m_Simulation;
-                    if (n == 0)
-                    {
-                        m_Simulation = Simulation::createDomainWallSimulation();
-                        // Set field
-                        m_Simulation->setField(Texture2D::loadCTDD("data/default/domain_walls_M256_N256_np20228.ctdd"));
-                    }
-                    else if (n == 1)
-                    {
-                        m_Simulation = Simulation::createCosmicStringSimulation();
-                        // Set field
-                        m_Simulation->setField(Texture2D::loadCTDD("data/default/cosmic_strings_M256_N256_np20228.ctdd"));
-                    }
-                    else if (n == 2)
-                    {
-                        m_Simulation = Simulation::createSingleAxionSimulation();
-                        // Set field
-                        m_Simulation->setField(Texture2D::loadCTDD("data/default/single_axion_M256_N256_np20228.ctdd"));
-                    }
-                    else if (n == 3)
-                    {
-                        m_Simulation = Simulation::createCompanionAxionSimulation();
-                        // Set field
-                        m_Simulation->setField(Texture2D::loadCTDD("data/default/companion_axion_M256_N256_np20228.ctdd"));
-                    }
+                    m_Simulation = createDefaultSimulation((SimulationModel)n, precision);
                 }
                 if (isSelected)
                 {
@@ -753,6 +967,23 @@ void Application::onImGuiRender()
             ImGui::EndCombo();
         }
 
+        const char *availablePrecisions[] = {"Single", "Half"};
+        int currentPrecision = (int)m_Simulation->getPrecision();
+        if (ImGui::Combo("Field precision", &currentPrecision, availablePrecisions, IM_ARRAYSIZE(availablePrecisions)) &&
+            currentPrecision != (int)m_Simulation->getPrecision())
+        {
+            // Set new simulation of the same model
+            SimulationModel model = m_Simulation->getModel();
+            delete m_Simulation;
+            m_Simulation = createDefaultSimulation(model, (FieldPrecision)currentPrecision);
+        }
+        const char *availableOperators[] = {"Stencil", "Spectral"};
+        int currentOperator = (int)m_Simulation->laplacianOperator;
+        if (ImGui::Combo("Laplacian", &currentOperator, availableOperators, IM_ARRAYSIZE(availableOperators)))
+        {
+            m_Simulation->laplacianOperator = (LaplacianOperator)currentOperator;
+        }
+
         ImGui::Text("Simulation Controls and Parameters");
         m_Simulation->onUIRender();
 
@@ -765,11 +996,124 @@ void Application::onImGuiRender()
 
         ImGui::InputInt("Number of trials", &numTrials);
         ImGui::InputInt("Starting Seed", &trialSeed);
+        if (ImGui::InputInt("Count cadence", &m_Simulation->stringCountCadence))
+        {
+            m_Simulation->stringCountCadence = std::max(m_Simulation->stringCountCadence, 1);
+        }
+        ImGui::Checkbox("Track strings", &m_Simulation->trackStrings);
+        if (ImGui::InputFloat("Tracking radius", &m_Simulation->trackingRadius))
+        {
+            m_Simulation->trackingRadius = std::max(m_Simulation->trackingRadius, 1.0f);
+        }
+        if (ImGui::InputInt("Checkpoint interval", &m_Simulation->checkpointInterval, 100, 1000))
+        {
+            m_Simulation->checkpointInterval = std::max(m_Simulation->checkpointInterval, 0);
+        }
+        if (ImGui::InputInt("Energy cadence", &m_Simulation->energyCadence))
+        {
+            m_Simulation->energyCadence = std::max(m_Simulation->energyCadence, 0);
+        }
+        if (ImGui::InputInt("Spectrum cadence", &m_Simulation->spectrumCadence))
+        {
+            m_Simulation->spectrumCadence = std::max(m_Simulation->spectrumCadence, 0);
+        }
+        if (ImGui::InputInt("Component cadence", &m_Simulation->componentCadence))
+        {
+            m_Simulation->componentCadence = std::max(m_Simulation->componentCadence, 0);
+        }
+        ImGui::Checkbox("Refine defects", &m_Simulation->refineDefects);
+        if (ImGui::InputInt("Regrid interval", &m_Simulation->regridInterval))
+        {
+            m_Simulation->regridInterval = std::max(m_Simulation->regridInterval, 1);
+        }
+        if (m_Simulation->refineDefects && m_Simulation->getMeshRefinement() != nullptr)
+        {
+            const MeshRefinement *meshRefinement = m_Simulation->getMeshRefinement();
+            ImGui::Text("Refined tiles: %d of %d (%.1f MB)", meshRefinement->getNumPatches(), meshRefinement->getNumTiles(),
+                        meshRefinement->getMemoryUsage() / 1048576.0);
+        }
+        if (ImGui::InputInt("Domain sectors", &m_Simulation->domainSectors))
+        {
+            m_Simulation->domainSectors = std::max(m_Simulation->domainSectors, 1);
+        }
+        if (ImGui::InputInt("Stop after no defects for", &m_Simulation->zeroDefectWindow, 100, 1000))
+        {
+            m_Simulation->zeroDefectWindow = std::max(m_Simulation->zeroDefectWindow, 0);
+        }
+        if (ImGui::InputInt("Stop after a plateau for", &m_Simulation->plateauWindow, 100, 1000))
+        {
+            m_Simulation->plateauWindow = std::max(m_Simulation->plateauWindow, 0);
+        }
+        if (ImGui::InputFloat("Plateau tolerance", &m_Simulation->plateauTolerance))
+        {
+            m_Simulation->plateauTolerance = std::max(m_Simulation->plateauTolerance, 0.0f);
+        }
+        if (ImGui::InputFloat("Blow up threshold", &m_Simulation->blowUpThreshold))
+        {
+            m_Simulation->blowUpThreshold = std::max(m_Simulation->blowUpThreshold, 0.0f);
+        }
+        ImGui::Checkbox("Classify outcomes", &m_Simulation->classifyOutcomes);
+        if (m_Simulation->classifyOutcomes)
+        {
+            OutcomeClassifier &outcomeClassifier = m_Simulation->getOutcomeClassifier();
+            ImGui::Checkbox("Stop once classified", &m_Simulation->stopWhenClassified);
+            if (ImGui::InputInt("Classify from timestep", &outcomeClassifier.minTimestep, 100, 1000))
+            {
+                outcomeClassifier.minTimestep = std::max(outcomeClassifier.minTimestep, 0);
+            }
+            if (ImGui::InputInt("Slope window", &outcomeClassifier.slopeWindow, 100, 1000))
+            {
+                outcomeClassifier.slopeWindow = std::max(outcomeClassifier.slopeWindow, 1);
+            }
+            if (ImGui::InputInt("Confidence window", &outcomeClassifier.confidenceWindow, 100, 1000))
+            {
+                outcomeClassifier.confidenceWindow = std::max(outcomeClassifier.confidenceWindow, 0);
+            }
+        }
 
         if (ImGui::Button("Run trials"))
         {
             m_Simulation->runRandomTrials(fieldWidth, fieldHeight, numTrials, trialSeed, outFolder);
         }
+        ImGui::SameLine();
+        if (ImGui::Button("Benchmark precision"))
+        {
+            m_Simulation->runPrecisionBenchmark(fieldWidth, fieldHeight, trialSeed, outFolder);
+        }
+        ImGui::SameLine();
+        if (ImGui::Button("Benchmark Laplacian"))
+        {
+            m_Simulation->runLaplacianBenchmark(outFolder);
+        }
+
+        // Batched trials evolve many small trials at once, which keeps the GPU busy on lattices too small to fill it
+        static int batchSize = 16;
+        if (ImGui::InputInt("Batch size", &batchSize, 1, 16))
+        {
+            batchSize = std::max(batchSize, 1);
+        }
+        if (ImGui::Button("Run batched trials"))
+        {
+            m_Simulation->runBatchedTrials(fieldWidth, fieldHeight, numTrials, batchSize, trialSeed, outFolder);
+        }
+        // Each line of the sweep file after the parameter names is a configuration that runs the number of trials
+        static std::string sweepPath = std::string("data/sweep.csv");
+        ImGui::InputText("Sweep file", &sweepPath);
+        if (ImGui::Button("Run parameter sweep"))
+        {
+            m_Simulation->runParameterSweep(fieldWidth, fieldHeight, numTrials, batchSize, trialSeed, sweepPath, outFolder);
+        }
+
+        // Volume runs share the model, parameters and run length of the simulation
+        static int fieldDepth = 64;
+        if (ImGui::InputInt("Field depth", &fieldDepth, 8, 64))
+        {
+            fieldDepth = std::max(fieldDepth, 4);
+        }
+        if (ImGui::Button("Run volume"))
+        {
+            m_Simulation->runVolumeTrial(fieldWidth, fieldHeight, fieldDepth, trialSeed, outFolder);
+        }
     }
     ImGui::End();
 
@@ -0,0 +1,401 @@
+// Standard libraries
+#include <algorithm>
+
+// External libraries
+#include <glad/glad.h>
+
+// Internal libraries
+#include "batch_simulation.h"
+
+// Work group size along each axis of a layer. Work groups never span layers so that each one adds to the counts of a single trial.
+constexpr uint32_t WORK_GROUP_SIZE = 8;
+
+// Defines that specialise the shaders shared with the 2D simulation to layers of a texture array at single precision, with the
+// model parameters of each layer read from a buffer
+static const char *BATCH_SHADER_PREAMBLE =
+    "#define FIELD_FORMAT rgba32f\n#define LAPLACIAN_FORMAT r32f\n#define LAYERED\n#define LAYER_PARAMETERS\n"
+    "#define LATTICE_IMAGE image2DArray\n#define LATTICE_POSITION ivec3\n#define INVOCATION_POSITION ivec3(gl_GlobalInvocationID)\n"
+    "#define WORK_GROUP_SIZE_X 8\n#define WORK_GROUP_SIZE_Y 8\n#define WORK_GROUP_SIZE_Z 1\n#define PRS_ALPHA 2.0f\n";
+
+BatchSimulation::BatchSimulation(
+    uint32_t numFields,
+    ComputeShaderProgram *evolveFieldPass,
+    ComputeShaderProgram *evolveVelocityPass,
+    ComputeShaderProgram *calculateAccelerationPass,
+    ComputeShaderProgram *updateAccelerationPass,
+    ComputeShaderProgram *calculateLaplacianPass,
+    ComputeShaderProgram *countStringsPass,
+    ComputeShaderProgram *countWallsPass,
+    ComputeShaderProgram *randomiseFieldPass)
+    : m_EvolveFieldPass(evolveFieldPass),
+      m_EvolveVelocityPass(evolveVelocityPass),
+      m_CalculateAccelerationPass(calculateAccelerationPass),
+      m_UpdateAccelerationPass(updateAccelerationPass),
+      m_CalculateLaplacianPass(calculateLaplacianPass),
+      m_CountStringsPass(countStringsPass),
+      m_CountWallsPass(countWallsPass),
+      m_RandomiseFieldPass(randomiseFieldPass),
+      m_NumFields(numFields)
+{
+    m_Fields.resize(m_NumFields);
+    m_LaplacianTextures.resize(m_NumFields);
+    // Each pair of fields has strings, and a single real field has walls of its own
+    uint32_t numPhases = m_NumFields / 2;
+    m_NumStringChannels = m_CountStringsPass != nullptr ? numPhases : 0;
+    m_NumWallChannels = m_CountWallsPass != nullptr ? (m_NumFields == 1 ? 1 : numPhases) : 0;
+}
+
+BatchSimulation::~BatchSimulation()
+{
+    delete m_EvolveFieldPass;
+    delete m_EvolveVelocityPass;
+    delete m_CalculateAccelerationPass;
+    delete m_UpdateAccelerationPass;
+    delete m_CalculateLaplacianPass;
+    delete m_CountStringsPass;
+    delete m_CountWallsPass;
+    delete m_RandomiseFieldPass;
+    delete m_RandomFieldFilter;
+}
+
+BatchSimulation *BatchSimulation::create(
+    SimulationModel model, const std::vector<std::pair<std::string, float>> &parameters, float dx, float dt, int era)
+{
+    const char *accelerationShaderPath = nullptr;
+    uint32_t numFields = 0;
+    bool hasStrings = false;
+    bool hasWalls = false;
+    switch (model)
+    {
+    case SimulationModel::DOMAIN_WALLS:
+        accelerationShaderPath = "shaders/domain_walls.glsl";
+        numFields = 1;
+        hasWalls = true;
+        break;
+    case SimulationModel::COSMIC_STRINGS:
+        accelerationShaderPath = "shaders/cosmic_strings.glsl";
+        numFields = 2;
+        hasStrings = true;
+        break;
+    case SimulationModel::SINGLE_AXION:
+        accelerationShaderPath = "shaders/single_axion.glsl";
+        numFields = 2;
+        hasStrings = true;
+        hasWalls = true;
+        break;
+    case SimulationModel::COMPANION_AXION:
+        accelerationShaderPath = "shaders/companion_axion.glsl";
+        numFields = 4;
+        hasStrings = true;
+        hasWalls = true;
+        break;
+    default:
+        logError("Unknown simulation model!");
+        return nullptr;
+    }
+
+    ComputeShaderProgram *evolveFieldPass =
+        ComputeShaderProgram::createFromFile("shaders/evolve_field.glsl", BATCH_SHADER_PREAMBLE);
+    ComputeShaderProgram *evolveVelocityPass =
+        ComputeShaderProgram::createFromFile("shaders/evolve_velocity.glsl", BATCH_SHADER_PREAMBLE);
+    ComputeShaderProgram *calculateAccelerationPass =
+        ComputeShaderProgram::createFromFile(accelerationShaderPath, BATCH_SHADER_PREAMBLE);
+    ComputeShaderProgram *updateAccelerationPass =
+        ComputeShaderProgram::createFromFile("shaders/update_acceleration.glsl", BATCH_SHADER_PREAMBLE);
+    ComputeShaderProgram *calculateLaplacianPass =
+        ComputeShaderProgram::createFromFile("shaders/calculate_laplacian.glsl", BATCH_SHADER_PREAMBLE);
+    ComputeShaderProgram *countStringsPass =
+        hasStrings ? ComputeShaderProgram::createFromFile("shaders/count_strings.glsl", BATCH_SHADER_PREAMBLE) : nullptr;
+    ComputeShaderProgram *countWallsPass =
+        hasWalls ? ComputeShaderProgram::createFromFile("shaders/count_walls.glsl", BATCH_SHADER_PREAMBLE) : nullptr;
+    ComputeShaderProgram *randomiseFieldPass =
+        ComputeShaderProgram::createFromFile("shaders/randomise_field.glsl", BATCH_SHADER_PREAMBLE);
+
+    BatchSimulation *simulation = new BatchSimulation(
+        numFields,
+        evolveFieldPass,
+        evolveVelocityPass,
+        calculateAccelerationPass,
+        updateAccelerationPass,
+        calculateLaplacianPass,
+        countStringsPass,
+        countWallsPass,
+        randomiseFieldPass);
+    if (evolveFieldPass == nullptr || evolveVelocityPass == nullptr || calculateAccelerationPass == nullptr ||
+        updateAccelerationPass == nullptr || calculateLaplacianPass == nullptr || (hasStrings && countStringsPass == nullptr) ||
+        (hasWalls && countWallsPass == nullptr) || randomiseFieldPass == nullptr)
+    {
+        logError("Failed to compile the shaders of the %s batch simulation!", convertSimulationModelToString(model).c_str());
+        delete simulation;
+        return nullptr;
+    }
+    for (const auto &[name, value] : parameters)
+    {
+        simulation->m_Parameters.push_back(value);
+    }
+    simulation->m_Dx = dx;
+    simulation->m_Dt = dt;
+    simulation->m_Era = era;
+    return simulation;
+}
+
+void BatchSimulation::setTrialParameters(const std::vector<std::vector<float>> &trialParameters)
+{
+    m_TrialParameters = trialParameters;
+}
+
+void BatchSimulation::randomiseFields(uint32_t width, uint32_t height, const std::vector<uint32_t> &seeds)
+{
+    uint32_t numTrials = seeds.size();
+
+    // Reset timestep
+    m_CurrentTimestep = 1;
+    m_XNumGroups = (width + WORK_GROUP_SIZE - 1) / WORK_GROUP_SIZE;
+    m_YNumGroups = (height + WORK_GROUP_SIZE - 1) / WORK_GROUP_SIZE;
+
+    // Resize textures if necessary
+    for (size_t fieldIndex = 0; fieldIndex < m_NumFields; fieldIndex++)
+    {
+        Texture2DArray &field = m_Fields[fieldIndex];
+        if (field.width != width || field.height != height || field.numLayers != numTrials)
+        {
+            field = Texture2DArray(width, height, numTrials, GL_RGBA32F);
+            m_LaplacianTextures[fieldIndex] = Texture2DArray(width, height, numTrials, GL_R32F);
+        }
+    }
+    uint32_t numCounts = std::max((m_NumStringChannels + m_NumWallChannels) * numTrials, (uint32_t)1);
+    if (m_DefectCountBuffer == nullptr || m_DefectCountBuffer->size != numCounts * sizeof(uint32_t))
+    {
+        m_DefectCountBuffer = std::make_unique<ShaderStorageBuffer>(numCounts * sizeof(uint32_t), BufferUsageType::DYNAMIC_COPY);
+    }
+    m_NumTrials = numTrials;
+
+    // Pack the parameters of each trial into consecutive blocks
+    std::vector<float> parameterData;
+    for (uint32_t trialIndex = 0; trialIndex < numTrials; trialIndex++)
+    {
+        bool hasOwnParameters = trialIndex < m_TrialParameters.size();
+        if (hasOwnParameters && m_TrialParameters[trialIndex].size() != m_Parameters.size())
+        {
+            logWarning("Trial %d has %d parameter values instead of %d! Using the default values.", trialIndex,
+                       (int)m_TrialParameters[trialIndex].size(), (int)m_Parameters.size());
+            hasOwnParameters = false;
+        }
+        const std::vector<float> &parameters = hasOwnParameters ? m_TrialParameters[trialIndex] : m_Parameters;
+        parameterData.insert(parameterData.end(), parameters.begin(), parameters.end());
+    }
+    uint32_t parameterBufferSize = std::max((uint32_t)(parameterData.size() * sizeof(float)), (uint32_t)sizeof(float));
+    if (m_ParameterBuffer == nullptr || m_ParameterBuffer->size != parameterBufferSize)
+    {
+        m_ParameterBuffer = std::make_unique<ShaderStorageBuffer>(parameterBufferSize, BufferUsageType::DYNAMIC_DRAW);
+    }
+    m_ParameterBuffer->write(0, parameterData.size() * sizeof(float), parameterData.data());
+
+    // Each layer is randomised with the seed of its trial in a single dispatch per field
+    uint32_t seedBufferSize = std::max((uint32_t)(numTrials * sizeof(uint32_t)), (uint32_t)sizeof(uint32_t));
+    if (m_SeedBuffer == nullptr || m_SeedBuffer->size != seedBufferSize)
+    {
+        m_SeedBuffer = std::make_unique<ShaderStorageBuffer>(seedBufferSize, BufferUsageType::DYNAMIC_DRAW);
+    }
+    m_SeedBuffer->write(0, numTrials * sizeof(uint32_t), seeds.data());
+    m_RandomiseFieldPass->use();
+    m_SeedBuffer->bindBase(0);
+    for (size_t fieldIndex = 0; fieldIndex < m_NumFields; fieldIndex++)
+    {
+        glUniform1ui(1, fieldIndex);
+        glBindImageTexture(0, m_Fields[fieldIndex].textureID, 0, GL_TRUE, 0, GL_WRITE_ONLY, GL_RGBA32F);
+        glDispatchCompute(m_XNumGroups, m_YNumGroups, m_NumTrials);
+    }
+    glMemoryBarrier(GL_ALL_BARRIER_BITS);
+
+    // Correlate the noise of each pair of fields of each trial to the initial spectrum. The transform works on single textures, so
+    // each layer is copied out, filtered and copied back, which gives the same fields as a simulation with the same seed.
+    if (initialSpectrum.type != InitialSpectrumType::WHITE_NOISE)
+    {
+        Texture2D layerTextures[2];
+        for (auto &layerTexture : layerTextures)
+        {
+            glTextureStorage2D(layerTexture.textureID, 1, GL_RGBA32F, width, height);
+            layerTexture.width = width;
+            layerTexture.height = height;
+        }
+
+        // Random fields are filtered to their initial spectrum on the GPU. The filter is only created once it is needed, and
+        // creation is only attempted once.
+        if (!m_HasCreatedRandomFieldFilter)
+        {
+            m_RandomFieldFilter = RandomFieldFilter::create();
+            m_HasCreatedRandomFieldFilter = true;
+        }
+        // Every layer has the same size and spectrum, so if filtering fails it fails on the first layer and all stay white noise
+        bool isFiltered = m_RandomFieldFilter != nullptr;
+        for (uint32_t trialIndex = 0; trialIndex < numTrials && isFiltered; trialIndex++)
+        {
+            for (uint32_t fieldIndex = 0; fieldIndex < m_NumFields && isFiltered; fieldIndex += 2)
+            {
+                uint32_t numPairedFields = std::min(m_NumFields - fieldIndex, (uint32_t)2);
+                for (uint32_t pairIndex = 0; pairIndex < numPairedFields; pairIndex++)
+                {
+                    glCopyImageSubData(
+                        m_Fields[fieldIndex + pairIndex].textureID, GL_TEXTURE_2D_ARRAY, 0, 0, 0, trialIndex,
+                        layerTextures[pairIndex].textureID, GL_TEXTURE_2D, 0, 0, 0, 0,
+                        width, height, 1);
+                }
+                isFiltered =
+                    m_RandomFieldFilter->filter(&layerTextures[0], numPairedFields > 1 ? &layerTextures[1] : nullptr, initialSpectrum);
+                for (uint32_t pairIndex = 0; isFiltered && pairIndex < numPairedFields; pairIndex++)
+                {
+                    glCopyImageSubData(
+                        layerTextures[pairIndex].textureID, GL_TEXTURE_2D, 0, 0, 0, 0,
+                        m_Fields[fieldIndex + pairIndex].textureID, GL_TEXTURE_2D_ARRAY, 0, 0, 0, trialIndex,
+                        width, height, 1);
+                }
+            }
+        }
+        if (!isFiltered)
+        {
+            logWarning("Could not filter the random fields to the %s initial spectrum! Using white noise instead.",
+                       convertInitialSpectrumTypeToString(initialSpectrum.type).c_str());
+        }
+        glMemoryBarrier(GL_ALL_BARRIER_BITS);
+    }
+
+    m_StringNumbers.assign(numTrials, std::vector<std::vector<int>>(m_NumStringChannels));
+    m_WallNumbers.assign(numTrials, std::vector<std::vector<int>>(m_NumWallChannels));
+    calculateLaplacian();
+    sampleDefects();
+}
+
+void BatchSimulation::update()
+{
+    // Stop running after hitting max timesteps
+    if (m_CurrentTimestep >= maxTimesteps)
+    {
+        runFlag = false;
+    }
+
+    // Do not update if not running
+    if (!runFlag)
+    {
+        return;
+    }
+
+    // Evolve field
+    for (size_t fieldIndex = 0; fieldIndex < m_Fields.size(); fieldIndex++)
+    {
+        dispatchFieldPass(m_EvolveFieldPass, fieldIndex);
+    }
+    calculateLaplacian();
+
+    // Update time
+    m_CurrentTimestep += 1;
+    sampleDefects();
+
+    // Calculate next acceleration
+    calculateAcceleration();
+
+    // Update velocity and then acceleration
+    for (size_t fieldIndex = 0; fieldIndex < m_Fields.size(); fieldIndex++)
+    {
+        dispatchFieldPass(m_EvolveVelocityPass, fieldIndex);
+    }
+    for (size_t fieldIndex = 0; fieldIndex < m_Fields.size(); fieldIndex++)
+    {
+        dispatchFieldPass(m_UpdateAccelerationPass, fieldIndex);
+    }
+}
+
+uint64_t BatchSimulation::getFieldMemoryUsage() const
+{
+    // Four 32 bit channels per field and one per Laplacian
+    uint64_t numCells = (uint64_t)m_Fields[0].width * m_Fields[0].height * m_Fields[0].numLayers;
+    return numCells * (16 + 4) * m_NumFields;
+}
+
+void BatchSimulation::calculateLaplacian()
+{
+    for (size_t fieldIndex = 0; fieldIndex < m_Fields.size(); fieldIndex++)
+    {
+        m_CalculateLaplacianPass->use();
+        glUniform1f(0, m_Dx);
+        glBindImageTexture(0, m_Fields[fieldIndex].textureID, 0, GL_TRUE, 0, GL_READ_ONLY, GL_RGBA32F);
+        glBindImageTexture(1, m_LaplacianTextures[fieldIndex].textureID, 0, GL_TRUE, 0, GL_WRITE_ONLY, GL_R32F);
+        // Dispatch and barrier
+        glDispatchCompute(m_XNumGroups, m_YNumGroups, m_NumTrials);
+        glMemoryBarrier(GL_ALL_BARRIER_BITS);
+    }
+}
+
+void BatchSimulation::calculateAcceleration()
+{
+    m_CalculateAccelerationPass->use();
+    glUniform1f(0, m_CurrentTimestep * m_Dt);
+    glUniform1f(1, m_Dt);
+    glUniform1i(2, m_Era);
+    m_ParameterBuffer->bindBase(0);
+    for (size_t fieldIndex = 0; fieldIndex < m_Fields.size(); fieldIndex++)
+    {
+        // Bind field and its Laplacian
+        glBindImageTexture(2 * fieldIndex, m_Fields[fieldIndex].textureID, 0, GL_TRUE, 0, GL_READ_WRITE, GL_RGBA32F);
+        glBindImageTexture(2 * fieldIndex + 1, m_LaplacianTextures[fieldIndex].textureID, 0, GL_TRUE, 0, GL_READ_ONLY, GL_R32F);
+    }
+
+    // Dispatch and barrier
+    glDispatchCompute(m_XNumGroups, m_YNumGroups, m_NumTrials);
+    glMemoryBarrier(GL_ALL_BARRIER_BITS);
+}
+
+void BatchSimulation::sampleDefects()
+{
+    if ((m_CurrentTimestep - 1) % std::max(stringCountCadence, 1) != 0 || m_NumStringChannels + m_NumWallChannels == 0)
+    {
+        return;
+    }
+
+    m_DefectCountBuffer->clear(0, m_DefectCountBuffer->size);
+    m_DefectCountBuffer->bindBase(0);
+    for (size_t stringIndex = 0; stringIndex < m_NumStringChannels; stringIndex++)
+    {
+        m_CountStringsPass->use();
+        glUniform1i(0, stringIndex);
+        glBindImageTexture(0, m_Fields[2 * stringIndex].textureID, 0, GL_TRUE, 0, GL_READ_ONLY, GL_RGBA32F);
+        glBindImageTexture(1, m_Fields[2 * stringIndex + 1].textureID, 0, GL_TRUE, 0, GL_READ_ONLY, GL_RGBA32F);
+        glDispatchCompute(m_XNumGroups, m_YNumGroups, m_NumTrials);
+    }
+    for (size_t wallIndex = 0; wallIndex < m_NumWallChannels; wallIndex++)
+    {
+        m_CountWallsPass->use();
+        bool isComplex = m_Fields.size() > 1;
+        glUniform1i(0, m_NumStringChannels + wallIndex);
+        glUniform1i(1, isComplex);
+        glBindImageTexture(0, m_Fields[isComplex ? 2 * wallIndex : 0].textureID, 0, GL_TRUE, 0, GL_READ_ONLY, GL_RGBA32F);
+        glBindImageTexture(1, m_Fields[isComplex ? 2 * wallIndex + 1 : 0].textureID, 0, GL_TRUE, 0, GL_READ_ONLY, GL_RGBA32F);
+        glDispatchCompute(m_XNumGroups, m_YNumGroups, m_NumTrials);
+    }
+    glMemoryBarrier(GL_ALL_BARRIER_BITS);
+
+    // The counts of every trial come back in a single read, ordered by channel and then by trial
+    std::vector<uint32_t> counts((m_NumStringChannels + m_NumWallChannels) * m_NumTrials);
+    m_DefectCountBuffer->read(0, counts.size() * sizeof(uint32_t), counts.data());
+    for (uint32_t trialIndex = 0; trialIndex < m_NumTrials; trialIndex++)
+    {
+        for (uint32_t stringIndex = 0; stringIndex < m_NumStringChannels; stringIndex++)
+        {
+            m_StringNumbers[trialIndex][stringIndex].push_back(counts[stringIndex * m_NumTrials + trialIndex]);
+        }
+        for (uint32_t wallIndex = 0; wallIndex < m_NumWallChannels; wallIndex++)
+        {
+            m_WallNumbers[trialIndex][wallIndex].push_back(counts[(m_NumStringChannels + wallIndex) * m_NumTrials + trialIndex]);
+        }
+    }
+}
+
+void BatchSimulation::dispatchFieldPass(ComputeShaderProgram *pass, size_t fieldIndex)
+{
+    pass->use();
+    glUniform1f(0, m_Dt);
+    glBindImageTexture(0, m_Fields[fieldIndex].textureID, 0, GL_TRUE, 0, GL_READ_WRITE, GL_RGBA32F);
+    // Dispatch and barrier
+    glDispatchCompute(m_XNumGroups, m_YNumGroups, m_NumTrials);
+    glMemoryBarrier(GL_ALL_BARRIER_BITS);
+}
\ No newline at end of file
@@ -1,4 +1,6 @@
 // Standard libraries
+#include <algorithm>
+#include <cstring>
 #include <intrin.h>
 
 // External libraries
@@ -315,4 +317,138 @@ void VertexArray::unbind()
 {
     logLoop("Unbinding vertex array with ID %d...", arrayID);
     glBindVertexArray(0);
+}
+
+ShaderStorageBuffer::ShaderStorageBuffer(uint32_t size, BufferUsageType usageType) : size(size)
+{
+    glGenBuffers(1, &bufferID);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, bufferID);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, size, nullptr, convertBufferUsageTypeToOpenGLEnum(usageType));
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    clear(0, size);
+    logDebug("Shader storage buffer successfully created with ID %d.", bufferID);
+}
+
+ShaderStorageBuffer::~ShaderStorageBuffer()
+{
+    logDebug("Shader storage buffer with ID %d is being destroyed...", bufferID);
+    glDeleteBuffers(1, &bufferID);
+    logDebug("Shader storage buffer with ID %d has been destroyed.", bufferID);
+}
+
+void ShaderStorageBuffer::bindBase(uint32_t binding)
+{
+    logLoop("Binding shader storage buffer with ID %d to binding %d.", bufferID, binding);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, binding, bufferID);
+}
+
+void ShaderStorageBuffer::clear(uint32_t offset, uint32_t numBytes)
+{
+    uint32_t zero = 0;
+    glClearNamedBufferSubData(bufferID, GL_R32UI, offset, numBytes, GL_RED_INTEGER, GL_UNSIGNED_INT, &zero);
+}
+
+void ShaderStorageBuffer::read(uint32_t offset, uint32_t numBytes, void *destination)
+{
+    glGetNamedBufferSubData(bufferID, offset, numBytes, destination);
+}
+
+void ShaderStorageBuffer::write(uint32_t offset, uint32_t numBytes, const void *source)
+{
+    glNamedBufferSubData(bufferID, offset, numBytes, source);
+}
+
+ReadbackBuffer::ReadbackBuffer()
+{
+    glGenBuffers(1, &bufferID);
+    logDebug("Readback buffer successfully created with ID %d.", bufferID);
+}
+
+ReadbackBuffer::~ReadbackBuffer()
+{
+    logDebug("Readback buffer with ID %d is being destroyed...", bufferID);
+    if (m_Fence != nullptr)
+    {
+        glDeleteSync((GLsync)m_Fence);
+    }
+    glDeleteBuffers(1, &bufferID);
+    logDebug("Readback buffer with ID %d has been destroyed.", bufferID);
+}
+
+void ReadbackBuffer::readTexture(uint32_t textureID, uint32_t format, uint32_t type, uint32_t numBytes)
+{
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, bufferID);
+    // Only reallocate when growing
+    if (numBytes > size)
+    {
+        glBufferData(GL_PIXEL_PACK_BUFFER, numBytes, nullptr, GL_STREAM_READ);
+        size = numBytes;
+    }
+
+    // With a pixel pack buffer bound the read is queued instead of stalling until the data arrives
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glGetTextureImage(textureID, 0, format, type, numBytes, nullptr);
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    if (m_Fence != nullptr)
+    {
+        glDeleteSync((GLsync)m_Fence);
+    }
+    m_Fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+void ReadbackBuffer::readBuffer(uint32_t sourceBufferID, uint32_t offset, uint32_t numBytes)
+{
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, bufferID);
+    // Only reallocate when growing
+    if (numBytes > size)
+    {
+        glBufferData(GL_PIXEL_PACK_BUFFER, numBytes, nullptr, GL_STREAM_READ);
+        size = numBytes;
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    // The copy is queued on the GPU like any other command
+    glCopyNamedBufferSubData(sourceBufferID, bufferID, offset, 0, numBytes);
+
+    if (m_Fence != nullptr)
+    {
+        glDeleteSync((GLsync)m_Fence);
+    }
+    m_Fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+bool ReadbackBuffer::isReady()
+{
+    if (m_Fence == nullptr)
+    {
+        return true;
+    }
+    GLenum result = glClientWaitSync((GLsync)m_Fence, 0, 0);
+    return result == GL_ALREADY_SIGNALED || result == GL_CONDITION_SATISFIED;
+}
+
+void ReadbackBuffer::copyTo(void *destination, uint32_t numBytes)
+{
+    if (m_Fence != nullptr)
+    {
+        // Flush so that the fence is guaranteed to be signalled eventually
+        glClientWaitSync((GLsync)m_Fence, GL_SYNC_FLUSH_COMMANDS_BIT, UINT64_MAX);
+        glDeleteSync((GLsync)m_Fence);
+        m_Fence = nullptr;
+    }
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, bufferID);
+    void *data = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, std::min(numBytes, size), GL_MAP_READ_BIT);
+    if (data != nullptr)
+    {
+        memcpy(destination, data, std::min(numBytes, size));
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+    else
+    {
+        logError("Failed to map readback buffer with ID %d!", bufferID);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
 }
\ No newline at end of file
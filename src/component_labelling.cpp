@@ -0,0 +1,134 @@
+// Standard libraries
+#include <algorithm>
+
+// External libraries
+#include <glad/glad.h>
+
+// Internal libraries
+#include "component_labelling.h"
+
+// Width and height of each work group
+constexpr uint32_t LABEL_GROUP_SIZE = 8;
+
+ComponentLabelling::ComponentLabelling(
+    ComputeShaderProgram *initialisePass,
+    ComputeShaderProgram *mergePass,
+    ComputeShaderProgram *countPass,
+    ComputeShaderProgram *histogramPass)
+    : m_InitialisePass(initialisePass),
+      m_MergePass(mergePass),
+      m_CountPass(countPass),
+      m_HistogramPass(histogramPass)
+{
+    m_SummaryBuffer = std::make_unique<ShaderStorageBuffer>(NUM_SUMMARY_VALUES * sizeof(uint32_t), BufferUsageType::DYNAMIC_COPY);
+}
+
+ComponentLabelling::~ComponentLabelling()
+{
+    delete m_InitialisePass;
+    delete m_MergePass;
+    delete m_CountPass;
+    delete m_HistogramPass;
+}
+
+void ComponentLabelling::label(Texture2D *texture, ComponentClassType classType, uint32_t numSectors, ReadbackBuffer &result)
+{
+    uint32_t numCells = texture->width * texture->height;
+    uint32_t numBytes = numCells * sizeof(uint32_t);
+    if (m_ParentBuffer == nullptr || m_ParentBuffer->size != numBytes)
+    {
+        m_ParentBuffer = std::make_unique<ShaderStorageBuffer>(numBytes, BufferUsageType::DYNAMIC_COPY);
+        m_ClassBuffer = std::make_unique<ShaderStorageBuffer>(numBytes, BufferUsageType::DYNAMIC_COPY);
+        m_SizeBuffer = std::make_unique<ShaderStorageBuffer>(numBytes, BufferUsageType::DYNAMIC_COPY);
+    }
+    uint32_t xNumGroups = std::max((texture->width + LABEL_GROUP_SIZE - 1) / LABEL_GROUP_SIZE, (uint32_t)1);
+    uint32_t yNumGroups = std::max((texture->height + LABEL_GROUP_SIZE - 1) / LABEL_GROUP_SIZE, (uint32_t)1);
+
+    m_ParentBuffer->bindBase(0);
+    m_ClassBuffer->bindBase(1);
+    m_SizeBuffer->bindBase(2);
+    m_SummaryBuffer->bindBase(3);
+
+    // Classify the cells
+    m_InitialisePass->use();
+    glUniform1i(0, (int)classType);
+    glUniform1i(1, std::max(numSectors, (uint32_t)1));
+    texture->bindUnit(0);
+    glDispatchCompute(xNumGroups, yNumGroups, 1);
+    glMemoryBarrier(GL_ALL_BARRIER_BITS);
+    texture->unbindUnit(0);
+
+    // Merge neighbouring cells
+    m_MergePass->use();
+    glUniform2i(0, texture->width, texture->height);
+    glDispatchCompute(xNumGroups, yNumGroups, 1);
+    glMemoryBarrier(GL_ALL_BARRIER_BITS);
+
+    // Flatten the forest and count the components
+    m_CountPass->use();
+    glUniform2i(0, texture->width, texture->height);
+    glDispatchCompute(xNumGroups, yNumGroups, 1);
+    glMemoryBarrier(GL_ALL_BARRIER_BITS);
+
+    // Summarise the components
+    m_SummaryBuffer->clear(0, NUM_SUMMARY_VALUES * sizeof(uint32_t));
+    m_HistogramPass->use();
+    glUniform2i(0, texture->width, texture->height);
+    glDispatchCompute(xNumGroups, yNumGroups, 1);
+    glMemoryBarrier(GL_ALL_BARRIER_BITS);
+
+    result.readBuffer(m_SummaryBuffer->bufferID, 0, NUM_SUMMARY_VALUES * sizeof(uint32_t));
+}
+
+ComponentStatistics ComponentLabelling::getResult(ReadbackBuffer &result)
+{
+    int32_t values[NUM_SUMMARY_VALUES];
+    result.copyTo(values, sizeof(values));
+    return unflattenStatistics(values);
+}
+
+ComponentStatistics ComponentLabelling::labelNow(Texture2D *texture, ComponentClassType classType, uint32_t numSectors)
+{
+    label(texture, classType, numSectors, m_ImmediateResult);
+    return getResult(m_ImmediateResult);
+}
+
+std::vector<int32_t> ComponentLabelling::flattenStatistics(const ComponentStatistics &statistics)
+{
+    std::vector<int32_t> values(NUM_SUMMARY_VALUES, 0);
+    values[0] = statistics.numComponents;
+    values[1] = statistics.largestSize;
+    for (size_t binIndex = 0; binIndex < std::min(statistics.sizeBins.size(), (size_t)NUM_SIZE_BINS); binIndex++)
+    {
+        values[2 + binIndex] = statistics.sizeBins[binIndex];
+    }
+    return values;
+}
+
+ComponentStatistics ComponentLabelling::unflattenStatistics(const int32_t *values)
+{
+    ComponentStatistics statistics;
+    statistics.numComponents = values[0];
+    statistics.largestSize = values[1];
+    statistics.sizeBins.assign(values + 2, values + NUM_SUMMARY_VALUES);
+    return statistics;
+}
+
+ComponentLabelling *ComponentLabelling::create()
+{
+    ComputeShaderProgram *initialisePass = ComputeShaderProgram::createFromFile("shaders/label_components_init.glsl");
+    ComputeShaderProgram *mergePass = ComputeShaderProgram::createFromFile("shaders/label_components_merge.glsl");
+    ComputeShaderProgram *countPass = ComputeShaderProgram::createFromFile("shaders/label_components_count.glsl");
+    ComputeShaderProgram *histogramPass = ComputeShaderProgram::createFromFile("shaders/label_components_histogram.glsl");
+    if (initialisePass == nullptr || mergePass == nullptr || countPass == nullptr || histogramPass == nullptr)
+    {
+        logError("Failed to create the component labelling passes!");
+        delete initialisePass;
+        delete mergePass;
+        delete countPass;
+        delete histogramPass;
+        return nullptr;
+    }
+
+    return new ComponentLabelling(initialisePass, mergePass, countPass, histogramPass);
+}
\ No newline at end of file
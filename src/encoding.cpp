@@ -0,0 +1,234 @@
+// Standard libraries
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+// External libraries
+
+// Internal libraries
+#include "encoding.h"
+
+constexpr float PI = 3.1415926535897932384626433832795f;
+// The largest magnitude of a quantised phase. This is the same as the largest value of a signed normalised 16-bit integer.
+constexpr float PHASE_QUANTISATION_SCALE = 32767.0f;
+
+float getChannelEncodingMaxError(ChannelEncoding encoding)
+{
+    switch (encoding)
+    {
+    case ChannelEncoding::FLOAT32:
+        return 0.0f;
+    case ChannelEncoding::FLOAT16:
+        // Half of the unit in the last place of a 10-bit mantissa
+        return 1.0f / 2048.0f;
+    case ChannelEncoding::PHASE_UINT16:
+        // Half of a quantisation step
+        return PI / (2.0f * PHASE_QUANTISATION_SCALE);
+    case ChannelEncoding::STRING_2BIT:
+        return 0.0f;
+    default:
+        logError("Unknown channel encoding!");
+        return 0.0f;
+    }
+}
+
+uint16_t convertFloatToHalf(float value)
+{
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(float));
+
+    uint32_t sign = (bits >> 16) & 0x8000;
+    int32_t floatExponent = (bits >> 23) & 0xFF;
+    uint32_t mantissa = bits & 0x7FFFFF;
+
+    // Infinity and NaN
+    if (floatExponent == 0xFF)
+    {
+        return (uint16_t)(sign | 0x7C00 | (mantissa ? 0x200 : 0));
+    }
+
+    // Rebias the exponent
+    int32_t exponent = floatExponent - 127 + 15;
+
+    // Overflow to infinity
+    if (exponent >= 31)
+    {
+        return (uint16_t)(sign | 0x7C00);
+    }
+
+    // Subnormal half or underflow to zero
+    if (exponent <= 0)
+    {
+        if (exponent < -10)
+        {
+            return (uint16_t)sign;
+        }
+        // Add the implicit leading bit and shift into place
+        mantissa |= 0x800000;
+        uint32_t shift = (uint32_t)(14 - exponent);
+        uint32_t halfMantissa = mantissa >> shift;
+        uint32_t remainder = mantissa & ((1u << shift) - 1);
+        uint32_t halfway = 1u << (shift - 1);
+        // Round to nearest even
+        if (remainder > halfway || (remainder == halfway && (halfMantissa & 1)))
+        {
+            halfMantissa++;
+        }
+        return (uint16_t)(sign | halfMantissa);
+    }
+
+    uint32_t half = sign | ((uint32_t)exponent << 10) | (mantissa >> 13);
+    uint32_t remainder = mantissa & 0x1FFF;
+    // Round to nearest even. A carry into the exponent is the correctly rounded result.
+    if (remainder > 0x1000 || (remainder == 0x1000 && (half & 1)))
+    {
+        half++;
+    }
+    return (uint16_t)half;
+}
+
+float convertHalfToFloat(uint16_t value)
+{
+    uint32_t sign = ((uint32_t)value & 0x8000) << 16;
+    uint32_t exponent = (value >> 10) & 0x1F;
+    uint32_t mantissa = value & 0x3FF;
+
+    uint32_t bits;
+    if (exponent == 0)
+    {
+        // Zero and subnormals
+        float result = std::ldexp((float)mantissa, -24);
+        return sign ? -result : result;
+    }
+    else if (exponent == 31)
+    {
+        // Infinity and NaN
+        bits = sign | 0x7F800000 | (mantissa << 13);
+    }
+    else
+    {
+        bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+    }
+
+    float result;
+    memcpy(&result, &bits, sizeof(float));
+    return result;
+}
+
+uint16_t quantisePhase(float phase)
+{
+    float normalisedPhase = std::clamp(phase / PI, -1.0f, 1.0f);
+    return (uint16_t)(std::lround(normalisedPhase * PHASE_QUANTISATION_SCALE) + (long)PHASE_QUANTISATION_SCALE);
+}
+
+float dequantisePhase(uint16_t quantisedPhase)
+{
+    return ((float)quantisedPhase - PHASE_QUANTISATION_SCALE) * PI / PHASE_QUANTISATION_SCALE;
+}
+
+std::vector<uint8_t> encodeChannel(const std::vector<float> &values, ChannelEncoding encoding)
+{
+    std::vector<uint8_t> bytes;
+    switch (encoding)
+    {
+    case ChannelEncoding::FLOAT32:
+        bytes.resize(values.size() * sizeof(float));
+        memcpy(bytes.data(), values.data(), bytes.size());
+        break;
+    case ChannelEncoding::FLOAT16:
+        bytes.resize(values.size() * sizeof(uint16_t));
+        for (size_t valueIndex = 0; valueIndex < values.size(); valueIndex++)
+        {
+            uint16_t half = convertFloatToHalf(values[valueIndex]);
+            memcpy(&bytes[valueIndex * sizeof(uint16_t)], &half, sizeof(uint16_t));
+        }
+        break;
+    case ChannelEncoding::PHASE_UINT16:
+        bytes.resize(values.size() * sizeof(uint16_t));
+        for (size_t valueIndex = 0; valueIndex < values.size(); valueIndex++)
+        {
+            uint16_t quantisedPhase = quantisePhase(values[valueIndex]);
+            memcpy(&bytes[valueIndex * sizeof(uint16_t)], &quantisedPhase, sizeof(uint16_t));
+        }
+        break;
+    case ChannelEncoding::STRING_2BIT:
+        // Four cells per byte. +1 is stored as 0b01 and -1 as 0b11 (two's complement).
+        bytes.resize((values.size() + 3) / 4, 0);
+        for (size_t valueIndex = 0; valueIndex < values.size(); valueIndex++)
+        {
+            uint8_t code = 0;
+            if (values[valueIndex] > 0.5f)
+            {
+                code = 0b01;
+            }
+            else if (values[valueIndex] < -0.5f)
+            {
+                code = 0b11;
+            }
+            bytes[valueIndex / 4] |= code << (2 * (valueIndex % 4));
+        }
+        break;
+    default:
+        logError("Unknown channel encoding!");
+        break;
+    }
+    return bytes;
+}
+
+std::vector<float> decodeChannel(const std::vector<uint8_t> &bytes, size_t numValues, ChannelEncoding encoding)
+{
+    std::vector<float> values(numValues, 0.0f);
+    switch (encoding)
+    {
+    case ChannelEncoding::FLOAT32:
+        memcpy(values.data(), bytes.data(), std::min(bytes.size(), numValues * sizeof(float)));
+        break;
+    case ChannelEncoding::FLOAT16:
+        for (size_t valueIndex = 0; valueIndex < numValues; valueIndex++)
+        {
+            uint16_t half;
+            memcpy(&half, &bytes[valueIndex * sizeof(uint16_t)], sizeof(uint16_t));
+            values[valueIndex] = convertHalfToFloat(half);
+        }
+        break;
+    case ChannelEncoding::PHASE_UINT16:
+        for (size_t valueIndex = 0; valueIndex < numValues; valueIndex++)
+        {
+            uint16_t quantisedPhase;
+            memcpy(&quantisedPhase, &bytes[valueIndex * sizeof(uint16_t)], sizeof(uint16_t));
+            values[valueIndex] = dequantisePhase(quantisedPhase);
+        }
+        break;
+    case ChannelEncoding::STRING_2BIT:
+        for (size_t valueIndex = 0; valueIndex < numValues; valueIndex++)
+        {
+            uint8_t code = (bytes[valueIndex / 4] >> (2 * (valueIndex % 4))) & 0b11;
+            values[valueIndex] = code == 0b01 ? 1.0f : (code == 0b11 ? -1.0f : 0.0f);
+        }
+        break;
+    default:
+        logError("Unknown channel encoding!");
+        break;
+    }
+    return values;
+}
+
+void writeEncodedChannel(
+    std::ofstream &dataFile, uint32_t M, uint32_t N, float simulationTime, ChannelEncoding encoding,
+    const std::vector<float> &values)
+{
+    std::vector<uint8_t> encodedData = encodeChannel(values, encoding);
+    uint32_t encodingIndex = (uint32_t)encoding;
+    float maxError = getChannelEncodingMaxError(encoding);
+    uint32_t numBytes = encodedData.size();
+
+    // Channel header
+    dataFile.write(reinterpret_cast<char *>(&M), sizeof(uint32_t));
+    dataFile.write(reinterpret_cast<char *>(&N), sizeof(uint32_t));
+    dataFile.write(reinterpret_cast<char *>(&simulationTime), sizeof(float));
+    dataFile.write(reinterpret_cast<char *>(&encodingIndex), sizeof(uint32_t));
+    dataFile.write(reinterpret_cast<char *>(&maxError), sizeof(float));
+    dataFile.write(reinterpret_cast<char *>(&numBytes), sizeof(uint32_t));
+    // Encoded data
+    dataFile.write(reinterpret_cast<char *>(encodedData.data()), numBytes);
+}
\ No newline at end of file
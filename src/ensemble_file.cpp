@@ -0,0 +1,307 @@
+// Standard libraries
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+
+// External libraries
+
+// Internal libraries
+#include "ensemble_file.h"
+
+// Version of the ensemble file format
+constexpr uint32_t ENSEMBLE_FILE_VERSION = 1;
+// Byte offset of the number of completed trials in the header
+constexpr uint64_t COMPLETED_TRIALS_OFFSET = 12;
+// The data block is aligned to this many bytes
+constexpr uint64_t DATA_ALIGNMENT = 64;
+
+// Helper function that appends a value's bytes to a byte buffer.
+template <typename T>
+static void appendBytes(std::vector<char> &buffer, const T &value)
+{
+    const char *bytes = reinterpret_cast<const char *>(&value);
+    buffer.insert(buffer.end(), bytes, bytes + sizeof(T));
+}
+
+// Helper function that reads a value from a file.
+template <typename T>
+static T readValue(std::ifstream &dataFile)
+{
+    T value;
+    dataFile.read(reinterpret_cast<char *>(&value), sizeof(T));
+    return value;
+}
+
+// Helper function that reads a length prefixed string from a file.
+static std::string readString(std::ifstream &dataFile)
+{
+    uint32_t length = readValue<uint32_t>(dataFile);
+    std::string value(length, '\0');
+    dataFile.read(value.data(), length);
+    return value;
+}
+
+// Helper function that appends a length prefixed string to a byte buffer.
+static void appendString(std::vector<char> &buffer, const std::string &value)
+{
+    appendBytes(buffer, (uint32_t)value.size());
+    buffer.insert(buffer.end(), value.begin(), value.end());
+}
+
+EnsembleFile::EnsembleFile(const char *filePath, const EnsembleHeader &header, uint64_t dataOffset)
+    : header(header), m_FilePath(filePath), m_DataOffset(dataOffset)
+{
+    m_File.exceptions(std::fstream::failbit | std::fstream::badbit);
+    m_File.open(filePath, std::ios::binary | std::ios::in | std::ios::out);
+}
+
+EnsembleFile::~EnsembleFile()
+{
+    if (m_File.is_open())
+    {
+        m_File.close();
+    }
+}
+
+void EnsembleFile::writeSamples(uint32_t channelIndex, uint32_t trialIndex, const std::vector<int32_t> &samples)
+{
+    if (header.dataType != EnsembleDataType::INT32)
+    {
+        logError(
+            "Can not write INT32 samples to an ensemble file of type %s!", convertEnsembleDataTypeToString(header.dataType).c_str());
+        return;
+    }
+    writeSampleBytes(channelIndex, trialIndex, reinterpret_cast<const char *>(samples.data()), samples.size() * sizeof(int32_t));
+}
+
+void EnsembleFile::writeSamples(uint32_t channelIndex, uint32_t trialIndex, const std::vector<float> &samples)
+{
+    if (header.dataType != EnsembleDataType::FLOAT32)
+    {
+        logError(
+            "Can not write FLOAT32 samples to an ensemble file of type %s!", convertEnsembleDataTypeToString(header.dataType).c_str());
+        return;
+    }
+    writeSampleBytes(channelIndex, trialIndex, reinterpret_cast<const char *>(samples.data()), samples.size() * sizeof(float));
+}
+
+void EnsembleFile::writeSampleBytes(uint32_t channelIndex, uint32_t trialIndex, const char *data, size_t numBytes)
+{
+    if (channelIndex >= header.numChannels || trialIndex >= header.numTrials)
+    {
+        logError(
+            "Ensemble file index (channel %d, trial %d) is out of bounds (%d, %d)!",
+            channelIndex, trialIndex, header.numChannels, header.numTrials);
+        return;
+    }
+
+    // All data types are 4 bytes wide
+    uint64_t trialSize = (uint64_t)header.numSamples * header.valuesPerSample * 4;
+    uint64_t offset = m_DataOffset + ((uint64_t)channelIndex * header.numTrials + trialIndex) * trialSize;
+
+    // Pad or truncate to the size of a trial
+    std::vector<char> trialData(trialSize, 0);
+    memcpy(trialData.data(), data, std::min((uint64_t)numBytes, trialSize));
+
+    try
+    {
+        m_File.seekp(offset);
+        m_File.write(trialData.data(), trialSize);
+    }
+    catch (std::fstream::failure &e)
+    {
+        logError("Failed to write to ensemble file at path: %s - %s", m_FilePath.c_str(), e.what());
+    }
+}
+
+void EnsembleFile::completeTrial()
+{
+    numCompletedTrials++;
+    try
+    {
+        m_File.seekp(COMPLETED_TRIALS_OFFSET);
+        m_File.write(reinterpret_cast<char *>(&numCompletedTrials), sizeof(uint32_t));
+        m_File.flush();
+    }
+    catch (std::fstream::failure &e)
+    {
+        logError("Failed to write to ensemble file at path: %s - %s", m_FilePath.c_str(), e.what());
+    }
+}
+
+bool EnsembleFile::readSamples(uint32_t channelIndex, uint32_t trialIndex, std::vector<float> &samples)
+{
+    if (channelIndex >= header.numChannels || trialIndex >= header.numTrials)
+    {
+        logError(
+            "Ensemble file index (channel %d, trial %d) is out of bounds (%d, %d)!",
+            channelIndex, trialIndex, header.numChannels, header.numTrials);
+        return false;
+    }
+
+    uint64_t numValues = (uint64_t)header.numSamples * header.valuesPerSample;
+    uint64_t offset = m_DataOffset + ((uint64_t)channelIndex * header.numTrials + trialIndex) * numValues * 4;
+    samples.resize(numValues);
+    try
+    {
+        m_File.seekg(offset);
+        m_File.read(reinterpret_cast<char *>(samples.data()), numValues * 4);
+    }
+    catch (std::fstream::failure &e)
+    {
+        logError("Failed to read from ensemble file at path: %s - %s", m_FilePath.c_str(), e.what());
+        return false;
+    }
+
+    // Integer samples are converted in place since both types are 4 bytes wide
+    if (header.dataType == EnsembleDataType::INT32)
+    {
+        for (auto &sample : samples)
+        {
+            int32_t value;
+            memcpy(&value, &sample, sizeof(int32_t));
+            sample = value;
+        }
+    }
+    return true;
+}
+
+EnsembleFile *EnsembleFile::create(const char *filePath, const EnsembleHeader &header)
+{
+    if (header.seeds.size() != header.numTrials)
+    {
+        logError("The number of seeds %d does not match the number of trials %d!", header.seeds.size(), header.numTrials);
+        return nullptr;
+    }
+
+    // Serialise the header
+    std::vector<char> headerData;
+    headerData.insert(headerData.end(), {'C', 'T', 'D', 'E'});
+    appendBytes(headerData, ENSEMBLE_FILE_VERSION);
+    // Placeholder for the header size
+    appendBytes(headerData, (uint32_t)0);
+    // No trials have been completed yet
+    appendBytes(headerData, (uint32_t)0);
+    appendBytes(headerData, (uint32_t)header.dataType);
+    appendBytes(headerData, header.numChannels);
+    appendBytes(headerData, header.numTrials);
+    appendBytes(headerData, header.numSamples);
+    appendBytes(headerData, header.valuesPerSample);
+    appendBytes(headerData, header.cadence);
+    appendBytes(headerData, header.maxTimesteps);
+    appendBytes(headerData, header.width);
+    appendBytes(headerData, header.height);
+    appendBytes(headerData, header.era);
+    appendBytes(headerData, header.dt);
+    appendBytes(headerData, header.dx);
+    appendString(headerData, header.modelName);
+    appendBytes(headerData, (uint32_t)header.parameters.size());
+    for (const auto &[name, value] : header.parameters)
+    {
+        appendString(headerData, name);
+        appendBytes(headerData, value);
+    }
+    for (uint32_t seed : header.seeds)
+    {
+        appendBytes(headerData, seed);
+    }
+
+    // Pad the header so that the data block is aligned
+    uint64_t headerSize = ((headerData.size() + DATA_ALIGNMENT - 1) / DATA_ALIGNMENT) * DATA_ALIGNMENT;
+    headerData.resize(headerSize, 0);
+    uint32_t headerSizeValue = headerSize;
+    memcpy(&headerData[8], &headerSizeValue, sizeof(uint32_t));
+
+    uint64_t dataSize = (uint64_t)header.numChannels * header.numTrials * header.numSamples * header.valuesPerSample * 4;
+
+    std::string tempPath = std::string(filePath) + ".tmp";
+    try
+    {
+        std::ofstream dataFile;
+        dataFile.exceptions(std::ofstream::failbit | std::ofstream::badbit);
+        dataFile.open(tempPath, std::ios::binary | std::ios::trunc);
+        dataFile.write(headerData.data(), headerSize);
+        dataFile.close();
+
+        // Allocate the zeroed data block up front so that the file can always be memory mapped
+        std::filesystem::resize_file(tempPath, headerSize + dataSize);
+        std::filesystem::rename(tempPath, filePath);
+
+        logTrace("Created ensemble file at path %s with a %d byte header and a %lld byte data block.", filePath, headerSize, dataSize);
+        return new EnsembleFile(filePath, header, headerSize);
+    }
+    catch (std::ofstream::failure &e)
+    {
+        logError("Failed to create ensemble file at path: %s - %s", filePath, e.what());
+    }
+    catch (std::filesystem::filesystem_error &e)
+    {
+        logError("Failed to allocate ensemble file at path: %s - %s", filePath, e.what());
+    }
+    return nullptr;
+}
+
+EnsembleFile *EnsembleFile::open(const char *filePath)
+{
+    EnsembleHeader header;
+    uint32_t numCompletedTrials;
+    uint32_t headerSize;
+
+    std::ifstream dataFile;
+    dataFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
+    try
+    {
+        dataFile.open(filePath, std::ios::binary);
+
+        char magic[4];
+        dataFile.read(magic, 4);
+        if (memcmp(magic, "CTDE", 4) != 0)
+        {
+            logError("The file at path %s is not an ensemble file!", filePath);
+            return nullptr;
+        }
+        uint32_t version = readValue<uint32_t>(dataFile);
+        if (version != ENSEMBLE_FILE_VERSION)
+        {
+            logError("The ensemble file at path %s has an unsupported version %d!", filePath, version);
+            return nullptr;
+        }
+        headerSize = readValue<uint32_t>(dataFile);
+        numCompletedTrials = readValue<uint32_t>(dataFile);
+        header.dataType = (EnsembleDataType)readValue<uint32_t>(dataFile);
+        header.numChannels = readValue<uint32_t>(dataFile);
+        header.numTrials = readValue<uint32_t>(dataFile);
+        header.numSamples = readValue<uint32_t>(dataFile);
+        header.valuesPerSample = readValue<uint32_t>(dataFile);
+        header.cadence = readValue<uint32_t>(dataFile);
+        header.maxTimesteps = readValue<uint32_t>(dataFile);
+        header.width = readValue<uint32_t>(dataFile);
+        header.height = readValue<uint32_t>(dataFile);
+        header.era = readValue<int32_t>(dataFile);
+        header.dt = readValue<float>(dataFile);
+        header.dx = readValue<float>(dataFile);
+        header.modelName = readString(dataFile);
+        uint32_t numParameters = readValue<uint32_t>(dataFile);
+        for (uint32_t parameterIndex = 0; parameterIndex < numParameters; parameterIndex++)
+        {
+            std::string name = readString(dataFile);
+            float value = readValue<float>(dataFile);
+            header.parameters.push_back({name, value});
+        }
+        for (uint32_t trialIndex = 0; trialIndex < header.numTrials; trialIndex++)
+        {
+            header.seeds.push_back(readValue<uint32_t>(dataFile));
+        }
+        dataFile.close();
+
+        EnsembleFile *ensembleFile = new EnsembleFile(filePath, header, headerSize);
+        ensembleFile->numCompletedTrials = numCompletedTrials;
+        logTrace("Opened ensemble file at path %s with %d of %d trials completed.", filePath, numCompletedTrials, header.numTrials);
+        return ensembleFile;
+    }
+    catch (std::ifstream::failure &e)
+    {
+        logError("Failed to open ensemble file at path: %s - %s", filePath, e.what());
+    }
+    return nullptr;
+}
\ No newline at end of file
@@ -0,0 +1,255 @@
+// Standard libraries
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+
+// External libraries
+
+// Internal libraries
+#include "ensemble_statistics.h"
+
+P2Quantile::P2Quantile(double quantile)
+{
+    m_Quantile = quantile;
+}
+
+void P2Quantile::add(double value)
+{
+    // Collect the first five values and then place the markers on them
+    if (m_Count < 5)
+    {
+        m_Heights[m_Count++] = value;
+        if (m_Count == 5)
+        {
+            std::sort(m_Heights, m_Heights + 5);
+            double p = m_Quantile;
+            double desiredPositions[5] = {1.0, 1.0 + 2.0 * p, 1.0 + 4.0 * p, 3.0 + 2.0 * p, 5.0};
+            for (uint32_t markerIndex = 0; markerIndex < 5; markerIndex++)
+            {
+                m_Positions[markerIndex] = markerIndex + 1;
+                m_DesiredPositions[markerIndex] = desiredPositions[markerIndex];
+            }
+        }
+        return;
+    }
+    m_Count++;
+
+    // Find the cell the value falls in, extending the extreme markers if needed
+    uint32_t cellIndex = 0;
+    if (value < m_Heights[0])
+    {
+        m_Heights[0] = value;
+    }
+    else if (value >= m_Heights[4])
+    {
+        m_Heights[4] = value;
+        cellIndex = 3;
+    }
+    else
+    {
+        while (value >= m_Heights[cellIndex + 1])
+        {
+            cellIndex++;
+        }
+    }
+    for (uint32_t markerIndex = cellIndex + 1; markerIndex < 5; markerIndex++)
+    {
+        m_Positions[markerIndex]++;
+    }
+    double p = m_Quantile;
+    double increments[5] = {0.0, 0.5 * p, p, 0.5 * (1.0 + p), 1.0};
+    for (uint32_t markerIndex = 0; markerIndex < 5; markerIndex++)
+    {
+        m_DesiredPositions[markerIndex] += increments[markerIndex];
+    }
+
+    // Move the middle markers towards their desired positions, using a parabolic prediction of their height if it keeps the
+    // heights in order and a linear one otherwise
+    for (uint32_t markerIndex = 1; markerIndex < 4; markerIndex++)
+    {
+        double offset = m_DesiredPositions[markerIndex] - m_Positions[markerIndex];
+        int32_t rightGap = m_Positions[markerIndex + 1] - m_Positions[markerIndex];
+        int32_t leftGap = m_Positions[markerIndex - 1] - m_Positions[markerIndex];
+        if ((offset >= 1.0 && rightGap > 1) || (offset <= -1.0 && leftGap < -1))
+        {
+            int32_t step = offset > 0.0 ? 1 : -1;
+            double height = m_Heights[markerIndex];
+            double leftHeight = m_Heights[markerIndex - 1];
+            double rightHeight = m_Heights[markerIndex + 1];
+            double position = m_Positions[markerIndex];
+            double leftPosition = m_Positions[markerIndex - 1];
+            double rightPosition = m_Positions[markerIndex + 1];
+            double parabolicHeight =
+                height + step / (rightPosition - leftPosition) *
+                             ((position - leftPosition + step) * (rightHeight - height) / (rightPosition - position) +
+                              (rightPosition - position - step) * (height - leftHeight) / (position - leftPosition));
+            if (leftHeight < parabolicHeight && parabolicHeight < rightHeight)
+            {
+                m_Heights[markerIndex] = parabolicHeight;
+            }
+            else
+            {
+                uint32_t neighbourIndex = markerIndex + step;
+                m_Heights[markerIndex] = height + step * (m_Heights[neighbourIndex] - height) /
+                                                      (m_Positions[neighbourIndex] - m_Positions[markerIndex]);
+            }
+            m_Positions[markerIndex] += step;
+        }
+    }
+}
+
+double P2Quantile::getEstimate() const
+{
+    if (m_Count == 0)
+    {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+    else if (m_Count >= 5)
+    {
+        return m_Heights[2];
+    }
+
+    // Interpolate between the values seen so far
+    double values[5];
+    std::copy(m_Heights, m_Heights + m_Count, values);
+    std::sort(values, values + m_Count);
+    double rank = m_Quantile * (m_Count - 1);
+    uint32_t lowerIndex = (uint32_t)floor(rank);
+    uint32_t upperIndex = std::min(lowerIndex + 1, m_Count - 1);
+    double fraction = rank - lowerIndex;
+    return values[lowerIndex] + fraction * (values[upperIndex] - values[lowerIndex]);
+}
+
+EnsembleStatistics::EnsembleStatistics(uint32_t numChannels, uint32_t numSamples, uint32_t cadence, float dt)
+{
+    m_NumChannels = numChannels;
+    m_NumSamples = numSamples;
+    m_Cadence = cadence;
+    m_Dt = dt;
+
+    SampleStatistics emptyStatistics;
+    for (uint32_t quantileIndex = 0; quantileIndex < NUM_QUANTILES; quantileIndex++)
+    {
+        emptyStatistics.quantiles[quantileIndex] = P2Quantile(QUANTILES[quantileIndex]);
+    }
+    m_Statistics.assign((size_t)numChannels * numSamples, emptyStatistics);
+}
+
+void EnsembleStatistics::addSamples(uint32_t channelIndex, const std::vector<int32_t> &samples)
+{
+    if (channelIndex >= m_NumChannels)
+    {
+        logError("The channel index %d is out of range of the %d channels!", channelIndex, m_NumChannels);
+        return;
+    }
+    uint32_t numSamples = std::min((uint32_t)samples.size(), m_NumSamples);
+    for (uint32_t sampleIndex = 0; sampleIndex < numSamples; sampleIndex++)
+    {
+        addValue(m_Statistics[(size_t)channelIndex * m_NumSamples + sampleIndex], samples[sampleIndex]);
+    }
+}
+
+void EnsembleStatistics::addSamples(uint32_t channelIndex, const std::vector<float> &samples)
+{
+    if (channelIndex >= m_NumChannels)
+    {
+        logError("The channel index %d is out of range of the %d channels!", channelIndex, m_NumChannels);
+        return;
+    }
+    uint32_t numSamples = std::min((uint32_t)samples.size(), m_NumSamples);
+    for (uint32_t sampleIndex = 0; sampleIndex < numSamples; sampleIndex++)
+    {
+        addValue(m_Statistics[(size_t)channelIndex * m_NumSamples + sampleIndex], samples[sampleIndex]);
+    }
+}
+
+void EnsembleStatistics::addValue(SampleStatistics &statistics, double value)
+{
+    // The value belongs to the trial after the completed ones
+    uint32_t count = m_NumTrials + 1;
+    double deviation = value - statistics.mean;
+    statistics.mean += deviation / count;
+    statistics.squaredDeviations += deviation * (value - statistics.mean);
+    statistics.minimum = count == 1 ? value : std::min(statistics.minimum, value);
+    statistics.maximum = count == 1 ? value : std::max(statistics.maximum, value);
+    for (auto &quantile : statistics.quantiles)
+    {
+        quantile.add(value);
+    }
+}
+
+void EnsembleStatistics::completeTrial()
+{
+    m_NumTrials++;
+}
+
+double EnsembleStatistics::getMean(uint32_t channelIndex, uint32_t sampleIndex) const
+{
+    return m_Statistics[(size_t)channelIndex * m_NumSamples + sampleIndex].mean;
+}
+
+double EnsembleStatistics::getVariance(uint32_t channelIndex, uint32_t sampleIndex) const
+{
+    if (m_NumTrials < 2)
+    {
+        return 0.0;
+    }
+    return m_Statistics[(size_t)channelIndex * m_NumSamples + sampleIndex].squaredDeviations / (m_NumTrials - 1);
+}
+
+double EnsembleStatistics::getQuantile(uint32_t channelIndex, uint32_t sampleIndex, uint32_t quantileIndex) const
+{
+    return m_Statistics[(size_t)channelIndex * m_NumSamples + sampleIndex].quantiles[quantileIndex].getEstimate();
+}
+
+bool EnsembleStatistics::write(const std::string &filePath) const
+{
+    // Write to a temporary file first so that readers never see a partially written summary
+    std::string tempPath = filePath + ".tmp";
+    try
+    {
+        std::ofstream summaryFile;
+        summaryFile.exceptions(std::ofstream::failbit | std::ofstream::badbit);
+        summaryFile.open(tempPath, std::ios::trunc);
+        summaryFile.precision(9);
+        summaryFile << "channel,timestep,time,trials,mean,variance,min,max";
+        for (uint32_t quantileIndex = 0; quantileIndex < NUM_QUANTILES; quantileIndex++)
+        {
+            summaryFile << ",q" << (int)round(100.0 * QUANTILES[quantileIndex]);
+        }
+        summaryFile << "\n";
+
+        for (uint32_t channelIndex = 0; channelIndex < m_NumChannels; channelIndex++)
+        {
+            for (uint32_t sampleIndex = 0; sampleIndex < m_NumSamples; sampleIndex++)
+            {
+                // Sample n is taken at timestep 1 + n * cadence
+                uint32_t timestep = 1 + sampleIndex * m_Cadence;
+                const SampleStatistics &statistics = m_Statistics[(size_t)channelIndex * m_NumSamples + sampleIndex];
+                summaryFile << channelIndex << "," << timestep << "," << timestep * m_Dt << "," << m_NumTrials << ","
+                            << statistics.mean << "," << getVariance(channelIndex, sampleIndex) << "," << statistics.minimum
+                            << "," << statistics.maximum;
+                for (const auto &quantile : statistics.quantiles)
+                {
+                    summaryFile << "," << quantile.getEstimate();
+                }
+                summaryFile << "\n";
+            }
+        }
+        summaryFile.close();
+        std::filesystem::rename(tempPath, filePath);
+    }
+    catch (std::ofstream::failure &e)
+    {
+        logError("Failed to write ensemble statistics at path: %s - %s", tempPath.c_str(), e.what());
+        return false;
+    }
+    catch (std::filesystem::filesystem_error &e)
+    {
+        logError("Failed to replace ensemble statistics at path: %s - %s", filePath.c_str(), e.what());
+        return false;
+    }
+    return true;
+}
\ No newline at end of file
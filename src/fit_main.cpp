@@ -0,0 +1,241 @@
+// Standard libraries
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// External libraries
+
+// Internal libraries
+#include "ensemble_file.h"
+#include "errors.h"
+#include "log.h"
+#include "power_law_fit.h"
+
+// Options of the fitting tool
+struct FitOptions
+{
+public:
+    // Only samples at or after this timestep are fitted
+    uint32_t startTimestep = 200;
+    // Only samples at or before this timestep are fitted. Zero fits up to the end of the run.
+    uint32_t endTimestep = 0;
+    // Path of the csv file to write the fits to. Nothing is written if this is empty.
+    std::string outputPath;
+    // Folders that hold a string_counts.ctde file
+    std::vector<std::string> folderPaths;
+    // Settings of the fitter
+    PowerLawFitter fitter;
+};
+
+// Helper function that prints how to use the tool.
+static void printUsage()
+{
+    printf("Usage: cosmotd_fit [options] <folder>...\n"
+           "Fits a * t^q + c to the mean string count per cell of the string_counts.ctde file in each folder and bootstraps\n"
+           "68%% confidence intervals over its trials.\n"
+           "Options:\n"
+           "  --start <timestep>    First timestep to fit (default 200)\n"
+           "  --end <timestep>      Last timestep to fit (default the end of the run)\n"
+           "  --resamples <n>       Number of bootstrap resamples (default 200)\n"
+           "  --threads <n>         Number of threads, 0 for every hardware thread (default 0)\n"
+           "  --seed <n>            Seed of the bootstrap (default 1)\n"
+           "  --output <path>       Writes every fit to a csv file\n");
+}
+
+// Helper function that parses the command line. Returns false if the arguments are invalid.
+static bool parseArguments(int argc, char **argv, FitOptions &options)
+{
+    for (int argumentIndex = 1; argumentIndex < argc; argumentIndex++)
+    {
+        std::string argument = argv[argumentIndex];
+        bool hasValue = argumentIndex + 1 < argc;
+        if (argument == "--help" || argument == "-h")
+        {
+            return false;
+        }
+        else if (argument.starts_with("--") && !hasValue)
+        {
+            logError("The option %s requires a value!", argument.c_str());
+            return false;
+        }
+        else if (argument == "--start")
+        {
+            options.startTimestep = std::strtoul(argv[++argumentIndex], nullptr, 10);
+        }
+        else if (argument == "--end")
+        {
+            options.endTimestep = std::strtoul(argv[++argumentIndex], nullptr, 10);
+        }
+        else if (argument == "--resamples")
+        {
+            options.fitter.numResamples = std::strtoul(argv[++argumentIndex], nullptr, 10);
+        }
+        else if (argument == "--threads")
+        {
+            options.fitter.numThreads = std::strtoul(argv[++argumentIndex], nullptr, 10);
+        }
+        else if (argument == "--seed")
+        {
+            options.fitter.seed = std::strtoul(argv[++argumentIndex], nullptr, 10);
+        }
+        else if (argument == "--output")
+        {
+            options.outputPath = argv[++argumentIndex];
+        }
+        else if (argument.starts_with("--"))
+        {
+            logError("Unknown option %s!", argument.c_str());
+            return false;
+        }
+        else
+        {
+            options.folderPaths.push_back(argument);
+        }
+    }
+    return options.folderPaths.size() > 0;
+}
+
+int main(int argc, char **argv)
+{
+    FitOptions options;
+    if (!parseArguments(argc, argv, options))
+    {
+        printUsage();
+        return APPLICATION_INITIALISATION_FAILURE;
+    }
+
+    std::ofstream outputFile;
+    outputFile.exceptions(std::ofstream::failbit | std::ofstream::badbit);
+    if (options.outputPath.size() > 0)
+    {
+        try
+        {
+            outputFile.open(options.outputPath, std::ios::trunc);
+            outputFile << "folder,channel,trials,a,q,c,a_median,q_median,c_median,a_lower,a_upper,q_lower,q_upper,c_lower,c_upper,"
+                          "residual,iterations,quality\n";
+        }
+        catch (std::ofstream::failure &e)
+        {
+            logError("Failed to open file to write to at path: %s - %s", options.outputPath.c_str(), e.what());
+            return APPLICATION_INITIALISATION_FAILURE;
+        }
+    }
+
+    auto startTime = std::chrono::steady_clock::now();
+    std::vector<std::string> badFits;
+    for (const auto &folderPath : options.folderPaths)
+    {
+        std::string ensemblePath = folderPath + "/string_counts.ctde";
+        if (!std::filesystem::exists(ensemblePath))
+        {
+            logWarning("The folder %s does not contain any string count data!", folderPath.c_str());
+            continue;
+        }
+        EnsembleFile *ensembleFile = EnsembleFile::open(ensemblePath.c_str());
+        if (ensembleFile == nullptr)
+        {
+            continue;
+        }
+        const EnsembleHeader &header = ensembleFile->header;
+        uint32_t numTrials = ensembleFile->numCompletedTrials;
+        if (numTrials == 0)
+        {
+            logWarning("The ensemble in %s has no completed trials!", folderPath.c_str());
+            delete ensembleFile;
+            continue;
+        }
+
+        // Sample n is taken at timestep 1 + n * cadence, which is at time timestep * dt
+        uint32_t endTimestep = options.endTimestep > 0 ? options.endTimestep : header.maxTimesteps;
+        std::vector<uint32_t> sampleIndices;
+        std::vector<double> times;
+        for (uint32_t sampleIndex = 0; sampleIndex < header.numSamples; sampleIndex++)
+        {
+            uint32_t timestep = 1 + sampleIndex * header.cadence;
+            if (timestep >= options.startTimestep && timestep <= endTimestep)
+            {
+                sampleIndices.push_back(sampleIndex);
+                times.push_back(timestep * (double)header.dt);
+            }
+        }
+
+        if (times.size() < 3)
+        {
+            logWarning("The ensemble in %s has only %d samples between timesteps %d and %d!", folderPath.c_str(),
+                       (int)times.size(), options.startTimestep, endTimestep);
+            delete ensembleFile;
+            continue;
+        }
+
+        // String counts are fitted per cell so that different field sizes can be compared
+        double numCells = (double)header.width * header.height;
+        for (uint32_t channelIndex = 0; channelIndex < header.numChannels; channelIndex++)
+        {
+            std::vector<std::vector<double>> trials;
+            std::vector<float> samples;
+            for (uint32_t trialIndex = 0; trialIndex < numTrials; trialIndex++)
+            {
+                if (!ensembleFile->readSamples(channelIndex, trialIndex, samples))
+                {
+                    break;
+                }
+                std::vector<double> trial;
+                for (uint32_t sampleIndex : sampleIndices)
+                {
+                    trial.push_back(samples[sampleIndex * header.valuesPerSample] / numCells);
+                }
+                trials.push_back(trial);
+            }
+
+            PowerLawEnsembleFit ensembleFit = options.fitter.fitEnsemble(times, trials);
+            const PowerLawParameters &parameters = ensembleFit.meanFit.parameters;
+            std::string qualityName = convertFitQualityToString(ensembleFit.quality);
+            printf("%s [%d]: q = %.4f (%.4f, %.4f), a = %.4g, c = %.4g, %s\n", folderPath.c_str(), channelIndex, parameters.q,
+                   ensembleFit.lowerInterval.q, ensembleFit.upperInterval.q, parameters.a, parameters.c, qualityName.c_str());
+            if (ensembleFit.quality != FitQuality::GOOD)
+            {
+                badFits.push_back(folderPath + " [" + std::to_string(channelIndex) + "] " + qualityName);
+            }
+
+            if (outputFile.is_open())
+            {
+                try
+                {
+                    outputFile << folderPath << "," << channelIndex << "," << ensembleFit.numTrials << "," << parameters.a << ","
+                               << parameters.q << "," << parameters.c << "," << ensembleFit.median.a << "," << ensembleFit.median.q
+                               << "," << ensembleFit.median.c << "," << ensembleFit.lowerInterval.a << ","
+                               << ensembleFit.upperInterval.a << "," << ensembleFit.lowerInterval.q << ","
+                               << ensembleFit.upperInterval.q << "," << ensembleFit.lowerInterval.c << ","
+                               << ensembleFit.upperInterval.c << "," << ensembleFit.meanFit.residual << ","
+                               << ensembleFit.meanFit.numIterations << "," << qualityName << "\n";
+                }
+                catch (std::ofstream::failure &e)
+                {
+                    logError("Failed to write fit to path: %s - %s", options.outputPath.c_str(), e.what());
+                }
+            }
+        }
+        delete ensembleFile;
+    }
+
+    double elapsedSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    printf("Fitted %d folders in %.2f seconds.\n", (int)options.folderPaths.size(), elapsedSeconds);
+    if (badFits.size() == 0)
+    {
+        printf("There were no bad fits!\n");
+    }
+    else
+    {
+        printf("The following produce bad fits:\n");
+        for (const auto &badFit : badFits)
+        {
+            printf("%s\n", badFit.c_str());
+        }
+    }
+
+    return APPLICATION_SUCCESS;
+}
\ No newline at end of file
@@ -0,0 +1,322 @@
+// Standard libraries
+#include <algorithm>
+#include <cmath>
+
+// External libraries
+#include <glad/glad.h>
+
+// Internal libraries
+#include "fourier_transform.h"
+
+// Width and height of each work group of the transform passes
+constexpr uint32_t TRANSFORM_GROUP_SIZE = 8;
+// Width and height of each work group of the bin pass
+constexpr uint32_t BIN_GROUP_SIZE = 16;
+// Number of consecutive bins each work group of the bin pass can touch
+constexpr uint32_t BIN_WINDOW_SIZE = 32;
+// Number of invocations per work group of the reduce pass
+constexpr uint32_t REDUCE_GROUP_SIZE = 64;
+
+// Helper function that returns true if the given value is a non-zero power of two.
+static bool isPowerOfTwo(uint32_t value)
+{
+    return value != 0 && (value & (value - 1)) == 0;
+}
+
+// Helper function that returns the number of work groups needed to cover the given number of invocations.
+static uint32_t getNumGroups(uint32_t numInvocations, uint32_t groupSize)
+{
+    return std::max((numInvocations + groupSize - 1) / groupSize, (uint32_t)1);
+}
+
+FourierTransform::FourierTransform(ComputeShaderProgram *loadPass, ComputeShaderProgram *stockhamPass)
+    : m_LoadPass(loadPass), m_StockhamPass(stockhamPass)
+{
+}
+
+FourierTransform::~FourierTransform()
+{
+    delete m_LoadPass;
+    delete m_StockhamPass;
+}
+
+bool FourierTransform::setSize(uint32_t width, uint32_t height)
+{
+    if (!isPowerOfTwo(width) || !isPowerOfTwo(height))
+    {
+        logWarning("The Fourier transform requires power of two dimensions but was given %d x %d!", width, height);
+        return false;
+    }
+    if (width == m_Width && height == m_Height)
+    {
+        return true;
+    }
+
+    for (auto &buffer : m_Buffers)
+    {
+        // Create new texture because old texture is of the wrong size
+        buffer = Texture2D();
+        glBindTexture(GL_TEXTURE_2D, buffer.textureID);
+        glTexStorage2D(GL_TEXTURE_2D, 1, GL_RG32F, width, height);
+        buffer.width = width;
+        buffer.height = height;
+    }
+    m_Width = width;
+    m_Height = height;
+    return true;
+}
+
+void FourierTransform::load(Texture2D *realTexture, Texture2D *imagTexture, float scale)
+{
+    m_CurrentBuffer = 0;
+
+    m_LoadPass->use();
+    glUniform1i(0, imagTexture != nullptr);
+    glUniform1f(1, scale);
+    realTexture->bindUnit(0);
+    // Keep the sampler valid even when there is no imaginary part
+    (imagTexture != nullptr ? imagTexture : realTexture)->bindUnit(1);
+    glBindImageTexture(0, m_Buffers[m_CurrentBuffer].textureID, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RG32F);
+
+    glDispatchCompute(getNumGroups(m_Width, TRANSFORM_GROUP_SIZE), getNumGroups(m_Height, TRANSFORM_GROUP_SIZE), 1);
+    glMemoryBarrier(GL_ALL_BARRIER_BITS);
+    realTexture->unbindUnit(0);
+    realTexture->unbindUnit(1);
+}
+
+void FourierTransform::transform(bool isInverse)
+{
+    m_StockhamPass->use();
+    glUniform1f(2, isInverse ? 1.0f : -1.0f);
+
+    for (int axis = 0; axis < 2; axis++)
+    {
+        uint32_t lineLength = axis == 0 ? m_Width : m_Height;
+        glUniform1i(0, axis);
+
+        // Each invocation computes one butterfly so only half of the axis needs to be covered
+        uint32_t xNumGroups = getNumGroups(axis == 0 ? m_Width / 2 : m_Width, TRANSFORM_GROUP_SIZE);
+        uint32_t yNumGroups = getNumGroups(axis == 0 ? m_Height : m_Height / 2, TRANSFORM_GROUP_SIZE);
+        for (uint32_t stride = 1; stride < lineLength; stride *= 2)
+        {
+            glUniform1i(1, stride);
+            glBindImageTexture(0, m_Buffers[m_CurrentBuffer].textureID, 0, GL_FALSE, 0, GL_READ_ONLY, GL_RG32F);
+            glBindImageTexture(1, m_Buffers[1 - m_CurrentBuffer].textureID, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RG32F);
+            glDispatchCompute(xNumGroups, yNumGroups, 1);
+            glMemoryBarrier(GL_ALL_BARRIER_BITS);
+            m_CurrentBuffer = 1 - m_CurrentBuffer;
+        }
+    }
+}
+
+Texture2D *FourierTransform::getData()
+{
+    return &m_Buffers[m_CurrentBuffer];
+}
+
+FourierTransform *FourierTransform::create()
+{
+    ComputeShaderProgram *loadPass = ComputeShaderProgram::createFromFile("shaders/fft_load.glsl");
+    ComputeShaderProgram *stockhamPass = ComputeShaderProgram::createFromFile("shaders/fft_stockham.glsl");
+    if (loadPass == nullptr || stockhamPass == nullptr)
+    {
+        logError("Failed to create the Fourier transform passes!");
+        delete loadPass;
+        delete stockhamPass;
+        return nullptr;
+    }
+
+    return new FourierTransform(loadPass, stockhamPass);
+}
+
+PowerSpectrum::PowerSpectrum(FourierTransform *transform, ComputeShaderProgram *binPass, ComputeShaderProgram *reducePass)
+    : m_Transform(transform), m_BinPass(binPass), m_ReducePass(reducePass)
+{
+}
+
+PowerSpectrum::~PowerSpectrum()
+{
+    delete m_Transform;
+    delete m_BinPass;
+    delete m_ReducePass;
+}
+
+bool PowerSpectrum::setSize(uint32_t width, uint32_t height)
+{
+    if (width == m_Transform->getWidth() && height == m_Transform->getHeight() && m_ModeCounts.size() > 0)
+    {
+        return true;
+    }
+    if (!m_Transform->setSize(width, height))
+    {
+        m_ModeCounts.clear();
+        return false;
+    }
+
+    // Count the modes of each bin once per size using the same binning as the shader
+    uint32_t numBins = calculateNumBins(width, height);
+    m_ModeCounts.assign(numBins, 0);
+    float shortSide = std::min(width, height);
+    for (uint32_t y = 0; y < height; y++)
+    {
+        for (uint32_t x = 0; x < width; x++)
+        {
+            float xWavenumber = (float)(x > width / 2 ? (int)x - (int)width : (int)x) / width * shortSide;
+            float yWavenumber = (float)(y > height / 2 ? (int)y - (int)height : (int)y) / height * shortSide;
+            uint32_t bin = (uint32_t)floor(sqrt(xWavenumber * xWavenumber + yWavenumber * yWavenumber) + 0.5f);
+            if (bin < numBins)
+            {
+                m_ModeCounts[bin]++;
+            }
+        }
+    }
+
+    m_XNumGroups = getNumGroups(width, BIN_GROUP_SIZE);
+    m_YNumGroups = getNumGroups(height, BIN_GROUP_SIZE);
+    uint32_t numWindows = m_XNumGroups * m_YNumGroups;
+    m_WindowStarts = std::make_unique<ShaderStorageBuffer>(numWindows * sizeof(uint32_t), BufferUsageType::DYNAMIC_COPY);
+    m_WindowSums = std::make_unique<ShaderStorageBuffer>(numWindows * BIN_WINDOW_SIZE * sizeof(float), BufferUsageType::DYNAMIC_COPY);
+    m_Powers = std::make_unique<ShaderStorageBuffer>(numBins * sizeof(float), BufferUsageType::DYNAMIC_COPY);
+    return true;
+}
+
+uint32_t PowerSpectrum::calculateNumBins(uint32_t width, uint32_t height)
+{
+    if (!isPowerOfTwo(width) || !isPowerOfTwo(height))
+    {
+        return 0;
+    }
+    // Bins run from the mean up to the Nyquist wavenumber of the shorter side
+    return std::min(width, height) / 2 + 1;
+}
+
+void PowerSpectrum::calculate(Texture2D *realTexture, Texture2D *imagTexture, float scale, ReadbackBuffer &result)
+{
+    if (m_ModeCounts.size() == 0)
+    {
+        logError("The power spectrum size has not been set!");
+        return;
+    }
+
+    m_Transform->load(realTexture, imagTexture, scale);
+    m_Transform->transform(false);
+
+    // Sum the power per bin within each work group
+    m_BinPass->use();
+    glUniform1ui(0, m_ModeCounts.size());
+    glBindImageTexture(0, m_Transform->getData()->textureID, 0, GL_FALSE, 0, GL_READ_ONLY, GL_RG32F);
+    m_WindowStarts->bindBase(0);
+    m_WindowSums->bindBase(1);
+    glDispatchCompute(m_XNumGroups, m_YNumGroups, 1);
+    glMemoryBarrier(GL_ALL_BARRIER_BITS);
+
+    // Sum the work groups
+    m_ReducePass->use();
+    glUniform1ui(0, m_ModeCounts.size());
+    glUniform1ui(1, m_XNumGroups * m_YNumGroups);
+    m_WindowStarts->bindBase(0);
+    m_WindowSums->bindBase(1);
+    m_Powers->bindBase(2);
+    glDispatchCompute(getNumGroups(m_ModeCounts.size(), REDUCE_GROUP_SIZE), 1, 1);
+    glMemoryBarrier(GL_ALL_BARRIER_BITS);
+
+    result.readBuffer(m_Powers->bufferID, 0, m_ModeCounts.size() * sizeof(float));
+}
+
+std::vector<float> PowerSpectrum::getResult(ReadbackBuffer &result)
+{
+    std::vector<float> powers(m_ModeCounts.size());
+    result.copyTo(powers.data(), powers.size() * sizeof(float));
+
+    // Normalise to the mean power per mode
+    float numCells = (float)m_Transform->getWidth() * m_Transform->getHeight();
+    for (size_t bin = 0; bin < powers.size(); bin++)
+    {
+        powers[bin] = m_ModeCounts[bin] > 0 ? powers[bin] / (m_ModeCounts[bin] * numCells) : 0.0f;
+    }
+    return powers;
+}
+
+PowerSpectrum *PowerSpectrum::create()
+{
+    FourierTransform *transform = FourierTransform::create();
+    ComputeShaderProgram *binPass = ComputeShaderProgram::createFromFile("shaders/power_spectrum_bin.glsl");
+    ComputeShaderProgram *reducePass = ComputeShaderProgram::createFromFile("shaders/power_spectrum_reduce.glsl");
+    if (transform == nullptr || binPass == nullptr || reducePass == nullptr)
+    {
+        logError("Failed to create the power spectrum passes!");
+        delete transform;
+        delete binPass;
+        delete reducePass;
+        return nullptr;
+    }
+
+    return new PowerSpectrum(transform, binPass, reducePass);
+}
+
+SpectralLaplacian::SpectralLaplacian(FourierTransform *transform, ComputeShaderProgram *multiplyPass, ComputeShaderProgram *storePass)
+    : m_Transform(transform), m_MultiplyPass(multiplyPass), m_StorePass(storePass)
+{
+}
+
+SpectralLaplacian::~SpectralLaplacian()
+{
+    delete m_Transform;
+    delete m_MultiplyPass;
+    delete m_StorePass;
+}
+
+bool SpectralLaplacian::setSize(uint32_t width, uint32_t height)
+{
+    return m_Transform->setSize(width, height);
+}
+
+void SpectralLaplacian::calculate(
+    Texture2D *firstField, Texture2D *secondField, Texture2D *firstLaplacian, Texture2D *secondLaplacian, float dx)
+{
+    uint32_t width = m_Transform->getWidth();
+    uint32_t height = m_Transform->getHeight();
+    uint32_t xNumGroups = getNumGroups(width, TRANSFORM_GROUP_SIZE);
+    uint32_t yNumGroups = getNumGroups(height, TRANSFORM_GROUP_SIZE);
+
+    // -k^2 is real and even, so the Laplacians of the real and imaginary parts stay separate
+    m_Transform->load(firstField, secondField);
+    m_Transform->transform(false);
+
+    // The inverse transform is normalised here
+    m_MultiplyPass->use();
+    glUniform1f(0, dx);
+    glUniform1f(1, 1.0f / ((float)width * height));
+    glBindImageTexture(0, m_Transform->getData()->textureID, 0, GL_FALSE, 0, GL_READ_WRITE, GL_RG32F);
+    glDispatchCompute(xNumGroups, yNumGroups, 1);
+    glMemoryBarrier(GL_ALL_BARRIER_BITS);
+
+    m_Transform->transform(true);
+
+    m_StorePass->use();
+    glUniform1i(0, secondLaplacian != nullptr);
+    glBindImageTexture(0, m_Transform->getData()->textureID, 0, GL_FALSE, 0, GL_READ_ONLY, GL_RG32F);
+    glBindImageTexture(1, firstLaplacian->textureID, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F);
+    // Keep the image unit valid even when there is no second field
+    glBindImageTexture(
+        2, (secondLaplacian != nullptr ? secondLaplacian : firstLaplacian)->textureID, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F);
+    glDispatchCompute(xNumGroups, yNumGroups, 1);
+    glMemoryBarrier(GL_ALL_BARRIER_BITS);
+}
+
+SpectralLaplacian *SpectralLaplacian::create()
+{
+    FourierTransform *transform = FourierTransform::create();
+    ComputeShaderProgram *multiplyPass = ComputeShaderProgram::createFromFile("shaders/spectral_laplacian_multiply.glsl");
+    ComputeShaderProgram *storePass = ComputeShaderProgram::createFromFile("shaders/spectral_laplacian_store.glsl");
+    if (transform == nullptr || multiplyPass == nullptr || storePass == nullptr)
+    {
+        logError("Failed to create the spectral Laplacian passes!");
+        delete transform;
+        delete multiplyPass;
+        delete storePass;
+        return nullptr;
+    }
+
+    return new SpectralLaplacian(transform, multiplyPass, storePass);
+}
\ No newline at end of file
@@ -0,0 +1,96 @@
+// Standard libraries
+#include <algorithm>
+#include <chrono>
+
+// External libraries
+
+// Internal libraries
+#include "io_service.h"
+
+IOService::IOService(size_t capacity) : m_Capacity(std::max(capacity, (size_t)1))
+{
+    m_Thread = std::thread(&IOService::run, this);
+    logDebug("I/O service started with a queue capacity of %d.", m_Capacity);
+}
+
+IOService::~IOService()
+{
+    {
+        std::unique_lock<std::mutex> lock(m_Mutex);
+        m_IsStopping = true;
+    }
+    m_JobQueued.notify_all();
+    // The I/O thread drains the queue before exiting
+    m_Thread.join();
+    logDebug("I/O service stopped after completing %lld jobs.", m_Metrics.numCompletedJobs);
+}
+
+void IOService::submit(std::function<void()> job)
+{
+    {
+        std::unique_lock<std::mutex> lock(m_Mutex);
+        if (m_Jobs.size() >= m_Capacity)
+        {
+            // Wait for the I/O thread to make space
+            auto startTime = std::chrono::high_resolution_clock::now();
+            m_JobTaken.wait(lock, [this]
+                            { return m_Jobs.size() < m_Capacity; });
+            auto stopTime = std::chrono::high_resolution_clock::now();
+
+            m_Metrics.numStalledSubmissions++;
+            m_Metrics.totalStallMilliseconds += std::chrono::duration<double, std::milli>(stopTime - startTime).count();
+        }
+
+        m_Jobs.push_back(std::move(job));
+        m_Metrics.numSubmittedJobs++;
+        m_Metrics.queueDepth = m_Jobs.size();
+        m_Metrics.maxQueueDepth = std::max(m_Metrics.maxQueueDepth, m_Metrics.queueDepth);
+    }
+    m_JobQueued.notify_one();
+}
+
+void IOService::flush()
+{
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    m_JobTaken.wait(lock, [this]
+                    { return m_Jobs.empty() && !m_IsBusy; });
+}
+
+IOServiceMetrics IOService::getMetrics()
+{
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    return m_Metrics;
+}
+
+void IOService::run()
+{
+    while (true)
+    {
+        std::function<void()> job;
+        {
+            std::unique_lock<std::mutex> lock(m_Mutex);
+            m_JobQueued.wait(lock, [this]
+                             { return !m_Jobs.empty() || m_IsStopping; });
+            // Only exit once every queued job has been written
+            if (m_Jobs.empty())
+            {
+                return;
+            }
+
+            job = std::move(m_Jobs.front());
+            m_Jobs.pop_front();
+            m_IsBusy = true;
+            m_Metrics.queueDepth = m_Jobs.size();
+        }
+        m_JobTaken.notify_all();
+
+        job();
+
+        {
+            std::unique_lock<std::mutex> lock(m_Mutex);
+            m_IsBusy = false;
+            m_Metrics.numCompletedJobs++;
+        }
+        m_JobTaken.notify_all();
+    }
+}
\ No newline at end of file
@@ -0,0 +1,288 @@
+// Standard libraries
+#include <algorithm>
+#include <string>
+
+// External libraries
+#include <glad/glad.h>
+
+// Internal libraries
+#include "mesh_refinement.h"
+
+// Width and height of each work group
+constexpr uint32_t REFINEMENT_GROUP_SIZE = 8;
+
+MeshRefinement::MeshRefinement(ComputeShaderProgram *flagTilesPass, ComputeShaderProgram *prolongPass, ComputeShaderProgram *restrictPass)
+    : m_FlagTilesPass(flagTilesPass), m_ProlongPass(prolongPass), m_RestrictPass(restrictPass)
+{
+}
+
+MeshRefinement::~MeshRefinement()
+{
+    delete m_FlagTilesPass;
+    delete m_ProlongPass;
+    delete m_RestrictPass;
+}
+
+bool MeshRefinement::regrid(const std::vector<Texture2D *> &defectTextures, const std::vector<Texture2D> &fields)
+{
+    uint32_t width = fields[0].width;
+    uint32_t height = fields[0].height;
+    uint32_t numXTiles = width / TILE_SIZE;
+    uint32_t numYTiles = height / TILE_SIZE;
+    uint32_t numTiles = numXTiles * numYTiles;
+    if (numTiles == 0)
+    {
+        bool hadPatches = getNumPatches() > 0;
+        clear();
+        return hadPatches;
+    }
+    // Patches are dropped when the lattice changes size
+    if (numXTiles != m_NumXTiles || numYTiles != m_NumYTiles || m_PatchFields.size() != fields.size())
+    {
+        clear();
+        m_NumXTiles = numXTiles;
+        m_NumYTiles = numYTiles;
+        m_TileFlagBuffer = std::make_unique<ShaderStorageBuffer>(numTiles * sizeof(uint32_t), BufferUsageType::DYNAMIC_COPY);
+        m_TilePatchBuffer = std::make_unique<ShaderStorageBuffer>(numTiles * sizeof(int32_t), BufferUsageType::DYNAMIC_DRAW);
+        m_PatchFields.resize(fields.size());
+        m_PatchLaplacians.resize(fields.size());
+    }
+
+    // Flag the tiles that hold a defect
+    m_TileFlagBuffer->clear(0, m_TileFlagBuffer->size);
+    m_TileFlagBuffer->bindBase(0);
+    m_FlagTilesPass->use();
+    glUniform1i(0, TILE_SIZE);
+    glUniform2i(1, m_NumXTiles, m_NumYTiles);
+    glUniform1i(2, DEFECT_MARGIN);
+    for (Texture2D *defectTexture : defectTextures)
+    {
+        defectTexture->bindUnit(0);
+        glDispatchCompute(
+            (width + REFINEMENT_GROUP_SIZE - 1) / REFINEMENT_GROUP_SIZE, (height + REFINEMENT_GROUP_SIZE - 1) / REFINEMENT_GROUP_SIZE, 1);
+        glMemoryBarrier(GL_ALL_BARRIER_BITS);
+        defectTexture->unbindUnit(0);
+    }
+    std::vector<uint32_t> tileFlags(numTiles);
+    m_TileFlagBuffer->read(0, numTiles * sizeof(uint32_t), tileFlags.data());
+    std::vector<bool> isRefined(numTiles, false);
+    for (uint32_t tileIndex = 0; tileIndex < numTiles; tileIndex++)
+    {
+        isRefined[tileIndex] = tileFlags[tileIndex] != 0;
+    }
+
+    // Patches that are kept come first in their old order, followed by the new patches
+    std::vector<int32_t> newPatchTiles;
+    std::vector<uint32_t> keptPatches;
+    for (uint32_t patchIndex = 0; patchIndex < m_PatchTiles.size(); patchIndex++)
+    {
+        if (isRefined[m_PatchTiles[patchIndex]])
+        {
+            newPatchTiles.push_back(m_PatchTiles[patchIndex]);
+            keptPatches.push_back(patchIndex);
+            isRefined[m_PatchTiles[patchIndex]] = false;
+        }
+    }
+    uint32_t numKeptPatches = newPatchTiles.size();
+    for (uint32_t tileIndex = 0; tileIndex < numTiles; tileIndex++)
+    {
+        if (isRefined[tileIndex])
+        {
+            newPatchTiles.push_back(tileIndex);
+        }
+    }
+    if (newPatchTiles == m_PatchTiles)
+    {
+        return false;
+    }
+    if (newPatchTiles.empty())
+    {
+        m_PatchTiles.clear();
+        for (size_t fieldIndex = 0; fieldIndex < m_PatchFields.size(); fieldIndex++)
+        {
+            m_PatchFields[fieldIndex] = Texture2D();
+            m_PatchLaplacians[fieldIndex] = Texture2D();
+        }
+        return true;
+    }
+
+    // Pack the patches into new atlases, copying over the patches that are kept
+    uint32_t numPatches = newPatchTiles.size();
+    uint32_t atlasWidth = PATCHES_PER_ROW * PATCH_SIZE;
+    uint32_t atlasHeight = ((numPatches + PATCHES_PER_ROW - 1) / PATCHES_PER_ROW) * PATCH_SIZE;
+    for (size_t fieldIndex = 0; fieldIndex < m_PatchFields.size(); fieldIndex++)
+    {
+        Texture2D patchField;
+        glBindTexture(GL_TEXTURE_2D, patchField.textureID);
+        glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA32F, atlasWidth, atlasHeight);
+        patchField.width = atlasWidth;
+        patchField.height = atlasHeight;
+        // Unused patches at the end of the last row are still evolved, so they start from zero
+        static float clearColor = 0.0f;
+        glClearTexImage(patchField.textureID, 0, GL_RED, GL_FLOAT, &clearColor);
+        for (uint32_t patchIndex = 0; patchIndex < numKeptPatches; patchIndex++)
+        {
+            uint32_t oldPatchIndex = keptPatches[patchIndex];
+            glCopyImageSubData(
+                m_PatchFields[fieldIndex].textureID, GL_TEXTURE_2D, 0,
+                (oldPatchIndex % PATCHES_PER_ROW) * PATCH_SIZE, (oldPatchIndex / PATCHES_PER_ROW) * PATCH_SIZE, 0,
+                patchField.textureID, GL_TEXTURE_2D, 0,
+                (patchIndex % PATCHES_PER_ROW) * PATCH_SIZE, (patchIndex / PATCHES_PER_ROW) * PATCH_SIZE, 0,
+                PATCH_SIZE, PATCH_SIZE, 1);
+        }
+        m_PatchFields[fieldIndex] = std::move(patchField);
+        m_PatchFields[fieldIndex].width = atlasWidth;
+        m_PatchFields[fieldIndex].height = atlasHeight;
+
+        // Resize Laplacian atlas if necessary
+        if (m_PatchLaplacians[fieldIndex].width != atlasWidth || m_PatchLaplacians[fieldIndex].height != atlasHeight)
+        {
+            m_PatchLaplacians[fieldIndex] = Texture2D();
+            glBindTexture(GL_TEXTURE_2D, m_PatchLaplacians[fieldIndex].textureID);
+            glTexStorage2D(GL_TEXTURE_2D, 1, GL_R32F, atlasWidth, atlasHeight);
+            m_PatchLaplacians[fieldIndex].width = atlasWidth;
+            m_PatchLaplacians[fieldIndex].height = atlasHeight;
+        }
+    }
+
+    // Upload the mapping between patches and tiles
+    m_PatchTiles = newPatchTiles;
+    if (m_PatchTileBuffer == nullptr || m_PatchTileBuffer->size < numPatches * sizeof(int32_t))
+    {
+        m_PatchTileBuffer = std::make_unique<ShaderStorageBuffer>(numPatches * sizeof(int32_t), BufferUsageType::DYNAMIC_DRAW);
+    }
+    m_PatchTileBuffer->write(0, numPatches * sizeof(int32_t), m_PatchTiles.data());
+    std::vector<int32_t> tilePatches(numTiles, -1);
+    for (uint32_t patchIndex = 0; patchIndex < numPatches; patchIndex++)
+    {
+        tilePatches[m_PatchTiles[patchIndex]] = patchIndex;
+    }
+    m_TilePatchBuffer->write(0, numTiles * sizeof(int32_t), tilePatches.data());
+
+    // New patches are prolonged from the fields at the end of the coarse timestep
+    prolong(fields, numKeptPatches, numPatches - numKeptPatches, 1.0f, false);
+    return true;
+}
+
+void MeshRefinement::clear()
+{
+    m_PatchTiles.clear();
+    m_PatchFields.clear();
+    m_PatchLaplacians.clear();
+    m_PreviousFields.clear();
+    m_NumXTiles = 0;
+    m_NumYTiles = 0;
+}
+
+void MeshRefinement::storePreviousFields(const std::vector<Texture2D> &fields)
+{
+    m_PreviousFields.resize(fields.size());
+    for (size_t fieldIndex = 0; fieldIndex < fields.size(); fieldIndex++)
+    {
+        // Resize texture if necessary
+        Texture2D &previousField = m_PreviousFields[fieldIndex];
+        if (previousField.width != fields[fieldIndex].width || previousField.height != fields[fieldIndex].height)
+        {
+            previousField = Texture2D();
+            glBindTexture(GL_TEXTURE_2D, previousField.textureID);
+            glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA32F, fields[fieldIndex].width, fields[fieldIndex].height);
+            previousField.width = fields[fieldIndex].width;
+            previousField.height = fields[fieldIndex].height;
+        }
+        glCopyImageSubData(
+            fields[fieldIndex].textureID, GL_TEXTURE_2D, 0, 0, 0, 0,
+            previousField.textureID, GL_TEXTURE_2D, 0, 0, 0, 0,
+            previousField.width, previousField.height, 1);
+    }
+}
+
+void MeshRefinement::fillGhosts(const std::vector<Texture2D> &fields, float fraction)
+{
+    prolong(fields, 0, getNumPatches(), fraction, true);
+}
+
+void MeshRefinement::restrictPatches(const std::vector<Texture2D> &fields)
+{
+    if (getNumPatches() == 0)
+    {
+        return;
+    }
+
+    m_RestrictPass->use();
+    glUniform2i(0, m_NumXTiles, m_NumYTiles);
+    m_PatchTileBuffer->bindBase(0);
+    for (size_t fieldIndex = 0; fieldIndex < fields.size(); fieldIndex++)
+    {
+        glBindImageTexture(0, m_PatchFields[fieldIndex].textureID, 0, GL_FALSE, 0, GL_READ_ONLY, GL_RGBA32F);
+        glBindImageTexture(1, fields[fieldIndex].textureID, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA32F);
+        // Dispatch and barrier
+        glDispatchCompute(TILE_SIZE / REFINEMENT_GROUP_SIZE, TILE_SIZE / REFINEMENT_GROUP_SIZE, getNumPatches());
+        glMemoryBarrier(GL_ALL_BARRIER_BITS);
+    }
+}
+
+uint64_t MeshRefinement::getMemoryUsage() const
+{
+    uint64_t numBytes = 0;
+    for (size_t fieldIndex = 0; fieldIndex < m_PatchFields.size(); fieldIndex++)
+    {
+        // Four 32 bit channels per field and one per Laplacian
+        numBytes += (uint64_t)m_PatchFields[fieldIndex].width * m_PatchFields[fieldIndex].height * (16 + 4);
+    }
+    for (const auto &previousField : m_PreviousFields)
+    {
+        numBytes += (uint64_t)previousField.width * previousField.height * 16;
+    }
+    return numBytes;
+}
+
+MeshRefinement *MeshRefinement::create()
+{
+    // The layout of the tiles and patches is shared with the shaders
+    std::string preamble = "#define TILE_SIZE " + std::to_string(TILE_SIZE) + "\n#define REFINEMENT_RATIO " +
+                           std::to_string(REFINEMENT_RATIO) + "\n#define GHOST_WIDTH " + std::to_string(GHOST_WIDTH) +
+                           "\n#define PATCH_SIZE " + std::to_string(PATCH_SIZE) + "\n#define PATCHES_PER_ROW " +
+                           std::to_string(PATCHES_PER_ROW) + "\n";
+
+    ComputeShaderProgram *flagTilesPass = ComputeShaderProgram::createFromFile("shaders/flag_refinement_tiles.glsl");
+    ComputeShaderProgram *prolongPass = ComputeShaderProgram::createFromFile("shaders/prolong_patches.glsl", preamble.c_str());
+    ComputeShaderProgram *restrictPass = ComputeShaderProgram::createFromFile("shaders/restrict_patches.glsl", preamble.c_str());
+    if (flagTilesPass == nullptr || prolongPass == nullptr || restrictPass == nullptr)
+    {
+        logError("Failed to compile the mesh refinement passes!");
+        delete flagTilesPass;
+        delete prolongPass;
+        delete restrictPass;
+        return nullptr;
+    }
+    return new MeshRefinement(flagTilesPass, prolongPass, restrictPass);
+}
+
+void MeshRefinement::prolong(
+    const std::vector<Texture2D> &fields, uint32_t firstPatch, uint32_t numPatches, float fraction, bool ghostsOnly)
+{
+    if (numPatches == 0)
+    {
+        return;
+    }
+
+    m_ProlongPass->use();
+    glUniform1f(0, fraction);
+    glUniform1i(1, firstPatch);
+    glUniform1i(2, ghostsOnly);
+    glUniform2i(3, m_NumXTiles, m_NumYTiles);
+    m_PatchTileBuffer->bindBase(0);
+    m_TilePatchBuffer->bindBase(1);
+    for (size_t fieldIndex = 0; fieldIndex < fields.size(); fieldIndex++)
+    {
+        // The fields at the start of the timestep are only needed part way through it
+        bool usesPreviousField = fraction < 1.0f && m_PreviousFields.size() == fields.size();
+        const Texture2D &previousField = usesPreviousField ? m_PreviousFields[fieldIndex] : fields[fieldIndex];
+        glBindImageTexture(0, m_PatchFields[fieldIndex].textureID, 0, GL_FALSE, 0, GL_READ_WRITE, GL_RGBA32F);
+        glBindImageTexture(1, previousField.textureID, 0, GL_FALSE, 0, GL_READ_ONLY, GL_RGBA32F);
+        glBindImageTexture(2, fields[fieldIndex].textureID, 0, GL_FALSE, 0, GL_READ_ONLY, GL_RGBA32F);
+        // Dispatch and barrier
+        glDispatchCompute(PATCH_SIZE / REFINEMENT_GROUP_SIZE, PATCH_SIZE / REFINEMENT_GROUP_SIZE, numPatches);
+        glMemoryBarrier(GL_ALL_BARRIER_BITS);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,116 @@
+// Standard libraries
+#include <algorithm>
+#include <cmath>
+
+// External libraries
+
+// Internal libraries
+#include "outcome_classifier.h"
+
+void OutcomeClassifier::reset()
+{
+    m_Samples.clear();
+    m_Candidate = TrialOutcome::UNDECIDED;
+    m_CandidateTimestep = 0;
+    m_IsConfident = false;
+    m_ConfidentTimestep = 0;
+}
+
+void OutcomeClassifier::addSample(const OutcomeSample &sample)
+{
+    m_Samples.push_back(sample);
+    if (m_IsConfident)
+    {
+        return;
+    }
+
+    TrialOutcome outcome = classifyLatestSample();
+    if (outcome != m_Candidate)
+    {
+        m_Candidate = outcome;
+        m_CandidateTimestep = sample.timestep;
+    }
+    if (m_Candidate != TrialOutcome::UNDECIDED && sample.timestep - m_CandidateTimestep >= confidenceWindow)
+    {
+        m_IsConfident = true;
+        m_ConfidentTimestep = sample.timestep;
+    }
+}
+
+template <typename CountFunction>
+float OutcomeClassifier::getSlope(CountFunction getCount) const
+{
+    int32_t startTimestep = m_Samples.back().timestep - slopeWindow;
+    double sumX = 0.0;
+    double sumY = 0.0;
+    double sumXX = 0.0;
+    double sumXY = 0.0;
+    uint32_t numPoints = 0;
+    for (auto sample = m_Samples.rbegin(); sample != m_Samples.rend() && sample->timestep >= startTimestep; sample++)
+    {
+        if (sample->time <= 0.0f)
+        {
+            continue;
+        }
+        double x = log(sample->time);
+        double y = log(std::max(getCount(*sample), 0) + 1.0);
+        sumX += x;
+        sumY += y;
+        sumXX += x * x;
+        sumXY += x * y;
+        numPoints++;
+    }
+
+    double denominator = numPoints * sumXX - sumX * sumX;
+    if (numPoints < 2 || denominator <= 0.0)
+    {
+        return 0.0f;
+    }
+    return (numPoints * sumXY - sumX * sumY) / denominator;
+}
+
+TrialOutcome OutcomeClassifier::classifyLatestSample() const
+{
+    const OutcomeSample &sample = m_Samples.back();
+    // Slopes need a full window of samples
+    if (sample.timestep < std::max(minTimestep, m_Samples.front().timestep + slopeWindow))
+    {
+        return TrialOutcome::UNDECIDED;
+    }
+
+    int32_t numDefects = sample.numStrings + sample.numWalls;
+    int32_t numInitialDefects = m_Samples.front().numStrings + m_Samples.front().numWalls;
+    if (numDefects == 0)
+    {
+        return TrialOutcome::ZERO;
+    }
+    else if (sample.amplitudeImbalance > imbalanceThreshold)
+    {
+        return TrialOutcome::ONE_FIELD_VANISHES;
+    }
+    else if (numDefects <= closeToZeroFraction * numInitialDefects &&
+             std::fabs(getSlope([](const OutcomeSample &other) { return other.numStrings + other.numWalls; })) <= stableSlope)
+    {
+        return TrialOutcome::CLOSE_TO_ZERO;
+    }
+    else if (sample.numStrings == 0)
+    {
+        return TrialOutcome::NO_STRINGS;
+    }
+
+    // The remaining outcomes are told apart by the walls
+    if (sample.numWalls == 0)
+    {
+        return TrialOutcome::UNDECIDED;
+    }
+    float wallSlope = getSlope([](const OutcomeSample &other) { return other.numWalls; });
+    if (wallSlope < -unstableSlope)
+    {
+        return TrialOutcome::UNSTABLE_WALLS;
+    }
+    else if (std::fabs(wallSlope) <= stableSlope)
+    {
+        return sample.numDomains >= alternatingDomains ? TrialOutcome::STABLE_ALTERNATING_WALLS : TrialOutcome::STABLE_WALLS;
+    }
+    return TrialOutcome::UNDECIDED;
+}
\ No newline at end of file
@@ -0,0 +1,118 @@
+// Standard libraries
+#include <bit>
+
+// External libraries
+
+// Internal libraries
+#include "philox.h"
+
+// Multipliers and key increments of Philox4x32
+constexpr uint32_t PHILOX_M0 = 0xD2511F53u;
+constexpr uint32_t PHILOX_M1 = 0xCD9E8D57u;
+constexpr uint32_t PHILOX_W0 = 0x9E3779B9u;
+constexpr uint32_t PHILOX_W1 = 0xBB67AE85u;
+
+std::array<uint32_t, 4> generatePhilox4x32(std::array<uint32_t, 4> counter, std::array<uint32_t, 2> key)
+{
+    for (uint32_t roundIndex = 0; roundIndex < 10; roundIndex++)
+    {
+        uint64_t firstProduct = (uint64_t)PHILOX_M0 * counter[0];
+        uint64_t secondProduct = (uint64_t)PHILOX_M1 * counter[2];
+        counter = {
+            (uint32_t)(secondProduct >> 32) ^ counter[1] ^ key[0],
+            (uint32_t)secondProduct,
+            (uint32_t)(firstProduct >> 32) ^ counter[3] ^ key[1],
+            (uint32_t)firstProduct};
+        key[0] += PHILOX_W0;
+        key[1] += PHILOX_W1;
+    }
+    return counter;
+}
+
+// Returns the natural logarithm of a number in (0, 1]
+static float calculateLogarithm(float x)
+{
+    // Split into a mantissa within a factor of root two of one and a power of two
+    uint32_t bits = std::bit_cast<uint32_t>(x);
+    float exponent = (float)((int32_t)(bits >> 23) - 127);
+    float mantissa = std::bit_cast<float>((bits & 0x007FFFFFu) | 0x3F800000u);
+    if (mantissa > 1.41421356f)
+    {
+        mantissa = mantissa * 0.5f;
+        exponent = exponent + 1.0f;
+    }
+
+    // The reciprocal of the mantissa plus one, which lies in [1.7, 2.5), converges from one half by Newton's method
+    float denominator = mantissa + 1.0f;
+    float reciprocal = 0.5f;
+    for (uint32_t iterationIndex = 0; iterationIndex < 4; iterationIndex++)
+    {
+        reciprocal = reciprocal * (2.0f - denominator * reciprocal);
+    }
+
+    // log(m) = 2 atanh(s) with s = (m - 1) / (m + 1), whose series converges quickly as |s| < 0.18
+    float s = (mantissa - 1.0f) * reciprocal;
+    float s2 = s * s;
+    float series = 0.0769230769f;
+    series = series * s2 + 0.0909090909f;
+    series = series * s2 + 0.111111111f;
+    series = series * s2 + 0.142857143f;
+    series = series * s2 + 0.2f;
+    series = series * s2 + 0.333333333f;
+    series = series * s2 + 1.0f;
+    return exponent * 0.693147181f + 2.0f * s * series;
+}
+
+// Returns the square root of a non-negative number
+static float calculateSquareRoot(float x)
+{
+    // The inverse square root converges from the bit level estimate by Newton's method
+    float inverseRoot = std::bit_cast<float>(0x5F3759DFu - (std::bit_cast<uint32_t>(x) >> 1));
+    for (uint32_t iterationIndex = 0; iterationIndex < 4; iterationIndex++)
+    {
+        inverseRoot = inverseRoot * (1.5f - 0.5f * x * inverseRoot * inverseRoot);
+    }
+    return x * inverseRoot;
+}
+
+// Returns the cosine of a whole turn times a number in [0, 1)
+static float calculateTurnCosine(float turns)
+{
+    // Reduce to a quarter turn either side of zero, flipping the sign for the half turn that was removed
+    float offset = turns - 0.5f;
+    float sign = -1.0f;
+    float reduced = offset < 0.0f ? -offset : offset;
+    if (reduced > 0.25f)
+    {
+        reduced = 0.5f - reduced;
+        sign = 1.0f;
+    }
+
+    // Taylor series of the cosine up to the 14th power, which is accurate to 1e-8 within a quarter turn
+    float angle = reduced * 6.28318531f;
+    float angle2 = angle * angle;
+    float series = -1.14707456e-11f;
+    series = series * angle2 + 2.08767570e-9f;
+    series = series * angle2 - 2.75573192e-7f;
+    series = series * angle2 + 2.48015873e-5f;
+    series = series * angle2 - 1.38888889e-3f;
+    series = series * angle2 + 4.16666667e-2f;
+    series = series * angle2 - 0.5f;
+    series = series * angle2 + 1.0f;
+    return sign * series;
+}
+
+float convertToNormal(uint32_t firstWord, uint32_t secondWord)
+{
+    // Uniform numbers on a grid of 2^-24, which floats hold exactly. The first is in (0, 1] so that its logarithm is finite.
+    float firstUniform = (float)((firstWord >> 8) + 1u) * 5.96046448e-8f;
+    float secondUniform = (float)(secondWord >> 8) * 5.96046448e-8f;
+    float radius = calculateSquareRoot(-2.0f * calculateLogarithm(firstUniform));
+    return radius * calculateTurnCosine(secondUniform);
+}
+
+float generateInitialFieldValue(uint32_t seed, uint32_t fieldIndex, uint32_t x, uint32_t y, uint32_t z)
+{
+    std::array<uint32_t, 4> words = generatePhilox4x32({x, y, z, 0u}, {seed, fieldIndex});
+    return 0.1f * convertToNormal(words[0], words[1]);
+}
\ No newline at end of file
@@ -0,0 +1,417 @@
+// Standard libraries
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <random>
+#include <thread>
+
+// External libraries
+
+// Internal libraries
+#include "power_law_fit.h"
+
+// Number of fitted parameters
+constexpr uint32_t NUM_PARAMETERS = 3;
+// Damping of the first Levenberg-Marquardt step
+constexpr double INITIAL_DAMPING = 1e-3;
+// The fit gives up once the damping grows past this without finding a better step
+constexpr double MAX_DAMPING = 1e16;
+// Percentiles of the 68% confidence interval
+constexpr double LOWER_PERCENTILE = 0.16;
+constexpr double UPPER_PERCENTILE = 0.84;
+
+// Helper function that packs parameters into an array.
+static void packParameters(const PowerLawParameters &parameters, double *values)
+{
+    values[0] = parameters.a;
+    values[1] = parameters.q;
+    values[2] = parameters.c;
+}
+
+// Helper function that unpacks parameters from an array.
+static PowerLawParameters unpackParameters(const double *values)
+{
+    return {values[0], values[1], values[2]};
+}
+
+// Helper function that returns the sum of squared residuals of the power law. The logarithms of the times are passed in so that
+// each point only needs a single exponential.
+static double calculateResidual(
+    const std::vector<double> &logTimes, const std::vector<double> &values, const PowerLawParameters &parameters)
+{
+    double residual = 0.0;
+    for (size_t pointIndex = 0; pointIndex < values.size(); pointIndex++)
+    {
+        double difference = values[pointIndex] - (parameters.a * exp(parameters.q * logTimes[pointIndex]) + parameters.c);
+        residual += difference * difference;
+    }
+    return residual;
+}
+
+// Helper function that solves the 3 x 3 system A x = b by Gaussian elimination with partial pivoting. Returns false if the
+// system is singular.
+static bool solveLinearSystem(double A[NUM_PARAMETERS][NUM_PARAMETERS], double *b, double *x)
+{
+    for (uint32_t column = 0; column < NUM_PARAMETERS; column++)
+    {
+        uint32_t pivot = column;
+        for (uint32_t row = column + 1; row < NUM_PARAMETERS; row++)
+        {
+            if (fabs(A[row][column]) > fabs(A[pivot][column]))
+            {
+                pivot = row;
+            }
+        }
+        if (fabs(A[pivot][column]) < 1e-300)
+        {
+            return false;
+        }
+        std::swap(A[column], A[pivot]);
+        std::swap(b[column], b[pivot]);
+
+        for (uint32_t row = column + 1; row < NUM_PARAMETERS; row++)
+        {
+            double factor = A[row][column] / A[column][column];
+            for (uint32_t otherColumn = column; otherColumn < NUM_PARAMETERS; otherColumn++)
+            {
+                A[row][otherColumn] -= factor * A[column][otherColumn];
+            }
+            b[row] -= factor * b[column];
+        }
+    }
+    for (int row = NUM_PARAMETERS - 1; row >= 0; row--)
+    {
+        double sum = b[row];
+        for (uint32_t column = row + 1; column < NUM_PARAMETERS; column++)
+        {
+            sum -= A[row][column] * x[column];
+        }
+        x[row] = sum / A[row][row];
+    }
+    return true;
+}
+
+// Helper function that returns the given percentile of a list of values, interpolating between neighbours.
+static double calculatePercentile(std::vector<double> values, double percentile)
+{
+    if (values.size() == 0)
+    {
+        return 0.0;
+    }
+    std::sort(values.begin(), values.end());
+    double position = percentile * (values.size() - 1);
+    size_t lowerIndex = (size_t)floor(position);
+    size_t upperIndex = std::min(lowerIndex + 1, values.size() - 1);
+    double weight = position - lowerIndex;
+    return (1.0 - weight) * values[lowerIndex] + weight * values[upperIndex];
+}
+
+PowerLawParameters PowerLawFitter::guess(const std::vector<double> &times, const std::vector<double> &values) const
+{
+    PowerLawParameters result = {1.0, -1.0, 0.0};
+    if (values.size() < 2)
+    {
+        return clamp(result);
+    }
+
+    // Place the offset below the smallest value so that the rest of the series can be logged
+    double minValue = *std::min_element(values.begin(), values.end());
+    double maxValue = *std::max_element(values.begin(), values.end());
+    result.c = std::max(minValue - 0.01 * (maxValue - minValue + 1e-12), lowerBounds.c);
+    result.c = std::min(result.c, minValue);
+
+    // Least squares line through log(y - c) against log(t)
+    double sumX = 0.0, sumY = 0.0, sumXX = 0.0, sumXY = 0.0;
+    uint32_t numPoints = 0;
+    for (size_t pointIndex = 0; pointIndex < values.size(); pointIndex++)
+    {
+        double shiftedValue = values[pointIndex] - result.c;
+        if (shiftedValue <= 0.0 || times[pointIndex] <= 0.0)
+        {
+            continue;
+        }
+        double x = log(times[pointIndex]);
+        double y = log(shiftedValue);
+        sumX += x;
+        sumY += y;
+        sumXX += x * x;
+        sumXY += x * y;
+        numPoints++;
+    }
+    double denominator = numPoints * sumXX - sumX * sumX;
+    if (numPoints >= 2 && fabs(denominator) > 1e-300)
+    {
+        result.q = (numPoints * sumXY - sumX * sumY) / denominator;
+        result.a = exp((sumY - result.q * sumX) / numPoints);
+    }
+    return clamp(result);
+}
+
+PowerLawFit PowerLawFitter::fit(const std::vector<double> &times, const std::vector<double> &values) const
+{
+    return fit(times, values, guess(times, values));
+}
+
+PowerLawFit PowerLawFitter::fit(const std::vector<double> &times, const std::vector<double> &values, PowerLawParameters initial) const
+{
+    PowerLawFit result;
+    result.parameters = clamp(initial);
+    if (times.size() != values.size() || values.size() < NUM_PARAMETERS)
+    {
+        logError("A power law fit needs at least %d points with a time each but was given %d values and %d times!", NUM_PARAMETERS,
+                 (int)values.size(), (int)times.size());
+        return result;
+    }
+
+    std::vector<double> logTimes(times.size());
+    for (size_t pointIndex = 0; pointIndex < times.size(); pointIndex++)
+    {
+        logTimes[pointIndex] = log(times[pointIndex]);
+    }
+
+    double damping = INITIAL_DAMPING;
+    result.residual = calculateResidual(logTimes, values, result.parameters);
+    for (result.numIterations = 0; result.numIterations < maxIterations; result.numIterations++)
+    {
+        // Build the normal equations J^T J and J^T r
+        double normalMatrix[NUM_PARAMETERS][NUM_PARAMETERS] = {};
+        double gradient[NUM_PARAMETERS] = {};
+        const PowerLawParameters &parameters = result.parameters;
+        for (size_t pointIndex = 0; pointIndex < values.size(); pointIndex++)
+        {
+            double power = exp(parameters.q * logTimes[pointIndex]);
+            double difference = values[pointIndex] - (parameters.a * power + parameters.c);
+            double jacobian[NUM_PARAMETERS] = {power, parameters.a * power * logTimes[pointIndex], 1.0};
+            for (uint32_t row = 0; row < NUM_PARAMETERS; row++)
+            {
+                gradient[row] += jacobian[row] * difference;
+                for (uint32_t column = 0; column < NUM_PARAMETERS; column++)
+                {
+                    normalMatrix[row][column] += jacobian[row] * jacobian[column];
+                }
+            }
+        }
+
+        // Keep damping until a step lowers the residual. The diagonal is floored so that a parameter with no influence, such as
+        // the exponent when the scale is zero, still gets a finite step.
+        double maxDiagonal = std::max({normalMatrix[0][0], normalMatrix[1][1], normalMatrix[2][2]});
+        // Parameters on a bound that the gradient pushes further out are held fixed for this step
+        bool isFixed[NUM_PARAMETERS];
+        double currentValues[NUM_PARAMETERS];
+        double lowerBoundValues[NUM_PARAMETERS];
+        double upperBoundValues[NUM_PARAMETERS];
+        packParameters(parameters, currentValues);
+        packParameters(lowerBounds, lowerBoundValues);
+        packParameters(upperBounds, upperBoundValues);
+        for (uint32_t parameterIndex = 0; parameterIndex < NUM_PARAMETERS; parameterIndex++)
+        {
+            isFixed[parameterIndex] = (currentValues[parameterIndex] <= lowerBoundValues[parameterIndex] && gradient[parameterIndex] < 0.0) ||
+                                      (currentValues[parameterIndex] >= upperBoundValues[parameterIndex] && gradient[parameterIndex] > 0.0);
+        }
+        bool isImproved = false;
+        double previousResidual = result.residual;
+        while (damping < MAX_DAMPING)
+        {
+            double dampedMatrix[NUM_PARAMETERS][NUM_PARAMETERS];
+            double rightHandSide[NUM_PARAMETERS];
+            for (uint32_t row = 0; row < NUM_PARAMETERS; row++)
+            {
+                for (uint32_t column = 0; column < NUM_PARAMETERS; column++)
+                {
+                    dampedMatrix[row][column] = normalMatrix[row][column];
+                }
+                dampedMatrix[row][row] += damping * std::max(normalMatrix[row][row], 1e-12 * maxDiagonal + 1e-300);
+                rightHandSide[row] = gradient[row];
+            }
+            for (uint32_t fixedIndex = 0; fixedIndex < NUM_PARAMETERS; fixedIndex++)
+            {
+                if (!isFixed[fixedIndex])
+                {
+                    continue;
+                }
+                for (uint32_t otherIndex = 0; otherIndex < NUM_PARAMETERS; otherIndex++)
+                {
+                    dampedMatrix[fixedIndex][otherIndex] = 0.0;
+                    dampedMatrix[otherIndex][fixedIndex] = 0.0;
+                }
+                dampedMatrix[fixedIndex][fixedIndex] = 1.0;
+                rightHandSide[fixedIndex] = 0.0;
+            }
+
+            double step[NUM_PARAMETERS];
+            if (!solveLinearSystem(dampedMatrix, rightHandSide, step))
+            {
+                damping *= 10.0;
+                continue;
+            }
+            double trialValues[NUM_PARAMETERS];
+            packParameters(parameters, trialValues);
+            for (uint32_t parameterIndex = 0; parameterIndex < NUM_PARAMETERS; parameterIndex++)
+            {
+                trialValues[parameterIndex] += step[parameterIndex];
+            }
+            PowerLawParameters trialParameters = clamp(unpackParameters(trialValues));
+            double trialResidual = calculateResidual(logTimes, values, trialParameters);
+            if (std::isfinite(trialResidual) && trialResidual < result.residual)
+            {
+                result.parameters = trialParameters;
+                result.residual = trialResidual;
+                damping = std::max(damping / 10.0, 1e-12);
+                isImproved = true;
+                break;
+            }
+            damping *= 10.0;
+        }
+
+        // Stop when no step helps or the residual has stopped changing
+        if (!isImproved || previousResidual - result.residual <= tolerance * previousResidual)
+        {
+            result.hasConverged = true;
+            result.numIterations++;
+            break;
+        }
+    }
+    return result;
+}
+
+PowerLawEnsembleFit PowerLawFitter::fitEnsemble(const std::vector<double> &times, const std::vector<std::vector<double>> &trials) const
+{
+    PowerLawEnsembleFit result;
+    result.numTrials = trials.size();
+    if (trials.size() == 0)
+    {
+        logError("Can not fit an ensemble with no trials!");
+        result.quality = FitQuality::NOT_CONVERGED;
+        return result;
+    }
+    for (size_t trialIndex = 0; trialIndex < trials.size(); trialIndex++)
+    {
+        if (trials[trialIndex].size() != times.size())
+        {
+            logError("Trial %d has %d values but there are %d times! Can not fit the ensemble.", (int)trialIndex,
+                     (int)trials[trialIndex].size(), (int)times.size());
+            result.quality = FitQuality::NOT_CONVERGED;
+            return result;
+        }
+    }
+
+    // Fit the mean of every trial
+    std::vector<double> meanValues(times.size(), 0.0);
+    for (const auto &trial : trials)
+    {
+        for (size_t pointIndex = 0; pointIndex < times.size(); pointIndex++)
+        {
+            meanValues[pointIndex] += trial[pointIndex] / trials.size();
+        }
+    }
+    result.meanFit = fit(times, meanValues);
+
+    // Fit the mean of each resample of the trials. Resamples start from the mean fit so they converge in a few iterations.
+    result.numResamples = numResamples;
+    std::vector<PowerLawParameters> resampleParameters(numResamples);
+    std::atomic<uint32_t> nextResample = 0;
+    auto runResamples = [&]()
+    {
+        std::vector<double> resampleValues(times.size());
+        for (uint32_t resampleIndex = nextResample++; resampleIndex < numResamples; resampleIndex = nextResample++)
+        {
+            std::mt19937 generator(seed + resampleIndex);
+            std::uniform_int_distribution<size_t> trialDistribution(0, trials.size() - 1);
+            std::fill(resampleValues.begin(), resampleValues.end(), 0.0);
+            for (size_t drawIndex = 0; drawIndex < trials.size(); drawIndex++)
+            {
+                const std::vector<double> &trial = trials[trialDistribution(generator)];
+                for (size_t pointIndex = 0; pointIndex < times.size(); pointIndex++)
+                {
+                    resampleValues[pointIndex] += trial[pointIndex] / trials.size();
+                }
+            }
+            resampleParameters[resampleIndex] = fit(times, resampleValues, result.meanFit.parameters).parameters;
+        }
+    };
+
+    uint32_t threadCount = numThreads > 0 ? numThreads : std::max(std::thread::hardware_concurrency(), 1u);
+    threadCount = std::min(threadCount, std::max(numResamples, 1u));
+    std::vector<std::thread> workers;
+    for (uint32_t threadIndex = 1; threadIndex < threadCount; threadIndex++)
+    {
+        workers.emplace_back(runResamples);
+    }
+    runResamples();
+    for (auto &worker : workers)
+    {
+        worker.join();
+    }
+
+    // Median and 68% interval of each parameter
+    double medianValues[NUM_PARAMETERS];
+    double lowerValues[NUM_PARAMETERS];
+    double upperValues[NUM_PARAMETERS];
+    // Without resamples the interval collapses onto the mean fit
+    if (numResamples == 0)
+    {
+        resampleParameters.push_back(result.meanFit.parameters);
+    }
+    for (uint32_t parameterIndex = 0; parameterIndex < NUM_PARAMETERS; parameterIndex++)
+    {
+        std::vector<double> distribution;
+        for (const auto &parameters : resampleParameters)
+        {
+            double values[NUM_PARAMETERS];
+            packParameters(parameters, values);
+            distribution.push_back(values[parameterIndex]);
+        }
+        medianValues[parameterIndex] = calculatePercentile(distribution, 0.5);
+        lowerValues[parameterIndex] = calculatePercentile(distribution, LOWER_PERCENTILE);
+        upperValues[parameterIndex] = calculatePercentile(distribution, UPPER_PERCENTILE);
+    }
+    result.median = unpackParameters(medianValues);
+    result.lowerInterval = unpackParameters(lowerValues);
+    result.upperInterval = unpackParameters(upperValues);
+
+    // Flag fits that did not converge, that hit a bound or whose parameters are not constrained by the data
+    double fitValues[NUM_PARAMETERS];
+    double lowerBoundValues[NUM_PARAMETERS];
+    double upperBoundValues[NUM_PARAMETERS];
+    packParameters(result.meanFit.parameters, fitValues);
+    packParameters(lowerBounds, lowerBoundValues);
+    packParameters(upperBounds, upperBoundValues);
+    result.quality = FitQuality::GOOD;
+    if (!result.meanFit.hasConverged)
+    {
+        result.quality = FitQuality::NOT_CONVERGED;
+        return result;
+    }
+    for (uint32_t parameterIndex = 0; parameterIndex < NUM_PARAMETERS; parameterIndex++)
+    {
+        if (isAtBound(fitValues[parameterIndex], lowerBoundValues[parameterIndex], upperBoundValues[parameterIndex]))
+        {
+            result.quality = FitQuality::AT_BOUND;
+            return result;
+        }
+    }
+    for (uint32_t parameterIndex = 0; parameterIndex < NUM_PARAMETERS; parameterIndex++)
+    {
+        if (0.5 * (upperValues[parameterIndex] - lowerValues[parameterIndex]) > fabs(medianValues[parameterIndex]))
+        {
+            result.quality = FitQuality::UNCONSTRAINED;
+            return result;
+        }
+    }
+    return result;
+}
+
+PowerLawParameters PowerLawFitter::clamp(PowerLawParameters parameters) const
+{
+    parameters.a = std::clamp(parameters.a, lowerBounds.a, upperBounds.a);
+    parameters.q = std::clamp(parameters.q, lowerBounds.q, upperBounds.q);
+    parameters.c = std::clamp(parameters.c, lowerBounds.c, upperBounds.c);
+    return parameters;
+}
+
+bool PowerLawFitter::isAtBound(double value, double lowerBound, double upperBound)
+{
+    double scale = std::max(fabs(value), 1e-12);
+    return (std::isfinite(lowerBound) && value - lowerBound <= 1e-9 * scale) ||
+           (std::isfinite(upperBound) && upperBound - value <= 1e-9 * scale);
+}
\ No newline at end of file
@@ -0,0 +1,302 @@
+// Standard libraries
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <complex>
+#include <functional>
+#include <thread>
+
+// External libraries
+#include <glad/glad.h>
+
+// Internal libraries
+#include "random_field.h"
+
+// Width and height of each work group of the filter passes
+constexpr uint32_t FILTER_GROUP_SIZE = 8;
+// Number of lines each thread of the CPU transform takes at a time
+constexpr uint32_t LINES_PER_TASK = 16;
+
+constexpr double PI = 3.14159265358979323846;
+
+// Helper function that returns true if the given value is a non-zero power of two.
+static bool isPowerOfTwo(uint32_t value)
+{
+    return value != 0 && (value & (value - 1)) == 0;
+}
+
+// Helper function that returns the wavenumber in radians per cell of the given mode along an axis of the given length.
+static float getWavenumber(uint32_t modeIndex, uint32_t length)
+{
+    int signedIndex = modeIndex > length / 2 ? (int)modeIndex - (int)length : (int)modeIndex;
+    return 2.0f * (float)PI * signedIndex / length;
+}
+
+// Helper function that calls the given function for every line, sharing the lines between the hardware threads.
+static void runLinesInParallel(uint32_t numLines, const std::function<void(uint32_t)> &function)
+{
+    std::atomic<uint32_t> nextLine = 0;
+    auto runLines = [&]()
+    {
+        for (uint32_t startLine = nextLine.fetch_add(LINES_PER_TASK); startLine < numLines;
+             startLine = nextLine.fetch_add(LINES_PER_TASK))
+        {
+            for (uint32_t lineIndex = startLine; lineIndex < std::min(startLine + LINES_PER_TASK, numLines); lineIndex++)
+            {
+                function(lineIndex);
+            }
+        }
+    };
+
+    uint32_t threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+    threadCount = std::min(threadCount, (numLines + LINES_PER_TASK - 1) / LINES_PER_TASK);
+    std::vector<std::thread> workers;
+    for (uint32_t threadIndex = 1; threadIndex < threadCount; threadIndex++)
+    {
+        workers.emplace_back(runLines);
+    }
+    runLines();
+    for (auto &worker : workers)
+    {
+        worker.join();
+    }
+}
+
+// Helper function that transforms a line of complex data in place with a radix-2 fast Fourier transform. The inverse transform is
+// not normalised.
+static void transformLine(std::vector<std::complex<double>> &line, bool isInverse)
+{
+    uint32_t length = line.size();
+    // Bit reversal permutation
+    for (uint32_t index = 1, reversedIndex = 0; index < length; index++)
+    {
+        uint32_t bit = length >> 1;
+        for (; reversedIndex & bit; bit >>= 1)
+        {
+            reversedIndex ^= bit;
+        }
+        reversedIndex ^= bit;
+        if (index < reversedIndex)
+        {
+            std::swap(line[index], line[reversedIndex]);
+        }
+    }
+
+    double direction = isInverse ? 1.0 : -1.0;
+    for (uint32_t stride = 1; stride < length; stride *= 2)
+    {
+        for (uint32_t subIndex = 0; subIndex < stride; subIndex++)
+        {
+            std::complex<double> twiddle = std::polar(1.0, direction * PI * subIndex / stride);
+            for (uint32_t start = 0; start < length; start += 2 * stride)
+            {
+                std::complex<double> first = line[start + subIndex];
+                std::complex<double> second = line[start + subIndex + stride] * twiddle;
+                line[start + subIndex] = first + second;
+                line[start + subIndex + stride] = first - second;
+            }
+        }
+    }
+}
+
+// Helper function that transforms row major complex data of the given size in place along both axes.
+static void transformData(std::vector<std::complex<double>> &data, uint32_t width, uint32_t height, bool isInverse)
+{
+    runLinesInParallel(
+        height,
+        [&](uint32_t rowIndex)
+        {
+            std::vector<std::complex<double>> line(data.begin() + (size_t)rowIndex * width,
+                                                   data.begin() + (size_t)(rowIndex + 1) * width);
+            transformLine(line, isInverse);
+            std::copy(line.begin(), line.end(), data.begin() + (size_t)rowIndex * width);
+        });
+    runLinesInParallel(
+        width,
+        [&](uint32_t columnIndex)
+        {
+            std::vector<std::complex<double>> line(height);
+            for (uint32_t rowIndex = 0; rowIndex < height; rowIndex++)
+            {
+                line[rowIndex] = data[(size_t)rowIndex * width + columnIndex];
+            }
+            transformLine(line, isInverse);
+            for (uint32_t rowIndex = 0; rowIndex < height; rowIndex++)
+            {
+                data[(size_t)rowIndex * width + columnIndex] = line[rowIndex];
+            }
+        });
+}
+
+float calculateSpectrumPower(const InitialSpectrum &spectrum, float wavenumber)
+{
+    float cutoff = std::exp(-0.5f * wavenumber * wavenumber * spectrum.correlationLength * spectrum.correlationLength);
+    float power = 1.0f;
+    switch (spectrum.type)
+    {
+    case InitialSpectrumType::WHITE_NOISE:
+        break;
+    case InitialSpectrumType::GAUSSIAN:
+        power = cutoff;
+        break;
+    case InitialSpectrumType::POWER_LAW:
+        power = std::pow(wavenumber, spectrum.spectralIndex) * cutoff;
+        break;
+    default:
+        logError("Unknown initial spectrum type!");
+        break;
+    }
+    return std::isfinite(power) ? power : 0.0f;
+}
+
+double calculateMeanSpectrumPower(const InitialSpectrum &spectrum, uint32_t width, uint32_t height)
+{
+    double totalPower = 0.0;
+    for (uint32_t y = 0; y < height; y++)
+    {
+        float yWavenumber = getWavenumber(y, height);
+        for (uint32_t x = 0; x < width; x++)
+        {
+            float xWavenumber = getWavenumber(x, width);
+            totalPower += calculateSpectrumPower(spectrum, std::sqrt(xWavenumber * xWavenumber + yWavenumber * yWavenumber));
+        }
+    }
+    return totalPower / ((double)width * height);
+}
+
+bool filterRandomFieldData(std::vector<std::vector<float>> &fieldData, uint32_t width, uint32_t height, const InitialSpectrum &spectrum)
+{
+    if (spectrum.type == InitialSpectrumType::WHITE_NOISE)
+    {
+        return true;
+    }
+    if (!isPowerOfTwo(width) || !isPowerOfTwo(height))
+    {
+        logWarning("Filtered initial fields require power of two dimensions but were given %d x %d!", width, height);
+        return false;
+    }
+    double meanPower = calculateMeanSpectrumPower(spectrum, width, height);
+    if (!(meanPower > 0.0))
+    {
+        logWarning("The %s initial spectrum has no power on a %d x %d lattice!",
+                   convertInitialSpectrumTypeToString(spectrum.type).c_str(), width, height);
+        return false;
+    }
+
+    // Dividing by the mean power keeps the variance of the noise, and dividing by the number of cells normalises the inverse
+    size_t numCells = (size_t)width * height;
+    double scale = 1.0 / (std::sqrt(meanPower) * numCells);
+    std::vector<std::complex<double>> data(numCells);
+    for (size_t firstIndex = 0; firstIndex < fieldData.size(); firstIndex += 2)
+    {
+        // The filter is real and even, so the real and imaginary parts stay separate and a pair of fields share one transform
+        std::vector<float> &firstField = fieldData[firstIndex];
+        std::vector<float> *secondField = firstIndex + 1 < fieldData.size() ? &fieldData[firstIndex + 1] : nullptr;
+        for (size_t cellIndex = 0; cellIndex < numCells; cellIndex++)
+        {
+            data[cellIndex] = {firstField[4 * cellIndex], secondField != nullptr ? (*secondField)[4 * cellIndex] : 0.0f};
+        }
+
+        transformData(data, width, height, false);
+        runLinesInParallel(
+            height,
+            [&](uint32_t y)
+            {
+                float yWavenumber = getWavenumber(y, height);
+                for (uint32_t x = 0; x < width; x++)
+                {
+                    float xWavenumber = getWavenumber(x, width);
+                    float power = calculateSpectrumPower(spectrum, std::sqrt(xWavenumber * xWavenumber + yWavenumber * yWavenumber));
+                    data[(size_t)y * width + x] *= std::sqrt((double)power) * scale;
+                }
+            });
+        transformData(data, width, height, true);
+
+        for (size_t cellIndex = 0; cellIndex < numCells; cellIndex++)
+        {
+            firstField[4 * cellIndex] = (float)data[cellIndex].real();
+            if (secondField != nullptr)
+            {
+                (*secondField)[4 * cellIndex] = (float)data[cellIndex].imag();
+            }
+        }
+    }
+    return true;
+}
+
+RandomFieldFilter::RandomFieldFilter(FourierTransform *transform, ComputeShaderProgram *filterPass, ComputeShaderProgram *storePass)
+    : m_Transform(transform), m_FilterPass(filterPass), m_StorePass(storePass)
+{
+}
+
+RandomFieldFilter::~RandomFieldFilter()
+{
+    delete m_Transform;
+    delete m_FilterPass;
+    delete m_StorePass;
+}
+
+bool RandomFieldFilter::filter(Texture2D *firstField, Texture2D *secondField, const InitialSpectrum &spectrum)
+{
+    if (spectrum.type == InitialSpectrumType::WHITE_NOISE)
+    {
+        return true;
+    }
+    uint32_t width = firstField->width;
+    uint32_t height = firstField->height;
+    if (!m_Transform->setSize(width, height))
+    {
+        return false;
+    }
+    double meanPower = calculateMeanSpectrumPower(spectrum, width, height);
+    if (!(meanPower > 0.0))
+    {
+        logWarning("The %s initial spectrum has no power on a %d x %d lattice!",
+                   convertInitialSpectrumTypeToString(spectrum.type).c_str(), width, height);
+        return false;
+    }
+    uint32_t xNumGroups = (width + FILTER_GROUP_SIZE - 1) / FILTER_GROUP_SIZE;
+    uint32_t yNumGroups = (height + FILTER_GROUP_SIZE - 1) / FILTER_GROUP_SIZE;
+
+    // A pair of fields is transformed at once as the real and imaginary parts
+    m_Transform->load(firstField, secondField);
+    m_Transform->transform(false);
+
+    m_FilterPass->use();
+    glUniform1i(0, (int)spectrum.type);
+    glUniform1f(1, spectrum.correlationLength);
+    glUniform1f(2, spectrum.spectralIndex);
+    glUniform1f(3, (float)(1.0 / (std::sqrt(meanPower) * width * height)));
+    glBindImageTexture(0, m_Transform->getData()->textureID, 0, GL_FALSE, 0, GL_READ_WRITE, GL_RG32F);
+    glDispatchCompute(xNumGroups, yNumGroups, 1);
+    glMemoryBarrier(GL_ALL_BARRIER_BITS);
+
+    m_Transform->transform(true);
+
+    m_StorePass->use();
+    glUniform1i(0, secondField != nullptr);
+    glBindImageTexture(0, m_Transform->getData()->textureID, 0, GL_FALSE, 0, GL_READ_ONLY, GL_RG32F);
+    glBindImageTexture(1, firstField->textureID, 0, GL_FALSE, 0, GL_READ_WRITE, GL_RGBA32F);
+    // Keep the image unit valid even when there is no second field
+    glBindImageTexture(2, (secondField != nullptr ? secondField : firstField)->textureID, 0, GL_FALSE, 0, GL_READ_WRITE, GL_RGBA32F);
+    glDispatchCompute(xNumGroups, yNumGroups, 1);
+    glMemoryBarrier(GL_ALL_BARRIER_BITS);
+    return true;
+}
+
+RandomFieldFilter *RandomFieldFilter::create()
+{
+    FourierTransform *transform = FourierTransform::create();
+    ComputeShaderProgram *filterPass = ComputeShaderProgram::createFromFile("shaders/random_field_filter.glsl");
+    ComputeShaderProgram *storePass = ComputeShaderProgram::createFromFile("shaders/random_field_store.glsl");
+    if (transform == nullptr || filterPass == nullptr || storePass == nullptr)
+    {
+        logError("Failed to create the random field filter passes!");
+        delete transform;
+        delete filterPass;
+        delete storePass;
+        return nullptr;
+    }
+
+    return new RandomFieldFilter(transform, filterPass, storePass);
+}
\ No newline at end of file
@@ -0,0 +1,193 @@
+// Standard libraries
+
+// External libraries
+#include <glad/glad.h>
+
+// Internal libraries
+#include "reduction.h"
+
+// Width and height of the tile reduced by each work group of the texture pass
+constexpr uint32_t TEXTURE_TILE_SIZE = 32;
+// Number of partials reduced by each work group of the partials pass
+constexpr uint32_t PARTIALS_PER_GROUP = 1024;
+// Width and height of each work group of the histogram pass
+constexpr uint32_t HISTOGRAM_GROUP_SIZE = 16;
+
+bool ReductionQuery::isReady()
+{
+    return m_Type != ReductionType::NONE && m_Readback.isReady();
+}
+
+ReductionResult ReductionQuery::getResult()
+{
+    ReductionResult result;
+    if (m_Type != ReductionType::STATISTICS)
+    {
+        logError("The reduction query does not hold a pending statistics reduction!");
+        return result;
+    }
+
+    // Partials are laid out as (sum, min, max, sum of squares)
+    float partial[4];
+    m_Readback.copyTo(partial, sizeof(partial));
+    result.sum = partial[0];
+    result.minValue = partial[1];
+    result.maxValue = partial[2];
+    result.sumOfSquares = partial[3];
+    result.count = m_Count;
+
+    m_Type = ReductionType::NONE;
+    return result;
+}
+
+Histogram ReductionQuery::getHistogram()
+{
+    Histogram result;
+    if (m_Type != ReductionType::HISTOGRAM)
+    {
+        logError("The reduction query does not hold a pending histogram!");
+        return result;
+    }
+
+    result.minValue = m_MinValue;
+    result.maxValue = m_MaxValue;
+    result.bins.resize(m_NumBins);
+    m_Readback.copyTo(result.bins.data(), m_NumBins * sizeof(uint32_t));
+
+    m_Type = ReductionType::NONE;
+    return result;
+}
+
+Reduction::Reduction(
+    ComputeShaderProgram *reduceTexturePass,
+    ComputeShaderProgram *reducePartialsPass,
+    ComputeShaderProgram *histogramTexturePass)
+    : m_ReduceTexturePass(reduceTexturePass),
+      m_ReducePartialsPass(reducePartialsPass),
+      m_HistogramTexturePass(histogramTexturePass)
+{
+    m_BinBuffer = std::make_unique<ShaderStorageBuffer>(MAX_HISTOGRAM_BINS * sizeof(uint32_t), BufferUsageType::DYNAMIC_COPY);
+}
+
+Reduction::~Reduction()
+{
+    delete m_ReduceTexturePass;
+    delete m_ReducePartialsPass;
+    delete m_HistogramTexturePass;
+}
+
+void Reduction::reservePartials(uint32_t numPartials)
+{
+    uint32_t numBytes = numPartials * 4 * sizeof(float);
+    for (auto &partialBuffer : m_PartialBuffers)
+    {
+        // Only reallocate when growing
+        if (partialBuffer == nullptr || partialBuffer->size < numBytes)
+        {
+            partialBuffer = std::make_unique<ShaderStorageBuffer>(numBytes, BufferUsageType::DYNAMIC_COPY);
+        }
+    }
+}
+
+void Reduction::reduce(Texture2D *texture, uint32_t channel, ReductionQuery &query)
+{
+    uint32_t xNumGroups = std::max((texture->width + TEXTURE_TILE_SIZE - 1) / TEXTURE_TILE_SIZE, (uint32_t)1);
+    uint32_t yNumGroups = std::max((texture->height + TEXTURE_TILE_SIZE - 1) / TEXTURE_TILE_SIZE, (uint32_t)1);
+    uint32_t numPartials = xNumGroups * yNumGroups;
+    reservePartials(numPartials);
+
+    // Reduce each tile of the texture into a partial
+    m_ReduceTexturePass->use();
+    glUniform1i(0, channel);
+    texture->bindUnit(0);
+    m_PartialBuffers[0]->bindBase(0);
+    glDispatchCompute(xNumGroups, yNumGroups, 1);
+    glMemoryBarrier(GL_ALL_BARRIER_BITS);
+    texture->unbindUnit(0);
+
+    // Keep reducing the partials until only one is left
+    uint32_t inputIndex = 0;
+    while (numPartials > 1)
+    {
+        uint32_t numGroups = (numPartials + PARTIALS_PER_GROUP - 1) / PARTIALS_PER_GROUP;
+        m_ReducePartialsPass->use();
+        glUniform1ui(0, numPartials);
+        m_PartialBuffers[inputIndex]->bindBase(0);
+        m_PartialBuffers[1 - inputIndex]->bindBase(1);
+        glDispatchCompute(numGroups, 1, 1);
+        glMemoryBarrier(GL_ALL_BARRIER_BITS);
+
+        numPartials = numGroups;
+        inputIndex = 1 - inputIndex;
+    }
+
+    // Only the final partial is read back
+    query.m_Readback.readBuffer(m_PartialBuffers[inputIndex]->bufferID, 0, 4 * sizeof(float));
+    query.m_Type = ReductionType::STATISTICS;
+    query.m_Count = texture->width * texture->height;
+}
+
+void Reduction::histogram(Texture2D *texture, uint32_t channel, float minValue, float maxValue, uint32_t numBins, ReductionQuery &query)
+{
+    if (numBins == 0 || numBins > MAX_HISTOGRAM_BINS)
+    {
+        logWarning("The number of histogram bins %d must be between 1 and %d! Clamping to the valid range.", numBins, MAX_HISTOGRAM_BINS);
+        numBins = std::clamp(numBins, (uint32_t)1, MAX_HISTOGRAM_BINS);
+    }
+    if (maxValue <= minValue)
+    {
+        logWarning("The histogram range [%f, %f] is empty! Widening the range.", minValue, maxValue);
+        maxValue = minValue + 1.0f;
+    }
+
+    uint32_t xNumGroups = std::max((texture->width + HISTOGRAM_GROUP_SIZE - 1) / HISTOGRAM_GROUP_SIZE, (uint32_t)1);
+    uint32_t yNumGroups = std::max((texture->height + HISTOGRAM_GROUP_SIZE - 1) / HISTOGRAM_GROUP_SIZE, (uint32_t)1);
+
+    m_HistogramTexturePass->use();
+    glUniform1i(0, channel);
+    glUniform1f(1, minValue);
+    glUniform1f(2, maxValue);
+    glUniform1ui(3, numBins);
+    texture->bindUnit(0);
+    m_BinBuffer->clear(0, numBins * sizeof(uint32_t));
+    m_BinBuffer->bindBase(0);
+    glDispatchCompute(xNumGroups, yNumGroups, 1);
+    glMemoryBarrier(GL_ALL_BARRIER_BITS);
+    texture->unbindUnit(0);
+
+    query.m_Readback.readBuffer(m_BinBuffer->bufferID, 0, numBins * sizeof(uint32_t));
+    query.m_Type = ReductionType::HISTOGRAM;
+    query.m_Count = texture->width * texture->height;
+    query.m_MinValue = minValue;
+    query.m_MaxValue = maxValue;
+    query.m_NumBins = numBins;
+}
+
+ReductionResult Reduction::reduceNow(Texture2D *texture, uint32_t channel)
+{
+    reduce(texture, channel, m_ImmediateQuery);
+    return m_ImmediateQuery.getResult();
+}
+
+Histogram Reduction::histogramNow(Texture2D *texture, uint32_t channel, float minValue, float maxValue, uint32_t numBins)
+{
+    histogram(texture, channel, minValue, maxValue, numBins, m_ImmediateQuery);
+    return m_ImmediateQuery.getHistogram();
+}
+
+Reduction *Reduction::create()
+{
+    ComputeShaderProgram *reduceTexturePass = ComputeShaderProgram::createFromFile("shaders/reduce_texture.glsl");
+    ComputeShaderProgram *reducePartialsPass = ComputeShaderProgram::createFromFile("shaders/reduce_partials.glsl");
+    ComputeShaderProgram *histogramTexturePass = ComputeShaderProgram::createFromFile("shaders/histogram_texture.glsl");
+    if (reduceTexturePass == nullptr || reducePartialsPass == nullptr || histogramTexturePass == nullptr)
+    {
+        logError("Failed to create the reduction passes!");
+        delete reduceTexturePass;
+        delete reducePartialsPass;
+        delete histogramTexturePass;
+        return nullptr;
+    }
+
+    return new Reduction(reduceTexturePass, reducePartialsPass, histogramTexturePass);
+}
\ No newline at end of file
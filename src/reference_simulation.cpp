@@ -0,0 +1,407 @@
+// Standard libraries
+#include <algorithm>
+#include <cmath>
+
+// External libraries
+
+// Internal libraries
+#include "reference_simulation.h"
+
+// PRS alpha
+constexpr double ALPHA_2D = 2.0;
+
+// Returns the handedness of a real crossing as +-1.
+static int calculateCrossingHandedness(double realCurrent, double imagCurrent, double realNext, double imagNext)
+{
+    double result = realNext * imagCurrent - realCurrent * imagNext;
+    return (result > 0.0) - (result < 0.0);
+}
+
+// Returns `1` if the link crosses the real axis, otherwise returns `0`.
+static int calculateRealCrossing(double imagCurrent, double imagNext)
+{
+    return (imagCurrent * imagNext) < 0.0;
+}
+
+// Detects whether a string pierces through the plaquette with the given corners, listed as top left, top right, bottom right and
+// bottom left.
+static int checkPlaquette(const std::vector<double> &realValues, const std::vector<double> &imagValues, const size_t corners[4])
+{
+    int result = 0;
+    for (uint32_t linkIndex = 0; linkIndex < 4; linkIndex++)
+    {
+        size_t current = corners[linkIndex];
+        size_t next = corners[(linkIndex + 1) % 4];
+        result += calculateRealCrossing(imagValues[current], imagValues[next]) *
+                  calculateCrossingHandedness(realValues[current], imagValues[current], realValues[next], imagValues[next]);
+    }
+    return result;
+}
+
+// Returns `1` if the link between two values of a complex field crosses the negative real axis, otherwise returns `0`.
+static int checkNegativeRealCrossing(double realCurrent, double imagCurrent, double realNext, double imagNext)
+{
+    double realAtCrossing = (imagCurrent * realNext - realCurrent * imagNext) * (imagCurrent - imagNext);
+    return (imagCurrent * imagNext < 0.0) && (realAtCrossing < 0.0);
+}
+
+// Looks up a parameter by name. Returns false if the parameter is missing.
+static bool findParameter(const std::vector<std::pair<std::string, float>> &parameters, const char *name, double &value)
+{
+    for (const auto &parameter : parameters)
+    {
+        if (parameter.first == name)
+        {
+            value = parameter.second;
+            return true;
+        }
+    }
+    logError("The reference simulation is missing the parameter %s!", name);
+    return false;
+}
+
+ReferenceSimulation::ReferenceSimulation(SimulationModel model, float dx, float dt, int era)
+{
+    m_Model = model;
+    m_Dx = dx;
+    m_Dt = dt;
+    m_Era = era;
+}
+
+ReferenceSimulation *ReferenceSimulation::create(
+    SimulationModel model, const std::vector<std::pair<std::string, float>> &parameters, float dx, float dt, int era)
+{
+    ReferenceSimulation *reference = new ReferenceSimulation(model, dx, dt, era);
+    bool foundParameters = findParameter(parameters, "eta", reference->m_Eta);
+    foundParameters &= findParameter(parameters, "lam", reference->m_Lambda);
+    switch (model)
+    {
+    case SimulationModel::DOMAIN_WALLS:
+        reference->m_NumFields = 1;
+        reference->m_HasWalls = true;
+        break;
+    case SimulationModel::COSMIC_STRINGS:
+        reference->m_NumFields = 2;
+        reference->m_HasStrings = true;
+        break;
+    case SimulationModel::SINGLE_AXION:
+    {
+        reference->m_NumFields = 2;
+        reference->m_HasStrings = true;
+        reference->m_HasWalls = true;
+        double colorAnomaly = 0.0;
+        foundParameters &= findParameter(parameters, "colorAnomaly", colorAnomaly);
+        reference->m_ColorAnomaly = (int)colorAnomaly;
+        foundParameters &= findParameter(parameters, "axionStrength", reference->m_AxionStrength);
+        foundParameters &= findParameter(parameters, "growthScale", reference->m_GrowthScale);
+        foundParameters &= findParameter(parameters, "growthLaw", reference->m_GrowthLaw);
+        break;
+    }
+    case SimulationModel::COMPANION_AXION:
+        reference->m_NumFields = 4;
+        reference->m_HasStrings = true;
+        reference->m_HasWalls = true;
+        foundParameters &= findParameter(parameters, "axionStrength", reference->m_AxionStrength);
+        foundParameters &= findParameter(parameters, "kappa", reference->m_Kappa);
+        foundParameters &= findParameter(parameters, "tGrowthScale", reference->m_TGrowthScale);
+        foundParameters &= findParameter(parameters, "tGrowthLaw", reference->m_TGrowthLaw);
+        foundParameters &= findParameter(parameters, "sGrowthScale", reference->m_SGrowthScale);
+        foundParameters &= findParameter(parameters, "sGrowthLaw", reference->m_SGrowthLaw);
+        foundParameters &= findParameter(parameters, "n", reference->m_N);
+        foundParameters &= findParameter(parameters, "nPrime", reference->m_NPrime);
+        foundParameters &= findParameter(parameters, "m", reference->m_M);
+        foundParameters &= findParameter(parameters, "mPrime", reference->m_MPrime);
+        break;
+    default:
+        logError("The reference simulation does not support the model %s!", convertSimulationModelToString(model).c_str());
+        foundParameters = false;
+        break;
+    }
+
+    if (!foundParameters)
+    {
+        delete reference;
+        return nullptr;
+    }
+
+    // Each pair of fields has strings, and a single real field has walls of its own
+    size_t numPhases = reference->m_NumFields / 2;
+    reference->m_Fields.resize(reference->m_NumFields);
+    reference->m_StringNumbers.resize(reference->m_HasStrings ? numPhases : 0);
+    reference->m_WallNumbers.resize(reference->m_HasWalls ? (reference->m_NumFields == 1 ? 1 : numPhases) : 0);
+    return reference;
+}
+
+void ReferenceSimulation::setFields(uint32_t width, uint32_t height, const std::vector<std::vector<float>> &fieldData)
+{
+    if (fieldData.size() < m_NumFields)
+    {
+        logError("The reference simulation needs %d fields but was given %d!", m_NumFields, (int)fieldData.size());
+        return;
+    }
+
+    m_Width = width;
+    m_Height = height;
+    m_CurrentTimestep = 1;
+    size_t numCells = (size_t)width * height;
+    for (size_t fieldIndex = 0; fieldIndex < m_NumFields; fieldIndex++)
+    {
+        ReferenceField &field = m_Fields[fieldIndex];
+        field.values.resize(numCells);
+        field.velocities.resize(numCells);
+        field.accelerations.resize(numCells);
+        field.nextAccelerations.resize(numCells);
+        field.laplacians.assign(numCells, 0.0);
+        for (size_t cellIndex = 0; cellIndex < numCells; cellIndex++)
+        {
+            field.values[cellIndex] = fieldData[fieldIndex][4 * cellIndex + 0];
+            field.velocities[cellIndex] = fieldData[fieldIndex][4 * cellIndex + 1];
+            field.accelerations[cellIndex] = fieldData[fieldIndex][4 * cellIndex + 2];
+            field.nextAccelerations[cellIndex] = fieldData[fieldIndex][4 * cellIndex + 3];
+        }
+    }
+
+    for (auto &stringCount : m_StringNumbers)
+    {
+        stringCount.clear();
+    }
+    for (auto &wallCount : m_WallNumbers)
+    {
+        wallCount.clear();
+    }
+    calculateLaplacian();
+    sampleDefects();
+}
+
+void ReferenceSimulation::update()
+{
+    // Evolve field
+    for (auto &field : m_Fields)
+    {
+        for (size_t cellIndex = 0; cellIndex < field.values.size(); cellIndex++)
+        {
+            field.values[cellIndex] += m_Dt * (field.velocities[cellIndex] + 0.5 * field.accelerations[cellIndex] * m_Dt);
+        }
+    }
+    calculateLaplacian();
+
+    // Update time
+    m_CurrentTimestep += 1;
+    sampleDefects();
+
+    // Calculate next acceleration
+    calculateAcceleration();
+
+    // Update velocity and acceleration
+    for (auto &field : m_Fields)
+    {
+        for (size_t cellIndex = 0; cellIndex < field.values.size(); cellIndex++)
+        {
+            field.velocities[cellIndex] += 0.5 * (field.accelerations[cellIndex] + field.nextAccelerations[cellIndex]) * m_Dt;
+            field.accelerations[cellIndex] = field.nextAccelerations[cellIndex];
+        }
+    }
+}
+
+uint64_t ReferenceSimulation::getFieldMemoryUsage() const
+{
+    // Four channels and a Laplacian per cell
+    return (uint64_t)m_NumFields * m_Width * m_Height * 5 * sizeof(double);
+}
+
+void ReferenceSimulation::calculateLaplacian()
+{
+    double denominator = 12.0 * m_Dx * m_Dx;
+    for (auto &field : m_Fields)
+    {
+        const std::vector<double> &values = field.values;
+        for (int32_t y = 0; y < (int32_t)m_Height; y++)
+        {
+            for (int32_t x = 0; x < (int32_t)m_Width; x++)
+            {
+                double laplacian = -60.0 * values[(size_t)y * m_Width + x];
+                laplacian += 16.0 * (values[getNeighbourIndex(x, y, -1, 0)] + values[getNeighbourIndex(x, y, 1, 0)] +
+                                     values[getNeighbourIndex(x, y, 0, -1)] + values[getNeighbourIndex(x, y, 0, 1)]);
+                laplacian -= values[getNeighbourIndex(x, y, -2, 0)] + values[getNeighbourIndex(x, y, 2, 0)] +
+                             values[getNeighbourIndex(x, y, 0, -2)] + values[getNeighbourIndex(x, y, 0, 2)];
+                field.laplacians[(size_t)y * m_Width + x] = laplacian / denominator;
+            }
+        }
+    }
+}
+
+// These must be kept in step with the model shaders. Simulation::runPrecisionBenchmark refuses to run if they disagree.
+void ReferenceSimulation::calculateAcceleration()
+{
+    // The time is taken after the timestep has been incremented, as in the shaders
+    double time = m_CurrentTimestep * m_Dt;
+    double damping = ALPHA_2D * (m_Era / time);
+    size_t numCells = (size_t)m_Width * m_Height;
+    switch (m_Model)
+    {
+    case SimulationModel::DOMAIN_WALLS:
+    {
+        ReferenceField &field = m_Fields[0];
+        for (size_t cellIndex = 0; cellIndex < numCells; cellIndex++)
+        {
+            double value = field.values[cellIndex];
+            field.nextAccelerations[cellIndex] = field.laplacians[cellIndex] - damping * field.velocities[cellIndex] -
+                                                 m_Lambda * (value * value - m_Eta * m_Eta) * value;
+        }
+        break;
+    }
+    case SimulationModel::COSMIC_STRINGS:
+    case SimulationModel::SINGLE_AXION:
+    {
+        ReferenceField &realField = m_Fields[0];
+        ReferenceField &imagField = m_Fields[1];
+        double growth = m_Model == SimulationModel::SINGLE_AXION ? pow(time / m_GrowthScale, m_GrowthLaw) : 0.0;
+        for (size_t cellIndex = 0; cellIndex < numCells; cellIndex++)
+        {
+            double realValue = realField.values[cellIndex];
+            double imagValue = imagField.values[cellIndex];
+            double squareAmplitude = realValue * realValue + imagValue * imagValue;
+            double potential = m_Lambda * (squareAmplitude - m_Eta * m_Eta);
+
+            double realAcceleration = realField.laplacians[cellIndex] - damping * realField.velocities[cellIndex] - potential * realValue;
+            double imagAcceleration = imagField.laplacians[cellIndex] - damping * imagField.velocities[cellIndex] - potential * imagValue;
+            // Axion contribution
+            if (m_Model == SimulationModel::SINGLE_AXION)
+            {
+                double phase = atan2(imagValue, realValue);
+                double axionFactor =
+                    2.0 * m_ColorAnomaly * m_AxionStrength * growth * sin(m_ColorAnomaly * phase) / squareAmplitude;
+                realAcceleration += imagValue * axionFactor;
+                imagAcceleration -= realValue * axionFactor;
+            }
+            realField.nextAccelerations[cellIndex] = realAcceleration;
+            imagField.nextAccelerations[cellIndex] = imagAcceleration;
+        }
+        break;
+    }
+    case SimulationModel::COMPANION_AXION:
+    {
+        double firstGrowth = 2.0 * m_AxionStrength * pow(time / m_TGrowthScale, m_TGrowthLaw);
+        double secondGrowth = 2.0 * m_AxionStrength * m_Kappa * pow(time / m_SGrowthScale, m_SGrowthLaw);
+        for (size_t cellIndex = 0; cellIndex < numCells; cellIndex++)
+        {
+            double phiReal = m_Fields[0].values[cellIndex];
+            double phiImag = m_Fields[1].values[cellIndex];
+            double psiReal = m_Fields[2].values[cellIndex];
+            double psiImag = m_Fields[3].values[cellIndex];
+            double phiSquareAmplitude = phiReal * phiReal + phiImag * phiImag;
+            double psiSquareAmplitude = psiReal * psiReal + psiImag * psiImag;
+            double phiPhase = atan2(phiImag, phiReal);
+            double psiPhase = atan2(psiImag, psiReal);
+
+            // Axion terms in the potential derivative bar the field value
+            double firstAxionFactor = firstGrowth * sin(m_N * phiPhase + m_NPrime * psiPhase);
+            double secondAxionFactor = secondGrowth * sin(m_M * phiPhase + m_MPrime * psiPhase);
+            double phiAxion = (m_N * firstAxionFactor + m_M * secondAxionFactor) / phiSquareAmplitude;
+            double psiAxion = (m_NPrime * firstAxionFactor + m_MPrime * secondAxionFactor) / psiSquareAmplitude;
+            double phiPotential = m_Lambda * (phiSquareAmplitude - m_Eta * m_Eta);
+            double psiPotential = m_Lambda * (psiSquareAmplitude - m_Eta * m_Eta);
+
+            m_Fields[0].nextAccelerations[cellIndex] = m_Fields[0].laplacians[cellIndex] -
+                                                       damping * m_Fields[0].velocities[cellIndex] - phiPotential * phiReal +
+                                                       phiAxion * phiImag;
+            m_Fields[1].nextAccelerations[cellIndex] = m_Fields[1].laplacians[cellIndex] -
+                                                       damping * m_Fields[1].velocities[cellIndex] - phiPotential * phiImag -
+                                                       phiAxion * phiReal;
+            m_Fields[2].nextAccelerations[cellIndex] = m_Fields[2].laplacians[cellIndex] -
+                                                       damping * m_Fields[2].velocities[cellIndex] - psiPotential * psiReal +
+                                                       psiAxion * psiImag;
+            m_Fields[3].nextAccelerations[cellIndex] = m_Fields[3].laplacians[cellIndex] -
+                                                       damping * m_Fields[3].velocities[cellIndex] - psiPotential * psiImag -
+                                                       psiAxion * psiReal;
+        }
+        break;
+    }
+    default:
+        logError("Unknown simulation model!");
+        break;
+    }
+}
+
+void ReferenceSimulation::sampleDefects()
+{
+    if ((m_CurrentTimestep - 1) % std::max(stringCountCadence, 1) != 0)
+    {
+        return;
+    }
+    for (size_t stringIndex = 0; stringIndex < m_StringNumbers.size(); stringIndex++)
+    {
+        m_StringNumbers[stringIndex].push_back(countStrings(stringIndex));
+    }
+    for (size_t wallIndex = 0; wallIndex < m_WallNumbers.size(); wallIndex++)
+    {
+        bool isComplex = m_NumFields > 1;
+        m_WallNumbers[wallIndex].push_back(countWalls(isComplex ? 2 * wallIndex : 0, isComplex ? 2 * wallIndex + 1 : 0, isComplex));
+    }
+}
+
+int ReferenceSimulation::countStrings(size_t stringIndex)
+{
+    const std::vector<double> &realValues = m_Fields[2 * stringIndex].values;
+    const std::vector<double> &imagValues = m_Fields[2 * stringIndex + 1].values;
+    int numStrings = 0;
+    for (int32_t y = 0; y < (int32_t)m_Height; y++)
+    {
+        for (int32_t x = 0; x < (int32_t)m_Width; x++)
+        {
+            size_t current = (size_t)y * m_Width + x;
+            size_t centreLeft = getNeighbourIndex(x, y, -1, 0);
+            size_t centreRight = getNeighbourIndex(x, y, 1, 0);
+            size_t centreDown = getNeighbourIndex(x, y, 0, -1);
+            size_t centreUp = getNeighbourIndex(x, y, 0, 1);
+            size_t bottomLeft = getNeighbourIndex(x, y, -1, -1);
+            size_t bottomRight = getNeighbourIndex(x, y, 1, -1);
+            size_t topLeft = getNeighbourIndex(x, y, -1, 1);
+            size_t topRight = getNeighbourIndex(x, y, 1, 1);
+
+            // A cell is highlighted if the net winding of the four plaquettes around it is not zero, as in the string texture
+            size_t plaquettes[4][4] = {
+                {topLeft, centreUp, current, centreLeft},
+                {centreUp, topRight, centreRight, current},
+                {current, centreRight, bottomRight, centreDown},
+                {centreLeft, current, centreDown, bottomLeft},
+            };
+            int highlighted = 0;
+            for (const auto &corners : plaquettes)
+            {
+                highlighted += checkPlaquette(realValues, imagValues, corners);
+            }
+            numStrings += highlighted != 0;
+        }
+    }
+    return numStrings;
+}
+
+int ReferenceSimulation::countWalls(size_t realIndex, size_t imagIndex, bool isComplex)
+{
+    const std::vector<double> &realValues = m_Fields[realIndex].values;
+    const std::vector<double> &imagValues = m_Fields[imagIndex].values;
+    int numWalls = 0;
+    for (int32_t y = 0; y < (int32_t)m_Height; y++)
+    {
+        for (int32_t x = 0; x < (int32_t)m_Width; x++)
+        {
+            // Only the links to the right and up are checked so that every link is counted exactly once
+            size_t neighbours[2] = {getNeighbourIndex(x, y, 1, 0), getNeighbourIndex(x, y, 0, 1)};
+            size_t current = (size_t)y * m_Width + x;
+            for (size_t neighbour : neighbours)
+            {
+                if (isComplex)
+                {
+                    numWalls += checkNegativeRealCrossing(
+                        realValues[current], imagValues[current], realValues[neighbour], imagValues[neighbour]);
+                }
+                else
+                {
+                    numWalls += realValues[current] * realValues[neighbour] < 0.0;
+                }
+            }
+        }
+    }
+    return numWalls;
+}
\ No newline at end of file
@@ -64,7 +64,7 @@ bool validateShaderCompilation(uint32_t shaderID)
     }
 }
 
-Shader::Shader(const char *shaderPath, ShaderType type) : type(type)
+Shader::Shader(const char *shaderPath, ShaderType type, const char *preamble) : type(type)
 {
     logDebug("Shader is being loaded from file located at %s", shaderPath);
     std::string shaderCode;
@@ -95,6 +95,16 @@ Shader::Shader(const char *shaderPath, ShaderType type) : type(type)
         return;
     }
 
+    // Insert the preamble after the version directive and restore the line numbers of the remaining code
+    if (preamble != nullptr)
+    {
+        size_t versionEnd = shaderCode.find('\n');
+        if (versionEnd != std::string::npos)
+        {
+            shaderCode.insert(versionEnd + 1, std::string(preamble) + "#line 2\n");
+        }
+    }
+
     // Convert to c string
     const char *csShaderCode = shaderCode.c_str();
 
@@ -118,4 +118,17 @@ void ComputeShaderProgram::use()
 {
     logLoop("Using compute shader program with ID %d.", programID);
     glUseProgram(programID);
+}
+
+ComputeShaderProgram *ComputeShaderProgram::createFromFile(const char *shaderPath, const char *preamble)
+{
+    Shader *computeShader = new Shader(shaderPath, ShaderType::COMPUTE_SHADER, preamble);
+    ComputeShaderProgram *program = new ComputeShaderProgram(computeShader);
+    delete computeShader;
+    if (!program->isInitialised)
+    {
+        delete program;
+        return nullptr;
+    }
+    return program;
 }
\ No newline at end of file
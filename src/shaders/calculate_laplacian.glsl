@@ -1,44 +1,94 @@
 #version 460 core
 // Work group specification
-layout(local_size_x = 8, local_size_y = 8, local_size_z = 1) in;
+layout(local_size_x = WORK_GROUP_SIZE_X, local_size_y = WORK_GROUP_SIZE_Y, local_size_z = WORK_GROUP_SIZE_Z) in;
 // In: Field texture
-layout(rgba32f, binding = 0) restrict readonly uniform image2D inFieldTexture;
+layout(FIELD_FORMAT, binding = 0) restrict readonly uniform LATTICE_IMAGE inFieldTexture;
 // Out: Laplacian texture
-layout(r32f, binding = 1) restrict writeonly uniform image2D outLaplacianTexture;
+layout(LAPLACIAN_FORMAT, binding = 1) restrict writeonly uniform LATTICE_IMAGE outLaplacianTexture;
+#ifdef COMPENSATED_FIELDS
+// In: Remainders of the field value and velocity that half precision storage can not hold
+layout(rg16f, binding = 2) restrict readonly uniform LATTICE_IMAGE inCompensationTexture;
+
+// Loads the field with its value in full precision
+vec4 loadField(LATTICE_POSITION pos)
+{
+    return imageLoad(inFieldTexture, pos) + vec4(imageLoad(inCompensationTexture, pos).r, 0.0f, 0.0f, 0.0f);
+}
+#else
+// Loads the field
+vec4 loadField(LATTICE_POSITION pos)
+{
+    return imageLoad(inFieldTexture, pos);
+}
+#endif
 
 // Uniforms: spatial interval
 layout(location=0) uniform float dx;
 
 
+#ifdef VOLUME
+void main() {
+    // Current cell position
+    LATTICE_POSITION pos = INVOCATION_POSITION;
+    // Need size to ensure periodic boundaries
+    ivec3 size = imageSize(inFieldTexture);
+
+    // Sum the neighbours one and two steps away along each axis
+    vec4 oneStepSum = vec4(0.0f);
+    vec4 twoStepSum = vec4(0.0f);
+    for (int axisIndex = 0; axisIndex < 3; axisIndex++) {
+        ivec3 step = ivec3(0);
+        step[axisIndex] = 1;
+        oneStepSum += loadField((pos - step + size) % size) + loadField((pos + step) % size);
+        twoStepSum += loadField((pos - 2 * step + 2 * size) % size) + loadField((pos + 2 * step) % size);
+    }
+
+    // Calculate Laplacian
+    vec4 laplacian = -90.0f * loadField(pos);
+    laplacian += 16.0f * oneStepSum;
+    laplacian -= twoStepSum;
+    laplacian /= 12.0f * pow(dx, 2.0f);
+
+    // Store Laplacian
+    imageStore(outLaplacianTexture, pos, laplacian);
+}
+#else
+#ifdef LAYERED
+// Each layer of the array is a separate lattice, so neighbours stay in the layer of the current cell
+#define PLANE_POSITION(x, y) ivec3(x, y, pos.z)
+#else
+#define PLANE_POSITION(x, y) ivec2(x, y)
+#endif
+
 void main() {
     // Current cell position
-    ivec2 pos = ivec2(gl_GlobalInvocationID.xy);
+    LATTICE_POSITION pos = INVOCATION_POSITION;
     // Need size to ensure periodic boundaries
-    ivec2 size = imageSize(inFieldTexture);
+    ivec2 size = imageSize(inFieldTexture).xy;
 
     // Horizontal
-    ivec2 leftOnePos = ivec2(mod(pos.x - 1, size.x), pos.y);
-    ivec2 rightOnePos = ivec2(mod(pos.x + 1, size.x), pos.y);
-    ivec2 leftTwoPos = ivec2(mod(pos.x - 2, size.x), pos.y);
-    ivec2 rightTwoPos = ivec2(mod(pos.x + 2, size.x), pos.y);
+    LATTICE_POSITION leftOnePos = PLANE_POSITION(mod(pos.x - 1, size.x), pos.y);
+    LATTICE_POSITION rightOnePos = PLANE_POSITION(mod(pos.x + 1, size.x), pos.y);
+    LATTICE_POSITION leftTwoPos = PLANE_POSITION(mod(pos.x - 2, size.x), pos.y);
+    LATTICE_POSITION rightTwoPos = PLANE_POSITION(mod(pos.x + 2, size.x), pos.y);
     // Vertical
-    ivec2 downOnePos = ivec2(pos.x, mod(pos.y - 1, size.y));
-    ivec2 upOnePos = ivec2(pos.x, mod(pos.y + 1, size.y));
-    ivec2 downTwoPos = ivec2(pos.x, mod(pos.y - 2, size.y));
-    ivec2 upTwoPos = ivec2(pos.x, mod(pos.y + 2, size.y));
+    LATTICE_POSITION downOnePos = PLANE_POSITION(pos.x, mod(pos.y - 1, size.y));
+    LATTICE_POSITION upOnePos = PLANE_POSITION(pos.x, mod(pos.y + 1, size.y));
+    LATTICE_POSITION downTwoPos = PLANE_POSITION(pos.x, mod(pos.y - 2, size.y));
+    LATTICE_POSITION upTwoPos = PLANE_POSITION(pos.x, mod(pos.y + 2, size.y));
     
     // Field value at current cell position
-    vec4 current = imageLoad(inFieldTexture, pos);
+    vec4 current = loadField(pos);
     // One step
-    vec4 leftOne = imageLoad(inFieldTexture, leftOnePos);
-    vec4 rightOne = imageLoad(inFieldTexture, rightOnePos);
-    vec4 downOne = imageLoad(inFieldTexture, downOnePos);
-    vec4 upOne = imageLoad(inFieldTexture, upOnePos);
+    vec4 leftOne = loadField(leftOnePos);
+    vec4 rightOne = loadField(rightOnePos);
+    vec4 downOne = loadField(downOnePos);
+    vec4 upOne = loadField(upOnePos);
     // Two steps
-    vec4 leftTwo = imageLoad(inFieldTexture, leftTwoPos);
-    vec4 rightTwo = imageLoad(inFieldTexture, rightTwoPos);
-    vec4 downTwo = imageLoad(inFieldTexture, downTwoPos);
-    vec4 upTwo = imageLoad(inFieldTexture, upTwoPos);
+    vec4 leftTwo = loadField(leftTwoPos);
+    vec4 rightTwo = loadField(rightTwoPos);
+    vec4 downTwo = loadField(downTwoPos);
+    vec4 upTwo = loadField(upTwoPos);
 
     // Calculate Laplacian
     vec4 laplacian = -60.0f * current;
@@ -48,4 +98,5 @@ void main() {
 
     // Store Laplacian
     imageStore(outLaplacianTexture, pos, laplacian);
-}
\ No newline at end of file
+}
+#endif
\ No newline at end of file
@@ -2,11 +2,11 @@
 // Work groups
 layout(local_size_x = 8, local_size_y = 8, local_size_z = 1) in;
 // In: Real field texture
-layout(rgba32f, binding = 0) restrict readonly uniform image2D inRealFieldTexture;
+layout(FIELD_FORMAT, binding = 0) restrict readonly uniform image2D inRealFieldTexture;
 // In: Imaginary field texture
-layout(rgba32f, binding = 1) restrict readonly uniform image2D inImagFieldTexture;
-// Out: Phase texture
-layout(r32f, binding = 2) restrict writeonly uniform image2D outPhaseTexture;
+layout(FIELD_FORMAT, binding = 1) restrict readonly uniform image2D inImagFieldTexture;
+// Out: Phase texture. The phase is stored normalised by pi to fit the signed normalised range [-1, 1].
+layout(r16_snorm, binding = 2) restrict writeonly uniform image2D outPhaseTexture;
 
 const float PI = 3.1415926535897932384626433832795f;
 
@@ -20,6 +20,6 @@ void main()
     float phaseAngle = atan(imagValue, realValue);
     phaseAngle = clamp(phaseAngle, -PI, +PI);
 
-    // Store phase
-    imageStore(outPhaseTexture, pos, vec4(phaseAngle, 0.0f, 0.0f, 0.0f));
+    // Store normalised phase
+    imageStore(outPhaseTexture, pos, vec4(phaseAngle / PI, 0.0f, 0.0f, 0.0f));
 }
\ No newline at end of file
@@ -1,26 +1,26 @@
 #version 460 core
 // Work group specification
-layout(local_size_x = 8, local_size_y = 8, local_size_z = 1) in;
+layout(local_size_x = WORK_GROUP_SIZE_X, local_size_y = WORK_GROUP_SIZE_Y, local_size_z = WORK_GROUP_SIZE_Z) in;
 
 // In/Out: Phi real field texture
-layout(rgba32f, binding = 0) restrict uniform image2D phiRealFieldTexture;
+layout(FIELD_FORMAT, binding = 0) restrict uniform LATTICE_IMAGE phiRealFieldTexture;
 // In: Phi real Laplacian texture
-layout(r32f, binding = 1) restrict readonly uniform image2D inPhiRealLaplacianTexture;
+layout(LAPLACIAN_FORMAT, binding = 1) restrict readonly uniform LATTICE_IMAGE inPhiRealLaplacianTexture;
 
 // In/Out: Phi imaginary field texture
-layout(rgba32f, binding = 2) restrict uniform image2D phiImagFieldTexture;
+layout(FIELD_FORMAT, binding = 2) restrict uniform LATTICE_IMAGE phiImagFieldTexture;
 // In: Phi imaginary Laplacian texture
-layout(r32f, binding = 3) restrict readonly uniform image2D inPhiImagLaplacianTexture;
+layout(LAPLACIAN_FORMAT, binding = 3) restrict readonly uniform LATTICE_IMAGE inPhiImagLaplacianTexture;
 
 // In/Out: Psi real field texture
-layout(rgba32f, binding = 4) restrict uniform image2D psiRealFieldTexture;
+layout(FIELD_FORMAT, binding = 4) restrict uniform LATTICE_IMAGE psiRealFieldTexture;
 // In: Psi real Laplacian texture
-layout(r32f, binding = 5) restrict readonly uniform image2D inPsiRealLaplacianTexture;
+layout(LAPLACIAN_FORMAT, binding = 5) restrict readonly uniform LATTICE_IMAGE inPsiRealLaplacianTexture;
 
 // In/Out: Psi imaginary field texture
-layout(rgba32f, binding = 6) restrict uniform image2D psiImagFieldTexture;
+layout(FIELD_FORMAT, binding = 6) restrict uniform LATTICE_IMAGE psiImagFieldTexture;
 // In: Psi imaginary Laplacian texture
-layout(r32f, binding = 7) restrict readonly uniform image2D inPsiImagLaplacianTexture;
+layout(LAPLACIAN_FORMAT, binding = 7) restrict readonly uniform LATTICE_IMAGE inPsiImagLaplacianTexture;
 
 // TODO: Need to use array textures because we ran out of bind targets
 // // In: Phi phase texture
@@ -32,6 +32,27 @@ layout(r32f, binding = 7) restrict readonly uniform image2D inPsiImagLaplacianTe
 layout(location=0) uniform float time;
 layout(location=1) uniform float dt;
 layout(location=2) uniform int era;
+#ifdef LAYER_PARAMETERS
+// Companion axion specific parameters in the order of the simulation layout.
+struct Parameters {
+    float eta;
+    float lam;
+    float axionStrength;
+    float kappa;
+    float tGrowthScale;
+    float tGrowthLaw;
+    float sGrowthScale;
+    float sGrowthLaw;
+    float n;
+    float nPrime;
+    float m;
+    float mPrime;
+};
+// In: Parameters of each layer of a batch
+layout(std430, binding = 0) restrict readonly buffer inLayerParameters {
+    Parameters layerParameters[];
+};
+#else
 // Companion axion specific uniform parameters
 layout(location=3) uniform float eta;
 layout(location=4) uniform float lam;
@@ -45,15 +66,31 @@ layout(location=11) uniform float n;
 layout(location=12) uniform float nPrime;
 layout(location=13) uniform float m;
 layout(location=14) uniform float mPrime;
+#endif
 
 
-const float ALPHA_2D = 2.0f;
 const float PI = 3.1415926535897932384626433832795f;
 
 
 void main() {
     // Current position
-    ivec2 pos = ivec2(gl_GlobalInvocationID.xy);
+    LATTICE_POSITION pos = INVOCATION_POSITION;
+#ifdef LAYER_PARAMETERS
+    // Each layer of a batch reads its own parameters in place of the uniforms
+    Parameters parameters = layerParameters[pos.z];
+    float eta = parameters.eta;
+    float lam = parameters.lam;
+    float axionStrength = parameters.axionStrength;
+    float kappa = parameters.kappa;
+    float tGrowthScale = parameters.tGrowthScale;
+    float tGrowthLaw = parameters.tGrowthLaw;
+    float sGrowthScale = parameters.sGrowthScale;
+    float sGrowthLaw = parameters.sGrowthLaw;
+    float n = parameters.n;
+    float nPrime = parameters.nPrime;
+    float m = parameters.m;
+    float mPrime = parameters.mPrime;
+#endif
     // Load the field data
     vec4 phiReal = imageLoad(phiRealFieldTexture, pos);
     vec4 phiImag = imageLoad(phiImagFieldTexture, pos);
@@ -97,7 +134,7 @@ void main() {
     // Laplacian term
     float phiRealNextAcceleration = imageLoad(inPhiRealLaplacianTexture, pos).r;
     // 'Damping' term
-    phiRealNextAcceleration -= ALPHA_2D * (era / time) * phiRealCurrentVelocity;
+    phiRealNextAcceleration -= PRS_ALPHA * (era / time) * phiRealCurrentVelocity;
     // Potential derivative
     phiRealNextAcceleration -= lam * (phiSquareAmplitude - pow(eta, 2)) * phiRealNextValue;
     // Axion contribution
@@ -108,7 +145,7 @@ void main() {
     // Laplacian term
     float phiImagNextAcceleration = imageLoad(inPhiImagLaplacianTexture, pos).r;
     // 'Damping' term
-    phiImagNextAcceleration -= ALPHA_2D * (era / time) * phiImagCurrentVelocity;
+    phiImagNextAcceleration -= PRS_ALPHA * (era / time) * phiImagCurrentVelocity;
     // Potential derivative
     phiImagNextAcceleration -= lam * (phiSquareAmplitude - pow(eta, 2)) * phiImagNextValue;
     // Axion contribution
@@ -119,7 +156,7 @@ void main() {
     // Laplacian term
     float psiRealNextAcceleration = imageLoad(inPsiRealLaplacianTexture, pos).r;
     // 'Damping' term
-    psiRealNextAcceleration -= ALPHA_2D * (era / time) * psiRealCurrentVelocity;
+    psiRealNextAcceleration -= PRS_ALPHA * (era / time) * psiRealCurrentVelocity;
     // Potential derivative
     psiRealNextAcceleration -= lam * (psiSquareAmplitude - pow(eta, 2)) * psiRealNextValue;
     // Axion contribution
@@ -130,7 +167,7 @@ void main() {
     // Laplacian term
     float psiImagNextAcceleration = imageLoad(inPsiImagLaplacianTexture, pos).r;
     // 'Damping' term
-    psiImagNextAcceleration -= ALPHA_2D * (era / time) * psiImagCurrentVelocity;
+    psiImagNextAcceleration -= PRS_ALPHA * (era / time) * psiImagCurrentVelocity;
     // Potential derivative
     psiImagNextAcceleration -= lam * (psiSquareAmplitude - pow(eta, 2)) * psiImagNextValue;
     // Axion contribution
@@ -1,31 +1,47 @@
 #version 460 core
 // Work group specification
-layout(local_size_x = 8, local_size_y = 8, local_size_z = 1) in;
+layout(local_size_x = WORK_GROUP_SIZE_X, local_size_y = WORK_GROUP_SIZE_Y, local_size_z = WORK_GROUP_SIZE_Z) in;
 
 // In/Out: Real field texture
-layout(rgba32f, binding = 0) restrict uniform image2D realFieldTexture;
+layout(FIELD_FORMAT, binding = 0) restrict uniform LATTICE_IMAGE realFieldTexture;
 // In: Real Laplacian texture
-layout(r32f, binding = 1) restrict readonly uniform image2D inRealLaplacianTexture;
+layout(LAPLACIAN_FORMAT, binding = 1) restrict readonly uniform LATTICE_IMAGE inRealLaplacianTexture;
 
 // In/Out: Imaginary field texture
-layout(rgba32f, binding = 2) restrict uniform image2D imagFieldTexture;
+layout(FIELD_FORMAT, binding = 2) restrict uniform LATTICE_IMAGE imagFieldTexture;
 // In: Imaginary Laplacian texture
-layout(r32f, binding = 3) restrict readonly uniform image2D inImagLaplacianTexture;
+layout(LAPLACIAN_FORMAT, binding = 3) restrict readonly uniform LATTICE_IMAGE inImagLaplacianTexture;
 
 // Universal simulation uniform parameters
 layout(location=0) uniform float time;
 layout(location=1) uniform float dt;
 layout(location=2) uniform int era;
+#ifdef LAYER_PARAMETERS
+// Cosmic string specific parameters in the order of the simulation layout.
+struct Parameters {
+    float eta;
+    float lam;
+};
+// In: Parameters of each layer of a batch
+layout(std430, binding = 0) restrict readonly buffer inLayerParameters {
+    Parameters layerParameters[];
+};
+#else
 // Cosmic string specific uniform parameters
 layout(location=3) uniform float eta;
 layout(location=4) uniform float lam;
-
-const float ALPHA_2D = 2.0f;
+#endif
 
 
 void main() {
     // Current position
-    ivec2 pos = ivec2(gl_GlobalInvocationID.xy);
+    LATTICE_POSITION pos = INVOCATION_POSITION;
+#ifdef LAYER_PARAMETERS
+    // Each layer of a batch reads its own parameters in place of the uniforms
+    Parameters parameters = layerParameters[pos.z];
+    float eta = parameters.eta;
+    float lam = parameters.lam;
+#endif
     // Load the field data
     vec4 realField = imageLoad(realFieldTexture, pos);
     vec4 imagField = imageLoad(imagFieldTexture, pos);
@@ -46,7 +62,7 @@ void main() {
     // Laplacian term
     float realNextAcceleration = imageLoad(inRealLaplacianTexture, pos).r;
     // 'Damping' term
-    realNextAcceleration -= ALPHA_2D * (era / time) * realCurrentVelocity;
+    realNextAcceleration -= PRS_ALPHA * (era / time) * realCurrentVelocity;
     // Potential derivative
     realNextAcceleration -= lam * (squareAmplitude - pow(eta, 2)) * realNextValue;
 
@@ -54,7 +70,7 @@ void main() {
     // Laplacian term
     float imagNextAcceleration = imageLoad(inImagLaplacianTexture, pos).r;
     // 'Damping' term
-    imagNextAcceleration -= ALPHA_2D * (era / time) * imagCurrentVelocity;
+    imagNextAcceleration -= PRS_ALPHA * (era / time) * imagCurrentVelocity;
     // Potential derivative
     imagNextAcceleration -= lam * (squareAmplitude - pow(eta, 2)) * imagNextValue;
 
@@ -0,0 +1,102 @@
+#version 460 core
+// Work groups
+layout(local_size_x = WORK_GROUP_SIZE_X, local_size_y = WORK_GROUP_SIZE_Y, local_size_z = WORK_GROUP_SIZE_Z) in;
+// In: Real field texture
+layout(FIELD_FORMAT, binding = 0) restrict readonly uniform LATTICE_IMAGE inRealFieldTexture;
+// In: Imaginary field texture
+layout(FIELD_FORMAT, binding = 1) restrict readonly uniform LATTICE_IMAGE inImagFieldTexture;
+// In/Out: Defect counts. The number of strings is added to the count at the count index. Each layer of a layered lattice has its
+// own set of counts.
+layout(std430, binding = 0) restrict buffer outDefectCounts {
+    uint defectCounts[];
+};
+
+// Uniforms: index of the count to add to
+layout(location=0) uniform int countIndex;
+
+// Number of strings found by the work group
+shared uint groupCount;
+
+
+// Returns the handedness of a real crossing as +-1.
+int calculateCrossingHandedness(vec2 current, vec2 next) {
+    float result = next.x * current.y - current.x * next.y;
+    return int(sign(result));
+}
+
+// Returns `1` if the link crosses the real axis, otherwise returns `0`.
+int calculateRealCrossing(vec2 current, vec2 next) {
+    return int((current.y * next.y) < 0);
+}
+
+// Returns the winding of the field around a plaquette, given as its four corners in order around it.
+int checkPlaquette(vec2 first, vec2 second, vec2 third, vec2 fourth) {
+    int result = 0;
+    result += calculateRealCrossing(first, second) * calculateCrossingHandedness(first, second);
+    result += calculateRealCrossing(second, third) * calculateCrossingHandedness(second, third);
+    result += calculateRealCrossing(third, fourth) * calculateCrossingHandedness(third, fourth);
+    result += calculateRealCrossing(fourth, first) * calculateCrossingHandedness(fourth, first);
+    return result;
+}
+
+// Loads the complex field value at the given position
+vec2 loadField(ivec3 pos) {
+    return vec2(imageLoad(inRealFieldTexture, pos).r, imageLoad(inImagFieldTexture, pos).r);
+}
+
+void main()
+{
+    ivec3 pos = ivec3(gl_GlobalInvocationID);
+    ivec3 size = imageSize(inRealFieldTexture);
+    if (gl_LocalInvocationIndex == 0) {
+        groupCount = 0;
+    }
+    barrier();
+
+    if (all(lessThan(pos, size))) {
+#ifdef LAYERED
+        // Each layer is a separate plane. A cell holds a string if the windings of the four plaquettes around it do not cancel,
+        // which is the same rule as the string texture of a single simulation.
+        int winding = 0;
+        for (int yOffset = -1; yOffset <= 0; yOffset++) {
+            for (int xOffset = -1; xOffset <= 0; xOffset++) {
+                ivec2 bottomLeft = (pos.xy + ivec2(xOffset, yOffset) + size.xy) % size.xy;
+                ivec2 topRight = (bottomLeft + 1) % size.xy;
+                winding += checkPlaquette(
+                    loadField(ivec3(bottomLeft.x, topRight.y, pos.z)),
+                    loadField(ivec3(topRight, pos.z)),
+                    loadField(ivec3(topRight.x, bottomLeft.y, pos.z)),
+                    loadField(ivec3(bottomLeft, pos.z)));
+            }
+        }
+        atomicAdd(groupCount, uint(winding != 0));
+#else
+        // Each cell checks the three plaquettes spanned by its links along the positive axes, so that every plaquette of every
+        // orientation is checked exactly once. Each pierced plaquette is one unit of string length.
+        vec2 current = loadField(pos);
+        uint numPierced = 0;
+        for (int normalIndex = 0; normalIndex < 3; normalIndex++) {
+            ivec3 firstStep = ivec3(0);
+            firstStep[(normalIndex + 1) % 3] = 1;
+            ivec3 secondStep = ivec3(0);
+            secondStep[(normalIndex + 2) % 3] = 1;
+
+            vec2 first = loadField((pos + firstStep) % size);
+            vec2 diagonal = loadField((pos + firstStep + secondStep) % size);
+            vec2 second = loadField((pos + secondStep) % size);
+            numPierced += uint(checkPlaquette(current, first, diagonal, second) != 0);
+        }
+        atomicAdd(groupCount, numPierced);
+#endif
+    }
+    barrier();
+
+    // Only one atomic per work group touches the buffer. Work groups never span layers.
+    if (gl_LocalInvocationIndex == 0 && groupCount > 0) {
+#ifdef LAYERED
+        atomicAdd(defectCounts[countIndex * size.z + pos.z], groupCount);
+#else
+        atomicAdd(defectCounts[countIndex], groupCount);
+#endif
+    }
+}
\ No newline at end of file
@@ -0,0 +1,79 @@
+#version 460 core
+// Work groups
+layout(local_size_x = WORK_GROUP_SIZE_X, local_size_y = WORK_GROUP_SIZE_Y, local_size_z = WORK_GROUP_SIZE_Z) in;
+// In: Real field texture
+layout(FIELD_FORMAT, binding = 0) restrict readonly uniform LATTICE_IMAGE inRealFieldTexture;
+// In: Imaginary field texture. This is the real field texture again for real fields.
+layout(FIELD_FORMAT, binding = 1) restrict readonly uniform LATTICE_IMAGE inImagFieldTexture;
+// In/Out: Defect counts. The number of links crossing a wall is added to the count at the count index. Each layer of a layered
+// lattice has its own set of counts.
+layout(std430, binding = 0) restrict buffer outDefectCounts {
+    uint defectCounts[];
+};
+
+// Uniforms: index of the count to add to
+layout(location=0) uniform int countIndex;
+// Uniforms: 1 if the field is complex, otherwise 0
+layout(location=1) uniform int isComplex;
+
+#ifdef LAYERED
+// Links only run along the axes of each layer
+const int NUM_AXES = 2;
+#else
+const int NUM_AXES = 3;
+#endif
+
+// Number of wall crossing links found by the work group
+shared uint groupCount;
+
+
+// Returns `1` if the link between two values of a complex field crosses the negative real axis, where the phase is pi,
+// otherwise returns `0`.
+uint checkNegativeRealCrossing(vec2 current, vec2 next) {
+    // The imaginary part must change sign, and the real part where it vanishes must be negative
+    float realAtCrossing = (current.y * next.x - current.x * next.y) * (current.y - next.y);
+    return uint(current.y * next.y < 0) * uint(realAtCrossing < 0);
+}
+
+// Loads the field value at the given position, with the imaginary part in the second component for complex fields
+vec2 loadField(ivec3 pos) {
+    return vec2(imageLoad(inRealFieldTexture, pos).r, imageLoad(inImagFieldTexture, pos).r);
+}
+
+void main()
+{
+    ivec3 pos = ivec3(gl_GlobalInvocationID);
+    ivec3 size = imageSize(inRealFieldTexture);
+    if (gl_LocalInvocationIndex == 0) {
+        groupCount = 0;
+    }
+    barrier();
+
+    if (all(lessThan(pos, size))) {
+        // Only the links along the positive axes are checked so that every link is counted exactly once. Each crossing link is one
+        // unit of wall area, or of wall length on a plane.
+        vec2 current = loadField(pos);
+        uint numCrossings = 0;
+        for (int axisIndex = 0; axisIndex < NUM_AXES; axisIndex++) {
+            ivec3 step = ivec3(0);
+            step[axisIndex] = 1;
+            vec2 next = loadField((pos + step) % size);
+            if (isComplex != 0) {
+                numCrossings += checkNegativeRealCrossing(current, next);
+            } else {
+                numCrossings += uint(current.x * next.x < 0);
+            }
+        }
+        atomicAdd(groupCount, numCrossings);
+    }
+    barrier();
+
+    // Only one atomic per work group touches the buffer. Work groups never span layers.
+    if (gl_LocalInvocationIndex == 0 && groupCount > 0) {
+#ifdef LAYERED
+        atomicAdd(defectCounts[countIndex * size.z + pos.z], groupCount);
+#else
+        atomicAdd(defectCounts[countIndex], groupCount);
+#endif
+    }
+}
\ No newline at end of file
@@ -2,11 +2,17 @@
 // Work groups
 layout(local_size_x = 8, local_size_y = 8, local_size_z = 1) in;
 // In: Real field texture
-layout(rgba32f, binding = 0) restrict readonly uniform image2D inRealFieldTexture;
+layout(FIELD_FORMAT, binding = 0) restrict readonly uniform image2D inRealFieldTexture;
 // In: Imaginary field texture
-layout(rgba32f, binding = 1) restrict readonly uniform image2D inImagFieldTexture;
-// Out: String texture
-layout(r32f, binding = 2) restrict writeonly uniform image2D outStringTexture;
+layout(FIELD_FORMAT, binding = 1) restrict readonly uniform image2D inImagFieldTexture;
+// Out: String texture. This only ever holds -1, 0 or +1.
+layout(r8_snorm, binding = 2) restrict writeonly uniform image2D outStringTexture;
+// Out: Sparse list of string plaquettes. Each cell appends a record for the plaquette to its bottom right, so that every
+// plaquette is recorded exactly once. A record packs x into bits 0-14, y into bits 15-29 and sets bit 30 for an anti-string.
+layout(std430, binding = 0) restrict buffer outStringRecords {
+    uint numStringRecords;
+    uint stringRecords[];
+};
 
 
 // Returns of the handedness of a real crossing as +-1.
@@ -105,12 +111,13 @@ void main()
         realCurrent, imagCurrent
     );
     // Bottom right plaquette
-    highlighted += checkPlaquette(
+    int bottomRightWinding = checkPlaquette(
         realCurrent, imagCurrent,
         realCentreRight, imagCentreRight,
         realBottomRight, imagBottomRight,
         realCentreDown, imagCentreDown
     );
+    highlighted += bottomRightWinding;
     // Bottom left plaquette
     highlighted += checkPlaquette(
         realCentreLeft, imagCentreLeft,
@@ -119,6 +126,16 @@ void main()
         realBottomLeft, imagBottomLeft
     );
 
+    // Append the bottom right plaquette if a string pierces it. The count keeps growing past the capacity so that an overflow
+    // can be detected.
+    if (bottomRightWinding != 0) {
+        uint recordIndex = atomicAdd(numStringRecords, 1u);
+        if (recordIndex < stringRecords.length()) {
+            uint isAntiString = bottomRightWinding < 0 ? 1u : 0u;
+            stringRecords[recordIndex] = uint(pos.x) | (uint(pos.y) << 15) | (isAntiString << 30);
+        }
+    }
+
     // Clamp result to between -1 and 1
     highlighted = clamp(highlighted, -1, 1);
 
@@ -1,25 +1,41 @@
 #version 460 core
 // Work group specification
-layout(local_size_x = 8, local_size_y = 8, local_size_z = 1) in;
+layout(local_size_x = WORK_GROUP_SIZE_X, local_size_y = WORK_GROUP_SIZE_Y, local_size_z = WORK_GROUP_SIZE_Z) in;
 
 // In/Out: Field texture
-layout(rgba32f, binding = 0) restrict uniform image2D fieldTexture;
+layout(FIELD_FORMAT, binding = 0) restrict uniform LATTICE_IMAGE fieldTexture;
 // In: Laplacian texture
-layout(r32f, binding = 1) restrict readonly uniform image2D inLaplacianTexture;
+layout(LAPLACIAN_FORMAT, binding = 1) restrict readonly uniform LATTICE_IMAGE inLaplacianTexture;
 
 // Universal simulation uniform parameters
 layout(location=0) uniform float time;
 layout(location=1) uniform float dt;
 layout(location=2) uniform int era;
+#ifdef LAYER_PARAMETERS
+// Domain wall specific parameters in the order of the simulation layout.
+struct Parameters {
+    float eta;
+    float lam;
+};
+// In: Parameters of each layer of a batch
+layout(std430, binding = 0) restrict readonly buffer inLayerParameters {
+    Parameters layerParameters[];
+};
+#else
 // Domain wall specific uniform parameters
 layout(location=3) uniform float eta;
 layout(location=4) uniform float lam;
-
-const float ALPHA_2D = 2.0f;
+#endif
 
 
 void main() {
-    ivec2 pos = ivec2(gl_GlobalInvocationID.xy);
+    LATTICE_POSITION pos = INVOCATION_POSITION;
+#ifdef LAYER_PARAMETERS
+    // Each layer of a batch reads its own parameters in place of the uniforms
+    Parameters parameters = layerParameters[pos.z];
+    float eta = parameters.eta;
+    float lam = parameters.lam;
+#endif
     vec4 field = imageLoad(fieldTexture, pos);
     float nextValue = field.r;
     float currentVelocity = field.g;
@@ -29,7 +45,7 @@ void main() {
     // Laplacian term
     float nextAcceleration = imageLoad(inLaplacianTexture, pos).r;
     // 'Damping' term
-    nextAcceleration -= ALPHA_2D * (era / time) * currentVelocity;
+    nextAcceleration -= PRS_ALPHA * (era / time) * currentVelocity;
     // Potential derivative
     nextAcceleration -= lam * (pow(nextValue, 2)  - pow(eta, 2)) * nextValue;
 
@@ -0,0 +1,85 @@
+#version 460 core
+// Work group specification
+layout(local_size_x = 8, local_size_y = 8, local_size_z = 1) in;
+
+// In: Phi real field texture
+layout(FIELD_FORMAT, binding = 0) restrict readonly uniform image2D inPhiRealFieldTexture;
+// In: Phi imaginary field texture
+layout(FIELD_FORMAT, binding = 1) restrict readonly uniform image2D inPhiImagFieldTexture;
+// In: Psi real field texture
+layout(FIELD_FORMAT, binding = 2) restrict readonly uniform image2D inPsiRealFieldTexture;
+// In: Psi imaginary field texture
+layout(FIELD_FORMAT, binding = 3) restrict readonly uniform image2D inPsiImagFieldTexture;
+// Out: Energy density texture holding (kinetic, gradient, potential, total)
+layout(rgba32f, binding = 4) restrict writeonly uniform image2D outEnergyTexture;
+
+// Universal simulation uniform parameters
+layout(location=0) uniform float time;
+layout(location=1) uniform float dt;
+layout(location=2) uniform int era;
+// Companion axion specific uniform parameters
+layout(location=3) uniform float eta;
+layout(location=4) uniform float lam;
+layout(location=5) uniform float axionStrength;
+layout(location=6) uniform float kappa;
+layout(location=7) uniform float tGrowthScale;
+layout(location=8) uniform float tGrowthLaw;
+layout(location=9) uniform float sGrowthScale;
+layout(location=10) uniform float sGrowthLaw;
+layout(location=11) uniform float n;
+layout(location=12) uniform float nPrime;
+layout(location=13) uniform float m;
+layout(location=14) uniform float mPrime;
+
+
+// Returns the values of all four fields at the given position as (phi real, phi imaginary, psi real, psi imaginary).
+vec4 loadValues(ivec2 pos) {
+    return vec4(
+        imageLoad(inPhiRealFieldTexture, pos).r,
+        imageLoad(inPhiImagFieldTexture, pos).r,
+        imageLoad(inPsiRealFieldTexture, pos).r,
+        imageLoad(inPsiImagFieldTexture, pos).r
+    );
+}
+
+// Returns the squared gradient summed over all four fields using the same fourth order stencil as the Laplacian. The gradient is
+// in lattice units, i.e. with dx = 1.
+float calculateSquareGradient(ivec2 pos, ivec2 size) {
+    vec4 leftTwo = loadValues(ivec2(mod(pos.x - 2, size.x), pos.y));
+    vec4 leftOne = loadValues(ivec2(mod(pos.x - 1, size.x), pos.y));
+    vec4 rightOne = loadValues(ivec2(mod(pos.x + 1, size.x), pos.y));
+    vec4 rightTwo = loadValues(ivec2(mod(pos.x + 2, size.x), pos.y));
+    vec4 downTwo = loadValues(ivec2(pos.x, mod(pos.y - 2, size.y)));
+    vec4 downOne = loadValues(ivec2(pos.x, mod(pos.y - 1, size.y)));
+    vec4 upOne = loadValues(ivec2(pos.x, mod(pos.y + 1, size.y)));
+    vec4 upTwo = loadValues(ivec2(pos.x, mod(pos.y + 2, size.y)));
+
+    vec4 xGradient = (leftTwo - 8.0f * leftOne + 8.0f * rightOne - rightTwo) / 12.0f;
+    vec4 yGradient = (downTwo - 8.0f * downOne + 8.0f * upOne - upTwo) / 12.0f;
+    return dot(xGradient, xGradient) + dot(yGradient, yGradient);
+}
+
+void main() {
+    ivec2 pos = ivec2(gl_GlobalInvocationID.xy);
+    ivec2 size = imageSize(inPhiRealFieldTexture);
+    vec4 phiReal = imageLoad(inPhiRealFieldTexture, pos);
+    vec4 phiImag = imageLoad(inPhiImagFieldTexture, pos);
+    vec4 psiReal = imageLoad(inPsiRealFieldTexture, pos);
+    vec4 psiImag = imageLoad(inPsiImagFieldTexture, pos);
+
+    // Square amplitude of complex field
+    float phiSquareAmplitude = pow(phiReal.r, 2) + pow(phiImag.r, 2);
+    float psiSquareAmplitude = pow(psiReal.r, 2) + pow(psiImag.r, 2);
+    // Phases of complex field
+    float phiPhase = atan(phiImag.r, phiReal.r);
+    float psiPhase = atan(psiImag.r, psiReal.r);
+
+    float kineticEnergy = 0.5f * (pow(phiReal.g, 2) + pow(phiImag.g, 2) + pow(psiReal.g, 2) + pow(psiImag.g, 2));
+    float gradientEnergy = 0.5f * calculateSquareGradient(pos, size);
+    float potentialEnergy = 0.25f * lam * (pow(phiSquareAmplitude - pow(eta, 2), 2) + pow(psiSquareAmplitude - pow(eta, 2), 2));
+    // Axion potentials, whose derivatives are the axion contributions to the acceleration
+    potentialEnergy += 2.0f * axionStrength * pow(time / tGrowthScale, tGrowthLaw) * (1.0f - cos(n * phiPhase + nPrime * psiPhase));
+    potentialEnergy += 2.0f * axionStrength * kappa * pow(time / sGrowthScale, sGrowthLaw) * (1.0f - cos(m * phiPhase + mPrime * psiPhase));
+
+    imageStore(outEnergyTexture, pos, vec4(kineticEnergy, gradientEnergy, potentialEnergy, kineticEnergy + gradientEnergy + potentialEnergy));
+}
\ No newline at end of file
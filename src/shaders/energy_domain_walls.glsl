@@ -0,0 +1,48 @@
+#version 460 core
+// Work group specification
+layout(local_size_x = 8, local_size_y = 8, local_size_z = 1) in;
+
+// In: Field texture
+layout(FIELD_FORMAT, binding = 0) restrict readonly uniform image2D inFieldTexture;
+// Out: Energy density texture holding (kinetic, gradient, potential, total)
+layout(rgba32f, binding = 1) restrict writeonly uniform image2D outEnergyTexture;
+
+// Universal simulation uniform parameters
+layout(location=0) uniform float time;
+layout(location=1) uniform float dt;
+layout(location=2) uniform int era;
+// Domain wall specific uniform parameters
+layout(location=3) uniform float eta;
+layout(location=4) uniform float lam;
+
+
+// Returns the squared gradient of the field using the same fourth order stencil as the Laplacian. The gradient is in lattice
+// units, i.e. with dx = 1.
+float calculateSquareGradient(ivec2 pos, ivec2 size) {
+    float leftTwo = imageLoad(inFieldTexture, ivec2(mod(pos.x - 2, size.x), pos.y)).r;
+    float leftOne = imageLoad(inFieldTexture, ivec2(mod(pos.x - 1, size.x), pos.y)).r;
+    float rightOne = imageLoad(inFieldTexture, ivec2(mod(pos.x + 1, size.x), pos.y)).r;
+    float rightTwo = imageLoad(inFieldTexture, ivec2(mod(pos.x + 2, size.x), pos.y)).r;
+    float downTwo = imageLoad(inFieldTexture, ivec2(pos.x, mod(pos.y - 2, size.y))).r;
+    float downOne = imageLoad(inFieldTexture, ivec2(pos.x, mod(pos.y - 1, size.y))).r;
+    float upOne = imageLoad(inFieldTexture, ivec2(pos.x, mod(pos.y + 1, size.y))).r;
+    float upTwo = imageLoad(inFieldTexture, ivec2(pos.x, mod(pos.y + 2, size.y))).r;
+
+    float xGradient = (leftTwo - 8.0f * leftOne + 8.0f * rightOne - rightTwo) / 12.0f;
+    float yGradient = (downTwo - 8.0f * downOne + 8.0f * upOne - upTwo) / 12.0f;
+    return pow(xGradient, 2) + pow(yGradient, 2);
+}
+
+void main() {
+    ivec2 pos = ivec2(gl_GlobalInvocationID.xy);
+    ivec2 size = imageSize(inFieldTexture);
+    vec4 field = imageLoad(inFieldTexture, pos);
+    float value = field.r;
+    float velocity = field.g;
+
+    float kineticEnergy = 0.5f * pow(velocity, 2);
+    float gradientEnergy = 0.5f * calculateSquareGradient(pos, size);
+    float potentialEnergy = 0.25f * lam * pow(pow(value, 2) - pow(eta, 2), 2);
+
+    imageStore(outEnergyTexture, pos, vec4(kineticEnergy, gradientEnergy, potentialEnergy, kineticEnergy + gradientEnergy + potentialEnergy));
+}
\ No newline at end of file
@@ -0,0 +1,69 @@
+#version 460 core
+// Work group specification
+layout(local_size_x = 8, local_size_y = 8, local_size_z = 1) in;
+
+// In: Real field texture
+layout(FIELD_FORMAT, binding = 0) restrict readonly uniform image2D inRealFieldTexture;
+// In: Imaginary field texture
+layout(FIELD_FORMAT, binding = 1) restrict readonly uniform image2D inImagFieldTexture;
+// Out: Energy density texture holding (kinetic, gradient, potential, total)
+layout(rgba32f, binding = 2) restrict writeonly uniform image2D outEnergyTexture;
+
+// Universal simulation uniform parameters
+layout(location=0) uniform float time;
+layout(location=1) uniform float dt;
+layout(location=2) uniform int era;
+// Single axion specific uniform parameters
+layout(location=3) uniform float eta;
+layout(location=4) uniform float lam;
+layout(location=5) uniform int colorAnomaly;
+layout(location=6) uniform float axionStrength;
+layout(location=7) uniform float growthScale;
+layout(location=8) uniform float growthLaw;
+
+
+// Returns the squared gradient of the real and imaginary parts using the same fourth order stencil as the Laplacian. The
+// gradient is in lattice units, i.e. with dx = 1.
+float calculateSquareGradient(ivec2 pos, ivec2 size) {
+    ivec2 leftTwoPos = ivec2(mod(pos.x - 2, size.x), pos.y);
+    ivec2 leftOnePos = ivec2(mod(pos.x - 1, size.x), pos.y);
+    ivec2 rightOnePos = ivec2(mod(pos.x + 1, size.x), pos.y);
+    ivec2 rightTwoPos = ivec2(mod(pos.x + 2, size.x), pos.y);
+    ivec2 downTwoPos = ivec2(pos.x, mod(pos.y - 2, size.y));
+    ivec2 downOnePos = ivec2(pos.x, mod(pos.y - 1, size.y));
+    ivec2 upOnePos = ivec2(pos.x, mod(pos.y + 1, size.y));
+    ivec2 upTwoPos = ivec2(pos.x, mod(pos.y + 2, size.y));
+
+    // Real and imaginary parts are packed into the x and y components
+    vec2 leftTwo = vec2(imageLoad(inRealFieldTexture, leftTwoPos).r, imageLoad(inImagFieldTexture, leftTwoPos).r);
+    vec2 leftOne = vec2(imageLoad(inRealFieldTexture, leftOnePos).r, imageLoad(inImagFieldTexture, leftOnePos).r);
+    vec2 rightOne = vec2(imageLoad(inRealFieldTexture, rightOnePos).r, imageLoad(inImagFieldTexture, rightOnePos).r);
+    vec2 rightTwo = vec2(imageLoad(inRealFieldTexture, rightTwoPos).r, imageLoad(inImagFieldTexture, rightTwoPos).r);
+    vec2 downTwo = vec2(imageLoad(inRealFieldTexture, downTwoPos).r, imageLoad(inImagFieldTexture, downTwoPos).r);
+    vec2 downOne = vec2(imageLoad(inRealFieldTexture, downOnePos).r, imageLoad(inImagFieldTexture, downOnePos).r);
+    vec2 upOne = vec2(imageLoad(inRealFieldTexture, upOnePos).r, imageLoad(inImagFieldTexture, upOnePos).r);
+    vec2 upTwo = vec2(imageLoad(inRealFieldTexture, upTwoPos).r, imageLoad(inImagFieldTexture, upTwoPos).r);
+
+    vec2 xGradient = (leftTwo - 8.0f * leftOne + 8.0f * rightOne - rightTwo) / 12.0f;
+    vec2 yGradient = (downTwo - 8.0f * downOne + 8.0f * upOne - upTwo) / 12.0f;
+    return dot(xGradient, xGradient) + dot(yGradient, yGradient);
+}
+
+void main() {
+    ivec2 pos = ivec2(gl_GlobalInvocationID.xy);
+    ivec2 size = imageSize(inRealFieldTexture);
+    vec4 realField = imageLoad(inRealFieldTexture, pos);
+    vec4 imagField = imageLoad(inImagFieldTexture, pos);
+
+    // Square amplitude of complex field
+    float squareAmplitude = pow(realField.r, 2) + pow(imagField.r, 2);
+
+    float kineticEnergy = 0.5f * (pow(realField.g, 2) + pow(imagField.g, 2));
+    float gradientEnergy = 0.5f * calculateSquareGradient(pos, size);
+    float potentialEnergy = 0.25f * lam * pow(squareAmplitude - pow(eta, 2), 2);
+    // Axion potential, whose derivative is the axion contribution to the acceleration
+    float phase = atan(imagField.r, realField.r);
+    potentialEnergy += 2.0f * axionStrength * pow(time / growthScale, growthLaw) * (1.0f - cos(colorAnomaly * phase));
+
+    imageStore(outEnergyTexture, pos, vec4(kineticEnergy, gradientEnergy, potentialEnergy, kineticEnergy + gradientEnergy + potentialEnergy));
+}
\ No newline at end of file
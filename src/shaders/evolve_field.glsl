@@ -1,22 +1,36 @@
 #version 460 core
 // Work group specification
-layout(local_size_x = 8, local_size_y = 8, local_size_z = 1) in;
+layout(local_size_x = WORK_GROUP_SIZE_X, local_size_y = WORK_GROUP_SIZE_Y, local_size_z = WORK_GROUP_SIZE_Z) in;
 // In/out: Field texture
-layout(rgba32f, binding = 0) restrict uniform image2D fieldTexture;
+layout(FIELD_FORMAT, binding = 0) restrict uniform LATTICE_IMAGE fieldTexture;
+#ifdef COMPENSATED_FIELDS
+// In/out: Remainders of the field value and velocity that half precision storage can not hold
+layout(rg16f, binding = 1) restrict uniform LATTICE_IMAGE compensationTexture;
+#endif
 
 // Uniforms: time interval
 layout(location=0) uniform float dt;
 
 
 void main() {
-    ivec2 pos = ivec2(gl_GlobalInvocationID.xy);
+    LATTICE_POSITION pos = INVOCATION_POSITION;
     vec4 field = imageLoad(fieldTexture, pos);
     float currentValue = field.r;
     float currentVelocity = field.g;
     float currentAcceleration = field.b;
 
+#ifdef COMPENSATED_FIELDS
+    // Calculate next field value from the full precision value and velocity
+    vec2 compensation = imageLoad(compensationTexture, pos).rg;
+    float nextValue = (currentValue + compensation.r) + dt * ((currentVelocity + compensation.g) + 0.5f * currentAcceleration * dt);
+    // Store the value rounded to half precision and carry the rounding error to the next step
+    float roundedValue = unpackHalf2x16(packHalf2x16(vec2(nextValue, 0.0f))).x;
+    imageStore(compensationTexture, pos, vec4(nextValue - roundedValue, compensation.g, 0.0f, 0.0f));
+    nextValue = roundedValue;
+#else
     // Calculate next field value
     float nextValue = currentValue + dt * (currentVelocity + 0.5f * currentAcceleration * dt);
+#endif
 
     // Update field value
     imageStore(fieldTexture, pos, vec4(nextValue, currentVelocity, currentAcceleration, 0.0f));
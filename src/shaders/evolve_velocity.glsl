@@ -1,26 +1,37 @@
 #version 460 core
 // Work group specification
-layout(local_size_x = 8, local_size_y = 8, local_size_z = 1) in;
+layout(local_size_x = WORK_GROUP_SIZE_X, local_size_y = WORK_GROUP_SIZE_Y, local_size_z = WORK_GROUP_SIZE_Z) in;
 // In/out: Field texture
-layout(rgba32f, binding = 0) restrict uniform image2D fieldTexture;
+layout(FIELD_FORMAT, binding = 0) restrict uniform LATTICE_IMAGE fieldTexture;
+#ifdef COMPENSATED_FIELDS
+// In/out: Remainders of the field value and velocity that half precision storage can not hold
+layout(rg16f, binding = 1) restrict uniform LATTICE_IMAGE compensationTexture;
+#endif
 
 // Uniforms: time interval
 layout(location = 0) uniform float dt;
 
-// PRS alpha
-const float ALPHA_2D = 2.0f;
-
 
 void main() {
-    ivec2 pos = ivec2(gl_GlobalInvocationID.xy);
+    LATTICE_POSITION pos = INVOCATION_POSITION;
     vec4 field = imageLoad(fieldTexture, pos);
     float nextValue = field.r;
     float currentVelocity = field.g;
     float currentAcceleration = field.b;
     float nextAcceleration = field.a;
 
+#ifdef COMPENSATED_FIELDS
+    // Calculate next velocity from the full precision velocity
+    vec2 compensation = imageLoad(compensationTexture, pos).rg;
+    float nextVelocity = (currentVelocity + compensation.g) + 0.5f * (currentAcceleration + nextAcceleration) * dt;
+    // Store the velocity rounded to half precision and carry the rounding error to the next step
+    float roundedVelocity = unpackHalf2x16(packHalf2x16(vec2(nextVelocity, 0.0f))).x;
+    imageStore(compensationTexture, pos, vec4(compensation.r, nextVelocity - roundedVelocity, 0.0f, 0.0f));
+    nextVelocity = roundedVelocity;
+#else
     // Calculate next velocity
     float nextVelocity = currentVelocity + 0.5f * (currentAcceleration + nextAcceleration) * dt;
+#endif
 
     // Update velocity
     imageStore(fieldTexture, pos, vec4(nextValue, nextVelocity, currentAcceleration, nextAcceleration));
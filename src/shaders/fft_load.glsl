@@ -0,0 +1,26 @@
+#version 460 core
+// Work groups
+layout(local_size_x = 8, local_size_y = 8, local_size_z = 1) in;
+// In: Real part. The first channel is used. A sampler is used so that any texture format can be read.
+layout(binding = 0) uniform sampler2D inRealTexture;
+// In: Imaginary part. The first channel is used.
+layout(binding = 1) uniform sampler2D inImagTexture;
+// Out: Complex data stored as (real, imaginary)
+layout(rg32f, binding = 0) restrict writeonly uniform image2D outData;
+
+// Uniforms: whether there is an imaginary part and the factor to multiply the data by
+layout(location=0) uniform int hasImag;
+layout(location=1) uniform float scale;
+
+
+void main() {
+    ivec2 pos = ivec2(gl_GlobalInvocationID.xy);
+    ivec2 size = imageSize(outData);
+    if (pos.x >= size.x || pos.y >= size.y) {
+        return;
+    }
+
+    float realValue = texelFetch(inRealTexture, pos, 0).r;
+    float imagValue = hasImag != 0 ? texelFetch(inImagTexture, pos, 0).r : 0.0f;
+    imageStore(outData, pos, vec4(scale * realValue, scale * imagValue, 0.0f, 0.0f));
+}
\ No newline at end of file
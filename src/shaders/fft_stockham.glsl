@@ -0,0 +1,54 @@
+#version 460 core
+// Work groups
+layout(local_size_x = 8, local_size_y = 8, local_size_z = 1) in;
+// In: Complex data stored as (real, imaginary)
+layout(rg32f, binding = 0) restrict readonly uniform image2D inData;
+// Out: Complex data after one radix-2 stage
+layout(rg32f, binding = 1) restrict writeonly uniform image2D outData;
+
+// Uniforms: the axis to transform along (0 for x, 1 for y), the length of the sub-transforms completed by the previous stages
+// and the sign of the exponent (-1 for the forward transform, +1 for the inverse)
+layout(location=0) uniform int axis;
+layout(location=1) uniform int stride;
+layout(location=2) uniform float direction;
+
+const float PI = 3.1415926535897932384626433832795f;
+
+
+// Returns the product of two complex numbers.
+vec2 multiplyComplex(vec2 a, vec2 b) {
+    return vec2(a.x * b.x - a.y * b.y, a.x * b.y + a.y * b.x);
+}
+
+// Returns the texel position of the given index along the transformed line.
+ivec2 getPosition(int index, int lineIndex) {
+    return axis == 0 ? ivec2(index, lineIndex) : ivec2(lineIndex, index);
+}
+
+// One Stockham stage. Each invocation computes a single butterfly. The Stockham ordering writes every stage in natural order so
+// no bit reversal pass is needed.
+void main() {
+    ivec2 size = imageSize(inData);
+    int lineLength = axis == 0 ? size.x : size.y;
+    int numLines = axis == 0 ? size.y : size.x;
+    int halfLength = lineLength / 2;
+
+    ivec2 id = ivec2(gl_GlobalInvocationID.xy);
+    int butterflyIndex = axis == 0 ? id.x : id.y;
+    int lineIndex = axis == 0 ? id.y : id.x;
+    if (butterflyIndex >= halfLength || lineIndex >= numLines) {
+        return;
+    }
+
+    vec2 first = imageLoad(inData, getPosition(butterflyIndex, lineIndex)).xy;
+    vec2 second = imageLoad(inData, getPosition(butterflyIndex + halfLength, lineIndex)).xy;
+
+    // Twiddle factor
+    int subIndex = butterflyIndex % stride;
+    float angle = direction * PI * float(subIndex) / float(stride);
+    second = multiplyComplex(second, vec2(cos(angle), sin(angle)));
+
+    int outIndex = (butterflyIndex / stride) * 2 * stride + subIndex;
+    imageStore(outData, getPosition(outIndex, lineIndex), vec4(first + second, 0.0f, 0.0f));
+    imageStore(outData, getPosition(outIndex + stride, lineIndex), vec4(first - second, 0.0f, 0.0f));
+}
\ No newline at end of file
@@ -0,0 +1,33 @@
+#version 460 core
+// Work group specification
+layout(local_size_x = 8, local_size_y = 8, local_size_z = 1) in;
+// In: String or wall texture. A sampler is used so that any texture format can be read.
+layout(binding = 0) uniform sampler2D inDefectTexture;
+// Out: Whether each tile holds a defect or is near one
+layout(std430, binding = 0) restrict writeonly buffer outTileFlags {
+    uint tileFlags[];
+};
+
+// Uniforms: width of a tile in cells, the number of tiles along each axis and the distance in cells around each defect that is
+// flagged
+layout(location=0) uniform int tileSize;
+layout(location=1) uniform ivec2 numTiles;
+layout(location=2) uniform int margin;
+
+
+void main() {
+    ivec2 pos = ivec2(gl_GlobalInvocationID.xy);
+    ivec2 size = textureSize(inDefectTexture, 0);
+    if (any(greaterThanEqual(pos, size)) || texelFetch(inDefectTexture, pos, 0).r == 0.0f) {
+        return;
+    }
+
+    // Flag the tiles of the corners and edges of the margin around the defect, which covers every tile the margin overlaps.
+    // Every flag is the same so the order of the writes does not matter.
+    for (int yOffset = -1; yOffset <= 1; yOffset++) {
+        for (int xOffset = -1; xOffset <= 1; xOffset++) {
+            ivec2 tile = ((pos + margin * ivec2(xOffset, yOffset) + size) % size) / tileSize;
+            tileFlags[tile.y * numTiles.x + tile.x] = 1u;
+        }
+    }
+}
\ No newline at end of file
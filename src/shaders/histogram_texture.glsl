@@ -0,0 +1,44 @@
+#version 460 core
+// Work groups
+layout(local_size_x = 16, local_size_y = 16, local_size_z = 1) in;
+// In: Texture to bin. A sampler is used so that any texture format can be read.
+layout(binding = 0) uniform sampler2D inTexture;
+// Out: Histogram bins. The bins must be cleared before the dispatch.
+layout(std430, binding = 0) restrict buffer outBins {
+    uint bins[];
+};
+
+// Uniforms: the channel to bin, the range of the histogram and the number of bins
+layout(location=0) uniform int channel;
+layout(location=1) uniform float minValue;
+layout(location=2) uniform float maxValue;
+layout(location=3) uniform uint numBins;
+
+// Maximum number of bins supported
+const uint MAX_BINS = 256;
+
+// Work group local histogram. This keeps most atomics in shared memory.
+shared uint localBins[MAX_BINS];
+
+
+void main() {
+    uint localIndex = gl_LocalInvocationIndex;
+    // There is one invocation per bin
+    localBins[localIndex] = 0;
+    barrier();
+
+    ivec2 size = textureSize(inTexture, 0);
+    ivec2 pos = ivec2(gl_GlobalInvocationID.xy);
+    if (pos.x < size.x && pos.y < size.y) {
+        float value = texelFetch(inTexture, pos, 0)[channel];
+        // Values outside of the range are counted in the edge bins
+        float normalisedValue = (value - minValue) / (maxValue - minValue);
+        uint binIndex = uint(clamp(int(floor(normalisedValue * float(numBins))), 0, int(numBins) - 1));
+        atomicAdd(localBins[binIndex], 1);
+    }
+    barrier();
+
+    if (localIndex < numBins && localBins[localIndex] > 0) {
+        atomicAdd(bins[localIndex], localBins[localIndex]);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,50 @@
+#version 460 core
+// Work groups
+layout(local_size_x = 8, local_size_y = 8, local_size_z = 1) in;
+// In/Out: The parent of each cell in the union-find forest. Each cell is relinked directly to its root.
+layout(std430, binding = 0) coherent restrict buffer inOutParents {
+    uint parents[];
+};
+// In: The class of each cell
+layout(std430, binding = 1) restrict readonly buffer inClasses {
+    uint classes[];
+};
+// Out: The size of each component, stored at its root
+layout(std430, binding = 2) restrict buffer outSizes {
+    uint sizes[];
+};
+
+// Uniforms: the size of the grid
+layout(location=0) uniform ivec2 size;
+
+// Cells that do not belong to any component
+const uint NO_CLASS = 0xFFFFFFFFu;
+
+
+// Returns the root of the component that the given cell belongs to.
+uint findRoot(uint index) {
+    uint parent = parents[index];
+    while (parent != index) {
+        index = parent;
+        parent = parents[index];
+    }
+    return index;
+}
+
+void main()
+{
+    ivec2 pos = ivec2(gl_GlobalInvocationID.xy);
+    if (pos.x >= size.x || pos.y >= size.y) {
+        return;
+    }
+
+    uint index = uint(pos.y * size.x + pos.x);
+    if (classes[index] == NO_CLASS) {
+        return;
+    }
+
+    // Every root is the smallest index of its component, so the labels are independent of the order of the merges
+    uint root = findRoot(index);
+    parents[index] = root;
+    atomicAdd(sizes[root], 1u);
+}
\ No newline at end of file
@@ -0,0 +1,48 @@
+#version 460 core
+// Work groups
+layout(local_size_x = 8, local_size_y = 8, local_size_z = 1) in;
+// In: The root of each cell
+layout(std430, binding = 0) restrict readonly buffer inParents {
+    uint parents[];
+};
+// In: The class of each cell
+layout(std430, binding = 1) restrict readonly buffer inClasses {
+    uint classes[];
+};
+// In: The size of each component, stored at its root
+layout(std430, binding = 2) restrict readonly buffer inSizes {
+    uint sizes[];
+};
+// Out: The number of components, the size of the largest component and the number of components in each size bin. Bin b holds
+// the components with 2^b to 2^(b + 1) - 1 cells. This must be cleared before the dispatch.
+layout(std430, binding = 3) restrict buffer outStatistics {
+    uint numComponents;
+    uint largestSize;
+    uint sizeBins[];
+};
+
+// Uniforms: the size of the grid
+layout(location=0) uniform ivec2 size;
+
+// Cells that do not belong to any component
+const uint NO_CLASS = 0xFFFFFFFFu;
+
+
+void main()
+{
+    ivec2 pos = ivec2(gl_GlobalInvocationID.xy);
+    if (pos.x >= size.x || pos.y >= size.y) {
+        return;
+    }
+
+    // Each component is counted once at its root
+    uint index = uint(pos.y * size.x + pos.x);
+    if (classes[index] == NO_CLASS || parents[index] != index) {
+        return;
+    }
+
+    uint componentSize = sizes[index];
+    atomicAdd(numComponents, 1u);
+    atomicMax(largestSize, componentSize);
+    atomicAdd(sizeBins[findMSB(componentSize)], 1u);
+}
\ No newline at end of file
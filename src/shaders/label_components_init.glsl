@@ -0,0 +1,57 @@
+#version 460 core
+// Work groups
+layout(local_size_x = 8, local_size_y = 8, local_size_z = 1) in;
+// In: Texture to label. A sampler is used so that any texture format can be read.
+layout(binding = 0) uniform sampler2D inTexture;
+// Out: The parent of each cell in the union-find forest
+layout(std430, binding = 0) restrict writeonly buffer outParents {
+    uint parents[];
+};
+// Out: The class of each cell. Only neighbouring cells of the same class belong to the same component.
+layout(std430, binding = 1) restrict writeonly buffer outClasses {
+    uint classes[];
+};
+// Out: The size of each component. This is cleared here and counted later.
+layout(std430, binding = 2) restrict writeonly buffer outSizes {
+    uint sizes[];
+};
+
+// Uniforms: how cells are classified and the number of phase sectors
+layout(location=0) uniform int classType;
+layout(location=1) uniform int numSectors;
+
+// Cells that do not belong to any component
+const uint NO_CLASS = 0xFFFFFFFFu;
+// Class types
+const int CLASS_NONZERO = 0;
+const int CLASS_SIGN = 1;
+const int CLASS_PHASE_SECTOR = 2;
+
+
+// Returns the class of a cell
+uint classify(float value) {
+    if (classType == CLASS_NONZERO) {
+        return value != 0.0f ? 0u : NO_CLASS;
+    } else if (classType == CLASS_SIGN) {
+        return value >= 0.0f ? 1u : 0u;
+    } else {
+        // The phase is stored in units of pi and each sector is centred on a vacuum at 2 pi k / numSectors
+        float sector = round(0.5f * value * float(numSectors));
+        return uint(mod(sector, float(numSectors)));
+    }
+}
+
+void main()
+{
+    ivec2 size = textureSize(inTexture, 0);
+    ivec2 pos = ivec2(gl_GlobalInvocationID.xy);
+    if (pos.x >= size.x || pos.y >= size.y) {
+        return;
+    }
+
+    uint index = uint(pos.y * size.x + pos.x);
+    // Every cell starts as the root of its own component
+    parents[index] = index;
+    classes[index] = classify(texelFetch(inTexture, pos, 0).r);
+    sizes[index] = 0;
+}
\ No newline at end of file
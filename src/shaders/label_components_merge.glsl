@@ -0,0 +1,74 @@
+#version 460 core
+// Work groups
+layout(local_size_x = 8, local_size_y = 8, local_size_z = 1) in;
+// In/Out: The parent of each cell in the union-find forest. A parent always has a smaller index than its child.
+layout(std430, binding = 0) coherent restrict buffer inOutParents {
+    uint parents[];
+};
+// In: The class of each cell
+layout(std430, binding = 1) restrict readonly buffer inClasses {
+    uint classes[];
+};
+
+// Uniforms: the size of the grid
+layout(location=0) uniform ivec2 size;
+
+// Cells that do not belong to any component
+const uint NO_CLASS = 0xFFFFFFFFu;
+
+
+// Returns the root of the component that the given cell belongs to.
+uint findRoot(uint index) {
+    uint parent = parents[index];
+    while (parent != index) {
+        index = parent;
+        parent = parents[index];
+    }
+    return index;
+}
+
+// Merges the components of two cells. Roots are only ever linked below smaller roots with an atomic minimum, so concurrent merges
+// can not lose a link: if the root was relinked in the meantime, its previous parent is merged instead.
+void merge(uint a, uint b) {
+    while (true) {
+        a = findRoot(a);
+        b = findRoot(b);
+        if (a == b) {
+            return;
+        }
+        if (a > b) {
+            uint temp = a;
+            a = b;
+            b = temp;
+        }
+        uint oldParent = atomicMin(parents[b], a);
+        if (oldParent == b) {
+            return;
+        }
+        b = oldParent;
+    }
+}
+
+void main()
+{
+    ivec2 pos = ivec2(gl_GlobalInvocationID.xy);
+    if (pos.x >= size.x || pos.y >= size.y) {
+        return;
+    }
+
+    uint index = uint(pos.y * size.x + pos.x);
+    uint currentClass = classes[index];
+    if (currentClass == NO_CLASS) {
+        return;
+    }
+
+    // Only the links to the right and up are merged so that every link is visited once. The grid is periodic.
+    uint rightIndex = uint(pos.y * size.x + (pos.x + 1) % size.x);
+    uint upIndex = uint(((pos.y + 1) % size.y) * size.x + pos.x);
+    if (classes[rightIndex] == currentClass) {
+        merge(index, rightIndex);
+    }
+    if (classes[upIndex] == currentClass) {
+        merge(index, upIndex);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,78 @@
+#version 460 core
+// Work groups
+layout(local_size_x = 16, local_size_y = 16, local_size_z = 1) in;
+// In: Fourier transform stored as (real, imaginary)
+layout(rg32f, binding = 0) restrict readonly uniform image2D inTransform;
+// Out: The first bin of each work group's window
+layout(std430, binding = 0) restrict writeonly buffer outWindowStarts {
+    uint windowStarts[];
+};
+// Out: The summed power of each bin in each work group's window
+layout(std430, binding = 1) restrict writeonly buffer outWindowSums {
+    float windowSums[];
+};
+
+// Uniforms: the number of radial bins
+layout(location=0) uniform uint numBins;
+
+// Number of invocations per work group
+const uint NUM_INVOCATIONS = 16 * 16;
+// Number of consecutive bins a work group can touch. A 16x16 tile of modes spans at most 24 bins.
+const uint WINDOW_SIZE = 32;
+// Marks modes that are outside of the binned range
+const uint NO_BIN = 0xFFFFFFFFu;
+
+shared uint localBins[NUM_INVOCATIONS];
+shared float localPowers[NUM_INVOCATIONS];
+shared uint localStartBin;
+
+
+// Each work group sums the power of its modes per radial bin. The sums are taken in a fixed order so that the spectrum is
+// deterministic, unlike floating point atomics.
+void main() {
+    uint localIndex = gl_LocalInvocationIndex;
+    ivec2 size = imageSize(inTransform);
+    ivec2 pos = ivec2(gl_GlobalInvocationID.xy);
+
+    uint bin = NO_BIN;
+    float power = 0.0f;
+    if (pos.x < size.x && pos.y < size.y) {
+        // Signed frequencies in units of the fundamental mode of the shorter side
+        ivec2 frequency = ivec2(
+            pos.x > size.x / 2 ? pos.x - size.x : pos.x,
+            pos.y > size.y / 2 ? pos.y - size.y : pos.y
+        );
+        vec2 wavenumber = vec2(frequency) / vec2(size) * float(min(size.x, size.y));
+        uint currentBin = uint(floor(length(wavenumber) + 0.5f));
+        if (currentBin < numBins) {
+            bin = currentBin;
+            vec2 mode = imageLoad(inTransform, pos).xy;
+            power = dot(mode, mode);
+        }
+    }
+    localBins[localIndex] = bin;
+    localPowers[localIndex] = power;
+    if (localIndex == 0) {
+        localStartBin = NO_BIN;
+    }
+    barrier();
+    atomicMin(localStartBin, bin);
+    barrier();
+
+    uint groupIndex = gl_WorkGroupID.y * gl_NumWorkGroups.x + gl_WorkGroupID.x;
+    if (localIndex < WINDOW_SIZE) {
+        float sum = 0.0f;
+        if (localStartBin != NO_BIN) {
+            uint targetBin = localStartBin + localIndex;
+            for (uint modeIndex = 0; modeIndex < NUM_INVOCATIONS; modeIndex++) {
+                if (localBins[modeIndex] == targetBin) {
+                    sum += localPowers[modeIndex];
+                }
+            }
+        }
+        windowSums[groupIndex * WINDOW_SIZE + localIndex] = sum;
+    }
+    if (localIndex == 0) {
+        windowStarts[groupIndex] = localStartBin;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,42 @@
+#version 460 core
+// Work groups
+layout(local_size_x = 64, local_size_y = 1, local_size_z = 1) in;
+// In: The first bin of each work group's window
+layout(std430, binding = 0) restrict readonly buffer inWindowStarts {
+    uint windowStarts[];
+};
+// In: The summed power of each bin in each work group's window
+layout(std430, binding = 1) restrict readonly buffer inWindowSums {
+    float windowSums[];
+};
+// Out: The summed power of each bin
+layout(std430, binding = 2) restrict writeonly buffer outPowers {
+    float powers[];
+};
+
+// Uniforms: the number of radial bins and the number of windows
+layout(location=0) uniform uint numBins;
+layout(location=1) uniform uint numWindows;
+
+// Number of consecutive bins in a window
+const uint WINDOW_SIZE = 32;
+// Marks windows that hold no bins
+const uint NO_BIN = 0xFFFFFFFFu;
+
+
+// Each invocation sums a single bin over every window in order.
+void main() {
+    uint bin = gl_GlobalInvocationID.x;
+    if (bin >= numBins) {
+        return;
+    }
+
+    float sum = 0.0f;
+    for (uint windowIndex = 0; windowIndex < numWindows; windowIndex++) {
+        uint startBin = windowStarts[windowIndex];
+        if (startBin != NO_BIN && bin >= startBin && bin < startBin + WINDOW_SIZE) {
+            sum += windowSums[windowIndex * WINDOW_SIZE + bin - startBin];
+        }
+    }
+    powers[bin] = sum;
+}
\ No newline at end of file
@@ -0,0 +1,82 @@
+#version 460 core
+// Work group specification. Each work group along z covers a single patch.
+layout(local_size_x = 8, local_size_y = 8, local_size_z = 1) in;
+// In/out: Atlas of the patches of a field. Ghost cells are copied from the interior of other patches.
+layout(rgba32f, binding = 0) uniform image2D patchFieldTexture;
+// In: Field at the start of the coarse timestep
+layout(rgba32f, binding = 1) restrict readonly uniform image2D inPreviousFieldTexture;
+// In: Field at the end of the coarse timestep
+layout(rgba32f, binding = 2) restrict readonly uniform image2D inCurrentFieldTexture;
+// In: The tile covered by each patch
+layout(std430, binding = 0) restrict readonly buffer inPatchTiles {
+    int patchTiles[];
+};
+// In: The patch covering each tile, or -1 if the tile is not refined
+layout(std430, binding = 1) restrict readonly buffer inTilePatches {
+    int tilePatches[];
+};
+
+// Uniforms: fraction of the coarse timestep that has passed, the first patch to fill, whether only the ghost cells are filled
+// and the number of tiles along each axis
+layout(location=0) uniform float fraction;
+layout(location=1) uniform int firstPatch;
+layout(location=2) uniform int fillGhostsOnly;
+layout(location=3) uniform ivec2 numTiles;
+
+
+// Returns the position of the first cell of a patch in the atlas
+ivec2 getPatchOrigin(int patchIndex) {
+    return PATCH_SIZE * ivec2(patchIndex % PATCHES_PER_ROW, patchIndex / PATCHES_PER_ROW);
+}
+
+// Interpolates the coarse fields bilinearly at a fine cell, given in fine cells from the origin of the lattice, and between the
+// start and end of the coarse timestep
+vec4 interpolateCoarseFields(ivec2 finePos) {
+    ivec2 size = imageSize(inCurrentFieldTexture);
+    // Fine cell centres are a quarter of a coarse cell away from the nearest coarse cell centre
+    vec2 coarsePos = (vec2(finePos) + 0.5f) / REFINEMENT_RATIO - 0.5f;
+    ivec2 lowerPos = ivec2(floor(coarsePos));
+    vec2 weights = coarsePos - vec2(lowerPos);
+
+    vec4 result = vec4(0.0f);
+    for (int yOffset = 0; yOffset < 2; yOffset++) {
+        for (int xOffset = 0; xOffset < 2; xOffset++) {
+            ivec2 samplePos = (lowerPos + ivec2(xOffset, yOffset) + size) % size;
+            float weight = (xOffset == 1 ? weights.x : 1.0f - weights.x) * (yOffset == 1 ? weights.y : 1.0f - weights.y);
+            vec4 previousField = imageLoad(inPreviousFieldTexture, samplePos);
+            vec4 currentField = imageLoad(inCurrentFieldTexture, samplePos);
+            result += weight * mix(previousField, currentField, fraction);
+        }
+    }
+    return result;
+}
+
+void main() {
+    int patchIndex = firstPatch + int(gl_WorkGroupID.z);
+    ivec2 localPos = ivec2(gl_GlobalInvocationID.xy);
+    ivec2 atlasPos = getPatchOrigin(patchIndex) + localPos;
+    bool isGhost = any(lessThan(localPos, ivec2(GHOST_WIDTH))) || any(greaterThanEqual(localPos, ivec2(PATCH_SIZE - GHOST_WIDTH)));
+    if (fillGhostsOnly != 0 && !isGhost) {
+        return;
+    }
+
+    // Position of the cell in fine cells from the origin of the lattice with periodic boundaries
+    int tileIndex = patchTiles[patchIndex];
+    ivec2 tileOrigin = TILE_SIZE * ivec2(tileIndex % numTiles.x, tileIndex / numTiles.x);
+    ivec2 fineSize = REFINEMENT_RATIO * imageSize(inCurrentFieldTexture);
+    ivec2 finePos = (REFINEMENT_RATIO * tileOrigin + localPos - GHOST_WIDTH + fineSize) % fineSize;
+
+    // Ghost cells that lie inside another patch are copied from it, as every patch has been evolved to the same time
+    if (fillGhostsOnly != 0) {
+        ivec2 neighbourTile = finePos / (REFINEMENT_RATIO * TILE_SIZE);
+        int neighbourPatch = tilePatches[neighbourTile.y * numTiles.x + neighbourTile.x];
+        if (neighbourPatch >= 0) {
+            ivec2 neighbourPos = getPatchOrigin(neighbourPatch) + finePos - REFINEMENT_RATIO * TILE_SIZE * neighbourTile + GHOST_WIDTH;
+            imageStore(patchFieldTexture, atlasPos, imageLoad(patchFieldTexture, neighbourPos));
+            return;
+        }
+    }
+
+    // Otherwise the cell is prolonged from the coarse fields
+    imageStore(patchFieldTexture, atlasPos, interpolateCoarseFields(finePos));
+}
\ No newline at end of file
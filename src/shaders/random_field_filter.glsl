@@ -0,0 +1,48 @@
+#version 460 core
+// Work groups
+layout(local_size_x = 8, local_size_y = 8, local_size_z = 1) in;
+// In/Out: Transformed noise stored as (real, imaginary)
+layout(rg32f, binding = 0) restrict uniform image2D ioData;
+
+// Uniforms: the spectrum shape as an InitialSpectrumType, its correlation length in cells and power law index, and the factor that
+// normalises the filtered fields
+layout(location=0) uniform int spectrumType;
+layout(location=1) uniform float correlationLength;
+layout(location=2) uniform float spectralIndex;
+layout(location=3) uniform float scale;
+
+const int GAUSSIAN = 1;
+const int POWER_LAW = 2;
+const float PI = 3.1415926535897932384626433832795f;
+
+
+// Returns the wavenumber in radians per cell of the given mode along an axis of the given length.
+float getWavenumber(int modeIndex, int length) {
+    int signedIndex = modeIndex > length / 2 ? modeIndex - length : modeIndex;
+    return 2.0f * PI * float(signedIndex) / float(length);
+}
+
+// Returns the power of the spectrum at the given wavenumber, or zero where it is not finite. This matches random_field.cpp.
+float calculatePower(float wavenumber) {
+    float cutoff = exp(-0.5f * wavenumber * wavenumber * correlationLength * correlationLength);
+    float power = 1.0f;
+    if (spectrumType == GAUSSIAN) {
+        power = cutoff;
+    } else if (spectrumType == POWER_LAW) {
+        // pow is undefined at zero, so the mean mode is handled separately
+        power = wavenumber > 0.0f ? pow(wavenumber, spectralIndex) * cutoff : (spectralIndex == 0.0f ? 1.0f : 0.0f);
+    }
+    return isinf(power) || isnan(power) ? 0.0f : power;
+}
+
+void main() {
+    ivec2 pos = ivec2(gl_GlobalInvocationID.xy);
+    ivec2 size = imageSize(ioData);
+    if (pos.x >= size.x || pos.y >= size.y) {
+        return;
+    }
+
+    float wavenumber = length(vec2(getWavenumber(pos.x, size.x), getWavenumber(pos.y, size.y)));
+    vec2 mode = imageLoad(ioData, pos).xy;
+    imageStore(ioData, pos, vec4(scale * sqrt(calculatePower(wavenumber)) * mode, 0.0f, 0.0f));
+}
\ No newline at end of file
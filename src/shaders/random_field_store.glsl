@@ -0,0 +1,30 @@
+#version 460 core
+// Work groups
+layout(local_size_x = 8, local_size_y = 8, local_size_z = 1) in;
+// In: Filtered values stored as (first field, second field)
+layout(rg32f, binding = 0) restrict readonly uniform image2D inData;
+// In/Out: First field
+layout(rgba32f, binding = 1) uniform image2D ioFirstFieldTexture;
+// In/Out: Second field. This is the first field again if there is no second field.
+layout(rgba32f, binding = 2) uniform image2D ioSecondFieldTexture;
+
+// Uniforms: whether there is a second field
+layout(location=0) uniform int hasSecond;
+
+
+void main() {
+    ivec2 pos = ivec2(gl_GlobalInvocationID.xy);
+    ivec2 size = imageSize(inData);
+    if (pos.x >= size.x || pos.y >= size.y) {
+        return;
+    }
+
+    // Only the values are replaced
+    vec2 values = imageLoad(inData, pos).xy;
+    vec4 firstField = imageLoad(ioFirstFieldTexture, pos);
+    imageStore(ioFirstFieldTexture, pos, vec4(values.x, firstField.yzw));
+    if (hasSecond != 0) {
+        vec4 secondField = imageLoad(ioSecondFieldTexture, pos);
+        imageStore(ioSecondFieldTexture, pos, vec4(values.y, secondField.yzw));
+    }
+}
\ No newline at end of file
@@ -0,0 +1,140 @@
+#version 460 core
+// Work groups
+layout(local_size_x = WORK_GROUP_SIZE_X, local_size_y = WORK_GROUP_SIZE_Y, local_size_z = WORK_GROUP_SIZE_Z) in;
+// Out: Single precision field texture
+layout(rgba32f, binding = 0) restrict writeonly uniform LATTICE_IMAGE outFieldTexture;
+
+#ifdef LAYERED
+// In: Seed of each layer
+layout(std430, binding = 0) restrict readonly buffer inLayerSeeds {
+    uint layerSeeds[];
+};
+#else
+// Uniforms: seed
+layout(location=0) uniform uint seed;
+#endif
+// Uniforms: index of the field being randomised
+layout(location=1) uniform uint fieldIndex;
+
+// Multipliers and key increments of Philox4x32
+const uint PHILOX_M0 = 0xD2511F53u;
+const uint PHILOX_M1 = 0xCD9E8D57u;
+const uint PHILOX_W0 = 0x9E3779B9u;
+const uint PHILOX_W1 = 0xBB67AE85u;
+
+// These functions mirror philox.cpp operation for operation so that the CPU gives the same fields. The results are `precise` so
+// that no multiplication and addition is fused, as that would round differently.
+
+// Returns the four 32 bit words of the Philox4x32-10 generator for the given counter and key
+uvec4 generatePhilox4x32(uvec4 counter, uvec2 key) {
+    for (int roundIndex = 0; roundIndex < 10; roundIndex++) {
+        uint firstHigh, firstLow, secondHigh, secondLow;
+        umulExtended(PHILOX_M0, counter.x, firstHigh, firstLow);
+        umulExtended(PHILOX_M1, counter.z, secondHigh, secondLow);
+        counter = uvec4(secondHigh ^ counter.y ^ key.x, secondLow, firstHigh ^ counter.w ^ key.y, firstLow);
+        key += uvec2(PHILOX_W0, PHILOX_W1);
+    }
+    return counter;
+}
+
+// Returns the natural logarithm of a number in (0, 1]
+float calculateLogarithm(float x) {
+    // Split into a mantissa within a factor of root two of one and a power of two
+    uint bits = floatBitsToUint(x);
+    precise float exponent = float(int(bits >> 23) - 127);
+    precise float mantissa = uintBitsToFloat((bits & 0x007FFFFFu) | 0x3F800000u);
+    if (mantissa > 1.41421356f) {
+        mantissa = mantissa * 0.5f;
+        exponent = exponent + 1.0f;
+    }
+
+    // The reciprocal of the mantissa plus one converges from one half by Newton's method
+    precise float denominator = mantissa + 1.0f;
+    precise float reciprocal = 0.5f;
+    for (int iterationIndex = 0; iterationIndex < 4; iterationIndex++) {
+        reciprocal = reciprocal * (2.0f - denominator * reciprocal);
+    }
+
+    // log(m) = 2 atanh(s) with s = (m - 1) / (m + 1)
+    precise float s = (mantissa - 1.0f) * reciprocal;
+    precise float s2 = s * s;
+    precise float series = 0.0769230769f;
+    series = series * s2 + 0.0909090909f;
+    series = series * s2 + 0.111111111f;
+    series = series * s2 + 0.142857143f;
+    series = series * s2 + 0.2f;
+    series = series * s2 + 0.333333333f;
+    series = series * s2 + 1.0f;
+    precise float result = exponent * 0.693147181f + 2.0f * s * series;
+    return result;
+}
+
+// Returns the square root of a non-negative number
+float calculateSquareRoot(float x) {
+    // The inverse square root converges from the bit level estimate by Newton's method
+    precise float inverseRoot = uintBitsToFloat(0x5F3759DFu - (floatBitsToUint(x) >> 1));
+    for (int iterationIndex = 0; iterationIndex < 4; iterationIndex++) {
+        inverseRoot = inverseRoot * (1.5f - 0.5f * x * inverseRoot * inverseRoot);
+    }
+    precise float result = x * inverseRoot;
+    return result;
+}
+
+// Returns the cosine of a whole turn times a number in [0, 1)
+float calculateTurnCosine(float turns) {
+    // Reduce to a quarter turn either side of zero, flipping the sign for the half turn that was removed
+    precise float offset = turns - 0.5f;
+    float sign = -1.0f;
+    precise float reduced = offset < 0.0f ? -offset : offset;
+    if (reduced > 0.25f) {
+        reduced = 0.5f - reduced;
+        sign = 1.0f;
+    }
+
+    // Taylor series of the cosine up to the 14th power
+    precise float angle = reduced * 6.28318531f;
+    precise float angle2 = angle * angle;
+    precise float series = -1.14707456e-11f;
+    series = series * angle2 + 2.08767570e-9f;
+    series = series * angle2 - 2.75573192e-7f;
+    series = series * angle2 + 2.48015873e-5f;
+    series = series * angle2 - 1.38888889e-3f;
+    series = series * angle2 + 4.16666667e-2f;
+    series = series * angle2 - 0.5f;
+    series = series * angle2 + 1.0f;
+    precise float result = sign * series;
+    return result;
+}
+
+// Returns a standard normal value from two random 32 bit words with the Box-Muller transform
+float convertToNormal(uint firstWord, uint secondWord) {
+    // Uniform numbers on a grid of 2^-24. The first is in (0, 1] so that its logarithm is finite.
+    precise float firstUniform = float((firstWord >> 8) + 1u) * 5.96046448e-8f;
+    precise float secondUniform = float(secondWord >> 8) * 5.96046448e-8f;
+    precise float radius = calculateSquareRoot(-2.0f * calculateLogarithm(firstUniform));
+    precise float result = radius * calculateTurnCosine(secondUniform);
+    return result;
+}
+
+void main()
+{
+    LATTICE_POSITION pos = INVOCATION_POSITION;
+    if (any(greaterThanEqual(pos, imageSize(outFieldTexture)))) {
+        return;
+    }
+
+#ifdef VOLUME
+    uvec3 cell = uvec3(pos);
+#else
+    uvec3 cell = uvec3(pos.xy, 0u);
+#endif
+#ifdef LAYERED
+    uint seed = layerSeeds[pos.z];
+#endif
+
+    // Each value depends only on its seed, field and cell. The velocity and accelerations start at zero, as the acceleration
+    // depends on the simulation parameters.
+    uvec4 words = generatePhilox4x32(uvec4(cell, 0u), uvec2(seed, fieldIndex));
+    precise float value = 0.1f * convertToNormal(words.x, words.y);
+    imageStore(outFieldTexture, pos, vec4(value, 0.0f, 0.0f, 0.0f));
+}
\ No newline at end of file
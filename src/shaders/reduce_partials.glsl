@@ -0,0 +1,61 @@
+#version 460 core
+// Work groups. Each invocation combines up to four partials so each work group reduces 1024 partials into one.
+layout(local_size_x = 256, local_size_y = 1, local_size_z = 1) in;
+// In: Partial results of the previous pass. Each partial holds (sum, min, max, sum of squares).
+layout(std430, binding = 0) restrict readonly buffer inPartials {
+    vec4 partials[];
+};
+// Out: One partial result per work group
+layout(std430, binding = 1) restrict writeonly buffer outPartials {
+    vec4 reducedPartials[];
+};
+
+// Uniforms: the number of input partials
+layout(location=0) uniform uint numPartials;
+
+// Number of invocations per work group
+const uint NUM_INVOCATIONS = 256;
+// Number of partials combined by each invocation
+const uint PARTIALS_PER_INVOCATION = 4;
+
+shared vec4 localPartials[NUM_INVOCATIONS];
+
+
+// Returns the identity of the reduction, which leaves any partial unchanged when combined with it.
+vec4 getIdentity() {
+    float infinity = uintBitsToFloat(0x7F800000u);
+    return vec4(0.0f, infinity, -infinity, 0.0f);
+}
+
+// Combines two partial results.
+vec4 combine(vec4 a, vec4 b) {
+    return vec4(a.x + b.x, min(a.y, b.y), max(a.z, b.z), a.w + b.w);
+}
+
+void main() {
+    uint localIndex = gl_LocalInvocationIndex;
+    // Strided loads keep neighbouring invocations on neighbouring partials
+    uint startIndex = gl_WorkGroupID.x * NUM_INVOCATIONS * PARTIALS_PER_INVOCATION + localIndex;
+
+    vec4 partial = getIdentity();
+    for (uint offset = 0; offset < PARTIALS_PER_INVOCATION; offset++) {
+        uint partialIndex = startIndex + offset * NUM_INVOCATIONS;
+        if (partialIndex < numPartials) {
+            partial = combine(partial, partials[partialIndex]);
+        }
+    }
+
+    // Tree reduction in shared memory
+    localPartials[localIndex] = partial;
+    barrier();
+    for (uint stride = NUM_INVOCATIONS / 2; stride > 0; stride /= 2) {
+        if (localIndex < stride) {
+            localPartials[localIndex] = combine(localPartials[localIndex], localPartials[localIndex + stride]);
+        }
+        barrier();
+    }
+
+    if (localIndex == 0) {
+        reducedPartials[gl_WorkGroupID.x] = localPartials[0];
+    }
+}
\ No newline at end of file
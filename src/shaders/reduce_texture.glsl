@@ -0,0 +1,63 @@
+#version 460 core
+// Work groups. Each invocation reduces a 2x2 block of texels so each work group covers a 32x32 tile.
+layout(local_size_x = 16, local_size_y = 16, local_size_z = 1) in;
+// In: Texture to reduce. A sampler is used so that any texture format can be read.
+layout(binding = 0) uniform sampler2D inTexture;
+// Out: One partial result per work group. Each partial holds (sum, min, max, sum of squares).
+layout(std430, binding = 0) restrict writeonly buffer outPartials {
+    vec4 partials[];
+};
+
+// Uniforms: the channel to reduce
+layout(location=0) uniform int channel;
+
+// Number of invocations per work group
+const uint NUM_INVOCATIONS = 16 * 16;
+
+shared vec4 localPartials[NUM_INVOCATIONS];
+
+
+// Returns the identity of the reduction, which leaves any partial unchanged when combined with it.
+vec4 getIdentity() {
+    float infinity = uintBitsToFloat(0x7F800000u);
+    return vec4(0.0f, infinity, -infinity, 0.0f);
+}
+
+// Combines two partial results.
+vec4 combine(vec4 a, vec4 b) {
+    return vec4(a.x + b.x, min(a.y, b.y), max(a.z, b.z), a.w + b.w);
+}
+
+void main() {
+    ivec2 size = textureSize(inTexture, 0);
+    // Top left texel of the 2x2 block
+    ivec2 blockPos = 2 * ivec2(gl_GlobalInvocationID.xy);
+
+    vec4 partial = getIdentity();
+    for (int yOffset = 0; yOffset < 2; yOffset++) {
+        for (int xOffset = 0; xOffset < 2; xOffset++) {
+            ivec2 pos = blockPos + ivec2(xOffset, yOffset);
+            // Texels outside of the texture do not contribute
+            if (pos.x < size.x && pos.y < size.y) {
+                float value = texelFetch(inTexture, pos, 0)[channel];
+                partial = combine(partial, vec4(value, value, value, value * value));
+            }
+        }
+    }
+
+    // Tree reduction in shared memory
+    uint localIndex = gl_LocalInvocationIndex;
+    localPartials[localIndex] = partial;
+    barrier();
+    for (uint stride = NUM_INVOCATIONS / 2; stride > 0; stride /= 2) {
+        if (localIndex < stride) {
+            localPartials[localIndex] = combine(localPartials[localIndex], localPartials[localIndex + stride]);
+        }
+        barrier();
+    }
+
+    if (localIndex == 0) {
+        uint groupIndex = gl_WorkGroupID.y * gl_NumWorkGroups.x + gl_WorkGroupID.x;
+        partials[groupIndex] = localPartials[0];
+    }
+}
\ No newline at end of file
@@ -0,0 +1,33 @@
+#version 460 core
+// Work group specification. Each work group along z covers a single patch.
+layout(local_size_x = 8, local_size_y = 8, local_size_z = 1) in;
+// In: Atlas of the patches of a field
+layout(rgba32f, binding = 0) restrict readonly uniform image2D inPatchFieldTexture;
+// Out: Field
+layout(rgba32f, binding = 1) restrict writeonly uniform image2D outFieldTexture;
+// In: The tile covered by each patch
+layout(std430, binding = 0) restrict readonly buffer inPatchTiles {
+    int patchTiles[];
+};
+
+// Uniforms: the number of tiles along each axis
+layout(location=0) uniform ivec2 numTiles;
+
+
+void main() {
+    int patchIndex = int(gl_WorkGroupID.z);
+    ivec2 localPos = ivec2(gl_GlobalInvocationID.xy);
+    int tileIndex = patchTiles[patchIndex];
+    ivec2 coarsePos = TILE_SIZE * ivec2(tileIndex % numTiles.x, tileIndex / numTiles.x) + localPos;
+    ivec2 finePos = PATCH_SIZE * ivec2(patchIndex % PATCHES_PER_ROW, patchIndex / PATCHES_PER_ROW) + GHOST_WIDTH +
+                    REFINEMENT_RATIO * localPos;
+
+    // The coarse cell centre is the centre of its fine cells, so their average is second order accurate
+    vec4 sum = vec4(0.0f);
+    for (int yOffset = 0; yOffset < REFINEMENT_RATIO; yOffset++) {
+        for (int xOffset = 0; xOffset < REFINEMENT_RATIO; xOffset++) {
+            sum += imageLoad(inPatchFieldTexture, finePos + ivec2(xOffset, yOffset));
+        }
+    }
+    imageStore(outFieldTexture, coarsePos, sum / float(REFINEMENT_RATIO * REFINEMENT_RATIO));
+}
\ No newline at end of file
@@ -1,16 +1,16 @@
 #version 460 core
 // Work group specification
-layout(local_size_x = 8, local_size_y = 8, local_size_z = 1) in;
+layout(local_size_x = WORK_GROUP_SIZE_X, local_size_y = WORK_GROUP_SIZE_Y, local_size_z = WORK_GROUP_SIZE_Z) in;
 
 // In/Out: Real field texture
-layout(rgba32f, binding = 0) restrict uniform image2D realFieldTexture;
+layout(FIELD_FORMAT, binding = 0) restrict uniform LATTICE_IMAGE realFieldTexture;
 // In: Real Laplacian texture
-layout(r32f, binding = 1) restrict readonly uniform image2D inRealLaplacianTexture;
+layout(LAPLACIAN_FORMAT, binding = 1) restrict readonly uniform LATTICE_IMAGE inRealLaplacianTexture;
 
 // In/Out: Imaginary field texture
-layout(rgba32f, binding = 2) restrict uniform image2D imagFieldTexture;
+layout(FIELD_FORMAT, binding = 2) restrict uniform LATTICE_IMAGE imagFieldTexture;
 // In: Imaginary Laplacian texture
-layout(r32f, binding = 3) restrict readonly uniform image2D inImagLaplacianTexture;
+layout(LAPLACIAN_FORMAT, binding = 3) restrict readonly uniform LATTICE_IMAGE inImagLaplacianTexture;
 
 // // In: Phase texture
 // layout(r32f, binding = 4) restrict readonly uniform image2D inPhaseTexture;
@@ -19,6 +19,21 @@ layout(r32f, binding = 3) restrict readonly uniform image2D inImagLaplacianTextu
 layout(location=0) uniform float time;
 layout(location=1) uniform float dt;
 layout(location=2) uniform int era;
+#ifdef LAYER_PARAMETERS
+// Single axion specific parameters in the order of the simulation layout. Integer parameters are stored as floats.
+struct Parameters {
+    float eta;
+    float lam;
+    float colorAnomaly;
+    float axionStrength;
+    float growthScale;
+    float growthLaw;
+};
+// In: Parameters of each layer of a batch
+layout(std430, binding = 0) restrict readonly buffer inLayerParameters {
+    Parameters layerParameters[];
+};
+#else
 // Single axion specific uniform parameters
 layout(location=3) uniform float eta;
 layout(location=4) uniform float lam;
@@ -26,16 +41,26 @@ layout(location=5) uniform int colorAnomaly;
 layout(location=6) uniform float axionStrength;
 layout(location=7) uniform float growthScale;
 layout(location=8) uniform float growthLaw;
+#endif
 
 
-const float ALPHA_2D = 2.0f;
 const float PI = 3.1415926535897932384626433832795f;
 const float EPSILON = 0.01f;
 
 
 void main() {
     // Current position
-    ivec2 pos = ivec2(gl_GlobalInvocationID.xy);
+    LATTICE_POSITION pos = INVOCATION_POSITION;
+#ifdef LAYER_PARAMETERS
+    // Each layer of a batch reads its own parameters in place of the uniforms
+    Parameters parameters = layerParameters[pos.z];
+    float eta = parameters.eta;
+    float lam = parameters.lam;
+    int colorAnomaly = int(parameters.colorAnomaly);
+    float axionStrength = parameters.axionStrength;
+    float growthScale = parameters.growthScale;
+    float growthLaw = parameters.growthLaw;
+#endif
     // Load the field data
     vec4 realField = imageLoad(realFieldTexture, pos);
     vec4 imagField = imageLoad(imagFieldTexture, pos);
@@ -61,7 +86,7 @@ void main() {
     // Laplacian term
     float realNextAcceleration = imageLoad(inRealLaplacianTexture, pos).r;
     // 'Damping' term
-    realNextAcceleration -= ALPHA_2D * (era / time) * realCurrentVelocity;
+    realNextAcceleration -= PRS_ALPHA * (era / time) * realCurrentVelocity;
     // Potential derivative
     realNextAcceleration -= lam * (squareAmplitude - pow(eta, 2)) * realNextValue;
     // Axion contribution
@@ -71,7 +96,7 @@ void main() {
     // Laplacian term
     float imagNextAcceleration = imageLoad(inImagLaplacianTexture, pos).r;
     // 'Damping' term
-    imagNextAcceleration -= ALPHA_2D * (era / time) * imagCurrentVelocity;
+    imagNextAcceleration -= PRS_ALPHA * (era / time) * imagCurrentVelocity;
     // Potential derivative
     imagNextAcceleration -= lam * (squareAmplitude - pow(eta, 2)) * imagNextValue;
     // Axion contribution
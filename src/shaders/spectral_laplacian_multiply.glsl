@@ -0,0 +1,30 @@
+#version 460 core
+// Work groups
+layout(local_size_x = 8, local_size_y = 8, local_size_z = 1) in;
+// In/Out: Transformed fields stored as (real, imaginary)
+layout(rg32f, binding = 0) restrict uniform image2D ioData;
+
+// Uniforms: spatial interval and the factor that normalises the inverse transform
+layout(location=0) uniform float dx;
+layout(location=1) uniform float scale;
+
+const float PI = 3.1415926535897932384626433832795f;
+
+
+// Returns the wavenumber of the given mode along an axis of the given length.
+float getWavenumber(int modeIndex, int length) {
+    int signedIndex = modeIndex > length / 2 ? modeIndex - length : modeIndex;
+    return 2.0f * PI * float(signedIndex) / (float(length) * dx);
+}
+
+void main() {
+    ivec2 pos = ivec2(gl_GlobalInvocationID.xy);
+    ivec2 size = imageSize(ioData);
+    if (pos.x >= size.x || pos.y >= size.y) {
+        return;
+    }
+
+    vec2 wavevector = vec2(getWavenumber(pos.x, size.x), getWavenumber(pos.y, size.y));
+    vec2 mode = imageLoad(ioData, pos).xy;
+    imageStore(ioData, pos, vec4(-scale * dot(wavevector, wavevector) * mode, 0.0f, 0.0f));
+}
\ No newline at end of file
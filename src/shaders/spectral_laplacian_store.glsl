@@ -0,0 +1,27 @@
+#version 460 core
+// Work groups
+layout(local_size_x = 8, local_size_y = 8, local_size_z = 1) in;
+// In: Laplacians stored as (first field, second field)
+layout(rg32f, binding = 0) restrict readonly uniform image2D inData;
+// Out: Laplacian of the first field
+layout(r32f, binding = 1) writeonly uniform image2D outFirstLaplacianTexture;
+// Out: Laplacian of the second field. This is the first Laplacian again if there is no second field.
+layout(r32f, binding = 2) writeonly uniform image2D outSecondLaplacianTexture;
+
+// Uniforms: whether there is a second field
+layout(location=0) uniform int hasSecond;
+
+
+void main() {
+    ivec2 pos = ivec2(gl_GlobalInvocationID.xy);
+    ivec2 size = imageSize(inData);
+    if (pos.x >= size.x || pos.y >= size.y) {
+        return;
+    }
+
+    vec2 laplacians = imageLoad(inData, pos).xy;
+    imageStore(outFirstLaplacianTexture, pos, vec4(laplacians.x, 0.0f, 0.0f, 0.0f));
+    if (hasSecond != 0) {
+        imageStore(outSecondLaplacianTexture, pos, vec4(laplacians.y, 0.0f, 0.0f, 0.0f));
+    }
+}
\ No newline at end of file
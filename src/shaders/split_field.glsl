@@ -0,0 +1,20 @@
+#version 460 core
+// Work group specification
+layout(local_size_x = 8, local_size_y = 8, local_size_z = 1) in;
+// In: Single precision field texture
+layout(rgba32f, binding = 0) restrict readonly uniform image2D inSourceFieldTexture;
+// Out: Field texture
+layout(FIELD_FORMAT, binding = 1) restrict writeonly uniform image2D outFieldTexture;
+// Out: Remainders of the field value and velocity that half precision storage can not hold
+layout(rg16f, binding = 2) restrict writeonly uniform image2D outCompensationTexture;
+
+
+void main() {
+    ivec2 pos = ivec2(gl_GlobalInvocationID.xy);
+    vec4 field = imageLoad(inSourceFieldTexture, pos);
+
+    // Round the value and velocity to half precision and keep the rounding errors
+    vec2 roundedField = unpackHalf2x16(packHalf2x16(field.rg));
+    imageStore(outFieldTexture, pos, vec4(roundedField, field.ba));
+    imageStore(outCompensationTexture, pos, vec4(field.rg - roundedField, 0.0f, 0.0f));
+}
\ No newline at end of file
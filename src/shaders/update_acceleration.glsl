@@ -1,18 +1,15 @@
 #version 460 core
 // Work group specification
-layout(local_size_x = 8, local_size_y = 8, local_size_z = 1) in;
+layout(local_size_x = WORK_GROUP_SIZE_X, local_size_y = WORK_GROUP_SIZE_Y, local_size_z = WORK_GROUP_SIZE_Z) in;
 // In/out: Field texture
-layout(rgba32f, binding = 0) restrict uniform image2D fieldTexture;
+layout(FIELD_FORMAT, binding = 0) restrict uniform LATTICE_IMAGE fieldTexture;
 
 // Uniforms: time interval
 layout(location=0) uniform float dt;
 
-// PRS alpha
-const float ALPHA_2D = 2.0f;
-
 
 void main() {
-    ivec2 pos = ivec2(gl_GlobalInvocationID.xy);
+    LATTICE_POSITION pos = INVOCATION_POSITION;
     vec4 field = imageLoad(fieldTexture, pos);
     float nextValue = field.r;
     float nextVelocity = field.g;
@@ -4,6 +4,7 @@
 #include <cmath>
 #include <filesystem>
 #include <fstream>
+#include <limits>
 #include <sstream>
 #include <random>
 
@@ -12,10 +13,82 @@
 #include <imgui.h>
 
 // Internal libraries
+#include "batch_simulation.h"
+#include "philox.h"
+#include "reference_simulation.h"
 #include "simulation.h"
+#include "volume_simulation.h"
+
+constexpr float PI = 3.1415926535897932384626433832795f;
+// Hubble damping coefficient of a 2D lattice, which is the PRS alpha that PLANE_LATTICE_DEFINES gives the shaders
+constexpr float PRS_ALPHA = 2.0f;
+
+// Helper function that flattens energy budgets into (kinetic, gradient, potential) triples.
+static std::vector<float> flattenEnergyBudgets(const std::vector<EnergyBudget> &energyBudgets)
+{
+    std::vector<float> energies;
+    energies.reserve(3 * energyBudgets.size());
+    for (const auto &energyBudget : energyBudgets)
+    {
+        energies.push_back(energyBudget.kinetic);
+        energies.push_back(energyBudget.gradient);
+        energies.push_back(energyBudget.potential);
+    }
+    return energies;
+}
+
+// Helper function that returns the image format of the fields at the given precision.
+static GLenum getFieldFormat(FieldPrecision precision)
+{
+    return precision == FieldPrecision::HALF ? GL_RGBA16F : GL_RGBA32F;
+}
+
+// Helper function that returns the image format of the Laplacians at the given precision.
+static GLenum getLaplacianFormat(FieldPrecision precision)
+{
+    return precision == FieldPrecision::HALF ? GL_R16F : GL_R32F;
+}
+
+// Defines that specialise the shaders shared with volume simulations to a 2D lattice, with the PRS alpha of two dimensions
+#define PLANE_LATTICE_DEFINES                                                                                  \
+    "#define LATTICE_IMAGE image2D\n#define LATTICE_POSITION ivec2\n"                                            \
+    "#define INVOCATION_POSITION ivec2(gl_GlobalInvocationID.xy)\n"                                               \
+    "#define WORK_GROUP_SIZE_X 8\n#define WORK_GROUP_SIZE_Y 8\n#define WORK_GROUP_SIZE_Z 1\n#define PRS_ALPHA 2.0f\n"
+
+// Helper function that returns the number of bytes per cell of a texture of the given format.
+static uint32_t getBytesPerCell(GLenum format)
+{
+    switch (format)
+    {
+    case GL_RGBA32F:
+        return 16;
+    case GL_RGBA16F:
+        return 8;
+    case GL_RG16F:
+    case GL_R32F:
+        return 4;
+    case GL_R16F:
+        return 2;
+    default:
+        logError("Unknown texture format %d!", format);
+        return 0;
+    }
+}
 
 Simulation::~Simulation()
 {
+    // Finish writing any outstanding saves
+    stopStringLocationStream();
+    stopStringTrackStream();
+    flushIO();
+    delete m_IOService;
+    delete m_Reduction;
+    delete m_PowerSpectrum;
+    delete m_RandomFieldFilter;
+    delete m_SpectralLaplacian;
+    delete m_ComponentLabelling;
+    delete m_MeshRefinement;
+
     // Call destructors
     delete m_EvolveFieldPass;
     delete m_EvolveVelocityPass;
@@ -30,10 +103,22 @@ Simulation::~Simulation()
     {
         delete m_DetectStringsPass;
     }
+    delete m_DetectWallsPass;
+    delete m_CalculateEnergyPass;
+    delete m_SplitFieldPass;
+    delete m_RandomiseFieldPass;
 }
 
 void Simulation::update()
 {
+    // Hand over any snapshots that have arrived to the I/O thread
+    collectSnapshots(false);
+    // Store the last string and wall counts, energy sample, power spectra and components if they have arrived
+    collectDefectCounts(false);
+    collectEnergyBudget(false);
+    collectPowerSpectra(false);
+    collectComponents(false);
+
     // Stop running after hitting max timesteps
     if (m_CurrentTimestep >= maxTimesteps)
     {
@@ -46,67 +131,168 @@ void Simulation::update()
         return;
     }
 
-    // Evolve field and time for all fields first
-    for (size_t fieldIndex = 0; fieldIndex < m_Fields.size(); fieldIndex++)
+    // Each update ends on the next timestep. Adaptive updates can instead span every timestep up to the next sampled one, and
+    // split that span into as many steps as the stability bounds require.
+    bool isRefining = isRefiningDefects();
+    int timestepStride = 1;
+    int numSubsteps = 1;
+    if (adaptiveTimestep)
     {
-        // Calculate and update field
-        m_EvolveFieldPass->use();
-        glUniform1f(0, dt);
-        // Bind read image
-        glActiveTexture(GL_TEXTURE0);
-        glBindImageTexture(0, m_Fields[fieldIndex].textureID, 0, GL_FALSE, 0, GL_READ_WRITE, GL_RGBA32F);
-        // Dispatch and barrier
-        glDispatchCompute(m_XNumGroups, m_YNumGroups, 1);
-        glMemoryBarrier(GL_ALL_BARRIER_BITS);
+        const char *limitingBound = "";
+        float stableDt = calculateStableTimestep(m_CurrentTimestep * dt, limitingBound);
+        if (stableDt >= dt)
+        {
+            // The timesteps up to the next sample are split evenly between the fewest steps that are stable
+            int maxStride = std::clamp((int)(stableDt / dt), 1, std::max(maxTimestepStride, 1));
+            int remainingTimesteps = getTimestepsToNextSample();
+            int numSteps = (remainingTimesteps + maxStride - 1) / maxStride;
+            timestepStride = (remainingTimesteps + numSteps - 1) / numSteps;
+        }
+        else
+        {
+            // A field that moves without any amplitude has no stable step, so it takes the most substeps
+            numSubsteps = stableDt > 0.0f ? (int)std::min(std::ceil(dt / stableDt), (float)std::max(maxSubsteps, 1))
+                                          : std::max(maxSubsteps, 1);
+        }
 
-        // Calculate Laplacian
-        m_CalculateLaplacianPass->use();
-        glUniform1f(0, dx);
-        // Bind images
-        glActiveTexture(GL_TEXTURE0);
-        glBindImageTexture(0, m_Fields[fieldIndex].textureID, 0, GL_FALSE, 0, GL_READ_ONLY, GL_RGBA32F);
-        glActiveTexture(GL_TEXTURE1);
-        glBindImageTexture(1, m_LaplacianTextures[fieldIndex].textureID, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F);
-        // Dispatch and barrier
-        glDispatchCompute(m_XNumGroups, m_YNumGroups, 1);
-        glMemoryBarrier(GL_ALL_BARRIER_BITS);
+        if (timestepStride != m_TimestepStride || numSubsteps != m_NumSubsteps)
+        {
+            logDebug("Timestep %d: taking steps of %g spanning %d timesteps in %d substeps, limited by the %s bound", m_CurrentTimestep,
+                    timestepStride * dt / numSubsteps, timestepStride, numSubsteps, limitingBound);
+            if (numSubsteps * stableDt < dt)
+            {
+                logWarning("Timestep %d: the stable step of %g needs more than %d substeps!", m_CurrentTimestep, stableDt, numSubsteps);
+            }
+            m_TimestepStride = timestepStride;
+            m_NumSubsteps = numSubsteps;
+        }
     }
+    float stepDt = timestepStride * dt / numSubsteps;
+    float startTime = m_CurrentTimestep * dt;
 
-    // Update time
-    m_CurrentTimestep += 1;
-
-    // Calculate phase if there is more than one field
-    if (m_Fields.size() > 1 && m_PhaseTextures.size() > 0)
+    if (!isRefining && m_MeshRefinement != nullptr && m_MeshRefinement->getNumPatches() > 0)
     {
-        calculatePhase();
+        m_MeshRefinement->clear();
     }
-    // Detect strings if requested
-    if (m_HasStrings && m_Fields.size() > 1 && m_StringTextures.size() > 0)
+    for (int substepIndex = 0; substepIndex < numSubsteps; substepIndex++)
     {
-        detectStrings();
-    }
+        float substepStartTime = startTime + substepIndex * stepDt;
+        bool isLastSubstep = substepIndex == numSubsteps - 1;
 
-    // Calculate next acceleration
-    calculateAcceleration();
+        // The ghost cells of the refined patches are interpolated between the fields at the start and end of the step
+        if (isRefining && m_MeshRefinement->getNumPatches() > 0)
+        {
+            m_MeshRefinement->storePreviousFields(m_Fields);
+        }
 
-    // Update velocity
-    for (size_t fieldIndex = 0; fieldIndex < m_Fields.size(); fieldIndex++)
+        // Evolve field and time for all fields first
+        for (size_t fieldIndex = 0; fieldIndex < m_Fields.size(); fieldIndex++)
+        {
+            // Calculate and update field
+            m_EvolveFieldPass->use();
+            glUniform1f(0, stepDt);
+            // Bind read image
+            glActiveTexture(GL_TEXTURE0);
+            glBindImageTexture(0, m_Fields[fieldIndex].textureID, 0, GL_FALSE, 0, GL_READ_WRITE, getFieldFormat(m_Precision));
+            bindCompensationTexture(fieldIndex, 1, GL_READ_WRITE);
+            // Dispatch and barrier
+            glDispatchCompute(m_XNumGroups, m_YNumGroups, 1);
+            glMemoryBarrier(GL_ALL_BARRIER_BITS);
+        }
+        // The spectral Laplacian transforms pairs of fields, so the Laplacians are calculated once every field has been evolved
+        calculateLaplacian();
+
+        // The defects are only detected at the end of the update
+        if (isLastSubstep)
+        {
+            // Update time
+            m_CurrentTimestep += timestepStride;
+
+            // Calculate phase if there is more than one field
+            if (m_Fields.size() > 1 && m_PhaseTextures.size() > 0)
+            {
+                calculatePhase();
+            }
+            // Detect strings if requested
+            if (m_HasStrings && m_Fields.size() > 1 && m_StringTextures.size() > 0)
+            {
+                detectStrings();
+            }
+            // Detect walls if requested
+            if (m_HasWalls && m_WallTextures.size() > 0)
+            {
+                detectWalls();
+            }
+        }
+
+        // Calculate next acceleration
+        calculateAcceleration(substepStartTime + stepDt, stepDt);
+
+        // Update velocity
+        for (size_t fieldIndex = 0; fieldIndex < m_Fields.size(); fieldIndex++)
+        {
+            // Calculate and update the velocity
+            m_EvolveVelocityPass->use();
+            glUniform1f(0, stepDt);
+            // Bind field
+            glActiveTexture(GL_TEXTURE0);
+            glBindImageTexture(0, m_Fields[fieldIndex].textureID, 0, GL_FALSE, 0, GL_READ_WRITE, getFieldFormat(m_Precision));
+            bindCompensationTexture(fieldIndex, 1, GL_READ_WRITE);
+            // Dispatch and barrier
+            glDispatchCompute(m_XNumGroups, m_YNumGroups, 1);
+            glMemoryBarrier(GL_ALL_BARRIER_BITS);
+        }
+
+        updateAcceleration();
+
+        // Catch the refined patches up with the fields
+        if (isRefining)
+        {
+            advanceRefinedPatches(substepStartTime, stepDt);
+        }
+        m_NumSteps++;
+    }
+
+    // Follow the defects with the refined patches
+    if (isRefining && (m_CurrentTimestep - 1) % std::max(regridInterval, 1) == 0)
     {
-        // Calculate and update the velocity
-        m_EvolveVelocityPass->use();
-        glUniform1f(0, dt);
-        // Bind field
-        glActiveTexture(GL_TEXTURE0);
-        glBindImageTexture(0, m_Fields[fieldIndex].textureID, 0, GL_FALSE, 0, GL_READ_WRITE, GL_RGBA32F);
-        // Dispatch and barrier
-        glDispatchCompute(m_XNumGroups, m_YNumGroups, 1);
-        glMemoryBarrier(GL_ALL_BARRIER_BITS);
+        regridRefinedPatches();
     }
 
-    updateAcceleration();
+    // Sample the energy once the velocity has caught up with the field
+    if (energyCadence > 0 && (m_CurrentTimestep - 1) % energyCadence == 0)
+    {
+        calculateEnergy();
+    }
+    // Sample the power spectra
+    if (spectrumCadence > 0 && (m_CurrentTimestep - 1) % spectrumCadence == 0)
+    {
+        calculatePowerSpectra();
+    }
+    // Sample the domains and string clusters
+    if (componentCadence > 0 && (m_CurrentTimestep - 1) % componentCadence == 0)
+    {
+        calculateComponents();
+    }
+    // Sample the field amplitudes alongside the string and wall counts
+    if (isSamplingFieldAmplitudes() && (m_CurrentTimestep - 1) % std::max(stringCountCadence, 1) == 0)
+    {
+        calculateFieldAmplitudes();
+    }
+    // Reduce the fields for the next step while the CPU gets on with the frame
+    if (adaptiveTimestep)
+    {
+        startTimestepReductions();
+    }
 }
 
 void Simulation::bindUniforms()
+{
+    bindUniforms(m_Layout, m_FloatUniforms, m_IntUniforms);
+}
+
+void Simulation::bindUniforms(
+    const SimulationLayout &layout, const std::vector<float> &floatUniforms, const std::vector<int32_t> &intUniforms)
 {
     // The first 3 uniforms are already taken up by dx, dt and era.
     uint32_t currentLocation = 3;
@@ -116,19 +302,19 @@ void Simulation::bindUniforms()
     uint32_t intUniformIndex = 0;
 
     // Iterate through layout and bind uniforms accordingly
-    for (const auto &element : m_Layout.m_Elements)
+    for (const auto &element : layout.m_Elements)
     {
         switch (element.type)
         {
         case UniformDataType::FLOAT:
-            glUniform1f(currentLocation, m_FloatUniforms[floatUniformIndex]);
+            glUniform1f(currentLocation, floatUniforms[floatUniformIndex]);
             // Iterate to next float uniform value
             floatUniformIndex++;
             // Go to next uniform location
             currentLocation++;
             break;
         case UniformDataType::FLOAT2:
-            glUniform2f(currentLocation, m_FloatUniforms[floatUniformIndex], m_FloatUniforms[floatUniformIndex + 1]);
+            glUniform2f(currentLocation, floatUniforms[floatUniformIndex], floatUniforms[floatUniformIndex + 1]);
             // Skip ahead two float values
             floatUniformIndex = floatUniformIndex + 2;
             // Go to next uniform location
@@ -137,9 +323,9 @@ void Simulation::bindUniforms()
         case UniformDataType::FLOAT3:
             glUniform3f(
                 currentLocation,
-                m_FloatUniforms[floatUniformIndex],
-                m_FloatUniforms[floatUniformIndex + 1],
-                m_FloatUniforms[floatUniformIndex + 2]);
+                floatUniforms[floatUniformIndex],
+                floatUniforms[floatUniformIndex + 1],
+                floatUniforms[floatUniformIndex + 2]);
             // Skip ahead three float values
             floatUniformIndex = floatUniformIndex + 3;
             // Go to next uniform location
@@ -148,24 +334,24 @@ void Simulation::bindUniforms()
         case UniformDataType::FLOAT4:
             glUniform4f(
                 currentLocation,
-                m_FloatUniforms[floatUniformIndex],
-                m_FloatUniforms[floatUniformIndex + 1],
-                m_FloatUniforms[floatUniformIndex + 2],
-                m_FloatUniforms[floatUniformIndex + 3]);
+                floatUniforms[floatUniformIndex],
+                floatUniforms[floatUniformIndex + 1],
+                floatUniforms[floatUniformIndex + 2],
+                floatUniforms[floatUniformIndex + 3]);
             // Skip ahead four float values
             floatUniformIndex = floatUniformIndex + 4;
             // Go to next uniform location
             currentLocation++;
             break;
         case UniformDataType::INT:
-            glUniform1i(currentLocation, m_IntUniforms[intUniformIndex]);
+            glUniform1i(currentLocation, intUniforms[intUniformIndex]);
             // Iterate to next integer uniform value
             intUniformIndex++;
             // Go to next uniform location
             currentLocation++;
             break;
         case UniformDataType::INT2:
-            glUniform2i(currentLocation, m_IntUniforms[intUniformIndex], m_IntUniforms[intUniformIndex + 1]);
+            glUniform2i(currentLocation, intUniforms[intUniformIndex], intUniforms[intUniformIndex + 1]);
             // Skip ahead two integer values
             intUniformIndex = intUniformIndex + 2;
             // Go to next uniform location
@@ -174,9 +360,9 @@ void Simulation::bindUniforms()
         case UniformDataType::INT3:
             glUniform3i(
                 currentLocation,
-                m_IntUniforms[intUniformIndex],
-                m_IntUniforms[intUniformIndex + 1],
-                m_IntUniforms[intUniformIndex + 2]);
+                intUniforms[intUniformIndex],
+                intUniforms[intUniformIndex + 1],
+                intUniforms[intUniformIndex + 2]);
             // Skip ahead three integer values
             intUniformIndex = intUniformIndex + 3;
             // Go to next uniform location
@@ -185,10 +371,10 @@ void Simulation::bindUniforms()
         case UniformDataType::INT4:
             glUniform4i(
                 currentLocation,
-                m_IntUniforms[intUniformIndex],
-                m_IntUniforms[intUniformIndex + 1],
-                m_IntUniforms[intUniformIndex + 2],
-                m_IntUniforms[intUniformIndex + 3]);
+                intUniforms[intUniformIndex],
+                intUniforms[intUniformIndex + 1],
+                intUniforms[intUniformIndex + 2],
+                intUniforms[intUniformIndex + 3]);
             // Skip ahead four integer values
             intUniformIndex = intUniformIndex + 4;
             // Go to next uniform location
@@ -210,7 +396,7 @@ void Simulation::onUIRender()
     if (ImGui::Checkbox("Running", &runFlag) && runFlag && m_CurrentTimestep == 1)
     {
         // This should only happen once upon initialisation.
-        calculateAcceleration();
+        calculateAcceleration(m_CurrentTimestep * dt, dt);
         updateAcceleration();
     }
 
@@ -229,6 +415,20 @@ void Simulation::onUIRender()
     // Universal simulation parameters
     ImGui::SliderFloat("dx", &dx, 0.1f, 10.0f);
     ImGui::SliderFloat("dt", &dt, 0.001f, 1.0f);
+    ImGui::Checkbox("Adaptive timestep", &adaptiveTimestep);
+    if (adaptiveTimestep)
+    {
+        ImGui::SliderFloat("Courant number", &courantNumber, 0.05f, 1.0f);
+        if (ImGui::InputInt("Max substeps", &maxSubsteps))
+        {
+            maxSubsteps = std::max(maxSubsteps, 1);
+        }
+        if (ImGui::InputInt("Max timestep stride", &maxTimestepStride))
+        {
+            maxTimestepStride = std::max(maxTimestepStride, 1);
+        }
+        ImGui::Text("Steps taken: %d over %d timesteps", m_NumSteps, m_CurrentTimestep - 1);
+    }
     ImGui::SliderInt("era", &era, 1, 2);
 
     // Uniform indices
@@ -339,9 +539,25 @@ void Simulation::setField(std::vector<std::shared_ptr<Texture2D>> newFields)
         logError("The number of fields to be set is lower than the simulations required amount. Aborting operation.");
         return;
     }
+    // Half precision fields can only be set if they can be split
+    if (m_Precision == FieldPrecision::HALF && m_SplitFieldPass == nullptr)
+    {
+        logError("Can not set half precision fields as the split field pass failed to compile!");
+        return;
+    }
 
     // Reset timestep
     m_CurrentTimestep = 1;
+    m_NumSteps = 0;
+    m_TimestepStride = 1;
+    m_NumSubsteps = 1;
+    // The stable step of the old fields no longer applies
+    m_TimestepQueries.clear();
+    // Refined patches belong to the old fields
+    if (m_MeshRefinement != nullptr)
+    {
+        m_MeshRefinement->clear();
+    }
 
     // TODO: This doesn't need to happen every time we set field. Maybe have two functions, one to set a new field, and one to
     // reset to the original field.
@@ -362,11 +578,34 @@ void Simulation::setField(std::vector<std::shared_ptr<Texture2D>> newFields)
 
         // Allocate data for textures
         glBindTexture(GL_TEXTURE_2D, m_Fields[fieldIndex].textureID);
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA32F, width, height, 0, GL_RGB, GL_FLOAT, NULL);
-        glCopyImageSubData(
-            newFields[fieldIndex]->textureID, GL_TEXTURE_2D, 0, 0, 0, 0,
-            m_Fields[fieldIndex].textureID, GL_TEXTURE_2D, 0, 0, 0, 0,
-            width, height, 1);
+        glTexImage2D(GL_TEXTURE_2D, 0, getFieldFormat(m_Precision), width, height, 0, GL_RGBA, GL_FLOAT, NULL);
+        if (m_Precision == FieldPrecision::HALF)
+        {
+            // Resize compensation texture if necessary
+            if (m_CompensationTextures[fieldIndex].width != width || m_CompensationTextures[fieldIndex].height != height)
+            {
+                m_CompensationTextures[fieldIndex] = Texture2D();
+                glBindTexture(GL_TEXTURE_2D, m_CompensationTextures[fieldIndex].textureID);
+                glTexStorage2D(GL_TEXTURE_2D, 1, GL_RG16F, width, height);
+                m_CompensationTextures[fieldIndex].width = width;
+                m_CompensationTextures[fieldIndex].height = height;
+            }
+
+            // Round the new field to half precision and keep the rounding errors in the compensation texture
+            m_SplitFieldPass->use();
+            glBindImageTexture(0, newFields[fieldIndex]->textureID, 0, GL_FALSE, 0, GL_READ_ONLY, GL_RGBA32F);
+            glBindImageTexture(1, m_Fields[fieldIndex].textureID, 0, GL_FALSE, 0, GL_WRITE_ONLY, getFieldFormat(m_Precision));
+            bindCompensationTexture(fieldIndex, 2, GL_WRITE_ONLY);
+            glDispatchCompute(m_XNumGroups, m_YNumGroups, 1);
+            glMemoryBarrier(GL_ALL_BARRIER_BITS);
+        }
+        else
+        {
+            glCopyImageSubData(
+                newFields[fieldIndex]->textureID, GL_TEXTURE_2D, 0, 0, 0, 0,
+                m_Fields[fieldIndex].textureID, GL_TEXTURE_2D, 0, 0, 0, 0,
+                width, height, 1);
+        }
 
         // Resize Laplacian texture sizes if necessary
         if (m_LaplacianTextures[fieldIndex].width != width || m_LaplacianTextures[fieldIndex].height != height)
@@ -377,7 +616,7 @@ void Simulation::setField(std::vector<std::shared_ptr<Texture2D>> newFields)
             m_LaplacianTextures[fieldIndex].setTextureWrap(TextureWrapAxis::UV, TextureWrapMode::REPEAT);
 
             glBindTexture(GL_TEXTURE_2D, m_LaplacianTextures[fieldIndex].textureID);
-            glTexStorage2D(GL_TEXTURE_2D, 1, GL_R32F, width, height);
+            glTexStorage2D(GL_TEXTURE_2D, 1, getLaplacianFormat(m_Precision), width, height);
             m_LaplacianTextures[fieldIndex].width = width;
             m_LaplacianTextures[fieldIndex].height = height;
         }
@@ -395,8 +634,9 @@ void Simulation::setField(std::vector<std::shared_ptr<Texture2D>> newFields)
                 // Create new texture because old texture is of the wrong size
                 m_PhaseTextures[phaseIndex] = Texture2D();
 
+                // The phase is normalised by pi and stored at 16 bits, giving a maximum error of pi / 65534
                 glBindTexture(GL_TEXTURE_2D, m_PhaseTextures[phaseIndex].textureID);
-                glTexStorage2D(GL_TEXTURE_2D, 1, GL_R32F, width, height);
+                glTexStorage2D(GL_TEXTURE_2D, 1, GL_R16_SNORM, width, height);
                 m_PhaseTextures[phaseIndex].width = width;
                 m_PhaseTextures[phaseIndex].height = height;
             }
@@ -411,21 +651,99 @@ void Simulation::setField(std::vector<std::shared_ptr<Texture2D>> newFields)
                 // Create new texture because old texture is of the wrong size
                 m_StringTextures[stringIndex] = Texture2D();
 
+                // Strings only take the values -1, 0 and +1 so they are stored exactly at 8 bits
                 glBindTexture(GL_TEXTURE_2D, m_StringTextures[stringIndex].textureID);
-                glTexStorage2D(GL_TEXTURE_2D, 1, GL_R32F, width, height);
+                glTexStorage2D(GL_TEXTURE_2D, 1, GL_R8_SNORM, width, height);
                 m_StringTextures[stringIndex].width = width;
                 m_StringTextures[stringIndex].height = height;
             }
             // Clear the phase texture
             glClearTexImage(m_StringTextures[stringIndex].textureID, 0, GL_RGBA, GL_UNSIGNED_BYTE, &clearColor);
+
+            // Every cell records at most one plaquette so a capacity of one record per cell can never overflow
+            uint32_t recordBufferSize = sizeof(uint32_t) * (1 + width * height);
+            if (m_StringRecordBuffers[stringIndex] == nullptr || m_StringRecordBuffers[stringIndex]->size != recordBufferSize)
+            {
+                m_StringRecordBuffers[stringIndex] = std::make_unique<ShaderStorageBuffer>(recordBufferSize, BufferUsageType::DYNAMIC_COPY);
+            }
+        }
+        if (m_WallTextures.size() > 0)
+        {
+            size_t wallIndex = floor(fieldIndex / 2);
+            if (m_WallTextures[wallIndex].width != width || m_WallTextures[wallIndex].height != height)
+            {
+                // Create new texture because old texture is of the wrong size
+                m_WallTextures[wallIndex] = Texture2D();
+
+                // Each cell holds at most 2 crossings which half floats store exactly, as they do sums of up to 2048
+                glBindTexture(GL_TEXTURE_2D, m_WallTextures[wallIndex].textureID);
+                glTexStorage2D(GL_TEXTURE_2D, 1, GL_R16F, width, height);
+                m_WallTextures[wallIndex].width = width;
+                m_WallTextures[wallIndex].height = height;
+            }
+            // Clear the wall texture
+            glClearTexImage(m_WallTextures[wallIndex].textureID, 0, GL_RGBA, GL_UNSIGNED_BYTE, &clearColor);
         }
     }
 
+    // Resize the energy density texture if necessary
+    uint32_t width = m_Fields[0].width;
+    uint32_t height = m_Fields[0].height;
+    if (m_EnergyTexture.width != width || m_EnergyTexture.height != height)
+    {
+        m_EnergyTexture = Texture2D();
+        glBindTexture(GL_TEXTURE_2D, m_EnergyTexture.textureID);
+        glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA32F, width, height);
+        m_EnergyTexture.width = width;
+        m_EnergyTexture.height = height;
+    }
+    // Collect any power spectra of the old fields before the transform is resized
+    collectPowerSpectra(true);
+    // Fields that are not a power of two in size are not transformed
+    if (PowerSpectrum::calculateNumBins(width, height) == 0)
+    {
+        logWarning("Power spectra require power of two dimensions and will not be sampled for fields of size %d x %d.", width, height);
+    }
+    else if (m_PowerSpectrum != nullptr)
+    {
+        m_PowerSpectrum->setSize(width, height);
+    }
+    if (laplacianOperator == LaplacianOperator::SPECTRAL && !isLaplacianSpectral())
+    {
+        logWarning("The spectral Laplacian needs single precision fields that are a power of two in size. Using the stencil for "
+                   "fields of size %d x %d.",
+                   width, height);
+    }
+
+    // Discard any counts of the old fields
+    collectDefectCounts(true);
     // Clear the string count
     for (auto &stringCount : m_StringNumbers)
     {
         stringCount.clear();
     }
+    // Clear the wall count
+    for (auto &wallCount : m_WallNumbers)
+    {
+        wallCount.clear();
+    }
+    // Discard any energy sample of the old fields
+    collectEnergyBudget(true);
+    m_EnergyBudgets.clear();
+    // Discard the power spectra of the old fields
+    m_PowerSpectra.assign(getNumPowerSpectrumChannels(), std::vector<float>());
+    // Start new tracks for the new fields
+    for (auto &stringTracker : m_StringTrackers)
+    {
+        stringTracker.reset(width, height, dx, trackingRadius);
+    }
+    // Discard any components of the old fields
+    collectComponents(true);
+    m_ComponentSummaries.assign(getNumComponentChannels(), std::vector<int32_t>());
+    // Discard the amplitudes and outcome of the old fields
+    collectFieldAmplitudes(true);
+    m_FieldAmplitudes.assign(m_Fields.size(), std::vector<float>());
+    m_OutcomeClassifier.reset();
 
     // Calculate Laplacian, phase and strings
     calculateLaplacian();
@@ -437,216 +755,991 @@ void Simulation::setField(std::vector<std::shared_ptr<Texture2D>> newFields)
     {
         detectStrings();
     }
+    if (m_HasWalls)
+    {
+        detectWalls();
+    }
+    if (energyCadence > 0)
+    {
+        calculateEnergy();
+    }
+    if (spectrumCadence > 0)
+    {
+        calculatePowerSpectra();
+    }
+    if (componentCadence > 0)
+    {
+        calculateComponents();
+    }
+    if (isSamplingFieldAmplitudes())
+    {
+        calculateFieldAmplitudes();
+    }
 }
 
 void Simulation::saveFields(const char *filePath)
 {
-    std::ofstream dataFile;
-    dataFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-    try
+    std::vector<uint32_t> textureIDs;
+    for (const auto &currentField : m_Fields)
     {
-        uint32_t numFields = m_Fields.size();
+        textureIDs.push_back(currentField.textureID);
+    }
 
-        dataFile.open(filePath, std::ios::binary);
-        // Write header
-        dataFile.write(reinterpret_cast<char *>(&numFields), sizeof(uint32_t));
+    std::string path(filePath);
+    uint32_t M = m_Fields[0].height;
+    uint32_t N = m_Fields[0].width;
+    float currentTime = getCurrentSimulationTime();
 
-        // Read data
-        for (const auto &currentField : m_Fields)
+    stageSnapshot(
+        textureIDs, 4,
+        [path, M, N, currentTime](const std::vector<std::vector<float>> &fieldData)
         {
-            glBindTexture(GL_TEXTURE_2D, currentField.textureID);
-            int M, N;
-            int miplevel = 0;
-            float currentTime = getCurrentSimulationTime();
-            glGetTexLevelParameteriv(GL_TEXTURE_2D, miplevel, GL_TEXTURE_HEIGHT, &M);
-            glGetTexLevelParameteriv(GL_TEXTURE_2D, miplevel, GL_TEXTURE_WIDTH, &N);
-            dataFile.write(reinterpret_cast<char *>(&M), sizeof(uint32_t));
-            dataFile.write(reinterpret_cast<char *>(&N), sizeof(uint32_t));
-            dataFile.write(reinterpret_cast<char *>(&currentTime), sizeof(float));
+            std::ofstream dataFile;
+            dataFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
+            try
+            {
+                uint32_t numFields = fieldData.size();
 
-            std::vector<float> textureData(M * N * 4);
+                dataFile.open(path, std::ios::binary);
+                // Write header
+                dataFile.write(reinterpret_cast<char *>(&numFields), sizeof(uint32_t));
 
-            glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GL_FLOAT, static_cast<void *>(textureData.data()));
-            glBindTexture(GL_TEXTURE_2D, 0);
-            for (int rowIndex = 0; rowIndex < M; rowIndex++)
-            {
-                for (int columnIndex = 0; columnIndex < N; columnIndex++)
+                for (const auto &textureData : fieldData)
                 {
-                    size_t currentIndex = (rowIndex * 4 * N) + 4 * columnIndex;
-                    float fieldValue = textureData[currentIndex + 0];
-                    float fieldVelocity = textureData[currentIndex + 1];
-                    dataFile.write(reinterpret_cast<char *>(&fieldValue), sizeof(float));
-                    dataFile.write(reinterpret_cast<char *>(&fieldVelocity), sizeof(float));
+                    uint32_t fieldM = M;
+                    uint32_t fieldN = N;
+                    float fieldTime = currentTime;
+                    dataFile.write(reinterpret_cast<char *>(&fieldM), sizeof(uint32_t));
+                    dataFile.write(reinterpret_cast<char *>(&fieldN), sizeof(uint32_t));
+                    dataFile.write(reinterpret_cast<char *>(&fieldTime), sizeof(float));
+
+                    // Interleave the field value and velocity
+                    std::vector<float> fieldValues(2 * M * N);
+                    for (size_t cellIndex = 0; cellIndex < (size_t)M * N; cellIndex++)
+                    {
+                        fieldValues[2 * cellIndex + 0] = textureData[4 * cellIndex + 0];
+                        fieldValues[2 * cellIndex + 1] = textureData[4 * cellIndex + 1];
+                    }
+                    dataFile.write(reinterpret_cast<char *>(fieldValues.data()), fieldValues.size() * sizeof(float));
                 }
+
+                dataFile.close();
+                logTrace("Successfully wrote field data to binary file at path %s", path.c_str());
             }
-        }
+            catch (std::ifstream::failure &e)
+            {
+                logError("Failed to open file to write to at path: %s - %s", path.c_str(), e.what());
+            }
+        });
+}
 
-        dataFile.close();
-        logTrace("Successfully wrote field data to binary file at path %s", filePath);
-    }
-    catch (std::ifstream::failure &e)
+void Simulation::saveTypedFields(const char *filePath, ChannelEncoding encoding)
+{
+    std::vector<uint32_t> textureIDs;
+    for (const auto &currentField : m_Fields)
     {
-        logError("Failed to open file to write to at path: %s - %s", filePath, e.what());
+        textureIDs.push_back(currentField.textureID);
     }
+
+    std::string path(filePath);
+    uint32_t M = m_Fields[0].height;
+    uint32_t N = m_Fields[0].width;
+    float currentTime = getCurrentSimulationTime();
+
+    stageSnapshot(
+        textureIDs, 4,
+        [path, M, N, currentTime, encoding](const std::vector<std::vector<float>> &fieldData)
+        {
+            std::ofstream dataFile;
+            dataFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
+            try
+            {
+                // Each field is written as two channels, the field value and the field velocity
+                uint32_t numChannels = 2 * fieldData.size();
+
+                dataFile.open(path, std::ios::binary);
+                // Write header
+                dataFile.write(reinterpret_cast<char *>(&numChannels), sizeof(uint32_t));
+
+                for (const auto &textureData : fieldData)
+                {
+                    // Split the field value and velocity into separate channels
+                    std::vector<float> fieldValues(M * N);
+                    std::vector<float> fieldVelocities(M * N);
+                    for (size_t cellIndex = 0; cellIndex < (size_t)M * N; cellIndex++)
+                    {
+                        fieldValues[cellIndex] = textureData[4 * cellIndex + 0];
+                        fieldVelocities[cellIndex] = textureData[4 * cellIndex + 1];
+                    }
+
+                    writeEncodedChannel(dataFile, M, N, currentTime, encoding, fieldValues);
+                    writeEncodedChannel(dataFile, M, N, currentTime, encoding, fieldVelocities);
+                }
+
+                dataFile.close();
+                logTrace(
+                    "Successfully wrote %s field data to binary file at path %s",
+                    convertChannelEncodingToString(encoding).c_str(), path.c_str());
+            }
+            catch (std::ifstream::failure &e)
+            {
+                logError("Failed to open file to write to at path: %s - %s", path.c_str(), e.what());
+            }
+        });
 }
 
-void Simulation::saveLaplacians(const char *filePath)
+// Helper function that writes each texture of a snapshot as a single typed data channel.
+static void writeTypedChannels(
+    const std::string &path, uint32_t M, uint32_t N, float currentTime, ChannelEncoding encoding,
+    const std::vector<std::vector<float>> &channelData)
 {
     std::ofstream dataFile;
     dataFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
     try
     {
-        uint32_t numFields = m_LaplacianTextures.size();
+        uint32_t numChannels = channelData.size();
 
-        dataFile.open(filePath, std::ios::binary);
+        dataFile.open(path, std::ios::binary);
         // Write header
-        dataFile.write(reinterpret_cast<char *>(&numFields), sizeof(uint32_t));
+        dataFile.write(reinterpret_cast<char *>(&numChannels), sizeof(uint32_t));
 
-        // Read data
-        for (const auto &currentLaplacian : m_LaplacianTextures)
+        for (const auto &textureData : channelData)
         {
-            glBindTexture(GL_TEXTURE_2D, currentLaplacian.textureID);
-            int M, N;
-            int miplevel = 0;
-            float currentTime = getCurrentSimulationTime();
-            glGetTexLevelParameteriv(GL_TEXTURE_2D, miplevel, GL_TEXTURE_HEIGHT, &M);
-            glGetTexLevelParameteriv(GL_TEXTURE_2D, miplevel, GL_TEXTURE_WIDTH, &N);
-            dataFile.write(reinterpret_cast<char *>(&M), sizeof(uint32_t));
-            dataFile.write(reinterpret_cast<char *>(&N), sizeof(uint32_t));
-            dataFile.write(reinterpret_cast<char *>(&currentTime), sizeof(float));
-
-            std::vector<float> textureData(M * N);
-
-            glGetTexImage(GL_TEXTURE_2D, 0, GL_RED, GL_FLOAT, static_cast<void *>(textureData.data()));
-            glBindTexture(GL_TEXTURE_2D, 0);
-            for (int rowIndex = 0; rowIndex < M; rowIndex++)
-            {
-                for (int columnIndex = 0; columnIndex < N; columnIndex++)
-                {
-                    size_t currentIndex = (rowIndex * N) + columnIndex;
-                    float laplacianValue = textureData[currentIndex];
-                    float fillerValue = 0;
-                    dataFile.write(reinterpret_cast<char *>(&laplacianValue), sizeof(float));
-                    dataFile.write(reinterpret_cast<char *>(&fillerValue), sizeof(float));
-                }
-            }
+            writeEncodedChannel(dataFile, M, N, currentTime, encoding, textureData);
         }
 
         dataFile.close();
-        logTrace("Successfully wrote Laplacian data to binary file at path %s", filePath);
+        logTrace(
+            "Successfully wrote %s data to binary file at path %s", convertChannelEncodingToString(encoding).c_str(), path.c_str());
     }
     catch (std::ifstream::failure &e)
     {
-        logError("Failed to open file to write to at path: %s - %s", filePath, e.what());
+        logError("Failed to open file to write to at path: %s - %s", path.c_str(), e.what());
     }
 }
 
-void Simulation::savePhases(const char *filePath)
+void Simulation::saveLaplacians(const char *filePath, ChannelEncoding encoding)
 {
-    std::ofstream dataFile;
-    dataFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-    try
+    std::vector<uint32_t> textureIDs;
+    for (const auto &currentLaplacian : m_LaplacianTextures)
     {
-        uint32_t numFields = m_PhaseTextures.size();
+        textureIDs.push_back(currentLaplacian.textureID);
+    }
 
-        dataFile.open(filePath, std::ios::binary);
-        // Write header
-        dataFile.write(reinterpret_cast<char *>(&numFields), sizeof(uint32_t));
+    std::string path(filePath);
+    uint32_t M = m_LaplacianTextures[0].height;
+    uint32_t N = m_LaplacianTextures[0].width;
+    float currentTime = getCurrentSimulationTime();
 
-        // Read data
-        for (const auto &currentPhase : m_PhaseTextures)
+    stageSnapshot(
+        textureIDs, 1,
+        [path, M, N, currentTime, encoding](const std::vector<std::vector<float>> &laplacianData)
         {
-            glBindTexture(GL_TEXTURE_2D, currentPhase.textureID);
-            int M, N;
-            int miplevel = 0;
-            float currentTime = getCurrentSimulationTime();
-            glGetTexLevelParameteriv(GL_TEXTURE_2D, miplevel, GL_TEXTURE_HEIGHT, &M);
-            glGetTexLevelParameteriv(GL_TEXTURE_2D, miplevel, GL_TEXTURE_WIDTH, &N);
-            dataFile.write(reinterpret_cast<char *>(&M), sizeof(uint32_t));
-            dataFile.write(reinterpret_cast<char *>(&N), sizeof(uint32_t));
-            dataFile.write(reinterpret_cast<char *>(&currentTime), sizeof(float));
+            writeTypedChannels(path, M, N, currentTime, encoding, laplacianData);
+        });
+}
 
-            std::vector<float> textureData(M * N);
+void Simulation::savePhases(const char *filePath)
+{
+    // Need a non-zero size list
+    if (m_PhaseTextures.size() == 0)
+    {
+        return;
+    }
+
+    std::vector<uint32_t> textureIDs;
+    for (const auto &currentPhase : m_PhaseTextures)
+    {
+        textureIDs.push_back(currentPhase.textureID);
+    }
+
+    std::string path(filePath);
+    uint32_t M = m_PhaseTextures[0].height;
+    uint32_t N = m_PhaseTextures[0].width;
+    float currentTime = getCurrentSimulationTime();
 
-            glGetTexImage(GL_TEXTURE_2D, 0, GL_RED, GL_FLOAT, static_cast<void *>(textureData.data()));
-            glBindTexture(GL_TEXTURE_2D, 0);
-            for (int rowIndex = 0; rowIndex < M; rowIndex++)
+    stageSnapshot(
+        textureIDs, 1,
+        [path, M, N, currentTime](const std::vector<std::vector<float>> &phaseData)
+        {
+            // The phase texture is normalised by pi
+            std::vector<std::vector<float>> phases(phaseData);
+            for (auto &currentPhases : phases)
             {
-                for (int columnIndex = 0; columnIndex < N; columnIndex++)
+                for (float &phaseValue : currentPhases)
                 {
-                    size_t currentIndex = (rowIndex * N) + columnIndex;
-                    float phaseValue = textureData[currentIndex];
-                    float fillerValue = 0;
-                    dataFile.write(reinterpret_cast<char *>(&phaseValue), sizeof(float));
-                    dataFile.write(reinterpret_cast<char *>(&fillerValue), sizeof(float));
+                    phaseValue *= PI;
                 }
             }
-        }
+            writeTypedChannels(path, M, N, currentTime, ChannelEncoding::PHASE_UINT16, phases);
+        });
+}
 
-        dataFile.close();
-        logTrace("Successfully wrote phase data to binary file at path %s", filePath);
+void Simulation::saveStrings(const char *filePath)
+{
+    // Need a non-zero size list
+    if (m_StringTextures.size() == 0)
+    {
+        return;
     }
-    catch (std::ifstream::failure &e)
+
+    std::vector<uint32_t> textureIDs;
+    for (const auto &currentStrings : m_StringTextures)
     {
-        logError("Failed to open file to write to at path: %s - %s", filePath, e.what());
+        textureIDs.push_back(currentStrings.textureID);
     }
+
+    std::string path(filePath);
+    uint32_t M = m_StringTextures[0].height;
+    uint32_t N = m_StringTextures[0].width;
+    float currentTime = getCurrentSimulationTime();
+
+    stageSnapshot(
+        textureIDs, 1,
+        [path, M, N, currentTime](const std::vector<std::vector<float>> &stringData)
+        {
+            writeTypedChannels(path, M, N, currentTime, ChannelEncoding::STRING_2BIT, stringData);
+        });
 }
 
 void Simulation::saveStringNumbers(const char *filePath)
 {
+    collectDefectCounts(true);
     // Need a non-zero size list
     if (m_StringNumbers.size() == 0)
     {
         return;
     }
 
-    std::ofstream dataFile;
-    dataFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-    try
-    {
-        // Open file
-        dataFile.open(filePath, std::ios::binary);
-        // Number of string fields
-        uint32_t numStringFields = m_StringNumbers.size();
-        dataFile.write(reinterpret_cast<char *>(&numStringFields), sizeof(uint32_t));
-        // Write the number of timesteps. This should be the same across both
-        uint32_t numTimesteps = m_StringNumbers[0].size();
-        dataFile.write(reinterpret_cast<char *>(&numTimesteps), sizeof(uint32_t));
-        // The time step used
-        dataFile.write(reinterpret_cast<char *>(&dt), sizeof(float));
+    // The string numbers are already on the CPU so they only need to be copied
+    std::string path(filePath);
+    std::vector<std::vector<int>> stringNumbers(m_StringNumbers);
+    float timestepSize = dt;
 
-        for (size_t fieldIndex = 0; fieldIndex < m_StringNumbers.size(); fieldIndex++)
+    submitIO(
+        [path, stringNumbers, timestepSize]()
         {
-            // Read data
-            for (int stringCount : m_StringNumbers[fieldIndex])
+            std::ofstream dataFile;
+            dataFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
+            try
+            {
+                // Open file
+                dataFile.open(path, std::ios::binary);
+                // Number of string fields
+                uint32_t numStringFields = stringNumbers.size();
+                dataFile.write(reinterpret_cast<char *>(&numStringFields), sizeof(uint32_t));
+                // Write the number of timesteps. This should be the same across both
+                uint32_t numTimesteps = stringNumbers[0].size();
+                dataFile.write(reinterpret_cast<char *>(&numTimesteps), sizeof(uint32_t));
+                // The time step used
+                float currentDt = timestepSize;
+                dataFile.write(reinterpret_cast<char *>(&currentDt), sizeof(float));
+
+                for (const auto &currentStringNumbers : stringNumbers)
+                {
+                    dataFile.write(reinterpret_cast<const char *>(currentStringNumbers.data()), currentStringNumbers.size() * sizeof(int));
+                }
+                // Structure is: Number of string fields = n -> Number of timesteps (n of these) = m -> String counts (m of these)
+
+                dataFile.close();
+                logTrace("Successfully wrote string count data to binary file at path %s", path.c_str());
+            }
+            catch (std::ifstream::failure &e)
             {
-                dataFile.write(reinterpret_cast<char *>(&stringCount), sizeof(int));
+                logError("Failed to open file to write to at path: %s - %s", path.c_str(), e.what());
             }
-        }
-        // Structure is: Number of string fields = n -> Number of timesteps (n of these) = m -> String counts (m of these)
+        });
+}
 
-        dataFile.close();
-        logTrace("Successfully wrote string count data to binary file at path %s", filePath);
-    }
-    catch (std::ifstream::failure &e)
+void Simulation::saveEnergies(const char *filePath)
+{
+    std::vector<EnergyBudget> energyBudgets = getEnergyBudgets();
+    if (energyBudgets.size() == 0)
     {
-        logError("Failed to open file to write to at path: %s - %s", filePath, e.what());
+        return;
     }
-}
 
-Texture2D *Simulation::getRenderTexture(uint32_t fieldIndex)
-{
-    return &m_Fields[fieldIndex];
+    // A single trial ensemble can be read with the same tools as the ensembles of random trials
+    EnsembleHeader header;
+    header.dataType = EnsembleDataType::FLOAT32;
+    header.numChannels = 1;
+    header.numTrials = 1;
+    header.numSamples = energyBudgets.size();
+    header.valuesPerSample = 3;
+    header.cadence = std::max(energyCadence, 1);
+    header.maxTimesteps = m_CurrentTimestep;
+    header.width = m_Fields[0].width;
+    header.height = m_Fields[0].height;
+    header.era = era;
+    header.dt = dt;
+    header.dx = dx;
+    header.modelName = convertSimulationModelToString(m_Model);
+    header.parameters = getParameters();
+    header.seeds.push_back(0);
+
+    std::string path(filePath);
+    submitIO(
+        [path, header, energyBudgets]()
+        {
+            EnsembleFile *energyFile = EnsembleFile::create(path.c_str(), header);
+            if (energyFile == nullptr)
+            {
+                return;
+            }
+            energyFile->writeSamples(0, 0, flattenEnergyBudgets(energyBudgets));
+            energyFile->completeTrial();
+            delete energyFile;
+            logTrace("Successfully wrote energy budgets to ensemble file at path %s", path.c_str());
+        });
 }
 
-Texture2D *Simulation::getCurrentRenderTexture()
+void Simulation::savePowerSpectra(const char *filePath)
 {
-    return &m_Fields[m_RenderIndex];
+    std::vector<std::vector<float>> powerSpectra = getPowerSpectra();
+    uint32_t numBins = getNumPowerSpectrumBins();
+    if (numBins == 0 || powerSpectra.size() == 0 || powerSpectra[0].size() == 0)
+    {
+        return;
+    }
+
+    EnsembleHeader header;
+    header.dataType = EnsembleDataType::FLOAT32;
+    header.numChannels = powerSpectra.size();
+    header.numTrials = 1;
+    header.numSamples = powerSpectra[0].size() / numBins;
+    header.valuesPerSample = numBins;
+    header.cadence = std::max(spectrumCadence, 1);
+    header.maxTimesteps = m_CurrentTimestep;
+    header.width = m_Fields[0].width;
+    header.height = m_Fields[0].height;
+    header.era = era;
+    header.dt = dt;
+    header.dx = dx;
+    header.modelName = convertSimulationModelToString(m_Model);
+    header.parameters = getParameters();
+    header.seeds.push_back(0);
+
+    std::string path(filePath);
+    submitIO(
+        [path, header, powerSpectra]()
+        {
+            EnsembleFile *spectrumFile = EnsembleFile::create(path.c_str(), header);
+            if (spectrumFile == nullptr)
+            {
+                return;
+            }
+            for (size_t channelIndex = 0; channelIndex < powerSpectra.size(); channelIndex++)
+            {
+                spectrumFile->writeSamples(channelIndex, 0, powerSpectra[channelIndex]);
+            }
+            spectrumFile->completeTrial();
+            delete spectrumFile;
+            logTrace("Successfully wrote power spectra to ensemble file at path %s", path.c_str());
+        });
 }
-Texture2D *Simulation::getCurrentRealTexture()
+
+void Simulation::startStringLocationStream(const char *filePath)
 {
-    size_t realIndex = 2 * floor(m_RenderIndex / 2);
-    return &m_Fields[realIndex];
+    // Need a non-zero size list
+    if (m_StringTextures.size() == 0)
+    {
+        return;
+    }
+    stopStringLocationStream();
+
+    std::shared_ptr<std::ofstream> dataFile = std::make_shared<std::ofstream>();
+    dataFile->exceptions(std::ofstream::failbit | std::ofstream::badbit);
+    try
+    {
+        dataFile->open(filePath, std::ios::binary | std::ios::trunc);
+    }
+    catch (std::ofstream::failure &e)
+    {
+        logError("Failed to open file to write to at path: %s - %s", filePath, e.what());
+        return;
+    }
+
+    uint32_t numStringFields = m_StringTextures.size();
+    uint32_t M = m_StringTextures[0].height;
+    uint32_t N = m_StringTextures[0].width;
+    float timestepSize = dt;
+    std::string path(filePath);
+    submitIO(
+        [dataFile, numStringFields, M, N, timestepSize, path]()
+        {
+            try
+            {
+                // Header: Number of string fields -> M -> N -> dt. Frames follow until the end of the file.
+                uint32_t headerValues[3] = {numStringFields, M, N};
+                float headerDt = timestepSize;
+                dataFile->write(reinterpret_cast<char *>(headerValues), sizeof(headerValues));
+                dataFile->write(reinterpret_cast<char *>(&headerDt), sizeof(float));
+                logTrace("Started streaming string locations to path %s", path.c_str());
+            }
+            catch (std::ofstream::failure &e)
+            {
+                logError("Failed to write string location header at path: %s - %s", path.c_str(), e.what());
+            }
+        });
+    m_StringLocationStream = dataFile;
+}
+
+void Simulation::stopStringLocationStream()
+{
+    if (m_StringLocationStream == nullptr)
+    {
+        return;
+    }
+
+    // Close the file after every queued frame has been written
+    std::shared_ptr<std::ofstream> dataFile = m_StringLocationStream;
+    m_StringLocationStream = nullptr;
+    submitIO(
+        [dataFile]()
+        {
+            try
+            {
+                dataFile->close();
+            }
+            catch (std::ofstream::failure &e)
+            {
+                logError("Failed to close string location file - %s", e.what());
+            }
+        });
+}
+
+void Simulation::startStringTrackStream(const char *filePath)
+{
+    // Need a non-zero size list
+    if (m_StringTextures.size() == 0)
+    {
+        return;
+    }
+    stopStringTrackStream();
+
+    std::shared_ptr<std::ofstream> dataFile = std::make_shared<std::ofstream>();
+    dataFile->exceptions(std::ofstream::failbit | std::ofstream::badbit);
+    try
+    {
+        dataFile->open(filePath, std::ios::binary | std::ios::trunc);
+    }
+    catch (std::ofstream::failure &e)
+    {
+        logError("Failed to open file to write to at path: %s - %s", filePath, e.what());
+        return;
+    }
+
+    uint32_t numStringFields = m_StringTextures.size();
+    uint32_t M = m_StringTextures[0].height;
+    uint32_t N = m_StringTextures[0].width;
+    float timestepSize = dt;
+    float spacing = dx;
+    std::string path(filePath);
+    submitIO(
+        [dataFile, numStringFields, M, N, timestepSize, spacing, path]()
+        {
+            try
+            {
+                // Header: Number of string fields -> M -> N -> dt -> dx. Frames follow until the end of the file.
+                uint32_t headerValues[3] = {numStringFields, M, N};
+                float headerSpacings[2] = {timestepSize, spacing};
+                dataFile->write(reinterpret_cast<char *>(headerValues), sizeof(headerValues));
+                dataFile->write(reinterpret_cast<char *>(headerSpacings), sizeof(headerSpacings));
+                logTrace("Started streaming string tracks to path %s", path.c_str());
+            }
+            catch (std::ofstream::failure &e)
+            {
+                logError("Failed to write string track header at path: %s - %s", path.c_str(), e.what());
+            }
+        });
+    m_StringTrackStream = dataFile;
+}
+
+void Simulation::stopStringTrackStream()
+{
+    if (m_StringTrackStream == nullptr)
+    {
+        return;
+    }
+
+    // Close the file after every queued frame has been written
+    std::shared_ptr<std::ofstream> dataFile = m_StringTrackStream;
+    m_StringTrackStream = nullptr;
+    submitIO(
+        [dataFile]()
+        {
+            try
+            {
+                dataFile->close();
+            }
+            catch (std::ofstream::failure &e)
+            {
+                logError("Failed to close string track file - %s", e.what());
+            }
+        });
+}
+
+void Simulation::saveCheckpoint(const char *filePath, uint32_t trialIndex, uint32_t seed)
+{
+    // The compensation of half precision fields is read back after the fields
+    std::vector<uint32_t> textureIDs;
+    for (const auto &currentField : m_Fields)
+    {
+        textureIDs.push_back(currentField.textureID);
+    }
+    for (const auto &currentCompensation : m_CompensationTextures)
+    {
+        textureIDs.push_back(currentCompensation.textureID);
+    }
+
+    std::string path(filePath);
+    uint32_t M = m_Fields[0].height;
+    uint32_t N = m_Fields[0].width;
+    uint32_t numFields = m_Fields.size();
+    int timestep = m_CurrentTimestep;
+    collectDefectCounts(true);
+    std::vector<std::vector<int>> stringNumbers(m_StringNumbers);
+    std::vector<std::vector<int>> wallNumbers(m_WallNumbers);
+    std::vector<EnergyBudget> energyBudgets = getEnergyBudgets();
+    std::vector<std::vector<float>> powerSpectra = getPowerSpectra();
+    std::vector<std::vector<int32_t>> componentSummaries = getComponentSummaries();
+    collectFieldAmplitudes(true);
+    std::vector<std::vector<float>> fieldAmplitudes(m_FieldAmplitudes);
+
+    // Write the full state of each field including the accelerations so that the trial continues exactly
+    stageSnapshot(
+        textureIDs, 4,
+        [path, M, N, numFields, timestep, stringNumbers, wallNumbers, energyBudgets, powerSpectra, componentSummaries,
+         fieldAmplitudes, trialIndex, seed](const std::vector<std::vector<float>> &fieldData)
+        {
+            // Write to a temporary file first so that a crash never leaves a partially written checkpoint behind
+            std::string tempPath = path + ".tmp";
+
+            std::ofstream dataFile;
+            dataFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
+            try
+            {
+                // Open file
+                dataFile.open(tempPath, std::ios::binary | std::ios::trunc);
+                // Trial identity
+                uint32_t checkpointTrialIndex = trialIndex;
+                uint32_t checkpointSeed = seed;
+                int checkpointTimestep = timestep;
+                dataFile.write(reinterpret_cast<char *>(&checkpointTrialIndex), sizeof(uint32_t));
+                dataFile.write(reinterpret_cast<char *>(&checkpointSeed), sizeof(uint32_t));
+                // Current timestep
+                dataFile.write(reinterpret_cast<char *>(&checkpointTimestep), sizeof(int));
+
+                uint32_t checkpointNumFields = numFields;
+                dataFile.write(reinterpret_cast<char *>(&checkpointNumFields), sizeof(uint32_t));
+                for (size_t fieldIndex = 0; fieldIndex < numFields; fieldIndex++)
+                {
+                    const auto &textureData = fieldData[fieldIndex];
+                    uint32_t fieldM = M;
+                    uint32_t fieldN = N;
+                    dataFile.write(reinterpret_cast<char *>(&fieldM), sizeof(uint32_t));
+                    dataFile.write(reinterpret_cast<char *>(&fieldN), sizeof(uint32_t));
+                    dataFile.write(reinterpret_cast<const char *>(textureData.data()), textureData.size() * sizeof(float));
+                }
+
+                // String numbers recorded so far
+                uint32_t numStringFields = stringNumbers.size();
+                dataFile.write(reinterpret_cast<char *>(&numStringFields), sizeof(uint32_t));
+                for (const auto &currentStringNumbers : stringNumbers)
+                {
+                    uint32_t numSamples = currentStringNumbers.size();
+                    dataFile.write(reinterpret_cast<char *>(&numSamples), sizeof(uint32_t));
+                    dataFile.write(reinterpret_cast<const char *>(currentStringNumbers.data()), numSamples * sizeof(int));
+                }
+
+                // Energy budgets recorded so far
+                uint32_t numEnergySamples = energyBudgets.size();
+                dataFile.write(reinterpret_cast<char *>(&numEnergySamples), sizeof(uint32_t));
+                for (const auto &energyBudget : energyBudgets)
+                {
+                    float energies[3] = {energyBudget.kinetic, energyBudget.gradient, energyBudget.potential};
+                    dataFile.write(reinterpret_cast<char *>(energies), sizeof(energies));
+                }
+
+                // Power spectra recorded so far
+                uint32_t numSpectrumChannels = powerSpectra.size();
+                dataFile.write(reinterpret_cast<char *>(&numSpectrumChannels), sizeof(uint32_t));
+                for (const auto &powerSpectrum : powerSpectra)
+                {
+                    uint32_t numValues = powerSpectrum.size();
+                    dataFile.write(reinterpret_cast<char *>(&numValues), sizeof(uint32_t));
+                    dataFile.write(reinterpret_cast<const char *>(powerSpectrum.data()), numValues * sizeof(float));
+                }
+
+                // Wall numbers recorded so far
+                uint32_t numWallFields = wallNumbers.size();
+                dataFile.write(reinterpret_cast<char *>(&numWallFields), sizeof(uint32_t));
+                for (const auto &currentWallNumbers : wallNumbers)
+                {
+                    uint32_t numSamples = currentWallNumbers.size();
+                    dataFile.write(reinterpret_cast<char *>(&numSamples), sizeof(uint32_t));
+                    dataFile.write(reinterpret_cast<const char *>(currentWallNumbers.data()), numSamples * sizeof(int));
+                }
+
+                // Component summaries recorded so far
+                uint32_t numComponentChannels = componentSummaries.size();
+                dataFile.write(reinterpret_cast<char *>(&numComponentChannels), sizeof(uint32_t));
+                for (const auto &currentSummaries : componentSummaries)
+                {
+                    uint32_t numValues = currentSummaries.size();
+                    dataFile.write(reinterpret_cast<char *>(&numValues), sizeof(uint32_t));
+                    dataFile.write(reinterpret_cast<const char *>(currentSummaries.data()), numValues * sizeof(int32_t));
+                }
+
+                // Field amplitudes recorded so far
+                uint32_t numAmplitudeFields = fieldAmplitudes.size();
+                dataFile.write(reinterpret_cast<char *>(&numAmplitudeFields), sizeof(uint32_t));
+                for (const auto &currentAmplitudes : fieldAmplitudes)
+                {
+                    uint32_t numSamples = currentAmplitudes.size();
+                    dataFile.write(reinterpret_cast<char *>(&numSamples), sizeof(uint32_t));
+                    dataFile.write(reinterpret_cast<const char *>(currentAmplitudes.data()), numSamples * sizeof(float));
+                }
+
+                // Rounding errors of the value and velocity of half precision fields
+                uint32_t numCompensatedFields = fieldData.size() - numFields;
+                dataFile.write(reinterpret_cast<char *>(&numCompensatedFields), sizeof(uint32_t));
+                for (size_t textureIndex = numFields; textureIndex < fieldData.size(); textureIndex++)
+                {
+                    std::vector<float> compensation(2 * M * N);
+                    for (size_t cellIndex = 0; cellIndex < (size_t)M * N; cellIndex++)
+                    {
+                        compensation[2 * cellIndex + 0] = fieldData[textureIndex][4 * cellIndex + 0];
+                        compensation[2 * cellIndex + 1] = fieldData[textureIndex][4 * cellIndex + 1];
+                    }
+                    dataFile.write(reinterpret_cast<const char *>(compensation.data()), compensation.size() * sizeof(float));
+                }
+                // Structure is: Trial index -> Seed -> Timestep -> Number of fields = n -> (M -> N -> RGBA data) (n of these) ->
+                // Number of string fields = m -> (Number of samples = k -> String counts (k of these)) (m of these) ->
+                // Number of energy samples = e -> (Kinetic -> Gradient -> Potential) (e of these) ->
+                // Number of spectrum channels = c -> (Number of values = v -> Binned powers (v of these)) (c of these) ->
+                // Number of wall fields = w -> (Number of samples = k -> Wall counts (k of these)) (w of these) ->
+                // Number of component channels = c -> (Number of values = v -> Component summaries (v of these)) (c of these) ->
+                // Number of amplitude fields = a -> (Number of samples = k -> Root mean square amplitudes (k of these)) (a of these) ->
+                // Number of compensated fields = h -> (Value and velocity compensation (M * N of these)) (h of these)
+
+                dataFile.close();
+                std::filesystem::rename(tempPath, path);
+                logTrace("Saved checkpoint of trial %d at timestep %d to path %s", trialIndex, timestep, path.c_str());
+            }
+            catch (std::ifstream::failure &e)
+            {
+                logError("Failed to open file to write to at path: %s - %s", tempPath.c_str(), e.what());
+            }
+            catch (std::filesystem::filesystem_error &e)
+            {
+                logError("Failed to replace checkpoint at path: %s - %s", path.c_str(), e.what());
+            }
+        });
+}
+
+void Simulation::stageSnapshot(const std::vector<uint32_t> &textureIDs, uint32_t numComponents, SnapshotWriter writer)
+{
+    // Both slots are in flight so hand the older snapshot over before reusing its slot
+    SnapshotStagingSlot &slot = m_StagingSlots[m_NextStagingSlot];
+    if (slot.isPending)
+    {
+        collectSnapshots(true);
+    }
+    m_NextStagingSlot = (m_NextStagingSlot + 1) % 2;
+
+    uint32_t width = m_Fields[0].width;
+    uint32_t height = m_Fields[0].height;
+    GLenum format = numComponents == 4 ? GL_RGBA : GL_RED;
+
+    while (slot.readbackBuffers.size() < textureIDs.size())
+    {
+        slot.readbackBuffers.push_back(std::make_unique<ReadbackBuffer>());
+    }
+    slot.numTextures = textureIDs.size();
+    slot.numValues = width * height * numComponents;
+    slot.writer = writer;
+    slot.isPending = true;
+
+    // Make compute shader writes visible to the readback
+    glMemoryBarrier(GL_PIXEL_BUFFER_BARRIER_BIT | GL_TEXTURE_UPDATE_BARRIER_BIT);
+    for (size_t textureIndex = 0; textureIndex < textureIDs.size(); textureIndex++)
+    {
+        slot.readbackBuffers[textureIndex]->readTexture(textureIDs[textureIndex], format, GL_FLOAT, slot.numValues * sizeof(float));
+    }
+}
+
+void Simulation::collectSnapshots(bool wait)
+{
+    // Collect the older slot first so that writes stay in submission order
+    for (uint32_t slotOffset = 0; slotOffset < 2; slotOffset++)
+    {
+        SnapshotStagingSlot &slot = m_StagingSlots[(m_NextStagingSlot + slotOffset) % 2];
+        if (!slot.isPending)
+        {
+            continue;
+        }
+
+        // Check if every readback has arrived
+        bool isReady = true;
+        for (uint32_t textureIndex = 0; textureIndex < slot.numTextures; textureIndex++)
+        {
+            isReady = isReady && slot.readbackBuffers[textureIndex]->isReady();
+        }
+        if (!isReady && !wait)
+        {
+            // Later snapshots can not be written before this one
+            return;
+        }
+
+        std::vector<std::vector<float>> snapshotData(slot.numTextures, std::vector<float>(slot.numValues));
+        for (uint32_t textureIndex = 0; textureIndex < slot.numTextures; textureIndex++)
+        {
+            slot.readbackBuffers[textureIndex]->copyTo(snapshotData[textureIndex].data(), slot.numValues * sizeof(float));
+        }
+
+        SnapshotWriter writer = std::move(slot.writer);
+        slot.isPending = false;
+        m_IOService->submit([writer, snapshotData = std::move(snapshotData)]()
+                            { writer(snapshotData); });
+    }
+}
+
+void Simulation::submitIO(std::function<void()> job)
+{
+    // Staged snapshots were requested earlier so they must be queued first
+    collectSnapshots(true);
+    m_IOService->submit(job);
+}
+
+void Simulation::flushIO()
+{
+    collectSnapshots(true);
+    m_IOService->flush();
+}
+
+IOServiceMetrics Simulation::getIOMetrics()
+{
+    return m_IOService->getMetrics();
+}
+
+bool Simulation::loadCheckpoint(const char *filePath, uint32_t trialIndex, uint32_t seed)
+{
+    if (!std::filesystem::exists(filePath))
+    {
+        return false;
+    }
+
+    std::ifstream dataFile;
+    dataFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
+    try
+    {
+        dataFile.open(filePath, std::ios::binary);
+
+        // Check that the checkpoint belongs to the given trial
+        uint32_t checkpointTrialIndex;
+        uint32_t checkpointSeed;
+        int checkpointTimestep;
+        dataFile.read(reinterpret_cast<char *>(&checkpointTrialIndex), sizeof(uint32_t));
+        dataFile.read(reinterpret_cast<char *>(&checkpointSeed), sizeof(uint32_t));
+        dataFile.read(reinterpret_cast<char *>(&checkpointTimestep), sizeof(int));
+        if (checkpointTrialIndex != trialIndex || checkpointSeed != seed)
+        {
+            return false;
+        }
+
+        uint32_t numFields;
+        dataFile.read(reinterpret_cast<char *>(&numFields), sizeof(uint32_t));
+        if (numFields != m_NumFields)
+        {
+            logWarning("The checkpoint at path %s has %d fields but the simulation requires %d!", filePath, numFields, m_NumFields);
+            return false;
+        }
+
+        std::vector<std::shared_ptr<Texture2D>> newFields(numFields);
+        for (size_t fieldIndex = 0; fieldIndex < numFields; fieldIndex++)
+        {
+            uint32_t M;
+            uint32_t N;
+            dataFile.read(reinterpret_cast<char *>(&M), sizeof(uint32_t));
+            dataFile.read(reinterpret_cast<char *>(&N), sizeof(uint32_t));
+            std::vector<float> textureData(M * N * 4);
+            dataFile.read(reinterpret_cast<char *>(textureData.data()), textureData.size() * sizeof(float));
+
+            Texture2D *fieldTexture = new Texture2D();
+            fieldTexture->setTextureWrap(TextureWrapAxis::UV, TextureWrapMode::REPEAT);
+            fieldTexture->setTextureFilter(TextureFilterLevel::MIN_MAG, TextureFilterMode::LINEAR);
+            newFields[fieldIndex] = std::shared_ptr<Texture2D>(fieldTexture);
+            newFields[fieldIndex]->width = N;
+            newFields[fieldIndex]->height = M;
+
+            glBindTexture(GL_TEXTURE_2D, newFields[fieldIndex]->textureID);
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA32F, N, M, 0, GL_RGBA, GL_FLOAT, static_cast<void *>(textureData.data()));
+        }
+
+        std::vector<std::vector<int>> stringNumbers;
+        uint32_t numStringFields;
+        dataFile.read(reinterpret_cast<char *>(&numStringFields), sizeof(uint32_t));
+        for (size_t stringIndex = 0; stringIndex < numStringFields; stringIndex++)
+        {
+            uint32_t numSamples;
+            dataFile.read(reinterpret_cast<char *>(&numSamples), sizeof(uint32_t));
+            std::vector<int> currentStringNumbers(numSamples);
+            dataFile.read(reinterpret_cast<char *>(currentStringNumbers.data()), numSamples * sizeof(int));
+            stringNumbers.push_back(currentStringNumbers);
+        }
+
+        uint32_t numEnergySamples;
+        dataFile.read(reinterpret_cast<char *>(&numEnergySamples), sizeof(uint32_t));
+        std::vector<EnergyBudget> energyBudgets(numEnergySamples);
+        for (auto &energyBudget : energyBudgets)
+        {
+            float energies[3];
+            dataFile.read(reinterpret_cast<char *>(energies), sizeof(energies));
+            energyBudget.kinetic = energies[0];
+            energyBudget.gradient = energies[1];
+            energyBudget.potential = energies[2];
+        }
+
+        std::vector<std::vector<float>> powerSpectra;
+        uint32_t numSpectrumChannels;
+        dataFile.read(reinterpret_cast<char *>(&numSpectrumChannels), sizeof(uint32_t));
+        for (size_t channelIndex = 0; channelIndex < numSpectrumChannels; channelIndex++)
+        {
+            uint32_t numValues;
+            dataFile.read(reinterpret_cast<char *>(&numValues), sizeof(uint32_t));
+            std::vector<float> powerSpectrum(numValues);
+            dataFile.read(reinterpret_cast<char *>(powerSpectrum.data()), numValues * sizeof(float));
+            powerSpectra.push_back(powerSpectrum);
+        }
+
+        std::vector<std::vector<int>> wallNumbers;
+        uint32_t numWallFields;
+        dataFile.read(reinterpret_cast<char *>(&numWallFields), sizeof(uint32_t));
+        for (size_t wallIndex = 0; wallIndex < numWallFields; wallIndex++)
+        {
+            uint32_t numSamples;
+            dataFile.read(reinterpret_cast<char *>(&numSamples), sizeof(uint32_t));
+            std::vector<int> currentWallNumbers(numSamples);
+            dataFile.read(reinterpret_cast<char *>(currentWallNumbers.data()), numSamples * sizeof(int));
+            wallNumbers.push_back(currentWallNumbers);
+        }
+
+        std::vector<std::vector<int32_t>> componentSummaries;
+        uint32_t numComponentChannels;
+        dataFile.read(reinterpret_cast<char *>(&numComponentChannels), sizeof(uint32_t));
+        for (size_t channelIndex = 0; channelIndex < numComponentChannels; channelIndex++)
+        {
+            uint32_t numValues;
+            dataFile.read(reinterpret_cast<char *>(&numValues), sizeof(uint32_t));
+            std::vector<int32_t> currentSummaries(numValues);
+            dataFile.read(reinterpret_cast<char *>(currentSummaries.data()), numValues * sizeof(int32_t));
+            componentSummaries.push_back(currentSummaries);
+        }
+
+        std::vector<std::vector<float>> fieldAmplitudes;
+        uint32_t numAmplitudeFields;
+        dataFile.read(reinterpret_cast<char *>(&numAmplitudeFields), sizeof(uint32_t));
+        for (size_t fieldIndex = 0; fieldIndex < numAmplitudeFields; fieldIndex++)
+        {
+            uint32_t numSamples;
+            dataFile.read(reinterpret_cast<char *>(&numSamples), sizeof(uint32_t));
+            std::vector<float> currentAmplitudes(numSamples);
+            dataFile.read(reinterpret_cast<char *>(currentAmplitudes.data()), numSamples * sizeof(float));
+            fieldAmplitudes.push_back(currentAmplitudes);
+        }
+
+        uint32_t numCompensatedFields;
+        dataFile.read(reinterpret_cast<char *>(&numCompensatedFields), sizeof(uint32_t));
+        if (numCompensatedFields != m_CompensationTextures.size())
+        {
+            logWarning(
+                "The checkpoint at path %s was saved at a different field precision than the simulation's %s precision!", filePath,
+                convertFieldPrecisionToString(m_Precision).c_str());
+            return false;
+        }
+        std::vector<std::vector<float>> compensations(numCompensatedFields);
+        for (auto &compensation : compensations)
+        {
+            compensation.resize(2 * (size_t)newFields[0]->width * newFields[0]->height);
+            dataFile.read(reinterpret_cast<char *>(compensation.data()), compensation.size() * sizeof(float));
+        }
+        dataFile.close();
+
+        // Setting the field resets the timestep and every sampled statistic so restore them afterwards
+        setField(newFields);
+        m_CurrentTimestep = checkpointTimestep;
+        // The checkpointed fields are already rounded to half precision so their rounding errors have to be restored
+        if (compensations.size() > 0)
+        {
+            for (size_t fieldIndex = 0; fieldIndex < compensations.size(); fieldIndex++)
+            {
+                glTextureSubImage2D(
+                    m_CompensationTextures[fieldIndex].textureID, 0, 0, 0, m_CompensationTextures[fieldIndex].width,
+                    m_CompensationTextures[fieldIndex].height, GL_RG, GL_FLOAT, compensations[fieldIndex].data());
+            }
+            calculateLaplacian();
+        }
+        collectDefectCounts(true);
+        if (stringNumbers.size() == m_StringNumbers.size())
+        {
+            m_StringNumbers = stringNumbers;
+        }
+        if (wallNumbers.size() == m_WallNumbers.size())
+        {
+            m_WallNumbers = wallNumbers;
+        }
+        collectComponents(true);
+        if (componentSummaries.size() == m_ComponentSummaries.size())
+        {
+            m_ComponentSummaries = componentSummaries;
+        }
+        collectEnergyBudget(true);
+        m_EnergyBudgets = energyBudgets;
+        collectPowerSpectra(true);
+        if (powerSpectra.size() == m_PowerSpectra.size())
+        {
+            m_PowerSpectra = powerSpectra;
+        }
+        collectFieldAmplitudes(true);
+        if (fieldAmplitudes.size() == m_Fields.size())
+        {
+            m_FieldAmplitudes = fieldAmplitudes;
+        }
+        // Replay the samples the classifier had seen. At every count sample it sees the sample before, skipping the first, so it
+        // has not seen the latest sample yet.
+        if (classifyOutcomes)
+        {
+            size_t numSamples = m_StringNumbers.size() > 0 ? m_StringNumbers[0].size() : m_WallNumbers.size() > 0 ? m_WallNumbers[0].size() : 0;
+            for (size_t sampleIndex = 1; sampleIndex + 1 < numSamples; sampleIndex++)
+            {
+                m_OutcomeClassifier.addSample(getOutcomeSample(sampleIndex));
+            }
+        }
+
+        logInfo("Resumed trial %d from its checkpoint at timestep %d.", trialIndex, checkpointTimestep);
+        return true;
+    }
+    catch (std::ifstream::failure &e)
+    {
+        logWarning("Failed to read checkpoint at path: %s - %s", filePath, e.what());
+        return false;
+    }
+}
+
+Texture2D *Simulation::getRenderTexture(uint32_t fieldIndex)
+{
+    return &m_Fields[fieldIndex];
+}
+
+Texture2D *Simulation::getCurrentRenderTexture()
+{
+    return &m_Fields[m_RenderIndex];
+}
+Texture2D *Simulation::getCurrentRealTexture()
+{
+    size_t realIndex = 2 * floor(m_RenderIndex / 2);
+    return &m_Fields[realIndex];
 }
 Texture2D *Simulation::getCurrentImagTexture()
 {
@@ -654,627 +1747,3177 @@ Texture2D *Simulation::getCurrentImagTexture()
     return &m_Fields[imagIndex];
 }
 
-Texture2D *Simulation::getCurrentLaplacian()
+Texture2D *Simulation::getCurrentLaplacian()
+{
+    return &m_LaplacianTextures[m_RenderIndex];
+}
+
+Texture2D *Simulation::getCurrentPhase()
+{
+    return &m_PhaseTextures[floor(m_RenderIndex / 2)];
+}
+
+Texture2D *Simulation::getCurrentStrings()
+{
+    return &m_StringTextures[floor(m_RenderIndex / 2)];
+}
+
+Texture2D *Simulation::getCurrentWalls()
+{
+    return &m_WallTextures[floor(m_RenderIndex / 2)];
+}
+
+float Simulation::getMaxValue()
+{
+    return getCachedMaxAbsoluteValue(getCurrentRenderTexture(), m_MaxValueQuery, m_MaxValue);
+}
+
+float Simulation::getMaxLaplacianValue()
+{
+    return getCachedMaxAbsoluteValue(getCurrentLaplacian(), m_MaxLaplacianQuery, m_MaxLaplacianValue);
+}
+
+float Simulation::getCachedMaxAbsoluteValue(Texture2D *texture, ReductionQuery &query, float &cachedValue)
+{
+    if (m_Reduction == nullptr || texture->width == 0 || texture->height == 0)
+    {
+        return 1.0f;
+    }
+
+    // Collect the last reduction if it has arrived, or wait for it if there is no value to show yet
+    if (query.isPending() && (query.isReady() || cachedValue < 0.0f))
+    {
+        cachedValue = query.getResult().getMaxAbsoluteValue();
+    }
+    // Start the next reduction
+    if (!query.isPending())
+    {
+        m_Reduction->reduce(texture, 0, query);
+    }
+    if (cachedValue < 0.0f)
+    {
+        cachedValue = query.getResult().getMaxAbsoluteValue();
+    }
+
+    // A flat or invalid field would otherwise divide by zero in the plot shader
+    if (!std::isfinite(cachedValue) || cachedValue <= 0.0f)
+    {
+        return 1.0f;
+    }
+    return cachedValue;
+}
+
+std::vector<std::pair<std::string, float>> Simulation::getParameters()
+{
+    std::vector<std::pair<std::string, float>> parameters;
+
+    // Uniform indices
+    uint32_t floatUniformIndex = 0;
+    uint32_t intUniformIndex = 0;
+
+    for (const auto &element : m_Layout.m_Elements)
+    {
+        switch (element.type)
+        {
+        case UniformDataType::FLOAT:
+        case UniformDataType::FLOAT2:
+        case UniformDataType::FLOAT3:
+        case UniformDataType::FLOAT4:
+        {
+            uint32_t numComponents = (uint32_t)element.type - (uint32_t)UniformDataType::FLOAT + 1;
+            for (uint32_t componentIndex = 0; componentIndex < numComponents; componentIndex++)
+            {
+                std::string name = numComponents > 1 ? element.name + "[" + std::to_string(componentIndex) + "]" : element.name;
+                parameters.push_back({name, m_FloatUniforms[floatUniformIndex]});
+                floatUniformIndex++;
+            }
+            break;
+        }
+        case UniformDataType::INT:
+        case UniformDataType::INT2:
+        case UniformDataType::INT3:
+        case UniformDataType::INT4:
+        {
+            uint32_t numComponents = (uint32_t)element.type - (uint32_t)UniformDataType::INT + 1;
+            for (uint32_t componentIndex = 0; componentIndex < numComponents; componentIndex++)
+            {
+                std::string name = numComponents > 1 ? element.name + "[" + std::to_string(componentIndex) + "]" : element.name;
+                parameters.push_back({name, (float)m_IntUniforms[intUniformIndex]});
+                intUniformIndex++;
+            }
+            break;
+        }
+        default:
+            logWarning(
+                "The given uniform data type %s for the uniform named %s is invalid!",
+                convertUniformDataTypeToString(element.type).c_str(),
+                element.name.c_str());
+            break;
+        }
+    }
+
+    return parameters;
+}
+
+float Simulation::getCurrentSimulationTime()
+{
+    return (m_CurrentTimestep + 1) * dt;
+}
+
+int Simulation::getCurrentSimulationTimestep()
+{
+    return m_CurrentTimestep;
+}
+
+Simulation *Simulation::createDomainWallSimulation(FieldPrecision precision)
+{
+    // Set up compute shader
+    const char *preamble = getFieldShaderPreamble(precision);
+    Shader *evolveFieldShader = new Shader("shaders/evolve_field.glsl", ShaderType::COMPUTE_SHADER, preamble);
+    ComputeShaderProgram *evolveFieldPass = new ComputeShaderProgram(evolveFieldShader);
+    if (!evolveFieldPass->isInitialised)
+    {
+        return nullptr;
+    }
+    delete evolveFieldShader;
+    Shader *evolveVelocityShader = new Shader("shaders/evolve_velocity.glsl", ShaderType::COMPUTE_SHADER, preamble);
+    ComputeShaderProgram *evolveVelocityPass = new ComputeShaderProgram(evolveVelocityShader);
+    if (!evolveVelocityPass->isInitialised)
+    {
+        return nullptr;
+    }
+    delete evolveVelocityShader;
+    Shader *calculateAccelerationShader = new Shader("shaders/domain_walls.glsl", ShaderType::COMPUTE_SHADER, preamble);
+    ComputeShaderProgram *calculateAccelerationPass = new ComputeShaderProgram(calculateAccelerationShader);
+    if (!calculateAccelerationPass->isInitialised)
+    {
+        return nullptr;
+    }
+    delete calculateAccelerationShader;
+    Shader *updateAccelerationShader = new Shader("shaders/update_acceleration.glsl", ShaderType::COMPUTE_SHADER, preamble);
+    ComputeShaderProgram *updateAccelerationPass = new ComputeShaderProgram(updateAccelerationShader);
+    if (!updateAccelerationPass->isInitialised)
+    {
+        return nullptr;
+    }
+    delete updateAccelerationShader;
+    Shader *calculateLaplacianShader = new Shader("shaders/calculate_laplacian.glsl", ShaderType::COMPUTE_SHADER, preamble);
+    ComputeShaderProgram *calculateLaplacianPass = new ComputeShaderProgram(calculateLaplacianShader);
+    if (!calculateLaplacianPass->isInitialised)
+    {
+        return nullptr;
+    }
+    delete calculateLaplacianShader;
+    Shader *calculateEnergyShader = new Shader("shaders/energy_domain_walls.glsl", ShaderType::COMPUTE_SHADER, preamble);
+    ComputeShaderProgram *calculateEnergyPass = new ComputeShaderProgram(calculateEnergyShader);
+    if (!calculateEnergyPass->isInitialised)
+    {
+        return nullptr;
+    }
+    delete calculateEnergyShader;
+    ComputeShaderProgram *detectWallsPass = ComputeShaderProgram::createFromFile("shaders/detect_walls.glsl", preamble);
+    if (detectWallsPass == nullptr)
+    {
+        return nullptr;
+    }
+
+    // Domain wall
+    SimulationLayout simulationLayout = {
+        {UniformDataType::FLOAT, std::string("eta"), 1.0f, 0.0f, 10.0f},
+        {UniformDataType::FLOAT, std::string("lam"), 5.0f, 0.1f, 10.0f}};
+
+    uint32_t numFields = 1;
+
+    return new Simulation(
+        SimulationModel::DOMAIN_WALLS,
+        numFields,
+        evolveFieldPass,
+        evolveVelocityPass,
+        calculateAccelerationPass,
+        updateAccelerationPass,
+        calculateLaplacianPass,
+        nullptr,
+        false,
+        nullptr,
+        false,
+        detectWallsPass,
+        true,
+        calculateEnergyPass,
+        simulationLayout,
+        precision);
+}
+
+Simulation *Simulation::createCosmicStringSimulation(FieldPrecision precision)
+{
+    // Set up compute shader
+    const char *preamble = getFieldShaderPreamble(precision);
+    Shader *evolveFieldShader = new Shader("shaders/evolve_field.glsl", ShaderType::COMPUTE_SHADER, preamble);
+    ComputeShaderProgram *evolveFieldPass = new ComputeShaderProgram(evolveFieldShader);
+    if (!evolveFieldPass->isInitialised)
+    {
+        return nullptr;
+    }
+    delete evolveFieldShader;
+    Shader *evolveVelocityShader = new Shader("shaders/evolve_velocity.glsl", ShaderType::COMPUTE_SHADER, preamble);
+    ComputeShaderProgram *evolveVelocityPass = new ComputeShaderProgram(evolveVelocityShader);
+    if (!evolveVelocityPass->isInitialised)
+    {
+        return nullptr;
+    }
+    delete evolveVelocityShader;
+    Shader *calculateAccelerationShader = new Shader("shaders/cosmic_strings.glsl", ShaderType::COMPUTE_SHADER, preamble);
+    ComputeShaderProgram *calculateAccelerationPass = new ComputeShaderProgram(calculateAccelerationShader);
+    if (!calculateAccelerationPass->isInitialised)
+    {
+        return nullptr;
+    }
+    delete calculateAccelerationShader;
+    Shader *updateAccelerationShader = new Shader("shaders/update_acceleration.glsl", ShaderType::COMPUTE_SHADER, preamble);
+    ComputeShaderProgram *updateAccelerationPass = new ComputeShaderProgram(updateAccelerationShader);
+    if (!updateAccelerationPass->isInitialised)
+    {
+        return nullptr;
+    }
+    delete updateAccelerationShader;
+    Shader *calculateLaplacianShader = new Shader("shaders/calculate_laplacian.glsl", ShaderType::COMPUTE_SHADER, preamble);
+    ComputeShaderProgram *calculateLaplacianPass = new ComputeShaderProgram(calculateLaplacianShader);
+    if (!calculateLaplacianPass->isInitialised)
+    {
+        return nullptr;
+    }
+    delete calculateLaplacianShader;
+    Shader *calculateEnergyShader = new Shader("shaders/energy_cosmic_strings.glsl", ShaderType::COMPUTE_SHADER, preamble);
+    ComputeShaderProgram *calculateEnergyPass = new ComputeShaderProgram(calculateEnergyShader);
+    if (!calculateEnergyPass->isInitialised)
+    {
+        return nullptr;
+    }
+    delete calculateEnergyShader;
+    Shader *calculatePhaseShader = new Shader("shaders/calculate_phase.glsl", ShaderType::COMPUTE_SHADER, preamble);
+    ComputeShaderProgram *calculatePhasePass = new ComputeShaderProgram(calculatePhaseShader);
+    if (!calculatePhasePass->isInitialised)
+    {
+        return nullptr;
+    }
+    delete calculatePhaseShader;
+    Shader *detectStringsShader = new Shader("shaders/detect_strings.glsl", ShaderType::COMPUTE_SHADER, preamble);
+    ComputeShaderProgram *detectStringsPass = new ComputeShaderProgram(detectStringsShader);
+    if (!detectStringsPass->isInitialised)
+    {
+        return nullptr;
+    }
+    delete detectStringsShader;
+
+    // Cosmic string
+    SimulationLayout simulationLayout = {
+        {UniformDataType::FLOAT, std::string("eta"), 1.0f, 0.0f, 10.0f},
+        {UniformDataType::FLOAT, std::string("lam"), 5.0f, 0.1f, 10.0f}};
+
+    uint32_t numFields = 2;
+
+    return new Simulation(
+        SimulationModel::COSMIC_STRINGS,
+        numFields,
+        evolveFieldPass,
+        evolveVelocityPass,
+        calculateAccelerationPass,
+        updateAccelerationPass,
+        calculateLaplacianPass,
+        calculatePhasePass,
+        false,
+        detectStringsPass,
+        true,
+        nullptr,
+        false,
+        calculateEnergyPass,
+        simulationLayout,
+        precision);
+}
+
+Simulation *Simulation::createSingleAxionSimulation(FieldPrecision precision)
+{
+    // Set up compute shader
+    const char *preamble = getFieldShaderPreamble(precision);
+    Shader *evolveFieldShader = new Shader("shaders/evolve_field.glsl", ShaderType::COMPUTE_SHADER, preamble);
+    ComputeShaderProgram *evolveFieldPass = new ComputeShaderProgram(evolveFieldShader);
+    if (!evolveFieldPass->isInitialised)
+    {
+        return nullptr;
+    }
+    delete evolveFieldShader;
+    Shader *evolveVelocityShader = new Shader("shaders/evolve_velocity.glsl", ShaderType::COMPUTE_SHADER, preamble);
+    ComputeShaderProgram *evolveVelocityPass = new ComputeShaderProgram(evolveVelocityShader);
+    if (!evolveVelocityPass->isInitialised)
+    {
+        return nullptr;
+    }
+    delete evolveVelocityShader;
+    Shader *calculateAccelerationShader = new Shader("shaders/single_axion.glsl", ShaderType::COMPUTE_SHADER, preamble);
+    ComputeShaderProgram *calculateAccelerationPass = new ComputeShaderProgram(calculateAccelerationShader);
+    if (!calculateAccelerationPass->isInitialised)
+    {
+        return nullptr;
+    }
+    delete calculateAccelerationShader;
+    Shader *updateAccelerationShader = new Shader("shaders/update_acceleration.glsl", ShaderType::COMPUTE_SHADER, preamble);
+    ComputeShaderProgram *updateAccelerationPass = new ComputeShaderProgram(updateAccelerationShader);
+    if (!updateAccelerationPass->isInitialised)
+    {
+        return nullptr;
+    }
+    delete updateAccelerationShader;
+    Shader *calculateLaplacianShader = new Shader("shaders/calculate_laplacian.glsl", ShaderType::COMPUTE_SHADER, preamble);
+    ComputeShaderProgram *calculateLaplacianPass = new ComputeShaderProgram(calculateLaplacianShader);
+    if (!calculateLaplacianPass->isInitialised)
+    {
+        return nullptr;
+    }
+    delete calculateLaplacianShader;
+    Shader *calculateEnergyShader = new Shader("shaders/energy_single_axion.glsl", ShaderType::COMPUTE_SHADER, preamble);
+    ComputeShaderProgram *calculateEnergyPass = new ComputeShaderProgram(calculateEnergyShader);
+    if (!calculateEnergyPass->isInitialised)
+    {
+        return nullptr;
+    }
+    delete calculateEnergyShader;
+    ComputeShaderProgram *detectWallsPass = ComputeShaderProgram::createFromFile("shaders/detect_walls.glsl", preamble);
+    if (detectWallsPass == nullptr)
+    {
+        return nullptr;
+    }
+    Shader *calculatePhaseShader = new Shader("shaders/calculate_phase.glsl", ShaderType::COMPUTE_SHADER, preamble);
+    ComputeShaderProgram *calculatePhasePass = new ComputeShaderProgram(calculatePhaseShader);
+    if (!calculatePhasePass->isInitialised)
+    {
+        return nullptr;
+    }
+    delete calculatePhaseShader;
+    Shader *detectStringsShader = new Shader("shaders/detect_strings.glsl", ShaderType::COMPUTE_SHADER, preamble);
+    ComputeShaderProgram *detectStringsPass = new ComputeShaderProgram(detectStringsShader);
+    if (!detectStringsPass->isInitialised)
+    {
+        return nullptr;
+    }
+    delete detectStringsShader;
+
+    // Single axion
+    SimulationLayout simulationLayout = {
+        {UniformDataType::FLOAT, std::string("eta"), 1.0f, 0.0f, 10.0f},
+        {UniformDataType::FLOAT, std::string("lam"), 5.0f, 0.1f, 10.0f},
+        {UniformDataType::INT, std::string("colorAnomaly"), (int)3, (int)1, (int)10},
+        {UniformDataType::FLOAT, std::string("axionStrength"), 0.025f, 0.1f, 5.0f},
+        {UniformDataType::FLOAT, std::string("growthScale"), 75.0f, 50.0f, 100.0f},
+        {UniformDataType::FLOAT, std::string("growthLaw"), 2.0f, 1.0f, 7.0f},
+    };
+
+    uint32_t numFields = 2;
+
+    return new Simulation(
+        SimulationModel::SINGLE_AXION,
+        numFields,
+        evolveFieldPass,
+        evolveVelocityPass,
+        calculateAccelerationPass,
+        updateAccelerationPass,
+        calculateLaplacianPass,
+        calculatePhasePass,
+        true,
+        detectStringsPass,
+        true,
+        detectWallsPass,
+        true,
+        calculateEnergyPass,
+        simulationLayout,
+        precision);
+}
+
+Simulation *Simulation::createCompanionAxionSimulation(FieldPrecision precision)
+{
+    // Set up compute shader
+    const char *preamble = getFieldShaderPreamble(precision);
+    Shader *evolveFieldShader = new Shader("shaders/evolve_field.glsl", ShaderType::COMPUTE_SHADER, preamble);
+    ComputeShaderProgram *evolveFieldPass = new ComputeShaderProgram(evolveFieldShader);
+    if (!evolveFieldPass->isInitialised)
+    {
+        return nullptr;
+    }
+    delete evolveFieldShader;
+    Shader *evolveVelocityShader = new Shader("shaders/evolve_velocity.glsl", ShaderType::COMPUTE_SHADER, preamble);
+    ComputeShaderProgram *evolveVelocityPass = new ComputeShaderProgram(evolveVelocityShader);
+    if (!evolveVelocityPass->isInitialised)
+    {
+        return nullptr;
+    }
+    delete evolveVelocityShader;
+    Shader *calculateAccelerationShader = new Shader("shaders/companion_axion.glsl", ShaderType::COMPUTE_SHADER, preamble);
+    ComputeShaderProgram *calculateAccelerationPass = new ComputeShaderProgram(calculateAccelerationShader);
+    if (!calculateAccelerationPass->isInitialised)
+    {
+        return nullptr;
+    }
+    delete calculateAccelerationShader;
+    Shader *updateAccelerationShader = new Shader("shaders/update_acceleration.glsl", ShaderType::COMPUTE_SHADER, preamble);
+    ComputeShaderProgram *updateAccelerationPass = new ComputeShaderProgram(updateAccelerationShader);
+    if (!updateAccelerationPass->isInitialised)
+    {
+        return nullptr;
+    }
+    delete updateAccelerationShader;
+    Shader *calculateLaplacianShader = new Shader("shaders/calculate_laplacian.glsl", ShaderType::COMPUTE_SHADER, preamble);
+    ComputeShaderProgram *calculateLaplacianPass = new ComputeShaderProgram(calculateLaplacianShader);
+    if (!calculateLaplacianPass->isInitialised)
+    {
+        return nullptr;
+    }
+    delete calculateLaplacianShader;
+    Shader *calculateEnergyShader = new Shader("shaders/energy_companion_axion.glsl", ShaderType::COMPUTE_SHADER, preamble);
+    ComputeShaderProgram *calculateEnergyPass = new ComputeShaderProgram(calculateEnergyShader);
+    if (!calculateEnergyPass->isInitialised)
+    {
+        return nullptr;
+    }
+    delete calculateEnergyShader;
+    ComputeShaderProgram *detectWallsPass = ComputeShaderProgram::createFromFile("shaders/detect_walls.glsl", preamble);
+    if (detectWallsPass == nullptr)
+    {
+        return nullptr;
+    }
+    Shader *calculatePhaseShader = new Shader("shaders/calculate_phase.glsl", ShaderType::COMPUTE_SHADER, preamble);
+    ComputeShaderProgram *calculatePhasePass = new ComputeShaderProgram(calculatePhaseShader);
+    if (!calculatePhasePass->isInitialised)
+    {
+        return nullptr;
+    }
+    delete calculatePhaseShader;
+    Shader *detectStringsShader = new Shader("shaders/detect_strings.glsl", ShaderType::COMPUTE_SHADER, preamble);
+    ComputeShaderProgram *detectStringsPass = new ComputeShaderProgram(detectStringsShader);
+    if (!detectStringsPass->isInitialised)
+    {
+        return nullptr;
+    }
+    delete detectStringsShader;
+
+    // Companion axion
+    SimulationLayout simulationLayout = {
+        {UniformDataType::FLOAT, std::string("eta"), 1.0f, 0.0f, 10.0f},
+        {UniformDataType::FLOAT, std::string("lam"), 5.0f, 0.1f, 10.0f},
+        {UniformDataType::FLOAT, std::string("axionStrength"), 0.025f, 0.1f, 5.0f},
+        {UniformDataType::FLOAT, std::string("kappa"), 0.04f, 0.001f, 1.0f},
+        {UniformDataType::FLOAT, std::string("tGrowthScale"), 75.0f, 50.0f, 100.0f},
+        {UniformDataType::FLOAT, std::string("tGrowthLaw"), 2.0f, 1.0f, 7.0f},
+        {UniformDataType::FLOAT, std::string("sGrowthScale"), 75.0f, 50.0f, 100.0f},
+        {UniformDataType::FLOAT, std::string("sGrowthLaw"), 2.0f, 1.0f, 7.0f},
+        {UniformDataType::FLOAT, std::string("n"), 3.0f, 0.0f, 10.0f},
+        {UniformDataType::FLOAT, std::string("nPrime"), 1.0f, 0.0f, 10.0f},
+        {UniformDataType::FLOAT, std::string("m"), 1.0f, 0.0f, 10.0f},
+        {UniformDataType::FLOAT, std::string("mPrime"), 1.0f, 0.0f, 10.0f},
+    };
+
+    uint32_t numFields = 4;
+
+    return new Simulation(
+        SimulationModel::COMPANION_AXION,
+        numFields,
+        evolveFieldPass,
+        evolveVelocityPass,
+        calculateAccelerationPass,
+        updateAccelerationPass,
+        calculateLaplacianPass,
+        calculatePhasePass,
+        true,
+        detectStringsPass,
+        true,
+        detectWallsPass,
+        true,
+        calculateEnergyPass,
+        simulationLayout,
+        precision);
+}
+
+Simulation *Simulation::createSimulation(SimulationModel model, FieldPrecision precision)
+{
+    switch (model)
+    {
+    case SimulationModel::DOMAIN_WALLS:
+        return createDomainWallSimulation(precision);
+    case SimulationModel::COSMIC_STRINGS:
+        return createCosmicStringSimulation(precision);
+    case SimulationModel::SINGLE_AXION:
+        return createSingleAxionSimulation(precision);
+    case SimulationModel::COMPANION_AXION:
+        return createCompanionAxionSimulation(precision);
+    default:
+        logError("Unknown simulation model!");
+        return nullptr;
+    }
+}
+
+const char *Simulation::getFieldShaderPreamble(FieldPrecision precision)
+{
+    // The shaders shared with volume simulations are also specialised to a plane
+    switch (precision)
+    {
+    case FieldPrecision::HALF:
+        return "#define FIELD_FORMAT rgba16f\n#define LAPLACIAN_FORMAT r16f\n#define COMPENSATED_FIELDS\n" PLANE_LATTICE_DEFINES;
+    case FieldPrecision::SINGLE:
+    default:
+        return "#define FIELD_FORMAT rgba32f\n#define LAPLACIAN_FORMAT r32f\n" PLANE_LATTICE_DEFINES;
+    }
+}
+
+uint64_t Simulation::getFieldMemoryUsage()
+{
+    uint32_t bytesPerCell = getBytesPerCell(getFieldFormat(m_Precision)) + getBytesPerCell(getLaplacianFormat(m_Precision));
+    if (m_CompensationTextures.size() > 0)
+    {
+        bytesPerCell += getBytesPerCell(GL_RG16F);
+    }
+    uint64_t numCells = (uint64_t)m_Fields[0].width * m_Fields[0].height;
+    return numCells * bytesPerCell * m_Fields.size();
+}
+
+std::vector<std::vector<float>> Simulation::readFieldValues()
+{
+    std::vector<std::vector<float>> fieldValues(m_Fields.size());
+    for (size_t fieldIndex = 0; fieldIndex < m_Fields.size(); fieldIndex++)
+    {
+        size_t numCells = (size_t)m_Fields[fieldIndex].width * m_Fields[fieldIndex].height;
+        std::vector<float> textureData(4 * numCells);
+        glGetTextureImage(
+            m_Fields[fieldIndex].textureID, 0, GL_RGBA, GL_FLOAT, textureData.size() * sizeof(float), textureData.data());
+        std::vector<float> compensationData;
+        if (m_CompensationTextures.size() > 0)
+        {
+            compensationData.resize(2 * numCells);
+            glGetTextureImage(m_CompensationTextures[fieldIndex].textureID, 0, GL_RG, GL_FLOAT,
+                              compensationData.size() * sizeof(float), compensationData.data());
+        }
+
+        fieldValues[fieldIndex].resize(numCells);
+        for (size_t cellIndex = 0; cellIndex < numCells; cellIndex++)
+        {
+            fieldValues[fieldIndex][cellIndex] =
+                textureData[4 * cellIndex] + (compensationData.empty() ? 0.0f : compensationData[2 * cellIndex]);
+        }
+    }
+    return fieldValues;
+}
+
+std::vector<std::vector<float>> Simulation::readFieldData()
+{
+    std::vector<std::vector<float>> fieldData(m_Fields.size());
+    for (size_t fieldIndex = 0; fieldIndex < m_Fields.size(); fieldIndex++)
+    {
+        fieldData[fieldIndex].resize(4 * (size_t)m_Fields[fieldIndex].width * m_Fields[fieldIndex].height);
+        glGetTextureImage(m_Fields[fieldIndex].textureID, 0, GL_RGBA, GL_FLOAT, fieldData[fieldIndex].size() * sizeof(float),
+                          fieldData[fieldIndex].data());
+    }
+    return fieldData;
+}
+
+void Simulation::calculateLaplacian()
+{
+    // Pairs of fields share a transform
+    if (isLaplacianSpectral() && m_SpectralLaplacian->setSize(m_Fields[0].width, m_Fields[0].height))
+    {
+        for (size_t fieldIndex = 0; fieldIndex < m_Fields.size(); fieldIndex += 2)
+        {
+            bool hasSecond = fieldIndex + 1 < m_Fields.size();
+            m_SpectralLaplacian->calculate(
+                &m_Fields[fieldIndex], hasSecond ? &m_Fields[fieldIndex + 1] : nullptr, &m_LaplacianTextures[fieldIndex],
+                hasSecond ? &m_LaplacianTextures[fieldIndex + 1] : nullptr, dx);
+        }
+        return;
+    }
+
+    // Bind each field texture and calculate the Laplacian
+    for (size_t fieldIndex = 0; fieldIndex < m_Fields.size(); fieldIndex++)
+    {
+        // Calculate Laplacian
+        m_CalculateLaplacianPass->use();
+        glUniform1f(0, dx);
+        // Bind images
+        glActiveTexture(GL_TEXTURE0);
+        glBindImageTexture(0, m_Fields[fieldIndex].textureID, 0, GL_FALSE, 0, GL_READ_ONLY, getFieldFormat(m_Precision));
+        glActiveTexture(GL_TEXTURE1);
+        glBindImageTexture(
+            1, m_LaplacianTextures[fieldIndex].textureID, 0, GL_FALSE, 0, GL_WRITE_ONLY, getLaplacianFormat(m_Precision));
+        bindCompensationTexture(fieldIndex, 2, GL_READ_ONLY);
+        // Dispatch and barrier
+        glDispatchCompute(m_XNumGroups, m_YNumGroups, 1);
+        glMemoryBarrier(GL_ALL_BARRIER_BITS);
+    }
+}
+
+void Simulation::calculatePhase()
+{
+    // Bind two textures at once and calculate the phase
+    for (size_t phaseIndex = 0; phaseIndex < m_PhaseTextures.size(); phaseIndex++)
+    {
+        m_CalculatePhasePass->use();
+        // Real part
+        glActiveTexture(GL_TEXTURE0);
+        glBindImageTexture(
+            0, m_Fields[(size_t)2 * phaseIndex].textureID, 0, GL_FALSE, 0, GL_READ_ONLY, getFieldFormat(m_Precision));
+        // Imaginary part
+        glActiveTexture(GL_TEXTURE1);
+        glBindImageTexture(
+            1, m_Fields[(size_t)2 * phaseIndex + 1].textureID, 0, GL_FALSE, 0, GL_READ_ONLY, getFieldFormat(m_Precision));
+        // Output phase texture
+        glActiveTexture(GL_TEXTURE2);
+        glBindImageTexture(2, m_PhaseTextures[phaseIndex].textureID, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_R16_SNORM);
+
+        // Dispatch and barrier
+        glDispatchCompute(m_XNumGroups, m_YNumGroups, 1);
+        glMemoryBarrier(GL_ALL_BARRIER_BITS);
+    }
+}
+
+void Simulation::detectStrings()
+{
+    bool isSampled = (m_CurrentTimestep - 1) % std::max(stringCountCadence, 1) == 0;
+    bool isTracked = isSampled && (trackStrings || m_StringTrackStream != nullptr);
+    std::vector<std::vector<uint32_t>> stringRecords(m_StringTextures.size());
+
+    // Bind two textures at once and detect the strings
+    for (size_t stringIndex = 0; stringIndex < m_StringTextures.size(); stringIndex++)
+    {
+        m_DetectStringsPass->use();
+        // Real part
+        glActiveTexture(GL_TEXTURE0);
+        glBindImageTexture(
+            0, m_Fields[(size_t)2 * stringIndex].textureID, 0, GL_FALSE, 0, GL_READ_ONLY, getFieldFormat(m_Precision));
+        // Imaginary part
+        glActiveTexture(GL_TEXTURE1);
+        glBindImageTexture(
+            1, m_Fields[(size_t)2 * stringIndex + 1].textureID, 0, GL_FALSE, 0, GL_READ_ONLY, getFieldFormat(m_Precision));
+        // Output string texture
+        glActiveTexture(GL_TEXTURE2);
+        glBindImageTexture(2, m_StringTextures[stringIndex].textureID, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_R8_SNORM);
+        // Output string records. Reset the record count.
+        ShaderStorageBuffer *recordBuffer = m_StringRecordBuffers[stringIndex].get();
+        recordBuffer->clear(0, sizeof(uint32_t));
+        recordBuffer->bindBase(0);
+
+        // Dispatch and barrier
+        glDispatchCompute(m_XNumGroups, m_YNumGroups, 1);
+        glMemoryBarrier(GL_ALL_BARRIER_BITS);
+
+        // Store the string count at the requested cadence
+        if (isSampled)
+        {
+            startStringCount(stringIndex);
+        }
+
+        // Read back only as many records as were written
+        if ((isSampled && m_StringLocationStream != nullptr) || isTracked)
+        {
+            uint32_t numRecords;
+            recordBuffer->read(0, sizeof(uint32_t), &numRecords);
+            uint32_t capacity = recordBuffer->size / sizeof(uint32_t) - 1;
+            if (numRecords > capacity)
+            {
+                logWarning("%d string records overflowed the capacity of %d! Dropping the excess records.", numRecords, capacity);
+                numRecords = capacity;
+            }
+            stringRecords[stringIndex].resize(numRecords);
+            recordBuffer->read(sizeof(uint32_t), numRecords * sizeof(uint32_t), stringRecords[stringIndex].data());
+        }
+
+        // Continue the tracks with the new records
+        if (isTracked)
+        {
+            m_StringTrackers[stringIndex].setSearchRadius(trackingRadius);
+            m_StringTrackers[stringIndex].update(
+                m_CurrentTimestep, m_CurrentTimestep * dt, stringRecords[stringIndex].data(), stringRecords[stringIndex].size());
+        }
+    }
+
+    if (isTracked)
+    {
+        // Events are only kept until they are written
+        std::vector<std::vector<StringTrack>> stringTracks;
+        std::vector<std::vector<StringEvent>> stringEvents;
+        for (auto &stringTracker : m_StringTrackers)
+        {
+            stringEvents.push_back(stringTracker.takeEvents());
+            if (m_StringTrackStream != nullptr)
+            {
+                stringTracks.push_back(stringTracker.getTracks());
+            }
+        }
+
+        if (m_StringTrackStream != nullptr)
+        {
+            std::shared_ptr<std::ofstream> dataFile = m_StringTrackStream;
+            int timestep = m_CurrentTimestep;
+            submitIO(
+                [dataFile, timestep, stringTracks = std::move(stringTracks), stringEvents = std::move(stringEvents)]()
+                {
+                    try
+                    {
+                        // Frame: Timestep -> (Number of tracks = k -> Tracks (k of these) -> Number of events = e -> Events
+                        // (e of these)) for each pair of fields
+                        int frameTimestep = timestep;
+                        dataFile->write(reinterpret_cast<char *>(&frameTimestep), sizeof(int));
+                        for (size_t stringIndex = 0; stringIndex < stringTracks.size(); stringIndex++)
+                        {
+                            uint32_t numTracks = stringTracks[stringIndex].size();
+                            dataFile->write(reinterpret_cast<char *>(&numTracks), sizeof(uint32_t));
+                            dataFile->write(reinterpret_cast<const char *>(stringTracks[stringIndex].data()), numTracks * sizeof(StringTrack));
+                            uint32_t numEvents = stringEvents[stringIndex].size();
+                            dataFile->write(reinterpret_cast<char *>(&numEvents), sizeof(uint32_t));
+                            dataFile->write(reinterpret_cast<const char *>(stringEvents[stringIndex].data()), numEvents * sizeof(StringEvent));
+                        }
+                    }
+                    catch (std::ofstream::failure &e)
+                    {
+                        logError("Failed to write string track frame at timestep %d - %s", timestep, e.what());
+                    }
+                });
+        }
+    }
+
+    if (isSampled && m_StringLocationStream != nullptr)
+    {
+        std::shared_ptr<std::ofstream> dataFile = m_StringLocationStream;
+        int timestep = m_CurrentTimestep;
+        submitIO(
+            [dataFile, timestep, stringRecords = std::move(stringRecords)]()
+            {
+                try
+                {
+                    // Frame: Timestep -> (Number of records = k -> Records (k of these)) for each pair of fields
+                    int frameTimestep = timestep;
+                    dataFile->write(reinterpret_cast<char *>(&frameTimestep), sizeof(int));
+                    for (const auto &records : stringRecords)
+                    {
+                        uint32_t numRecords = records.size();
+                        dataFile->write(reinterpret_cast<char *>(&numRecords), sizeof(uint32_t));
+                        dataFile->write(reinterpret_cast<const char *>(records.data()), numRecords * sizeof(uint32_t));
+                    }
+                }
+                catch (std::ofstream::failure &e)
+                {
+                    logError("Failed to write string location frame at timestep %d - %s", timestep, e.what());
+                }
+            });
+    }
+}
+
+void Simulation::detectWalls()
+{
+    bool isSampled = (m_CurrentTimestep - 1) % std::max(stringCountCadence, 1) == 0;
+
+    for (size_t wallIndex = 0; wallIndex < m_WallTextures.size(); wallIndex++)
+    {
+        m_DetectWallsPass->use();
+        // A single real field is bound in place of the imaginary part
+        bool isComplex = m_Fields.size() > 1;
+        glUniform1i(0, isComplex);
+        // Real part
+        glBindImageTexture(
+            0, m_Fields[isComplex ? 2 * wallIndex : 0].textureID, 0, GL_FALSE, 0, GL_READ_ONLY, getFieldFormat(m_Precision));
+        // Imaginary part
+        glBindImageTexture(
+            1, m_Fields[isComplex ? 2 * wallIndex + 1 : 0].textureID, 0, GL_FALSE, 0, GL_READ_ONLY, getFieldFormat(m_Precision));
+        // Output wall texture
+        glBindImageTexture(2, m_WallTextures[wallIndex].textureID, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_R16F);
+
+        // Dispatch and barrier
+        glDispatchCompute(m_XNumGroups, m_YNumGroups, 1);
+        glMemoryBarrier(GL_ALL_BARRIER_BITS);
+
+        // Store the wall count at the requested cadence
+        if (isSampled)
+        {
+            startWallCount(wallIndex);
+        }
+    }
+}
+
+void Simulation::calculateEnergy()
+{
+    if (m_CalculateEnergyPass == nullptr || m_Reduction == nullptr)
+    {
+        return;
+    }
+    // Only one sample is kept in flight
+    collectEnergyBudget(true);
+
+    m_CalculateEnergyPass->use();
+    glUniform1f(0, m_CurrentTimestep * dt);
+    glUniform1f(1, dt);
+    glUniform1i(2, era);
+    bindUniforms();
+    for (size_t fieldIndex = 0; fieldIndex < m_Fields.size(); fieldIndex++)
+    {
+        glBindImageTexture(fieldIndex, m_Fields[fieldIndex].textureID, 0, GL_FALSE, 0, GL_READ_ONLY, getFieldFormat(m_Precision));
+    }
+    glBindImageTexture(m_Fields.size(), m_EnergyTexture.textureID, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA32F);
+
+    // Dispatch and barrier
+    glDispatchCompute(m_XNumGroups, m_YNumGroups, 1);
+    glMemoryBarrier(GL_ALL_BARRIER_BITS);
+
+    // Reduce the kinetic, gradient and potential energy densities
+    for (uint32_t channel = 0; channel < 3; channel++)
+    {
+        m_Reduction->reduce(&m_EnergyTexture, channel, m_EnergyQueries[channel]);
+    }
+    m_EnergyCellArea = dx * dx;
+}
+
+void Simulation::collectEnergyBudget(bool wait)
+{
+    if (!m_EnergyQueries[0].isPending())
+    {
+        return;
+    }
+    if (!wait)
+    {
+        for (auto &query : m_EnergyQueries)
+        {
+            if (!query.isReady())
+            {
+                return;
+            }
+        }
+    }
+
+    // Integrate the densities over the grid. The gradient is in lattice units so its factors of dx cancel out.
+    EnergyBudget energyBudget;
+    energyBudget.kinetic = m_EnergyQueries[0].getResult().sum * m_EnergyCellArea;
+    energyBudget.gradient = m_EnergyQueries[1].getResult().sum;
+    energyBudget.potential = m_EnergyQueries[2].getResult().sum * m_EnergyCellArea;
+    m_EnergyBudgets.push_back(energyBudget);
+}
+
+std::vector<EnergyBudget> Simulation::getEnergyBudgets()
+{
+    collectEnergyBudget(true);
+    return m_EnergyBudgets;
+}
+
+EnergyBudget Simulation::getCurrentEnergyBudget()
+{
+    collectEnergyBudget(false);
+    return m_EnergyBudgets.size() > 0 ? m_EnergyBudgets.back() : EnergyBudget();
+}
+
+void Simulation::calculateComponents()
+{
+    uint32_t numChannels = getNumComponentChannels();
+    if (numChannels == 0 || ensureComponentLabelling() == nullptr)
+    {
+        return;
+    }
+    // Only one sample is kept in flight
+    collectComponents(true);
+
+    while (m_ComponentReadbacks.size() < numChannels)
+    {
+        m_ComponentReadbacks.push_back(std::make_unique<ReadbackBuffer>());
+    }
+
+    uint32_t channelIndex = 0;
+    // Domains are separated by walls, which are sign changes of a real field or sectors of the phase of a complex field
+    for (size_t wallIndex = 0; wallIndex < m_WallTextures.size(); wallIndex++)
+    {
+        if (m_Fields.size() == 1)
+        {
+            m_ComponentLabelling->label(&m_Fields[0], ComponentClassType::SIGN, 2, *m_ComponentReadbacks[channelIndex++]);
+        }
+        else
+        {
+            m_ComponentLabelling->label(
+                &m_PhaseTextures[wallIndex], ComponentClassType::PHASE_SECTOR, std::max(domainSectors, 1),
+                *m_ComponentReadbacks[channelIndex++]);
+        }
+    }
+    // Clusters of neighbouring strings
+    if (m_HasStrings)
+    {
+        for (auto &stringTexture : m_StringTextures)
+        {
+            m_ComponentLabelling->label(&stringTexture, ComponentClassType::NONZERO, 1, *m_ComponentReadbacks[channelIndex++]);
+        }
+    }
+    m_IsComponentPending = true;
+}
+
+void Simulation::collectComponents(bool wait)
+{
+    if (!m_IsComponentPending)
+    {
+        return;
+    }
+    uint32_t numChannels = getNumComponentChannels();
+    if (!wait)
+    {
+        for (uint32_t channelIndex = 0; channelIndex < numChannels; channelIndex++)
+        {
+            if (!m_ComponentReadbacks[channelIndex]->isReady())
+            {
+                return;
+            }
+        }
+    }
+
+    for (uint32_t channelIndex = 0; channelIndex < numChannels; channelIndex++)
+    {
+        ComponentStatistics statistics = m_ComponentLabelling->getResult(*m_ComponentReadbacks[channelIndex]);
+        std::vector<int32_t> summary = ComponentLabelling::flattenStatistics(statistics);
+        m_ComponentSummaries[channelIndex].insert(m_ComponentSummaries[channelIndex].end(), summary.begin(), summary.end());
+    }
+    m_IsComponentPending = false;
+}
+
+uint32_t Simulation::getNumComponentChannels()
+{
+    return m_WallTextures.size() + (m_HasStrings ? m_StringTextures.size() : 0);
+}
+
+std::vector<std::vector<int32_t>> Simulation::getComponentSummaries()
+{
+    collectComponents(true);
+    return m_ComponentSummaries;
+}
+
+std::vector<ComponentStatistics> Simulation::getCurrentComponentStatistics()
+{
+    collectComponents(false);
+    std::vector<ComponentStatistics> result;
+    for (const auto &currentSummaries : m_ComponentSummaries)
+    {
+        if (currentSummaries.size() >= ComponentLabelling::NUM_SUMMARY_VALUES)
+        {
+            result.push_back(ComponentLabelling::unflattenStatistics(
+                currentSummaries.data() + currentSummaries.size() - ComponentLabelling::NUM_SUMMARY_VALUES));
+        }
+    }
+    return result;
+}
+
+void Simulation::calculatePowerSpectra()
+{
+    if (ensurePowerSpectrum() == nullptr)
+    {
+        return;
+    }
+    uint32_t numBins = getNumPowerSpectrumBins();
+    if (numBins == 0)
+    {
+        return;
+    }
+    // Only one sample is kept in flight
+    collectPowerSpectra(true);
+
+    uint32_t numChannels = getNumPowerSpectrumChannels();
+    while (m_PowerSpectrumReadbacks.size() < numChannels)
+    {
+        m_PowerSpectrumReadbacks.push_back(std::make_unique<ReadbackBuffer>());
+    }
+
+    if (m_PhaseTextures.size() == 0)
+    {
+        m_PowerSpectrum->calculate(&m_Fields[0], nullptr, 1.0f, *m_PowerSpectrumReadbacks[0]);
+    }
+    else
+    {
+        for (size_t phaseIndex = 0; phaseIndex < m_PhaseTextures.size(); phaseIndex++)
+        {
+            // Each complex field is followed by its phase, which is stored in units of pi
+            m_PowerSpectrum->calculate(
+                &m_Fields[2 * phaseIndex], &m_Fields[2 * phaseIndex + 1], 1.0f, *m_PowerSpectrumReadbacks[2 * phaseIndex]);
+            m_PowerSpectrum->calculate(&m_PhaseTextures[phaseIndex], nullptr, PI, *m_PowerSpectrumReadbacks[2 * phaseIndex + 1]);
+        }
+    }
+    m_IsPowerSpectrumPending = true;
+}
+
+void Simulation::collectPowerSpectra(bool wait)
+{
+    if (!m_IsPowerSpectrumPending)
+    {
+        return;
+    }
+    uint32_t numChannels = getNumPowerSpectrumChannels();
+    if (!wait)
+    {
+        for (uint32_t channelIndex = 0; channelIndex < numChannels; channelIndex++)
+        {
+            if (!m_PowerSpectrumReadbacks[channelIndex]->isReady())
+            {
+                return;
+            }
+        }
+    }
+
+    for (uint32_t channelIndex = 0; channelIndex < numChannels; channelIndex++)
+    {
+        std::vector<float> powerSpectrum = m_PowerSpectrum->getResult(*m_PowerSpectrumReadbacks[channelIndex]);
+        m_PowerSpectra[channelIndex].insert(m_PowerSpectra[channelIndex].end(), powerSpectrum.begin(), powerSpectrum.end());
+    }
+    m_IsPowerSpectrumPending = false;
+}
+
+uint32_t Simulation::getNumPowerSpectrumChannels()
+{
+    // A single field has no phase
+    return m_PhaseTextures.size() > 0 ? 2 * m_PhaseTextures.size() : 1;
+}
+
+uint32_t Simulation::getNumPowerSpectrumBins()
+{
+    if (m_PowerSpectrum == nullptr || m_Fields.size() == 0 || PowerSpectrum::calculateNumBins(m_Fields[0].width, m_Fields[0].height) == 0)
+    {
+        return 0;
+    }
+    return m_PowerSpectrum->getNumBins();
+}
+
+std::vector<std::vector<float>> Simulation::getPowerSpectra()
+{
+    collectPowerSpectra(true);
+    return m_PowerSpectra;
+}
+
+void Simulation::calculateAcceleration(float time, float stepDt)
+{
+    // Calculate the acceleration
+    m_CalculateAccelerationPass->use();
+    glUniform1f(0, time);
+    glUniform1f(1, stepDt);
+    glUniform1i(2, era);
+    bindUniforms();
+    uint32_t bindIndex = 0;
+    uint32_t activeTextureIndex = GL_TEXTURE0;
+    for (size_t fieldIndex = 0; fieldIndex < m_Fields.size(); fieldIndex++)
+    {
+        // Bind field
+        glActiveTexture(activeTextureIndex++);
+        glBindImageTexture(
+            bindIndex++, m_Fields[fieldIndex].textureID, 0, GL_FALSE, 0, GL_READ_WRITE, getFieldFormat(m_Precision));
+        // Bind its Laplacian
+        glActiveTexture(activeTextureIndex++);
+        glBindImageTexture(
+            bindIndex++, m_LaplacianTextures[fieldIndex].textureID, 0, GL_FALSE, 0, GL_READ_ONLY, getLaplacianFormat(m_Precision));
+    }
+
+    // Dispatch and barrier
+    glDispatchCompute(m_XNumGroups, m_YNumGroups, 1);
+    glMemoryBarrier(GL_ALL_BARRIER_BITS);
+}
+
+void Simulation::updateAcceleration()
+{
+    // Update acceleration
+    for (size_t fieldIndex = 0; fieldIndex < m_Fields.size(); fieldIndex++)
+    {
+        // Now acceleration can be updated
+        m_UpdateAccelerationPass->use();
+        glUniform1f(0, dt);
+        // Bind field
+        glActiveTexture(GL_TEXTURE0);
+        glBindImageTexture(0, m_Fields[fieldIndex].textureID, 0, GL_FALSE, 0, GL_READ_WRITE, getFieldFormat(m_Precision));
+        // Dispatch and barrier
+        glDispatchCompute(m_XNumGroups, m_YNumGroups, 1);
+        glMemoryBarrier(GL_ALL_BARRIER_BITS);
+    }
+}
+
+float Simulation::calculateStableTimestep(float time, const char *&limitingBound)
+{
+    // Explicit steps are stable while every mode turns by less than two radians per step. The shortest waves oscillate at
+    // sqrt(lambda) / dx, where lambda is the largest eigenvalue of the Laplacian in lattice units. This is 2 pi^2 for the spectral
+    // operator and 2 x 16 / 3 for the fourth order stencil.
+    float laplacianEigenvalue = isLaplacianSpectral() ? 2.0f * PI * PI : 32.0f / 3.0f;
+    float stableDt = 2.0f * dx / std::sqrt(laplacianEigenvalue);
+    limitingBound = "CFL";
+
+    // The Hubble damping PRS_ALPHA era / t is also explicit
+    float dampingDt = 2.0f * time / (PRS_ALPHA * era);
+    if (dampingDt < stableDt)
+    {
+        stableDt = dampingDt;
+        limitingBound = "damping";
+    }
+
+    if (m_Reduction != nullptr)
+    {
+        // The fields have changed since the last update, so they are reduced now
+        if (m_TimestepQueries.size() < 3 * m_Fields.size() || !m_TimestepQueries[0]->isPending())
+        {
+            startTimestepReductions();
+        }
+        for (size_t fieldIndex = 0; fieldIndex < m_Fields.size(); fieldIndex++)
+        {
+            float amplitude = m_TimestepQueries[3 * fieldIndex]->getResult().getMaxAbsoluteValue();
+            float maxVelocity = m_TimestepQueries[3 * fieldIndex + 1]->getResult().getMaxAbsoluteValue();
+            float maxAcceleration = m_TimestepQueries[3 * fieldIndex + 2]->getResult().getMaxAbsoluteValue();
+            // No step can save a field that has already blown up, which the trial rules stop instead
+            if (!std::isfinite(amplitude) || !std::isfinite(maxVelocity) || !std::isfinite(maxAcceleration))
+            {
+                continue;
+            }
+
+            // A field should not cross its own amplitude in a single step. This resolves the passage of defect cores, where the
+            // axion terms divide by the square amplitude.
+            if (maxVelocity > 0.0f && amplitude / maxVelocity < stableDt)
+            {
+                stableDt = amplitude / maxVelocity;
+                limitingBound = "velocity";
+            }
+            // The stiffest oscillation has an angular frequency of at most sqrt(max |acceleration| / max |value|)
+            if (maxAcceleration > 0.0f && amplitude > 0.0f && 2.0f * std::sqrt(amplitude / maxAcceleration) < stableDt)
+            {
+                stableDt = 2.0f * std::sqrt(amplitude / maxAcceleration);
+                limitingBound = "stiffness";
+            }
+        }
+    }
+
+    return courantNumber * stableDt;
+}
+
+void Simulation::startTimestepReductions()
+{
+    if (m_Reduction == nullptr)
+    {
+        return;
+    }
+
+    while (m_TimestepQueries.size() < 3 * m_Fields.size())
+    {
+        m_TimestepQueries.push_back(std::make_unique<ReductionQuery>());
+    }
+    for (size_t fieldIndex = 0; fieldIndex < m_Fields.size(); fieldIndex++)
+    {
+        // Value, velocity and acceleration, which is the same in both of the last two channels after an update
+        for (uint32_t channel = 0; channel < 3; channel++)
+        {
+            // Collect any reduction that was not needed so that the query can be reused
+            if (m_TimestepQueries[3 * fieldIndex + channel]->isPending())
+            {
+                m_TimestepQueries[3 * fieldIndex + channel]->getResult();
+            }
+            m_Reduction->reduce(&m_Fields[fieldIndex], channel, *m_TimestepQueries[3 * fieldIndex + channel]);
+        }
+    }
+}
+
+int Simulation::getTimestepsToNextSample()
+{
+    int timesteps = std::max(maxTimesteps - m_CurrentTimestep, 1);
+    // A timestep T is sampled at a cadence c if (T - 1) % c == 0
+    auto limitToCadence = [&](int cadence)
+    {
+        if (cadence > 0)
+        {
+            timesteps = std::min(timesteps, cadence - (m_CurrentTimestep - 1) % cadence);
+        }
+    };
+    limitToCadence(std::max(stringCountCadence, 1));
+    limitToCadence(energyCadence);
+    limitToCadence(spectrumCadence);
+    limitToCadence(componentCadence);
+    if (isRefiningDefects())
+    {
+        limitToCadence(std::max(regridInterval, 1));
+    }
+    // Checkpoints are saved after the timesteps that are a multiple of the interval
+    if (checkpointInterval > 0)
+    {
+        timesteps = std::min(timesteps, checkpointInterval - m_CurrentTimestep % checkpointInterval);
+    }
+    return timesteps;
+}
+
+bool Simulation::isLaplacianSpectral()
+{
+    // The spectral Laplacian writes single precision Laplacians
+    return laplacianOperator == LaplacianOperator::SPECTRAL && m_Precision == FieldPrecision::SINGLE &&
+           PowerSpectrum::calculateNumBins(m_Fields[0].width, m_Fields[0].height) > 0 && ensureSpectralLaplacian() != nullptr;
+}
+
+bool Simulation::isRefiningDefects()
+{
+    return refineDefects && m_Precision == FieldPrecision::SINGLE && m_Fields[0].width > 0 && m_Fields[0].height > 0 &&
+           m_Fields[0].width % MeshRefinement::TILE_SIZE == 0 && m_Fields[0].height % MeshRefinement::TILE_SIZE == 0 &&
+           ensureMeshRefinement() != nullptr;
+}
+
+PowerSpectrum *Simulation::ensurePowerSpectrum()
+{
+    if (!m_HasCreatedPowerSpectrum)
+    {
+        m_PowerSpectrum = PowerSpectrum::create();
+        m_HasCreatedPowerSpectrum = true;
+        // The size is otherwise set along with the fields
+        if (m_PowerSpectrum != nullptr && PowerSpectrum::calculateNumBins(m_Fields[0].width, m_Fields[0].height) > 0)
+        {
+            m_PowerSpectrum->setSize(m_Fields[0].width, m_Fields[0].height);
+        }
+    }
+    return m_PowerSpectrum;
+}
+
+RandomFieldFilter *Simulation::ensureRandomFieldFilter()
+{
+    if (!m_HasCreatedRandomFieldFilter)
+    {
+        m_RandomFieldFilter = RandomFieldFilter::create();
+        m_HasCreatedRandomFieldFilter = true;
+    }
+    return m_RandomFieldFilter;
+}
+
+SpectralLaplacian *Simulation::ensureSpectralLaplacian()
+{
+    if (!m_HasCreatedSpectralLaplacian)
+    {
+        m_SpectralLaplacian = SpectralLaplacian::create();
+        m_HasCreatedSpectralLaplacian = true;
+    }
+    return m_SpectralLaplacian;
+}
+
+ComponentLabelling *Simulation::ensureComponentLabelling()
+{
+    if (!m_HasCreatedComponentLabelling)
+    {
+        m_ComponentLabelling = ComponentLabelling::create();
+        m_HasCreatedComponentLabelling = true;
+    }
+    return m_ComponentLabelling;
+}
+
+MeshRefinement *Simulation::ensureMeshRefinement()
+{
+    if (!m_HasCreatedMeshRefinement)
+    {
+        m_MeshRefinement = MeshRefinement::create();
+        m_HasCreatedMeshRefinement = true;
+    }
+    return m_MeshRefinement;
+}
+
+void Simulation::regridRefinedPatches()
+{
+    std::vector<Texture2D *> defectTextures;
+    for (auto &stringTexture : m_StringTextures)
+    {
+        defectTextures.push_back(&stringTexture);
+    }
+    for (auto &wallTexture : m_WallTextures)
+    {
+        defectTextures.push_back(&wallTexture);
+    }
+    if (!m_MeshRefinement->regrid(defectTextures, m_Fields) || m_MeshRefinement->getNumPatches() == 0)
+    {
+        return;
+    }
+
+    // Recalculating the acceleration of the kept patches leaves them unchanged, so every patch is initialised
+    float patchDx = dx / MeshRefinement::REFINEMENT_RATIO;
+    float patchDt = dt / MeshRefinement::REFINEMENT_RATIO;
+    m_MeshRefinement->fillGhosts(m_Fields, 1.0f);
+    calculatePatchAcceleration(m_CurrentTimestep * dt, patchDx, patchDt);
+    dispatchPatchPass(m_UpdateAccelerationPass, patchDt);
+}
+
+void Simulation::advanceRefinedPatches(float startTime, float stepDt)
+{
+    if (m_MeshRefinement->getNumPatches() == 0)
+    {
+        return;
+    }
+
+    // The patches take a substep for each level of refinement, with their ghost cells following the fields through the step
+    float patchDx = dx / MeshRefinement::REFINEMENT_RATIO;
+    float patchDt = stepDt / MeshRefinement::REFINEMENT_RATIO;
+    for (uint32_t substepIndex = 1; substepIndex <= MeshRefinement::REFINEMENT_RATIO; substepIndex++)
+    {
+        dispatchPatchPass(m_EvolveFieldPass, patchDt);
+        m_MeshRefinement->fillGhosts(m_Fields, substepIndex / (float)MeshRefinement::REFINEMENT_RATIO);
+        calculatePatchAcceleration(startTime + substepIndex * patchDt, patchDx, patchDt);
+        dispatchPatchPass(m_EvolveVelocityPass, patchDt);
+        dispatchPatchPass(m_UpdateAccelerationPass, patchDt);
+    }
+    m_MeshRefinement->restrictPatches(m_Fields);
+}
+
+void Simulation::calculatePatchAcceleration(float time, float patchDx, float patchDt)
+{
+    std::vector<Texture2D> &patchFields = m_MeshRefinement->getPatchFields();
+    std::vector<Texture2D> &patchLaplacians = m_MeshRefinement->getPatchLaplacians();
+    uint32_t xNumGroups = patchFields[0].width / 8;
+    uint32_t yNumGroups = patchFields[0].height / 8;
+
+    // Calculate Laplacian
+    for (size_t fieldIndex = 0; fieldIndex < patchFields.size(); fieldIndex++)
+    {
+        m_CalculateLaplacianPass->use();
+        glUniform1f(0, patchDx);
+        glBindImageTexture(0, patchFields[fieldIndex].textureID, 0, GL_FALSE, 0, GL_READ_ONLY, GL_RGBA32F);
+        glBindImageTexture(1, patchLaplacians[fieldIndex].textureID, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F);
+        // Dispatch and barrier
+        glDispatchCompute(xNumGroups, yNumGroups, 1);
+        glMemoryBarrier(GL_ALL_BARRIER_BITS);
+    }
+
+    // Calculate the acceleration
+    m_CalculateAccelerationPass->use();
+    glUniform1f(0, time);
+    glUniform1f(1, patchDt);
+    glUniform1i(2, era);
+    bindUniforms();
+    for (size_t fieldIndex = 0; fieldIndex < patchFields.size(); fieldIndex++)
+    {
+        glBindImageTexture(2 * fieldIndex, patchFields[fieldIndex].textureID, 0, GL_FALSE, 0, GL_READ_WRITE, GL_RGBA32F);
+        glBindImageTexture(2 * fieldIndex + 1, patchLaplacians[fieldIndex].textureID, 0, GL_FALSE, 0, GL_READ_ONLY, GL_R32F);
+    }
+    // Dispatch and barrier
+    glDispatchCompute(xNumGroups, yNumGroups, 1);
+    glMemoryBarrier(GL_ALL_BARRIER_BITS);
+}
+
+void Simulation::dispatchPatchPass(ComputeShaderProgram *pass, float patchDt)
+{
+    std::vector<Texture2D> &patchFields = m_MeshRefinement->getPatchFields();
+    for (size_t fieldIndex = 0; fieldIndex < patchFields.size(); fieldIndex++)
+    {
+        pass->use();
+        glUniform1f(0, patchDt);
+        glBindImageTexture(0, patchFields[fieldIndex].textureID, 0, GL_FALSE, 0, GL_READ_WRITE, GL_RGBA32F);
+        // Dispatch and barrier
+        glDispatchCompute(patchFields[fieldIndex].width / 8, patchFields[fieldIndex].height / 8, 1);
+        glMemoryBarrier(GL_ALL_BARRIER_BITS);
+    }
+}
+
+void Simulation::bindCompensationTexture(size_t fieldIndex, uint32_t unit, uint32_t access)
+{
+    if (m_CompensationTextures.size() > 0)
+    {
+        glBindImageTexture(unit, m_CompensationTextures[fieldIndex].textureID, 0, GL_FALSE, 0, access, GL_RG16F);
+    }
+}
+
+void Simulation::initialiseSimulation()
+{
+    // Calculate phase if needed
+    if (m_Fields.size() > 1)
+    {
+        calculatePhase();
+    }
+
+    // Update acceleration but not value or velocity
+    calculateAcceleration(m_CurrentTimestep * dt, dt);
+    updateAcceleration();
+}
+
+void Simulation::startStringCount(size_t stringIndex)
+{
+    if (m_Reduction == nullptr)
+    {
+        logError("Can not count strings without the reduction passes!");
+        return;
+    }
+
+    while (m_StringCountQueries.size() < m_StringTextures.size())
+    {
+        m_StringCountQueries.push_back(std::make_unique<ReductionQuery>());
+    }
+    // Only one sample is kept in flight
+    if (m_StringCountQueries[stringIndex]->isPending())
+    {
+        collectDefectCounts(true);
+    }
+    m_Reduction->reduce(&m_StringTextures[stringIndex], 0, *m_StringCountQueries[stringIndex]);
+}
+
+void Simulation::startWallCount(size_t wallIndex)
+{
+    if (m_Reduction == nullptr)
+    {
+        logError("Can not count walls without the reduction passes!");
+        return;
+    }
+
+    while (m_WallCountQueries.size() < m_WallTextures.size())
+    {
+        m_WallCountQueries.push_back(std::make_unique<ReductionQuery>());
+    }
+    // Only one sample is kept in flight
+    if (m_WallCountQueries[wallIndex]->isPending())
+    {
+        collectDefectCounts(true);
+    }
+    m_Reduction->reduce(&m_WallTextures[wallIndex], 0, *m_WallCountQueries[wallIndex]);
+}
+
+void Simulation::collectDefectCounts(bool wait)
+{
+    // The counts of a sample are stored together so that every channel has the same number of samples
+    if (!wait)
+    {
+        for (const auto *queries : {&m_StringCountQueries, &m_WallCountQueries})
+        {
+            for (const auto &query : *queries)
+            {
+                if (query->isPending() && !query->isReady())
+                {
+                    return;
+                }
+            }
+        }
+    }
+
+    // The string texture only holds -1, 0 or +1 so the sum of squares is exactly the number of strings
+    for (size_t stringIndex = 0; stringIndex < m_StringCountQueries.size(); stringIndex++)
+    {
+        if (m_StringCountQueries[stringIndex]->isPending())
+        {
+            ReductionResult result = m_StringCountQueries[stringIndex]->getResult();
+            m_StringNumbers[stringIndex].push_back((int)std::lround(result.sumOfSquares));
+        }
+    }
+    // The wall texture holds whole numbers of crossings so the sum is exact
+    for (size_t wallIndex = 0; wallIndex < m_WallCountQueries.size(); wallIndex++)
+    {
+        if (m_WallCountQueries[wallIndex]->isPending())
+        {
+            ReductionResult result = m_WallCountQueries[wallIndex]->getResult();
+            m_WallNumbers[wallIndex].push_back((int)std::lround(result.sum));
+        }
+    }
+}
+
+std::vector<int> Simulation::getCurrentStringNumber()
+{
+    collectDefectCounts(false);
+    size_t stringIndex = floor(m_RenderIndex / 2);
+    if (m_StringNumbers.size() > 0)
+    {
+        std::vector<int> result;
+        for (const auto &currentStringVector : m_StringNumbers)
+        {
+            if (currentStringVector.size() > 0)
+            {
+                result.push_back(currentStringVector.back());
+            }
+        }
+        return result;
+    }
+    else
+    {
+        return std::vector<int>();
+    }
+}
+
+std::vector<int> Simulation::getCurrentWallNumber()
 {
-    return &m_LaplacianTextures[m_RenderIndex];
+    collectDefectCounts(false);
+    std::vector<int> result;
+    for (const auto &currentWallVector : m_WallNumbers)
+    {
+        if (currentWallVector.size() > 0)
+        {
+            result.push_back(currentWallVector.back());
+        }
+    }
+    return result;
 }
 
-Texture2D *Simulation::getCurrentPhase()
+std::vector<std::vector<float>> Simulation::generateRandomFieldData(
+    uint32_t numFields, uint32_t width, uint32_t height, uint32_t seed, const InitialSpectrum &spectrum)
 {
-    return &m_PhaseTextures[floor(m_RenderIndex / 2)];
+    std::vector<std::vector<float>> fieldData(numFields);
+    for (size_t fieldIndex = 0; fieldIndex < numFields; fieldIndex++)
+    {
+        std::vector<float> &textureData = fieldData[fieldIndex];
+        textureData.resize(height * width * 4);
+        for (int rowIndex = 0; rowIndex < height; rowIndex++)
+        {
+            for (int columnIndex = 0; columnIndex < width; columnIndex++)
+            {
+                // Red channel - field value
+                textureData[(rowIndex * 4 * width) + 4 * columnIndex + 0] =
+                    generateInitialFieldValue(seed, fieldIndex, columnIndex, rowIndex, 0);
+                // Green channel - field velocity
+                textureData[(rowIndex * 4 * width) + 4 * columnIndex + 1] = 0.0f;
+                // Acceleration is initialised to zero. It needs to be initialised by the simulation itself, as the simulation
+                // parameters will affect the calculation.
+                // Blue channel - current field acceleration
+                textureData[(rowIndex * 4 * width) + 4 * columnIndex + 2] = 0.0f;
+                // Alpha channel - next field acceleration
+                textureData[(rowIndex * 4 * width) + 4 * columnIndex + 3] = 0.0f;
+            }
+        }
+    }
+    // Fields that can not be filtered are left as white noise
+    filterRandomFieldData(fieldData, width, height, spectrum);
+    return fieldData;
 }
 
-Texture2D *Simulation::getCurrentStrings()
+void Simulation::randomiseFields(uint32_t width, uint32_t height, uint32_t seed)
 {
-    return &m_StringTextures[floor(m_RenderIndex / 2)];
-}
+    // The fields are only generated on the CPU if the shader is unavailable
+    std::vector<std::vector<float>> fieldData;
+    if (m_RandomiseFieldPass == nullptr)
+    {
+        logWarning("The randomise field pass failed to compile! Generating the random fields on the CPU instead.");
+        fieldData = generateRandomFieldData(m_NumFields, width, height, seed, initialSpectrum);
+    }
 
-float Simulation::getMaxValue()
-{
-    return 1.0f;
+    // Create new fields
+    std::vector<std::shared_ptr<Texture2D>> newFields(m_NumFields);
+
+    for (size_t fieldIndex = 0; fieldIndex < newFields.size(); fieldIndex++)
+    {
+        Texture2D *fieldTexture = new Texture2D();
+        fieldTexture->setTextureWrap(TextureWrapAxis::UV, TextureWrapMode::REPEAT);
+        fieldTexture->setTextureFilter(TextureFilterLevel::MIN_MAG, TextureFilterMode::LINEAR);
+        fieldTexture->width = width;
+        fieldTexture->height = height;
+        glTextureStorage2D(fieldTexture->textureID, 1, GL_RGBA32F, width, height);
+        newFields[fieldIndex] = std::shared_ptr<Texture2D>(fieldTexture);
+
+        if (m_RandomiseFieldPass == nullptr)
+        {
+            glTextureSubImage2D(
+                fieldTexture->textureID, 0, 0, 0, width, height, GL_RGBA, GL_FLOAT, fieldData[fieldIndex].data());
+            continue;
+        }
+
+        // Write the random values straight into the new field
+        m_RandomiseFieldPass->use();
+        glUniform1ui(0, seed);
+        glUniform1ui(1, fieldIndex);
+        glBindImageTexture(0, fieldTexture->textureID, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA32F);
+        glDispatchCompute((width + 7) / 8, (height + 7) / 8, 1);
+    }
+    glMemoryBarrier(GL_ALL_BARRIER_BITS);
+
+    // Correlate the noise of each pair of fields to the initial spectrum, or leave it as white noise if it can not be filtered
+    if (m_RandomiseFieldPass != nullptr && initialSpectrum.type != InitialSpectrumType::WHITE_NOISE)
+    {
+        for (size_t fieldIndex = 0; fieldIndex < newFields.size(); fieldIndex += 2)
+        {
+            Texture2D *secondField = fieldIndex + 1 < newFields.size() ? newFields[fieldIndex + 1].get() : nullptr;
+            if (ensureRandomFieldFilter() == nullptr || !m_RandomFieldFilter->filter(newFields[fieldIndex].get(), secondField, initialSpectrum))
+            {
+                logWarning("Could not filter the random fields to the %s initial spectrum! Using white noise instead.",
+                           convertInitialSpectrumTypeToString(initialSpectrum.type).c_str());
+                break;
+            }
+        }
+    }
+
+    // Set the new fields
+    setField(newFields);
 }
 
-float Simulation::getCurrentSimulationTime()
+bool Simulation::shouldStopTrial(TrialStopReason &reason)
 {
-    return (m_CurrentTimestep + 1) * dt;
+    int cadence = std::max(stringCountCadence, 1);
+    if ((m_CurrentTimestep - 1) % cadence != 0)
+    {
+        return false;
+    }
+
+    // The latest amplitudes are those of the previous sample, as the current sample is still being reduced
+    if (blowUpThreshold > 0.0f)
+    {
+        for (const auto &fieldAmplitudes : m_FieldAmplitudes)
+        {
+            if (fieldAmplitudes.size() > 0 && (!std::isfinite(fieldAmplitudes.back()) || fieldAmplitudes.back() > blowUpThreshold))
+            {
+                reason = TrialStopReason::BLOW_UP;
+                return true;
+            }
+        }
+    }
+
+    size_t numSamples = 0;
+    for (const auto &stringCount : m_StringNumbers)
+    {
+        numSamples = std::max(numSamples, stringCount.size());
+    }
+    for (const auto &wallCount : m_WallNumbers)
+    {
+        numSamples = std::max(numSamples, wallCount.size());
+    }
+    // Likewise the counts are those up to the previous sample. Only one count is kept in flight, so these have always been
+    // collected, while the count of the current sample may still be reduced.
+    numSamples = std::min(numSamples, (size_t)((m_CurrentTimestep - 1) / cadence));
+    if (numSamples == 0)
+    {
+        return false;
+    }
+
+    // The rules only look at sampled diagnostics so that a trial resumed from a checkpoint stops at the same timestep
+    if (classifyOutcomes && numSamples > 1)
+    {
+        m_OutcomeClassifier.addSample(getOutcomeSample(numSamples - 1));
+    }
+    int latestNumber = getDefectNumber(numSamples - 1);
+    if (zeroDefectWindow > 0)
+    {
+        size_t numWindowSamples = zeroDefectWindow / cadence + 1;
+        bool hasNoDefects = numSamples >= numWindowSamples;
+        for (size_t sampleIndex = numSamples - std::min(numWindowSamples, numSamples); hasNoDefects && sampleIndex < numSamples; sampleIndex++)
+        {
+            hasNoDefects = getDefectNumber(sampleIndex) == 0;
+        }
+        if (hasNoDefects)
+        {
+            reason = TrialStopReason::NO_DEFECTS;
+            return true;
+        }
+    }
+    if (plateauWindow > 0)
+    {
+        size_t numWindowSamples = plateauWindow / cadence + 1;
+        float tolerance = plateauTolerance * latestNumber;
+        bool isOnPlateau = numSamples >= numWindowSamples;
+        for (size_t sampleIndex = numSamples - std::min(numWindowSamples, numSamples); isOnPlateau && sampleIndex < numSamples; sampleIndex++)
+        {
+            isOnPlateau = std::abs(getDefectNumber(sampleIndex) - latestNumber) <= tolerance;
+        }
+        if (isOnPlateau)
+        {
+            reason = TrialStopReason::PLATEAU;
+            return true;
+        }
+    }
+    if (classifyOutcomes && stopWhenClassified && m_OutcomeClassifier.isConfident())
+    {
+        reason = TrialStopReason::CLASSIFIED;
+        return true;
+    }
+    return false;
 }
 
-int Simulation::getCurrentSimulationTimestep()
+void Simulation::calculateFieldAmplitudes()
 {
-    return m_CurrentTimestep;
+    if (m_Reduction == nullptr)
+    {
+        return;
+    }
+    // Only one sample is kept in flight
+    collectFieldAmplitudes(true);
+
+    while (m_FieldAmplitudeQueries.size() < m_Fields.size())
+    {
+        m_FieldAmplitudeQueries.push_back(std::make_unique<ReductionQuery>());
+    }
+    for (size_t fieldIndex = 0; fieldIndex < m_Fields.size(); fieldIndex++)
+    {
+        m_Reduction->reduce(&m_Fields[fieldIndex], 0, *m_FieldAmplitudeQueries[fieldIndex]);
+    }
 }
 
-Simulation *Simulation::createDomainWallSimulation()
+void Simulation::collectFieldAmplitudes(bool wait)
 {
-    // Set up compute shader
-    Shader *evolveFieldShader = new Shader("shaders/evolve_field.glsl", ShaderType::COMPUTE_SHADER);
-    ComputeShaderProgram *evolveFieldPass = new ComputeShaderProgram(evolveFieldShader);
-    if (!evolveFieldPass->isInitialised)
+    if (m_FieldAmplitudeQueries.size() < m_Fields.size() || !m_FieldAmplitudeQueries[0]->isPending())
     {
-        return nullptr;
+        return;
     }
-    delete evolveFieldShader;
-    Shader *evolveVelocityShader = new Shader("shaders/evolve_velocity.glsl", ShaderType::COMPUTE_SHADER);
-    ComputeShaderProgram *evolveVelocityPass = new ComputeShaderProgram(evolveVelocityShader);
-    if (!evolveVelocityPass->isInitialised)
+    if (!wait)
     {
-        return nullptr;
+        for (size_t fieldIndex = 0; fieldIndex < m_Fields.size(); fieldIndex++)
+        {
+            if (!m_FieldAmplitudeQueries[fieldIndex]->isReady())
+            {
+                return;
+            }
+        }
     }
-    delete evolveVelocityShader;
-    Shader *calculateAccelerationShader = new Shader("shaders/domain_walls.glsl", ShaderType::COMPUTE_SHADER);
-    ComputeShaderProgram *calculateAccelerationPass = new ComputeShaderProgram(calculateAccelerationShader);
-    if (!calculateAccelerationPass->isInitialised)
+
+    // A NaN anywhere in the field makes the root mean square NaN
+    m_FieldAmplitudes.resize(m_Fields.size());
+    for (size_t fieldIndex = 0; fieldIndex < m_Fields.size(); fieldIndex++)
     {
-        return nullptr;
+        ReductionResult result = m_FieldAmplitudeQueries[fieldIndex]->getResult();
+        m_FieldAmplitudes[fieldIndex].push_back(result.count > 0 ? sqrt(result.sumOfSquares / result.count) : 0.0f);
     }
-    delete calculateAccelerationShader;
-    Shader *updateAccelerationShader = new Shader("shaders/update_acceleration.glsl", ShaderType::COMPUTE_SHADER);
-    ComputeShaderProgram *updateAccelerationPass = new ComputeShaderProgram(updateAccelerationShader);
-    if (!updateAccelerationPass->isInitialised)
+}
+
+OutcomeSample Simulation::getOutcomeSample(size_t sampleIndex)
+{
+    OutcomeSample sample;
+    sample.timestep = 1 + sampleIndex * std::max(stringCountCadence, 1);
+    sample.time = sample.timestep * dt;
+    for (const auto &stringCount : m_StringNumbers)
     {
-        return nullptr;
+        sample.numStrings += sampleIndex < stringCount.size() ? stringCount[sampleIndex] : 0;
     }
-    delete updateAccelerationShader;
-    Shader *calculateLaplacianShader = new Shader("shaders/calculate_laplacian.glsl", ShaderType::COMPUTE_SHADER);
-    ComputeShaderProgram *calculateLaplacianPass = new ComputeShaderProgram(calculateLaplacianShader);
-    if (!calculateLaplacianPass->isInitialised)
+    for (const auto &wallCount : m_WallNumbers)
     {
-        return nullptr;
+        sample.numWalls += sampleIndex < wallCount.size() ? wallCount[sampleIndex] : 0;
     }
-    delete calculateLaplacianShader;
-
-    // Domain wall
-    SimulationLayout simulationLayout = {
-        {UniformDataType::FLOAT, std::string("eta"), 1.0f, 0.0f, 10.0f},
-        {UniformDataType::FLOAT, std::string("lam"), 5.0f, 0.1f, 10.0f}};
 
-    uint32_t numFields = 1;
+    // The component sample before the latest one to start has always been collected, as only one is kept in flight
+    int32_t componentIndex = componentCadence > 0 ? (sample.timestep - 1) / componentCadence - 1 : -1;
+    for (size_t wallIndex = 0; componentIndex >= 0 && wallIndex < m_WallTextures.size() && wallIndex < m_ComponentSummaries.size(); wallIndex++)
+    {
+        const std::vector<int32_t> &summaries = m_ComponentSummaries[wallIndex];
+        size_t offset = (size_t)componentIndex * ComponentLabelling::NUM_SUMMARY_VALUES;
+        if (offset < summaries.size())
+        {
+            sample.numDomains = std::max(sample.numDomains, summaries[offset]);
+        }
+    }
 
-    return new Simulation(
-        numFields,
-        evolveFieldPass,
-        evolveVelocityPass,
-        calculateAccelerationPass,
-        updateAccelerationPass,
-        calculateLaplacianPass,
-        nullptr,
-        false,
-        nullptr,
-        false,
-        simulationLayout);
+    // Likewise the amplitude sample before this one has always been collected. Each complex field is a pair of real fields.
+    if (sampleIndex > 0 && m_FieldAmplitudes.size() >= 4)
+    {
+        float squaredAmplitudes[2] = {};
+        for (size_t fieldIndex = 0; fieldIndex < 4; fieldIndex++)
+        {
+            const std::vector<float> &fieldAmplitudes = m_FieldAmplitudes[fieldIndex];
+            float amplitude = sampleIndex - 1 < fieldAmplitudes.size() ? fieldAmplitudes[sampleIndex - 1] : 0.0f;
+            squaredAmplitudes[fieldIndex / 2] += amplitude * amplitude;
+        }
+        float firstAmplitude = sqrt(squaredAmplitudes[0]);
+        float secondAmplitude = sqrt(squaredAmplitudes[1]);
+        if (firstAmplitude + secondAmplitude > 0.0f)
+        {
+            sample.amplitudeImbalance = std::fabs(firstAmplitude - secondAmplitude) / (firstAmplitude + secondAmplitude);
+        }
+    }
+    return sample;
 }
 
-Simulation *Simulation::createCosmicStringSimulation()
+int Simulation::getDefectNumber(size_t sampleIndex)
 {
-    // Set up compute shader
-    Shader *evolveFieldShader = new Shader("shaders/evolve_field.glsl", ShaderType::COMPUTE_SHADER);
-    ComputeShaderProgram *evolveFieldPass = new ComputeShaderProgram(evolveFieldShader);
-    if (!evolveFieldPass->isInitialised)
+    int defectNumber = 0;
+    for (const auto &stringCount : m_StringNumbers)
     {
-        return nullptr;
+        defectNumber += sampleIndex < stringCount.size() ? stringCount[sampleIndex] : 0;
     }
-    delete evolveFieldShader;
-    Shader *evolveVelocityShader = new Shader("shaders/evolve_velocity.glsl", ShaderType::COMPUTE_SHADER);
-    ComputeShaderProgram *evolveVelocityPass = new ComputeShaderProgram(evolveVelocityShader);
-    if (!evolveVelocityPass->isInitialised)
+    for (const auto &wallCount : m_WallNumbers)
     {
-        return nullptr;
+        defectNumber += sampleIndex < wallCount.size() ? wallCount[sampleIndex] : 0;
     }
-    delete evolveVelocityShader;
-    Shader *calculateAccelerationShader = new Shader("shaders/cosmic_strings.glsl", ShaderType::COMPUTE_SHADER);
-    ComputeShaderProgram *calculateAccelerationPass = new ComputeShaderProgram(calculateAccelerationShader);
-    if (!calculateAccelerationPass->isInitialised)
+    return defectNumber;
+}
+
+// Helper function that pads samples of valuesPerSample values each up to numSamples samples by repeating the last sample. This
+// fills in the samples of a trial that stopped early.
+template <typename T>
+static void padSamples(std::vector<T> &samples, uint32_t numSamples, uint32_t valuesPerSample)
+{
+    size_t numValues = (size_t)numSamples * valuesPerSample;
+    if (samples.size() < valuesPerSample || samples.size() >= numValues)
     {
-        return nullptr;
+        return;
     }
-    delete calculateAccelerationShader;
-    Shader *updateAccelerationShader = new Shader("shaders/update_acceleration.glsl", ShaderType::COMPUTE_SHADER);
-    ComputeShaderProgram *updateAccelerationPass = new ComputeShaderProgram(updateAccelerationShader);
-    if (!updateAccelerationPass->isInitialised)
+    size_t lastSampleStart = samples.size() - valuesPerSample;
+    samples.reserve(numValues);
+    while (samples.size() + valuesPerSample <= numValues)
     {
-        return nullptr;
+        for (uint32_t valueIndex = 0; valueIndex < valuesPerSample; valueIndex++)
+        {
+            samples.push_back(samples[lastSampleStart + valueIndex]);
+        }
     }
-    delete updateAccelerationShader;
-    Shader *calculateLaplacianShader = new Shader("shaders/calculate_laplacian.glsl", ShaderType::COMPUTE_SHADER);
-    ComputeShaderProgram *calculateLaplacianPass = new ComputeShaderProgram(calculateLaplacianShader);
-    if (!calculateLaplacianPass->isInitialised)
+}
+
+// A trial of a campaign that has been completed.
+struct CompletedTrial
+{
+public:
+    // Seed of the trial
+    uint32_t seed;
+    // The timestep the trial stopped at
+    uint32_t stopTimestep;
+    // Why the trial stopped
+    TrialStopReason stopReason;
+    // The classified outcome of the trial
+    TrialOutcome outcome;
+};
+
+// The description, progress and output files of a campaign of random trials.
+struct TrialCampaign
+{
+public:
+    // Folder holding the campaign
+    std::string folderPath;
+    // Paths of the files in the folder
+    std::string journalPath;
+    std::string checkpointPath;
+    std::string stringCountPath;
+    std::string wallCountPath;
+    std::string energyPath;
+    std::string spectrumPath;
+    std::string componentPath;
+    std::string statisticsPath;
+    std::string outcomePath;
+    // Identifies runs that can be resumed from each other
+    std::string signature;
+
+    // Headers of each ensemble. Only the string counts are always written.
+    EnsembleHeader header;
+    EnsembleHeader wallHeader;
+    EnsembleHeader energyHeader;
+    EnsembleHeader spectrumHeader;
+    EnsembleHeader componentHeader;
+    bool hasWallCounts = false;
+    bool hasEnergies = false;
+    bool hasSpectra = false;
+    bool hasComponents = false;
+
+    // Trials completed so far
+    std::vector<CompletedTrial> completedTrials;
+    // Ensembles of each output. These are written on the I/O thread, so they must only be closed once it has been flushed.
+    std::unique_ptr<EnsembleFile> stringCountFile;
+    std::unique_ptr<EnsembleFile> wallCountFile;
+    std::unique_ptr<EnsembleFile> energyFile;
+    std::unique_ptr<EnsembleFile> spectrumFile;
+    std::unique_ptr<EnsembleFile> componentFile;
+    // Summary of the string counts of the completed trials. This is only updated on the I/O thread.
+    std::unique_ptr<EnsembleStatistics> stringCountStatistics;
+
+    // Returns true if every ensemble that is written is open
+    inline bool hasOpenFiles() const
     {
-        return nullptr;
+        return stringCountFile != nullptr && (!hasWallCounts || wallCountFile != nullptr) && (!hasEnergies || energyFile != nullptr) &&
+               (!hasSpectra || spectrumFile != nullptr) && (!hasComponents || componentFile != nullptr);
     }
-    delete calculateLaplacianShader;
-    Shader *calculatePhaseShader = new Shader("shaders/calculate_phase.glsl", ShaderType::COMPUTE_SHADER);
-    ComputeShaderProgram *calculatePhasePass = new ComputeShaderProgram(calculatePhaseShader);
-    if (!calculatePhasePass->isInitialised)
+    // Closes every ensemble
+    inline void closeFiles()
     {
-        return nullptr;
+        stringCountFile.reset();
+        wallCountFile.reset();
+        energyFile.reset();
+        spectrumFile.reset();
+        componentFile.reset();
     }
-    delete calculatePhaseShader;
-    Shader *detectStringsShader = new Shader("shaders/detect_strings.glsl", ShaderType::COMPUTE_SHADER);
-    ComputeShaderProgram *detectStringsPass = new ComputeShaderProgram(detectStringsShader);
-    if (!detectStringsPass->isInitialised)
+};
+
+// Reads the completed trials from a campaign journal. Returns false if the journal does not exist or belongs to a different
+// campaign.
+static bool readCampaignJournal(const std::string &journalPath, const std::string &signature, std::vector<CompletedTrial> &completedTrials)
+{
+    std::ifstream journalFile(journalPath);
+    if (!journalFile.is_open())
     {
-        return nullptr;
+        return false;
     }
-    delete detectStringsShader;
 
-    // Cosmic string
-    SimulationLayout simulationLayout = {
-        {UniformDataType::FLOAT, std::string("eta"), 1.0f, 0.0f, 10.0f},
-        {UniformDataType::FLOAT, std::string("lam"), 5.0f, 0.1f, 10.0f}};
+    // The first line identifies the campaign
+    std::string journalSignature;
+    std::getline(journalFile, journalSignature);
+    if (journalSignature != signature)
+    {
+        return false;
+    }
 
-    uint32_t numFields = 2;
+    // Every other line is the index, seed, stopping timestep, stop reason and outcome of a completed trial
+    uint32_t trialIndex;
+    uint32_t seed;
+    uint32_t stopTimestep;
+    uint32_t stopReason;
+    uint32_t outcome;
+    completedTrials.clear();
+    while (journalFile >> trialIndex >> seed >> stopTimestep >> stopReason >> outcome)
+    {
+        if (stopReason > (uint32_t)TrialStopReason::CLASSIFIED || outcome > (uint32_t)TrialOutcome::STABLE_ALTERNATING_WALLS)
+        {
+            logWarning("The campaign journal %s has an unknown stop reason %d or outcome %d!", journalPath.c_str(), stopReason, outcome);
+            return false;
+        }
+        completedTrials.push_back({seed, stopTimestep, (TrialStopReason)stopReason, (TrialOutcome)outcome});
+    }
+    return true;
+}
 
-    return new Simulation(
-        numFields,
-        evolveFieldPass,
-        evolveVelocityPass,
-        calculateAccelerationPass,
-        updateAccelerationPass,
-        calculateLaplacianPass,
-        calculatePhasePass,
-        false,
-        detectStringsPass,
-        true,
-        simulationLayout);
+// Atomically replaces the campaign journal with the given list of completed trials.
+static void writeCampaignJournal(const std::string &journalPath, const std::string &signature, const std::vector<CompletedTrial> &completedTrials)
+{
+    std::string tempPath = journalPath + ".tmp";
+    try
+    {
+        std::ofstream journalFile;
+        journalFile.exceptions(std::ofstream::failbit | std::ofstream::badbit);
+        journalFile.open(tempPath, std::ios::trunc);
+        journalFile << signature << "\n";
+        for (size_t trialIndex = 0; trialIndex < completedTrials.size(); trialIndex++)
+        {
+            const CompletedTrial &trial = completedTrials[trialIndex];
+            journalFile << trialIndex << " " << trial.seed << " " << trial.stopTimestep << " " << (uint32_t)trial.stopReason << " "
+                        << (uint32_t)trial.outcome << "\n";
+        }
+        journalFile.close();
+        std::filesystem::rename(tempPath, journalPath);
+    }
+    catch (std::ofstream::failure &e)
+    {
+        logError("Failed to write campaign journal at path: %s - %s", tempPath.c_str(), e.what());
+    }
+    catch (std::filesystem::filesystem_error &e)
+    {
+        logError("Failed to replace campaign journal at path: %s - %s", journalPath.c_str(), e.what());
+    }
 }
 
-Simulation *Simulation::createSingleAxionSimulation()
+// Atomically replaces the csv of the outcomes of the completed trials.
+static void writeCampaignOutcomes(const std::string &outcomePath, const std::vector<CompletedTrial> &completedTrials)
 {
-    // Set up compute shader
-    Shader *evolveFieldShader = new Shader("shaders/evolve_field.glsl", ShaderType::COMPUTE_SHADER);
-    ComputeShaderProgram *evolveFieldPass = new ComputeShaderProgram(evolveFieldShader);
-    if (!evolveFieldPass->isInitialised)
+    std::string tempPath = outcomePath + ".tmp";
+    try
     {
-        return nullptr;
+        std::ofstream outcomeFile;
+        outcomeFile.exceptions(std::ofstream::failbit | std::ofstream::badbit);
+        outcomeFile.open(tempPath, std::ios::trunc);
+        outcomeFile << "trial,seed,stop_timestep,stop_reason,outcome,code\n";
+        for (size_t trialIndex = 0; trialIndex < completedTrials.size(); trialIndex++)
+        {
+            const CompletedTrial &trial = completedTrials[trialIndex];
+            outcomeFile << trialIndex << "," << trial.seed << "," << trial.stopTimestep << ","
+                        << convertTrialStopReasonToString(trial.stopReason) << "," << convertTrialOutcomeToString(trial.outcome) << ","
+                        << getTrialOutcomeCode(trial.outcome) << "\n";
+        }
+        outcomeFile.close();
+        std::filesystem::rename(tempPath, outcomePath);
     }
-    delete evolveFieldShader;
-    Shader *evolveVelocityShader = new Shader("shaders/evolve_velocity.glsl", ShaderType::COMPUTE_SHADER);
-    ComputeShaderProgram *evolveVelocityPass = new ComputeShaderProgram(evolveVelocityShader);
-    if (!evolveVelocityPass->isInitialised)
+    catch (std::ofstream::failure &e)
+    {
+        logError("Failed to write campaign outcomes at path: %s - %s", tempPath.c_str(), e.what());
+    }
+    catch (std::filesystem::filesystem_error &e)
+    {
+        logError("Failed to replace campaign outcomes at path: %s - %s", outcomePath.c_str(), e.what());
+    }
+}
+
+void Simulation::describeCampaign(
+    TrialCampaign &campaign, uint32_t width, uint32_t height, uint32_t numTrials, uint32_t startSeed,
+    const std::string &outFolder)
+{
+    // The campaign lives in the folder of name `outFolder` in the data directory
+    std::stringstream folderStream;
+    folderStream << "data/" << outFolder;
+    campaign.folderPath = folderStream.str();
+    campaign.journalPath = campaign.folderPath + "/campaign.journal";
+    campaign.checkpointPath = campaign.folderPath + "/checkpoint.ctdc";
+    campaign.stringCountPath = campaign.folderPath + "/string_counts.ctde";
+    campaign.wallCountPath = campaign.folderPath + "/wall_counts.ctde";
+    campaign.energyPath = campaign.folderPath + "/energies.ctde";
+    campaign.spectrumPath = campaign.folderPath + "/spectra.ctde";
+    campaign.componentPath = campaign.folderPath + "/components.ctde";
+    campaign.statisticsPath = campaign.folderPath + "/string_count_statistics.csv";
+    campaign.outcomePath = campaign.folderPath + "/outcomes.csv";
+
+    // Generate seeds
+    std::default_random_engine seedGenerator;
+    seedGenerator.seed(startSeed);
+    std::uniform_int_distribution<uint32_t> seedDistribution(0, UINT32_MAX);
+
+    // Describe the ensemble of string counts. The first timestep is always sampled.
+    uint32_t cadence = std::max(stringCountCadence, 1);
+    EnsembleHeader &header = campaign.header;
+    header.dataType = EnsembleDataType::INT32;
+    header.numChannels = m_StringNumbers.size();
+    header.numTrials = numTrials;
+    header.numSamples = (maxTimesteps + cadence - 1) / cadence;
+    header.valuesPerSample = 1;
+    header.cadence = cadence;
+    header.maxTimesteps = maxTimesteps;
+    header.width = width;
+    header.height = height;
+    header.era = era;
+    header.dt = dt;
+    header.dx = dx;
+    header.modelName = convertSimulationModelToString(m_Model);
+    header.parameters = getParameters();
+    for (size_t trialIndex = 0; trialIndex < numTrials; trialIndex++)
     {
-        return nullptr;
+        header.seeds.push_back(seedDistribution(seedGenerator));
     }
-    delete evolveVelocityShader;
-    Shader *calculateAccelerationShader = new Shader("shaders/single_axion.glsl", ShaderType::COMPUTE_SHADER);
-    ComputeShaderProgram *calculateAccelerationPass = new ComputeShaderProgram(calculateAccelerationShader);
-    if (!calculateAccelerationPass->isInitialised)
+
+    // Describe the ensemble of wall counts, which are sampled alongside the string counts
+    campaign.hasWallCounts = m_WallNumbers.size() > 0;
+    campaign.wallHeader = header;
+    campaign.wallHeader.numChannels = m_WallNumbers.size();
+
+    // Describe the ensemble of energy budgets, which holds (kinetic, gradient, potential) for each sample
+    campaign.hasEnergies = energyCadence > 0;
+    EnsembleHeader &energyHeader = campaign.energyHeader;
+    energyHeader = header;
+    energyHeader.dataType = EnsembleDataType::FLOAT32;
+    energyHeader.numChannels = 1;
+    energyHeader.valuesPerSample = 3;
+    energyHeader.cadence = std::max(energyCadence, 1);
+    energyHeader.numSamples = (maxTimesteps + energyHeader.cadence - 1) / energyHeader.cadence;
+
+    // Describe the ensemble of power spectra, which holds the radial bins of each sample
+    uint32_t numSpectrumBins = PowerSpectrum::calculateNumBins(width, height);
+    campaign.hasSpectra = spectrumCadence > 0 && numSpectrumBins > 0 && ensurePowerSpectrum() != nullptr;
+    EnsembleHeader &spectrumHeader = campaign.spectrumHeader;
+    spectrumHeader = header;
+    spectrumHeader.dataType = EnsembleDataType::FLOAT32;
+    spectrumHeader.numChannels = getNumPowerSpectrumChannels();
+    spectrumHeader.valuesPerSample = numSpectrumBins;
+    spectrumHeader.cadence = std::max(spectrumCadence, 1);
+    spectrumHeader.numSamples = (maxTimesteps + spectrumHeader.cadence - 1) / spectrumHeader.cadence;
+
+    // Describe the ensemble of component summaries
+    campaign.hasComponents = componentCadence > 0 && getNumComponentChannels() > 0 && ensureComponentLabelling() != nullptr;
+    EnsembleHeader &componentHeader = campaign.componentHeader;
+    componentHeader = header;
+    componentHeader.numChannels = getNumComponentChannels();
+    componentHeader.valuesPerSample = ComponentLabelling::NUM_SUMMARY_VALUES;
+    componentHeader.cadence = std::max(componentCadence, 1);
+    componentHeader.numSamples = (maxTimesteps + componentHeader.cadence - 1) / componentHeader.cadence;
+
+    // The campaign signature identifies runs that can be resumed from each other
+    std::stringstream signatureStream;
+    signatureStream.precision(9);
+    signatureStream << header.modelName << " precision" << convertFieldPrecisionToString(m_Precision) << " M" << height << " N"
+                    << width << " trials" << numTrials << " seed" << startSeed << " steps" << maxTimesteps << " cadence" << cadence
+                    << " energyCadence" << energyCadence
+                    << " spectrumCadence" << (campaign.hasSpectra ? spectrumCadence : 0) << " componentCadence"
+                    << (campaign.hasComponents ? componentCadence : 0) << " domainSectors" << domainSectors << " dt" << dt
+                    << " dx" << dx << " era" << era << " zeroDefectWindow" << zeroDefectWindow << " plateauWindow" << plateauWindow
+                    << " plateauTolerance" << plateauTolerance << " blowUpThreshold" << blowUpThreshold << " classifyOutcomes"
+                    << classifyOutcomes << " stopWhenClassified" << stopWhenClassified;
+    // Stencil campaigns keep the signature they had before the operator could be chosen
+    if (laplacianOperator != LaplacianOperator::STENCIL)
     {
-        return nullptr;
+        signatureStream << " laplacian" << convertLaplacianOperatorToString(laplacianOperator);
     }
-    delete calculateAccelerationShader;
-    Shader *updateAccelerationShader = new Shader("shaders/update_acceleration.glsl", ShaderType::COMPUTE_SHADER);
-    ComputeShaderProgram *updateAccelerationPass = new ComputeShaderProgram(updateAccelerationShader);
-    if (!updateAccelerationPass->isInitialised)
+    // Fixed step campaigns keep the signature they had before steps could be adapted
+    if (adaptiveTimestep)
     {
-        return nullptr;
+        signatureStream << " courantNumber" << courantNumber << " maxSubsteps" << maxSubsteps << " maxTimestepStride"
+                        << maxTimestepStride;
     }
-    delete updateAccelerationShader;
-    Shader *calculateLaplacianShader = new Shader("shaders/calculate_laplacian.glsl", ShaderType::COMPUTE_SHADER);
-    ComputeShaderProgram *calculateLaplacianPass = new ComputeShaderProgram(calculateLaplacianShader);
-    if (!calculateLaplacianPass->isInitialised)
+    // White noise campaigns keep the signature they had before spectra could be chosen
+    if (initialSpectrum.type != InitialSpectrumType::WHITE_NOISE)
     {
-        return nullptr;
+        signatureStream << " spectrum" << convertInitialSpectrumTypeToString(initialSpectrum.type) << " correlationLength"
+                        << initialSpectrum.correlationLength << " spectralIndex" << initialSpectrum.spectralIndex;
     }
-    delete calculateLaplacianShader;
-    Shader *calculatePhaseShader = new Shader("shaders/calculate_phase.glsl", ShaderType::COMPUTE_SHADER);
-    ComputeShaderProgram *calculatePhasePass = new ComputeShaderProgram(calculatePhaseShader);
-    if (!calculatePhasePass->isInitialised)
+    if (classifyOutcomes)
     {
-        return nullptr;
+        signatureStream << " minTimestep" << m_OutcomeClassifier.minTimestep << " slopeWindow" << m_OutcomeClassifier.slopeWindow
+                        << " confidenceWindow" << m_OutcomeClassifier.confidenceWindow << " closeToZeroFraction"
+                        << m_OutcomeClassifier.closeToZeroFraction << " unstableSlope" << m_OutcomeClassifier.unstableSlope
+                        << " stableSlope" << m_OutcomeClassifier.stableSlope << " imbalanceThreshold"
+                        << m_OutcomeClassifier.imbalanceThreshold << " alternatingDomains" << m_OutcomeClassifier.alternatingDomains;
     }
-    delete calculatePhaseShader;
-    Shader *detectStringsShader = new Shader("shaders/detect_strings.glsl", ShaderType::COMPUTE_SHADER);
-    ComputeShaderProgram *detectStringsPass = new ComputeShaderProgram(detectStringsShader);
-    if (!detectStringsPass->isInitialised)
+    for (const auto &[name, value] : header.parameters)
     {
-        return nullptr;
+        signatureStream << " " << name << value;
     }
-    delete detectStringsShader;
-
-    // Single axion
-    SimulationLayout simulationLayout = {
-        {UniformDataType::FLOAT, std::string("eta"), 1.0f, 0.0f, 10.0f},
-        {UniformDataType::FLOAT, std::string("lam"), 5.0f, 0.1f, 10.0f},
-        {UniformDataType::INT, std::string("colorAnomaly"), (int)3, (int)1, (int)10},
-        {UniformDataType::FLOAT, std::string("axionStrength"), 0.025f, 0.1f, 5.0f},
-        {UniformDataType::FLOAT, std::string("growthScale"), 75.0f, 50.0f, 100.0f},
-        {UniformDataType::FLOAT, std::string("growthLaw"), 2.0f, 1.0f, 7.0f},
-    };
-
-    uint32_t numFields = 2;
-
-    return new Simulation(
-        numFields,
-        evolveFieldPass,
-        evolveVelocityPass,
-        calculateAccelerationPass,
-        updateAccelerationPass,
-        calculateLaplacianPass,
-        calculatePhasePass,
-        true,
-        detectStringsPass,
-        true,
-        simulationLayout);
+    campaign.signature = signatureStream.str();
 }
 
-Simulation *Simulation::createCompanionAxionSimulation()
+bool Simulation::openCampaign(TrialCampaign &campaign, const std::string &outFolder)
 {
-    // Set up compute shader
-    Shader *evolveFieldShader = new Shader("shaders/evolve_field.glsl", ShaderType::COMPUTE_SHADER);
-    ComputeShaderProgram *evolveFieldPass = new ComputeShaderProgram(evolveFieldShader);
-    if (!evolveFieldPass->isInitialised)
-    {
-        return nullptr;
-    }
-    delete evolveFieldShader;
-    Shader *evolveVelocityShader = new Shader("shaders/evolve_velocity.glsl", ShaderType::COMPUTE_SHADER);
-    ComputeShaderProgram *evolveVelocityPass = new ComputeShaderProgram(evolveVelocityShader);
-    if (!evolveVelocityPass->isInitialised)
+    // Handle when the given folder name is invalid
+    try
     {
-        return nullptr;
+        // Resume the campaign if the folder holds an interrupted run of the same campaign
+        bool isResumable = readCampaignJournal(campaign.journalPath, campaign.signature, campaign.completedTrials) &&
+                           std::filesystem::exists(campaign.stringCountPath) &&
+                           (!campaign.hasWallCounts || std::filesystem::exists(campaign.wallCountPath)) &&
+                           (!campaign.hasEnergies || std::filesystem::exists(campaign.energyPath)) &&
+                           (!campaign.hasSpectra || std::filesystem::exists(campaign.spectrumPath)) &&
+                           (!campaign.hasComponents || std::filesystem::exists(campaign.componentPath));
+        if (isResumable)
+        {
+            campaign.stringCountFile.reset(EnsembleFile::open(campaign.stringCountPath.c_str()));
+            if (campaign.hasWallCounts)
+            {
+                campaign.wallCountFile.reset(EnsembleFile::open(campaign.wallCountPath.c_str()));
+            }
+            if (campaign.hasEnergies)
+            {
+                campaign.energyFile.reset(EnsembleFile::open(campaign.energyPath.c_str()));
+            }
+            if (campaign.hasSpectra)
+            {
+                campaign.spectrumFile.reset(EnsembleFile::open(campaign.spectrumPath.c_str()));
+            }
+            if (campaign.hasComponents)
+            {
+                campaign.componentFile.reset(EnsembleFile::open(campaign.componentPath.c_str()));
+            }
+            // Start over if any of the ensembles can not be opened
+            if (!campaign.hasOpenFiles())
+            {
+                campaign.closeFiles();
+            }
+        }
+
+        if (campaign.stringCountFile != nullptr)
+        {
+            logInfo("Resuming campaign in %s with %d of %d trials completed.", campaign.folderPath.c_str(),
+                    (int)campaign.completedTrials.size(), campaign.header.numTrials);
+        }
+        else
+        {
+            // TODO: This is a bit hacky, but not sure how to delete a folder's contents and not the folder itself
+            // Check if folder exists, and if so delete it and all of its contents
+            if (std::filesystem::exists(campaign.folderPath))
+            {
+                // Clear folder of all files
+                std::filesystem::remove_all(campaign.folderPath.c_str());
+                logTrace("Cleared folder at %s of all files.", campaign.folderPath.c_str());
+            }
+            // Create the folder
+            std::filesystem::create_directory(campaign.folderPath);
+            logInfo("Created a new folder at %s in the data directory.", campaign.folderPath.c_str());
+
+            campaign.completedTrials.clear();
+            campaign.stringCountFile.reset(EnsembleFile::create(campaign.stringCountPath.c_str(), campaign.header));
+            if (campaign.hasWallCounts)
+            {
+                campaign.wallCountFile.reset(EnsembleFile::create(campaign.wallCountPath.c_str(), campaign.wallHeader));
+            }
+            if (campaign.hasEnergies)
+            {
+                campaign.energyFile.reset(EnsembleFile::create(campaign.energyPath.c_str(), campaign.energyHeader));
+            }
+            if (campaign.hasSpectra)
+            {
+                campaign.spectrumFile.reset(EnsembleFile::create(campaign.spectrumPath.c_str(), campaign.spectrumHeader));
+            }
+            if (campaign.hasComponents)
+            {
+                campaign.componentFile.reset(EnsembleFile::create(campaign.componentPath.c_str(), campaign.componentHeader));
+            }
+            writeCampaignJournal(campaign.journalPath, campaign.signature, campaign.completedTrials);
+        }
     }
-    delete evolveVelocityShader;
-    Shader *calculateAccelerationShader = new Shader("shaders/companion_axion.glsl", ShaderType::COMPUTE_SHADER);
-    ComputeShaderProgram *calculateAccelerationPass = new ComputeShaderProgram(calculateAccelerationShader);
-    if (!calculateAccelerationPass->isInitialised)
+    catch (std::filesystem::filesystem_error &e)
     {
-        return nullptr;
+        logWarning("The given folder name %s is invalid! Aborting trials... Please input a valid folder name and try again.",
+                   outFolder.c_str());
+        return false;
     }
-    delete calculateAccelerationShader;
-    Shader *updateAccelerationShader = new Shader("shaders/update_acceleration.glsl", ShaderType::COMPUTE_SHADER);
-    ComputeShaderProgram *updateAccelerationPass = new ComputeShaderProgram(updateAccelerationShader);
-    if (!updateAccelerationPass->isInitialised)
+
+    if (!campaign.hasOpenFiles())
     {
-        return nullptr;
+        logWarning("Failed to create the ensemble files! Aborting trials...");
+        return false;
     }
-    delete updateAccelerationShader;
-    Shader *calculateLaplacianShader = new Shader("shaders/calculate_laplacian.glsl", ShaderType::COMPUTE_SHADER);
-    ComputeShaderProgram *calculateLaplacianPass = new ComputeShaderProgram(calculateLaplacianShader);
-    if (!calculateLaplacianPass->isInitialised)
+    // The journal is the record of completed trials, as a crash can happen after the ensemble was updated but before the journal
+    uint32_t numCompletedTrials = campaign.completedTrials.size();
+    for (EnsembleFile *ensembleFile : {campaign.stringCountFile.get(), campaign.wallCountFile.get(), campaign.energyFile.get(),
+                                       campaign.spectrumFile.get(), campaign.componentFile.get()})
     {
-        return nullptr;
+        if (ensembleFile != nullptr)
+        {
+            ensembleFile->numCompletedTrials = numCompletedTrials;
+        }
     }
-    delete calculateLaplacianShader;
-    Shader *calculatePhaseShader = new Shader("shaders/calculate_phase.glsl", ShaderType::COMPUTE_SHADER);
-    ComputeShaderProgram *calculatePhasePass = new ComputeShaderProgram(calculatePhaseShader);
-    if (!calculatePhasePass->isInitialised)
+
+    // Summarise the string counts as trials complete. A resumed campaign replays its completed trials in order, which gives the
+    // same summary as an uninterrupted run.
+    const EnsembleHeader &header = campaign.header;
+    campaign.stringCountStatistics =
+        std::make_unique<EnsembleStatistics>(header.numChannels, header.numSamples, header.cadence, dt);
+    std::vector<float> completedSamples;
+    for (uint32_t trialIndex = 0; trialIndex < numCompletedTrials; trialIndex++)
     {
-        return nullptr;
+        for (uint32_t stringIndex = 0; stringIndex < header.numChannels; stringIndex++)
+        {
+            if (campaign.stringCountFile->readSamples(stringIndex, trialIndex, completedSamples))
+            {
+                campaign.stringCountStatistics->addSamples(stringIndex, completedSamples);
+            }
+        }
+        campaign.stringCountStatistics->completeTrial();
     }
-    delete calculatePhaseShader;
-    Shader *detectStringsShader = new Shader("shaders/detect_strings.glsl", ShaderType::COMPUTE_SHADER);
-    ComputeShaderProgram *detectStringsPass = new ComputeShaderProgram(detectStringsShader);
-    if (!detectStringsPass->isInitialised)
+    return true;
+}
+
+TrialStopReason Simulation::runTrial(TrialCampaign &campaign, size_t trialIndex, bool canResume)
+{
+    uint32_t currentSeed = campaign.header.seeds[trialIndex];
+
+    // Continue from the last checkpoint if the campaign was interrupted during this trial
+    if (!canResume || !loadCheckpoint(campaign.checkpointPath.c_str(), trialIndex, currentSeed))
     {
-        return nullptr;
+        logInfo("Beginning trial %d with seed %d", (int)trialIndex, currentSeed);
+        randomiseFields(campaign.header.width, campaign.header.height, currentSeed);
     }
-    delete detectStringsShader;
+    runFlag = true;
 
-    // Companion axion
-    SimulationLayout simulationLayout = {
-        {UniformDataType::FLOAT, std::string("eta"), 1.0f, 0.0f, 10.0f},
-        {UniformDataType::FLOAT, std::string("lam"), 5.0f, 0.1f, 10.0f},
-        {UniformDataType::FLOAT, std::string("axionStrength"), 0.025f, 0.1f, 5.0f},
-        {UniformDataType::FLOAT, std::string("kappa"), 0.04f, 0.001f, 1.0f},
-        {UniformDataType::FLOAT, std::string("tGrowthScale"), 75.0f, 50.0f, 100.0f},
-        {UniformDataType::FLOAT, std::string("tGrowthLaw"), 2.0f, 1.0f, 7.0f},
-        {UniformDataType::FLOAT, std::string("sGrowthScale"), 75.0f, 50.0f, 100.0f},
-        {UniformDataType::FLOAT, std::string("sGrowthLaw"), 2.0f, 1.0f, 7.0f},
-        {UniformDataType::FLOAT, std::string("n"), 3.0f, 0.0f, 10.0f},
-        {UniformDataType::FLOAT, std::string("nPrime"), 1.0f, 0.0f, 10.0f},
-        {UniformDataType::FLOAT, std::string("m"), 1.0f, 0.0f, 10.0f},
-        {UniformDataType::FLOAT, std::string("mPrime"), 1.0f, 0.0f, 10.0f},
-    };
+    TrialStopReason stopReason = TrialStopReason::MAX_TIMESTEPS;
+    while (runFlag)
+    {
+        update();
 
-    uint32_t numFields = 4;
+        // Stop once the trial has nothing left to show
+        if (runFlag && shouldStopTrial(stopReason))
+        {
+            logInfo("Stopping trial %d at timestep %d of %d: %s", (int)trialIndex, m_CurrentTimestep, maxTimesteps,
+                    convertTrialStopReasonToString(stopReason).c_str());
+            runFlag = false;
+        }
 
-    return new Simulation(
-        numFields,
-        evolveFieldPass,
-        evolveVelocityPass,
-        calculateAccelerationPass,
-        updateAccelerationPass,
-        calculateLaplacianPass,
-        calculatePhasePass,
-        true,
-        detectStringsPass,
-        true,
-        simulationLayout);
+        if (runFlag && checkpointInterval > 0 && m_CurrentTimestep % checkpointInterval == 0)
+        {
+            saveCheckpoint(campaign.checkpointPath.c_str(), trialIndex, currentSeed);
+        }
+    }
+    return stopReason;
 }
 
-void Simulation::calculateLaplacian()
+void Simulation::submitTrialOutput(TrialCampaign &campaign, size_t trialIndex, TrialStopReason stopReason)
 {
-    // Bind each field texture and calculate the Laplacian
-    for (size_t fieldIndex = 0; fieldIndex < m_Fields.size(); fieldIndex++)
+    // A trial that stopped early repeats its last samples up to the end of the run
+    collectDefectCounts(true);
+    std::vector<std::vector<int>> stringNumbers = m_StringNumbers;
+    for (auto &stringCount : stringNumbers)
     {
-        // Calculate Laplacian
-        m_CalculateLaplacianPass->use();
-        glUniform1f(0, dx);
-        // Bind images
-        glActiveTexture(GL_TEXTURE0);
-        glBindImageTexture(0, m_Fields[fieldIndex].textureID, 0, GL_FALSE, 0, GL_READ_ONLY, GL_RGBA32F);
-        glActiveTexture(GL_TEXTURE1);
-        glBindImageTexture(1, m_LaplacianTextures[fieldIndex].textureID, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F);
-        // Dispatch and barrier
-        glDispatchCompute(m_XNumGroups, m_YNumGroups, 1);
-        glMemoryBarrier(GL_ALL_BARRIER_BITS);
+        padSamples(stringCount, campaign.header.numSamples, campaign.header.valuesPerSample);
     }
-}
-
-void Simulation::calculatePhase()
-{
-    // Bind two textures at once and calculate the phase
-    for (size_t phaseIndex = 0; phaseIndex < m_PhaseTextures.size(); phaseIndex++)
+    std::vector<std::vector<int>> wallNumbers = m_WallNumbers;
+    for (auto &wallCount : wallNumbers)
     {
-        m_CalculatePhasePass->use();
-        // Real part
-        glActiveTexture(GL_TEXTURE0);
-        glBindImageTexture(0, m_Fields[(size_t)2 * phaseIndex].textureID, 0, GL_FALSE, 0, GL_READ_ONLY, GL_RGBA32F);
-        // Imaginary part
-        glActiveTexture(GL_TEXTURE1);
-        glBindImageTexture(1, m_Fields[(size_t)2 * phaseIndex + 1].textureID, 0, GL_FALSE, 0, GL_READ_ONLY, GL_RGBA32F);
-        // Output phase texture
-        glActiveTexture(GL_TEXTURE2);
-        glBindImageTexture(2, m_PhaseTextures[phaseIndex].textureID, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F);
+        padSamples(wallCount, campaign.wallHeader.numSamples, campaign.wallHeader.valuesPerSample);
+    }
+    std::vector<float> energies = flattenEnergyBudgets(getEnergyBudgets());
+    padSamples(energies, campaign.energyHeader.numSamples, campaign.energyHeader.valuesPerSample);
+    std::vector<std::vector<float>> powerSpectra = getPowerSpectra();
+    for (auto &powerSpectrum : powerSpectra)
+    {
+        padSamples(powerSpectrum, campaign.spectrumHeader.numSamples, campaign.spectrumHeader.valuesPerSample);
+    }
+    std::vector<std::vector<int32_t>> componentSummaries = getComponentSummaries();
+    for (auto &componentSummary : componentSummaries)
+    {
+        padSamples(componentSummary, campaign.componentHeader.numSamples, campaign.componentHeader.valuesPerSample);
+    }
 
-        // Dispatch and barrier
-        glDispatchCompute(m_XNumGroups, m_YNumGroups, 1);
-        glMemoryBarrier(GL_ALL_BARRIER_BITS);
+    TrialOutcome outcome = m_OutcomeClassifier.getOutcome();
+    if (classifyOutcomes)
+    {
+        logInfo("Classified trial %d as %s (%s)", (int)trialIndex, convertTrialOutcomeToString(outcome).c_str(),
+                getTrialOutcomeCode(outcome).c_str());
+    }
+    if (adaptiveTimestep)
+    {
+        logInfo("Trial %d took %d adaptive steps over %d timesteps", (int)trialIndex, m_NumSteps, m_CurrentTimestep - 1);
     }
+    campaign.completedTrials.push_back({campaign.header.seeds[trialIndex], (uint32_t)m_CurrentTimestep, stopReason, outcome});
+
+    // Write this trial's samples into the ensembles on the I/O thread. The ensembles outlive the job as the campaign flushes
+    // the I/O thread before closing them.
+    EnsembleFile *stringCountFile = campaign.stringCountFile.get();
+    EnsembleFile *wallCountFile = campaign.wallCountFile.get();
+    EnsembleFile *energyFile = campaign.energyFile.get();
+    EnsembleFile *spectrumFile = campaign.spectrumFile.get();
+    EnsembleFile *componentFile = campaign.componentFile.get();
+    EnsembleStatistics *stringCountStatistics = campaign.stringCountStatistics.get();
+    submitIO(
+        [stringCountFile, wallCountFile, energyFile, spectrumFile, componentFile, stringCountStatistics, trialIndex,
+         stringNumbers = std::move(stringNumbers), wallNumbers = std::move(wallNumbers), energies = std::move(energies),
+         powerSpectra = std::move(powerSpectra), componentSummaries = std::move(componentSummaries),
+         completedTrials = campaign.completedTrials, journalPath = campaign.journalPath, signature = campaign.signature,
+         checkpointPath = campaign.checkpointPath, statisticsPath = campaign.statisticsPath, outcomePath = campaign.outcomePath,
+         isClassifying = classifyOutcomes]()
+        {
+            for (size_t stringIndex = 0; stringIndex < stringNumbers.size(); stringIndex++)
+            {
+                stringCountFile->writeSamples(stringIndex, trialIndex, stringNumbers[stringIndex]);
+            }
+            stringCountFile->completeTrial();
+            for (size_t stringIndex = 0; stringIndex < stringNumbers.size(); stringIndex++)
+            {
+                stringCountStatistics->addSamples(stringIndex, stringNumbers[stringIndex]);
+            }
+            stringCountStatistics->completeTrial();
+            stringCountStatistics->write(statisticsPath);
+            if (wallCountFile != nullptr)
+            {
+                for (size_t wallIndex = 0; wallIndex < wallNumbers.size(); wallIndex++)
+                {
+                    wallCountFile->writeSamples(wallIndex, trialIndex, wallNumbers[wallIndex]);
+                }
+                wallCountFile->completeTrial();
+            }
+            if (energyFile != nullptr)
+            {
+                energyFile->writeSamples(0, trialIndex, energies);
+                energyFile->completeTrial();
+            }
+            if (spectrumFile != nullptr)
+            {
+                for (size_t channelIndex = 0; channelIndex < powerSpectra.size(); channelIndex++)
+                {
+                    spectrumFile->writeSamples(channelIndex, trialIndex, powerSpectra[channelIndex]);
+                }
+                spectrumFile->completeTrial();
+            }
+            if (componentFile != nullptr)
+            {
+                for (size_t channelIndex = 0; channelIndex < componentSummaries.size(); channelIndex++)
+                {
+                    componentFile->writeSamples(channelIndex, trialIndex, componentSummaries[channelIndex]);
+                }
+                componentFile->completeTrial();
+            }
+
+            // Record the trial as completed only once its output is flushed
+            writeCampaignJournal(journalPath, signature, completedTrials);
+            if (isClassifying)
+            {
+                writeCampaignOutcomes(outcomePath, completedTrials);
+            }
+            std::error_code errorCode;
+            std::filesystem::remove(checkpointPath, errorCode);
+        });
 }
 
-void Simulation::detectStrings()
+void Simulation::logCampaignSummary(const TrialCampaign &campaign)
 {
-    // Bind two textures at once and detect the strings
-    for (size_t stringIndex = 0; stringIndex < m_StringTextures.size(); stringIndex++)
+    // Report the timesteps that were saved by stopping trials early
+    uint64_t numTrialTimesteps = std::max(maxTimesteps - 1, 0);
+    uint64_t numSavedTimesteps = 0;
+    uint32_t numStoppedTrials[5] = {};
+    uint32_t numOutcomes[8] = {};
+    for (const auto &trial : campaign.completedTrials)
     {
-        m_DetectStringsPass->use();
-        // Real part
-        glActiveTexture(GL_TEXTURE0);
-        glBindImageTexture(0, m_Fields[(size_t)2 * stringIndex].textureID, 0, GL_FALSE, 0, GL_READ_ONLY, GL_RGBA32F);
-        // Imaginary part
-        glActiveTexture(GL_TEXTURE1);
-        glBindImageTexture(1, m_Fields[(size_t)2 * stringIndex + 1].textureID, 0, GL_FALSE, 0, GL_READ_ONLY, GL_RGBA32F);
-        // Output string texture
-        glActiveTexture(GL_TEXTURE2);
-        glBindImageTexture(2, m_StringTextures[stringIndex].textureID, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F);
-
-        // Dispatch and barrier
-        glDispatchCompute(m_XNumGroups, m_YNumGroups, 1);
-        glMemoryBarrier(GL_ALL_BARRIER_BITS);
-
-        // Store the string count
-        m_StringNumbers[stringIndex].push_back(getStringNumber(stringIndex));
+        numSavedTimesteps += std::max(maxTimesteps - (int)trial.stopTimestep, 0);
+        numStoppedTrials[(uint32_t)trial.stopReason]++;
+        numOutcomes[(uint32_t)trial.outcome]++;
+    }
+    uint64_t numCampaignTimesteps = numTrialTimesteps * campaign.completedTrials.size();
+    logInfo("Stopped %d trials without defects, %d on a plateau, %d after blowing up and %d once classified. Saved %lld of %lld "
+            "timesteps (%.1f%%).",
+            numStoppedTrials[(uint32_t)TrialStopReason::NO_DEFECTS], numStoppedTrials[(uint32_t)TrialStopReason::PLATEAU],
+            numStoppedTrials[(uint32_t)TrialStopReason::BLOW_UP], numStoppedTrials[(uint32_t)TrialStopReason::CLASSIFIED],
+            numSavedTimesteps, numCampaignTimesteps, 100.0 * numSavedTimesteps / std::max(numCampaignTimesteps, (uint64_t)1));
+    if (classifyOutcomes)
+    {
+        std::stringstream outcomeStream;
+        for (uint32_t outcomeIndex = 0; outcomeIndex < 8; outcomeIndex++)
+        {
+            if (numOutcomes[outcomeIndex] > 0)
+            {
+                outcomeStream << " " << getTrialOutcomeCode((TrialOutcome)outcomeIndex) << ":" << numOutcomes[outcomeIndex];
+            }
+        }
+        logInfo("Outcomes of the campaign:%s", outcomeStream.str().c_str());
     }
+
+    IOServiceMetrics metrics = getIOMetrics();
+    logDebug(
+        "I/O thread completed %lld jobs with a maximum queue depth of %d. Submissions stalled %lld times for a total of %f ms.",
+        metrics.numCompletedJobs, metrics.maxQueueDepth, metrics.numStalledSubmissions, metrics.totalStallMilliseconds);
 }
 
-void Simulation::calculateAcceleration()
+void Simulation::runRandomTrials(uint32_t width, uint32_t height, uint32_t numTrials, uint32_t startSeed, std::string outFolder)
 {
-    // Calculate the acceleration
-    m_CalculateAccelerationPass->use();
-    glUniform1f(0, m_CurrentTimestep * dt);
-    glUniform1f(1, dt);
-    glUniform1i(2, era);
-    bindUniforms();
-    uint32_t bindIndex = 0;
-    uint32_t activeTextureIndex = GL_TEXTURE0;
-    for (size_t fieldIndex = 0; fieldIndex < m_Fields.size(); fieldIndex++)
+    TrialCampaign campaign;
+    describeCampaign(campaign, width, height, numTrials, startSeed, outFolder);
+    if (!openCampaign(campaign, outFolder))
+    {
+        return;
+    }
+
+    auto startTime = std::chrono::high_resolution_clock::now();
+
+    // Only the first trial of a run can have been interrupted. The checkpoints of later trials are removed by their own output
+    // jobs, so the I/O thread is only caught up before the first trial reads its checkpoint.
+    size_t firstTrialIndex = campaign.completedTrials.size();
+    flushIO();
+    for (size_t trialIndex = firstTrialIndex; trialIndex < numTrials; trialIndex++)
     {
-        // Bind field
-        glActiveTexture(activeTextureIndex++);
-        glBindImageTexture(bindIndex++, m_Fields[fieldIndex].textureID, 0, GL_FALSE, 0, GL_READ_WRITE, GL_RGBA32F);
-        // Bind its Laplacian
-        glActiveTexture(activeTextureIndex++);
-        glBindImageTexture(bindIndex++, m_LaplacianTextures[fieldIndex].textureID, 0, GL_FALSE, 0, GL_READ_ONLY, GL_R32F);
+        TrialStopReason stopReason = runTrial(campaign, trialIndex, trialIndex == firstTrialIndex);
+        submitTrialOutput(campaign, trialIndex, stopReason);
     }
 
-    // Dispatch and barrier
-    glDispatchCompute(m_XNumGroups, m_YNumGroups, 1);
-    glMemoryBarrier(GL_ALL_BARRIER_BITS);
+    // The ensembles must be written before they are closed
+    flushIO();
+    campaign.closeFiles();
+    campaign.stringCountStatistics.reset();
+
+    logCampaignSummary(campaign);
+
+    auto stopTime = std::chrono::high_resolution_clock::now();
+
+    int64_t durationHours = duration_cast<std::chrono::hours>(stopTime - startTime).count();
+    int64_t durationMinutes = duration_cast<std::chrono::minutes>(stopTime - startTime).count() % 60;
+    int64_t durationSeconds = duration_cast<std::chrono::seconds>(stopTime - startTime).count() % 60;
+
+    logInfo(
+        "Finished %d trials, taking %lld hours, %lld minutes and %lld seconds.",
+        numTrials, durationHours, durationMinutes, durationSeconds);
 }
 
-void Simulation::updateAcceleration()
+Simulation *Simulation::createBenchmarkSimulation(FieldPrecision precision, uint32_t width, uint32_t height, uint32_t seed)
 {
-    // Update acceleration
-    for (size_t fieldIndex = 0; fieldIndex < m_Fields.size(); fieldIndex++)
+    Simulation *simulation = createSimulation(m_Model, precision);
+    if (simulation == nullptr)
     {
-        // Now acceleration can be updated
-        m_UpdateAccelerationPass->use();
-        glUniform1f(0, dt);
-        // Bind field
-        glActiveTexture(GL_TEXTURE0);
-        glBindImageTexture(0, m_Fields[fieldIndex].textureID, 0, GL_FALSE, 0, GL_READ_WRITE, GL_RGBA32F);
-        // Dispatch and barrier
-        glDispatchCompute(m_XNumGroups, m_YNumGroups, 1);
-        glMemoryBarrier(GL_ALL_BARRIER_BITS);
+        return nullptr;
     }
+    simulation->maxTimesteps = maxTimesteps;
+    simulation->stringCountCadence = stringCountCadence;
+    simulation->energyCadence = 0;
+    simulation->spectrumCadence = 0;
+    simulation->componentCadence = 0;
+    simulation->dx = dx;
+    simulation->dt = dt;
+    simulation->era = era;
+    simulation->initialSpectrum = initialSpectrum;
+    simulation->m_FloatUniforms = m_FloatUniforms;
+    simulation->m_IntUniforms = m_IntUniforms;
+    simulation->randomiseFields(width, height, seed);
+    return simulation;
 }
 
-void Simulation::initialiseSimulation()
+// Largest deviation of a single precision step from the reference step before the benchmark is abandoned
+constexpr double MAX_REFERENCE_STEP_DEVIATION = 1e-3;
+
+// Returns the largest deviation of the value, velocity and acceleration of each cell of the GPU fields from the reference, relative
+// to the magnitude of the reference with a floor of one. The field, cell and channel of the largest deviation are also returned.
+static double compareWithReference(const std::vector<std::vector<float>> &fieldData, const ReferenceSimulation &reference,
+                                   uint32_t &worstField, size_t &worstCell, uint32_t &worstChannel)
 {
-    // Calculate phase if needed
-    if (m_Fields.size() > 1)
+    double maxDeviation = 0.0;
+    for (uint32_t fieldIndex = 0; fieldIndex < fieldData.size(); fieldIndex++)
     {
-        calculatePhase();
+        const ReferenceField &field = reference.getField(fieldIndex);
+        const std::vector<double> *channels[3] = {&field.values, &field.velocities, &field.accelerations};
+        for (size_t cellIndex = 0; cellIndex < field.values.size(); cellIndex++)
+        {
+            for (uint32_t channelIndex = 0; channelIndex < 3; channelIndex++)
+            {
+                double referenceValue = (*channels[channelIndex])[cellIndex];
+                double gpuValue = fieldData[fieldIndex][4 * cellIndex + channelIndex];
+                double deviation = std::abs(gpuValue - referenceValue) / std::max(std::abs(referenceValue), 1.0);
+                // NaNs are always the worst deviation
+                if (!(deviation <= maxDeviation))
+                {
+                    maxDeviation = std::isnan(deviation) ? std::numeric_limits<double>::infinity() : deviation;
+                    worstField = fieldIndex;
+                    worstCell = cellIndex;
+                    worstChannel = channelIndex;
+                }
+            }
+        }
     }
-
-    // Update acceleration but not value or velocity
-    calculateAcceleration();
-    updateAcceleration();
+    return maxDeviation;
 }
 
-int Simulation::getStringNumber(size_t stringIndex)
+void Simulation::runPrecisionBenchmark(uint32_t width, uint32_t height, uint32_t seed, std::string outFolder)
 {
-    // If index out of bounds return 0.
-    if (stringIndex >= m_StringTextures.size() || stringIndex < 0)
+    std::string folderPath = "data/" + outFolder;
+    std::string benchmarkPath = folderPath + "/precision_benchmark.csv";
+    std::filesystem::create_directories(folderPath);
+
+    // The double precision reference comes first and is followed by the GPU runs. Every run copies the model, parameters and run
+    // length of this simulation and only samples the string and wall counts.
+    constexpr uint32_t NUM_RUNS = 3;
+    const char *runNames[NUM_RUNS] = {"Double", "Single", "Half"};
+    FieldPrecision precisions[NUM_RUNS] = {FieldPrecision::SINGLE, FieldPrecision::SINGLE, FieldPrecision::HALF};
+    std::vector<std::vector<int>> channels[NUM_RUNS];
+    double secondsPerStep[NUM_RUNS] = {};
+    uint64_t memoryUsage[NUM_RUNS] = {};
+    // Root mean square deviation of the final field values of each GPU run from the reference
+    double valueDeviations[NUM_RUNS] = {};
+
+    ReferenceSimulation *reference = ReferenceSimulation::create(m_Model, getParameters(), dx, dt, era);
+    if (reference == nullptr)
     {
-        return 0;
+        logError("Failed to create the double precision reference of the benchmark!");
+        return;
     }
+    reference->stringCountCadence = stringCountCadence;
 
-    glBindTexture(GL_TEXTURE_2D, m_StringTextures[stringIndex].textureID);
-    int M, N;
-    int miplevel = 0;
-    glGetTexLevelParameteriv(GL_TEXTURE_2D, miplevel, GL_TEXTURE_HEIGHT, &M);
-    glGetTexLevelParameteriv(GL_TEXTURE_2D, miplevel, GL_TEXTURE_WIDTH, &N);
-
-    std::vector<float> textureData(M * N);
+    // The equations of motion of the reference are written separately from the model shaders, so one step of each is compared
+    // before anything is measured. The initial fields of the GPU, whose accelerations have already been initialised by the
+    // shaders, are shared by every run.
+    Simulation *checkSimulation = createBenchmarkSimulation(FieldPrecision::SINGLE, width, height, seed);
+    if (checkSimulation == nullptr)
+    {
+        logError("Failed to create the single precision check of the benchmark reference!");
+        delete reference;
+        return;
+    }
+    std::vector<std::vector<float>> initialFieldData = checkSimulation->readFieldData();
+    reference->setFields(width, height, initialFieldData);
+    reference->update();
+    // The check always takes its step, even if the benchmark is too short to take any
+    checkSimulation->maxTimesteps = 2;
+    checkSimulation->runFlag = true;
+    checkSimulation->update();
+    uint32_t worstField = 0;
+    size_t worstCell = 0;
+    uint32_t worstChannel = 0;
+    double stepDeviation = compareWithReference(checkSimulation->readFieldData(), *reference, worstField, worstCell, worstChannel);
+    delete checkSimulation;
+    if (stepDeviation > MAX_REFERENCE_STEP_DEVIATION)
+    {
+        const char *channelNames[3] = {"value", "velocity", "acceleration"};
+        logError("The double precision reference of %s does not match the model shader! After one step the %s of field %d "
+                 "at (%d, %d) deviates by %g, more than the allowed %g. Abandoning the precision benchmark.",
+                 convertSimulationModelToString(m_Model).c_str(), channelNames[worstChannel], worstField, (int)(worstCell % width),
+                 (int)(worstCell / width), stepDeviation, MAX_REFERENCE_STEP_DEVIATION);
+        delete reference;
+        return;
+    }
 
-    glGetTexImage(GL_TEXTURE_2D, 0, GL_RED, GL_FLOAT, static_cast<void *>(textureData.data()));
-    glBindTexture(GL_TEXTURE_2D, 0);
+    reference->setFields(width, height, initialFieldData);
+    auto referenceStartTime = std::chrono::steady_clock::now();
+    while (reference->getCurrentTimestep() < maxTimesteps)
+    {
+        reference->update();
+    }
+    double referenceSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - referenceStartTime).count();
+    secondsPerStep[0] = referenceSeconds / std::max(reference->getCurrentTimestep() - 1, 1);
+    memoryUsage[0] = reference->getFieldMemoryUsage();
+    size_t numStringChannels = reference->getStringNumbers().size();
+    channels[0] = reference->getStringNumbers();
+    channels[0].insert(channels[0].end(), reference->getWallNumbers().begin(), reference->getWallNumbers().end());
+
+    for (uint32_t runIndex = 1; runIndex < NUM_RUNS; runIndex++)
+    {
+        Simulation *simulation = createBenchmarkSimulation(precisions[runIndex], width, height, seed);
+        if (simulation == nullptr)
+        {
+            logError("Failed to create the %s precision simulation of the benchmark!",
+                     convertFieldPrecisionToString(precisions[runIndex]).c_str());
+            delete reference;
+            return;
+        }
 
-    int stringNumber = 0;
+        // Wait for the GPU on both ends so that only the evolution is timed
+        simulation->runFlag = true;
+        glFinish();
+        auto startTime = std::chrono::steady_clock::now();
+        while (simulation->runFlag)
+        {
+            simulation->update();
+        }
+        glFinish();
+        double elapsedSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+
+        secondsPerStep[runIndex] = elapsedSeconds / std::max(simulation->m_CurrentTimestep - 1, 1);
+        memoryUsage[runIndex] = simulation->getFieldMemoryUsage();
+        simulation->collectDefectCounts(true);
+        channels[runIndex] = simulation->m_StringNumbers;
+        channels[runIndex].insert(channels[runIndex].end(), simulation->m_WallNumbers.begin(), simulation->m_WallNumbers.end());
+
+        // Compare the final field values with the reference
+        std::vector<std::vector<float>> fieldValues = simulation->readFieldValues();
+        double sumSquaredDeviation = 0.0;
+        size_t numValues = 0;
+        for (uint32_t fieldIndex = 0; fieldIndex < fieldValues.size(); fieldIndex++)
+        {
+            const std::vector<double> &referenceValues = reference->getFieldValues(fieldIndex);
+            for (size_t cellIndex = 0; cellIndex < fieldValues[fieldIndex].size(); cellIndex++)
+            {
+                double deviation = fieldValues[fieldIndex][cellIndex] - referenceValues[cellIndex];
+                sumSquaredDeviation += deviation * deviation;
+            }
+            numValues += fieldValues[fieldIndex].size();
+        }
+        valueDeviations[runIndex] = sqrt(sumSquaredDeviation / std::max(numValues, (size_t)1));
+        delete simulation;
+    }
+    delete reference;
 
-    for (int rowIndex = 0; rowIndex < M; rowIndex++)
+    // Compare the counts of each sample relative to the reference
+    double sumStringDrifts[NUM_RUNS] = {};
+    double maxStringDrifts[NUM_RUNS] = {};
+    uint32_t numStringSamples = 0;
+    try
     {
-        for (int columnIndex = 0; columnIndex < N; columnIndex++)
+        std::ofstream benchmarkFile;
+        benchmarkFile.exceptions(std::ofstream::failbit | std::ofstream::badbit);
+        benchmarkFile.open(benchmarkPath, std::ios::trunc);
+        benchmarkFile << "channel,timestep,double,single,half,single_drift,half_drift\n";
+        for (size_t channelIndex = 0; channelIndex < channels[0].size(); channelIndex++)
         {
-            size_t currentIndex = (rowIndex * N) + columnIndex;
-            float stringValue = textureData[currentIndex];
-            stringNumber += abs(int(stringValue));
+            size_t numSamples = channels[0][channelIndex].size();
+            for (uint32_t runIndex = 1; runIndex < NUM_RUNS; runIndex++)
+            {
+                numSamples = std::min(numSamples, channels[runIndex][channelIndex].size());
+            }
+            for (size_t sampleIndex = 0; sampleIndex < numSamples; sampleIndex++)
+            {
+                int referenceCount = channels[0][channelIndex][sampleIndex];
+                benchmarkFile << channelIndex << "," << 1 + sampleIndex * std::max(stringCountCadence, 1) << "," << referenceCount;
+                for (uint32_t runIndex = 1; runIndex < NUM_RUNS; runIndex++)
+                {
+                    benchmarkFile << "," << channels[runIndex][channelIndex][sampleIndex];
+                }
+                for (uint32_t runIndex = 1; runIndex < NUM_RUNS; runIndex++)
+                {
+                    // Counts below one are compared in absolute terms
+                    double drift =
+                        std::abs(channels[runIndex][channelIndex][sampleIndex] - referenceCount) / (double)std::max(referenceCount, 1);
+                    if (channelIndex < numStringChannels)
+                    {
+                        sumStringDrifts[runIndex] += drift;
+                        maxStringDrifts[runIndex] = std::max(maxStringDrifts[runIndex], drift);
+                    }
+                    benchmarkFile << "," << drift;
+                }
+                benchmarkFile << "\n";
+                numStringSamples += channelIndex < numStringChannels;
+            }
         }
+        benchmarkFile.close();
+    }
+    catch (std::ofstream::failure &e)
+    {
+        logError("Failed to write precision benchmark at path: %s - %s", benchmarkPath.c_str(), e.what());
     }
 
-    return stringNumber;
+    logInfo("Precision benchmark of %s at %d x %d over %d timesteps:", convertSimulationModelToString(m_Model).c_str(), width,
+            height, maxTimesteps);
+    logInfo("Double precision on the CPU took %.3f ms per step with %.1f MB of fields.", 1000.0 * secondsPerStep[0],
+            memoryUsage[0] / 1048576.0);
+    for (uint32_t runIndex = 1; runIndex < NUM_RUNS; runIndex++)
+    {
+        logInfo("%s precision took %.3f ms per step with %.1f MB of field textures, %.2fx the speed of double precision.",
+                runNames[runIndex], 1000.0 * secondsPerStep[runIndex], memoryUsage[runIndex] / 1048576.0,
+                secondsPerStep[0] / std::max(secondsPerStep[runIndex], 1e-12));
+        if (numStringSamples > 0)
+        {
+            logInfo("%s precision string counts drifted from double precision by %.2f%% on average and %.2f%% at most.",
+                    runNames[runIndex], 100.0 * sumStringDrifts[runIndex] / numStringSamples, 100.0 * maxStringDrifts[runIndex]);
+        }
+        logInfo("%s precision field values ended %.3g from double precision in root mean square.", runNames[runIndex],
+                valueDeviations[runIndex]);
+    }
 }
 
-std::vector<int> Simulation::getCurrentStringNumber()
+void Simulation::runLaplacianBenchmark(std::string outFolder)
 {
-    size_t stringIndex = floor(m_RenderIndex / 2);
-    if (m_StringNumbers.size() > 0)
+    std::string folderPath = "data/" + outFolder;
+    std::string benchmarkPath = folderPath + "/laplacian_benchmark.csv";
+    std::filesystem::create_directories(folderPath);
+
+    // Each operator is timed over a number of calculations after a warm up
+    constexpr uint32_t NUM_REPEATS = 20;
+    // Wavelength of the plane wave in cells. The stencil is accurate to about 0.4% at this wavelength.
+    constexpr uint32_t WAVELENGTH = 8;
+    constexpr uint32_t MIN_SIZE = 256;
+    constexpr uint32_t MAX_SIZE = 4096;
+    constexpr uint32_t NUM_OPERATORS = 2;
+    LaplacianOperator operators[NUM_OPERATORS] = {LaplacianOperator::STENCIL, LaplacianOperator::SPECTRAL};
+
+    try
     {
-        std::vector<int> result;
-        for (const auto &currentStringVector : m_StringNumbers)
+        std::ofstream benchmarkFile;
+        benchmarkFile.exceptions(std::ofstream::failbit | std::ofstream::badbit);
+        benchmarkFile.open(benchmarkPath, std::ios::trunc);
+        benchmarkFile << "size,operator,milliseconds,relative_error\n";
+
+        for (uint32_t size = MIN_SIZE; size <= MAX_SIZE; size *= 2)
         {
-            if (currentStringVector.size() > 0)
+            Simulation *simulation = createSimulation(m_Model, FieldPrecision::SINGLE);
+            if (simulation == nullptr)
             {
-                result.push_back(currentStringVector.back());
+                logError("Failed to create the %d x %d simulation of the Laplacian benchmark!", size, size);
+                return;
+            }
+            simulation->dx = dx;
+
+            // Even fields vary along x and odd fields along y, so every field has the same exact Laplacian -k^2 f
+            float wavenumber = 2.0f * PI / (WAVELENGTH * dx);
+            std::vector<std::shared_ptr<Texture2D>> newFields(m_NumFields);
+            std::vector<float> fieldData((size_t)size * size * 4, 0.0f);
+            for (size_t fieldIndex = 0; fieldIndex < newFields.size(); fieldIndex++)
+            {
+                for (uint32_t rowIndex = 0; rowIndex < size; rowIndex++)
+                {
+                    for (uint32_t columnIndex = 0; columnIndex < size; columnIndex++)
+                    {
+                        uint32_t position = fieldIndex % 2 == 0 ? columnIndex : rowIndex;
+                        fieldData[4 * ((size_t)rowIndex * size + columnIndex)] = sin(2.0 * PI * (position % WAVELENGTH) / WAVELENGTH);
+                    }
+                }
+                Texture2D *fieldTexture = new Texture2D();
+                fieldTexture->width = size;
+                fieldTexture->height = size;
+                glTextureStorage2D(fieldTexture->textureID, 1, GL_RGBA32F, size, size);
+                glTextureSubImage2D(fieldTexture->textureID, 0, 0, 0, size, size, GL_RGBA, GL_FLOAT, fieldData.data());
+                newFields[fieldIndex] = std::shared_ptr<Texture2D>(fieldTexture);
+            }
+            simulation->setField(newFields);
+
+            double milliseconds[NUM_OPERATORS] = {};
+            double relativeErrors[NUM_OPERATORS] = {};
+            std::vector<float> laplacianValues((size_t)size * size);
+            for (uint32_t operatorIndex = 0; operatorIndex < NUM_OPERATORS; operatorIndex++)
+            {
+                simulation->laplacianOperator = operators[operatorIndex];
+                simulation->calculateLaplacian();
+                glFinish();
+                auto startTime = std::chrono::steady_clock::now();
+                for (uint32_t repeatIndex = 0; repeatIndex < NUM_REPEATS; repeatIndex++)
+                {
+                    simulation->calculateLaplacian();
+                }
+                glFinish();
+                milliseconds[operatorIndex] =
+                    1000.0 * std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count() / NUM_REPEATS;
+
+                // Root mean square error relative to the root mean square of the exact Laplacian
+                double sumSquaredError = 0.0;
+                double sumSquaredExact = 0.0;
+                for (size_t fieldIndex = 0; fieldIndex < newFields.size(); fieldIndex++)
+                {
+                    glGetTextureImage(simulation->m_LaplacianTextures[fieldIndex].textureID, 0, GL_RED, GL_FLOAT,
+                                      laplacianValues.size() * sizeof(float), laplacianValues.data());
+                    for (uint32_t rowIndex = 0; rowIndex < size; rowIndex++)
+                    {
+                        for (uint32_t columnIndex = 0; columnIndex < size; columnIndex++)
+                        {
+                            uint32_t position = fieldIndex % 2 == 0 ? columnIndex : rowIndex;
+                            double exact = -(double)wavenumber * wavenumber * sin(2.0 * PI * (position % WAVELENGTH) / WAVELENGTH);
+                            double error = laplacianValues[(size_t)rowIndex * size + columnIndex] - exact;
+                            sumSquaredError += error * error;
+                            sumSquaredExact += exact * exact;
+                        }
+                    }
+                }
+                relativeErrors[operatorIndex] = sqrt(sumSquaredError / std::max(sumSquaredExact, 1e-30));
+                benchmarkFile << size << "," << convertLaplacianOperatorToString(operators[operatorIndex]) << ","
+                              << milliseconds[operatorIndex] << "," << relativeErrors[operatorIndex] << "\n";
             }
+            delete simulation;
+
+            logInfo("Laplacians of %d fields at %d x %d: the stencil took %.3f ms with a relative error of %.2e, and the spectral "
+                    "operator took %.3f ms (%.2fx) with a relative error of %.2e.",
+                    m_NumFields, size, size, milliseconds[0], relativeErrors[0], milliseconds[1],
+                    milliseconds[1] / std::max(milliseconds[0], 1e-9), relativeErrors[1]);
         }
-        return result;
+        benchmarkFile.close();
     }
-    else
+    catch (std::ofstream::failure &e)
     {
-        return std::vector<int>();
+        logError("Failed to write Laplacian benchmark at path: %s - %s", benchmarkPath.c_str(), e.what());
     }
 }
 
-void Simulation::randomiseFields(uint32_t width, uint32_t height, uint32_t seed)
+void Simulation::runVolumeTrial(uint32_t width, uint32_t height, uint32_t depth, uint32_t seed, std::string outFolder)
 {
-    std::default_random_engine seedGenerator;
-    seedGenerator.seed(seed);
-    std::uniform_int_distribution<uint32_t> seedDistribution(0, UINT32_MAX);
+    std::string folderPath = "data/" + outFolder;
+    std::string volumePath = folderPath + "/volume_counts.csv";
+    std::filesystem::create_directories(folderPath);
 
-    // Create new fields
-    std::vector<std::shared_ptr<Texture2D>> newFields(m_NumFields);
+    VolumeSimulation *volume = VolumeSimulation::create(m_Model, m_Layout, m_FloatUniforms, m_IntUniforms, dx, dt, era);
+    if (volume == nullptr)
+    {
+        logError("Failed to create the volume simulation of %s!", convertSimulationModelToString(m_Model).c_str());
+        return;
+    }
+    volume->maxTimesteps = maxTimesteps;
+    volume->stringCountCadence = stringCountCadence;
+    volume->randomiseFields(width, height, depth, seed);
+
+    // Wait for the GPU on both ends so that only the evolution is timed
+    volume->runFlag = true;
+    glFinish();
+    auto startTime = std::chrono::steady_clock::now();
+    while (volume->runFlag)
+    {
+        volume->update();
+    }
+    glFinish();
+    double elapsedSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    double secondsPerStep = elapsedSeconds / std::max(volume->getCurrentSimulationTimestep() - 1, 1);
 
-    for (size_t fieldIndex = 0; fieldIndex < newFields.size(); fieldIndex++)
+    const auto &stringLengths = volume->getStringLengths();
+    const auto &wallAreas = volume->getWallAreas();
+    try
     {
-        // Random generator
-        std::default_random_engine valueGenerator;
-        uint32_t currentSeed = seedDistribution(seedGenerator);
-        valueGenerator.seed(currentSeed);
-        std::normal_distribution<float> distribution(0.0f, 1.0f);
+        std::ofstream volumeFile;
+        volumeFile.exceptions(std::ofstream::badbit | std::ofstream::failbit);
+        volumeFile.open(volumePath, std::ios::out);
+        volumeFile << "timestep,time";
+        for (size_t stringIndex = 0; stringIndex < stringLengths.size(); stringIndex++)
+        {
+            volumeFile << ",string_length_" << stringIndex;
+        }
+        for (size_t wallIndex = 0; wallIndex < wallAreas.size(); wallIndex++)
+        {
+            volumeFile << ",wall_area_" << wallIndex;
+        }
+        volumeFile << "\n";
 
-        std::vector<float> textureData(height * width * 4);
-        for (int rowIndex = 0; rowIndex < height; rowIndex++)
+        size_t numSamples = stringLengths.empty() ? wallAreas[0].size() : stringLengths[0].size();
+        for (size_t sampleIndex = 0; sampleIndex < numSamples; sampleIndex++)
         {
-            for (int columnIndex = 0; columnIndex < width; columnIndex++)
+            int timestep = 1 + sampleIndex * std::max(stringCountCadence, 1);
+            volumeFile << timestep << "," << timestep * dt;
+            for (const auto &stringLength : stringLengths)
             {
-                // Red channel - field value
-                textureData[(rowIndex * 4 * width) + 4 * columnIndex + 0] = 0.1f * distribution(valueGenerator);
-                // Green channel - field velocity
-                textureData[(rowIndex * 4 * width) + 4 * columnIndex + 1] = 0.0f;
-                // Acceleration is initialised to zero. It needs to be initialised by the simulation itself, as the simulation
-                // parameters will affect the calculation.
-                // Blue channel - current field acceleration
-                textureData[(rowIndex * 4 * width) + 4 * columnIndex + 2] = 0.0f;
-                // Alpha channel - next field acceleration
-                textureData[(rowIndex * 4 * width) + 4 * columnIndex + 3] = 0.0f;
+                volumeFile << "," << stringLength[sampleIndex];
+            }
+            for (const auto &wallArea : wallAreas)
+            {
+                volumeFile << "," << wallArea[sampleIndex];
             }
+            volumeFile << "\n";
         }
+        volumeFile.close();
+    }
+    catch (std::ofstream::failure &e)
+    {
+        logError("Failed to write volume counts at path: %s - %s", volumePath.c_str(), e.what());
+    }
 
-        Texture2D *fieldTexture = new Texture2D();
-        fieldTexture->setTextureWrap(TextureWrapAxis::UV, TextureWrapMode::REPEAT);
-        fieldTexture->setTextureFilter(TextureFilterLevel::MIN_MAG, TextureFilterMode::LINEAR);
-        newFields[fieldIndex] = std::shared_ptr<Texture2D>(fieldTexture);
-        newFields[fieldIndex]->width = width;
-        newFields[fieldIndex]->height = height;
+    logInfo("Volume trial of %s at %d x %d x %d over %d timesteps took %.3f ms per step with %.1f MB of field textures.",
+            convertSimulationModelToString(m_Model).c_str(), width, height, depth, maxTimesteps, 1000.0 * secondsPerStep,
+            volume->getFieldMemoryUsage() / 1048576.0);
+    for (size_t stringIndex = 0; stringIndex < stringLengths.size(); stringIndex++)
+    {
+        logInfo("String length %d ended at %d.", stringIndex, stringLengths[stringIndex].back());
+    }
+    for (size_t wallIndex = 0; wallIndex < wallAreas.size(); wallIndex++)
+    {
+        logInfo("Wall area %d ended at %d.", wallIndex, wallAreas[wallIndex].back());
+    }
+    delete volume;
+}
+
+void Simulation::runBatchedTrials(
+    uint32_t width, uint32_t height, uint32_t numTrials, uint32_t batchSize, uint32_t startSeed, std::string outFolder)
+{
+    std::string folderPath = "data/" + outFolder;
 
-        glBindTexture(GL_TEXTURE_2D, newFields[fieldIndex]->textureID);
+    // Batched campaigns are not journaled so the folder always starts empty
+    try
+    {
+        if (std::filesystem::exists(folderPath))
+        {
+            std::filesystem::remove_all(folderPath.c_str());
+            logTrace("Cleared folder at %s of all files.", folderPath.c_str());
+        }
+        std::filesystem::create_directory(folderPath);
+        logInfo("Created a new folder at %s in the data directory.", folderPath.c_str());
+    }
+    catch (std::filesystem::filesystem_error &e)
+    {
+        logWarning("The given folder name %s is invalid! Aborting trials... Please input a valid folder name and try again.", outFolder.c_str());
+        return;
+    }
 
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA32F, width, height, 0, GL_RGBA, GL_FLOAT, static_cast<void *>(textureData.data()));
-        glGenerateMipmap(GL_TEXTURE_2D);
+    runBatchedConfigurations(width, height, numTrials, batchSize, startSeed, {getParameters()}, {folderPath});
+}
 
-        glTextureStorage2D(newFields[fieldIndex]->textureID, 1, GL_RGBA32F, width, height);
-        glBindImageTexture(0, newFields[fieldIndex]->textureID, 0, GL_FALSE, 0, GL_READ_WRITE, GL_RGBA32F);
+// Reads the configurations of a parameter sweep from a csv file. The first line names the swept parameters and every other line
+// holds the values of one configuration. Parameters that are not named keep their base values.
+static bool readParameterSweep(
+    const std::string &sweepPath,
+    const std::vector<std::pair<std::string, float>> &baseParameters,
+    std::vector<std::vector<std::pair<std::string, float>>> &configurations)
+{
+    std::ifstream sweepFile(sweepPath);
+    if (!sweepFile.is_open())
+    {
+        logWarning("Failed to open the parameter sweep at path: %s", sweepPath.c_str());
+        return false;
+    }
 
-        textureData.clear();
+    // Find the parameter of each column
+    std::string line;
+    std::getline(sweepFile, line);
+    std::stringstream headerStream(line);
+    std::string name;
+    std::vector<size_t> parameterIndices;
+    while (std::getline(headerStream, name, ','))
+    {
+        name.erase(0, name.find_first_not_of(" \t\r"));
+        name.erase(name.find_last_not_of(" \t\r") + 1);
+        auto parameter = std::find_if(
+            baseParameters.begin(), baseParameters.end(), [&name](const auto &parameter) { return parameter.first == name; });
+        if (parameter == baseParameters.end())
+        {
+            logWarning("The parameter sweep %s names an unknown parameter %s!", sweepPath.c_str(), name.c_str());
+            return false;
+        }
+        parameterIndices.push_back(parameter - baseParameters.begin());
     }
 
-    // Set the new fields
-    setField(newFields);
+    configurations.clear();
+    while (std::getline(sweepFile, line))
+    {
+        if (line.find_first_not_of(" \t\r") == std::string::npos)
+        {
+            continue;
+        }
+        std::vector<std::pair<std::string, float>> configuration = baseParameters;
+        std::stringstream valueStream(line);
+        std::string value;
+        size_t columnIndex = 0;
+        for (; columnIndex < parameterIndices.size() && std::getline(valueStream, value, ','); columnIndex++)
+        {
+            try
+            {
+                configuration[parameterIndices[columnIndex]].second = std::stof(value);
+            }
+            catch (std::exception &e)
+            {
+                break;
+            }
+        }
+        if (columnIndex != parameterIndices.size())
+        {
+            logWarning("Configuration %d of the parameter sweep %s does not have a value for every parameter!",
+                       configurations.size(), sweepPath.c_str());
+            return false;
+        }
+        configurations.push_back(configuration);
+    }
+    return configurations.size() > 0;
 }
 
-void Simulation::runRandomTrials(uint32_t width, uint32_t height, uint32_t numTrials, uint32_t startSeed, std::string outFolder)
+void Simulation::runParameterSweep(
+    uint32_t width,
+    uint32_t height,
+    uint32_t numTrials,
+    uint32_t batchSize,
+    uint32_t startSeed,
+    std::string sweepPath,
+    std::string outFolder)
 {
-    // Create folder of name `outFolder` in the data directory
-    std::stringstream folderStream;
-    folderStream << "data/" << outFolder;
-    std::string folderPath = folderStream.str();
+    std::string folderPath = "data/" + outFolder;
+    std::string configurationPath = folderPath + "/configurations.csv";
 
-    // Handle when the given folder name is invalid
+    std::vector<std::pair<std::string, float>> baseParameters = getParameters();
+    std::vector<std::vector<std::pair<std::string, float>>> configurations;
+    if (!readParameterSweep(sweepPath, baseParameters, configurations))
+    {
+        logWarning("Failed to read a parameter sweep from %s! Aborting sweep...", sweepPath.c_str());
+        return;
+    }
+
+    // Each configuration has a folder of its own, and the list of configurations maps the folders to their parameter values
+    std::vector<std::string> folderPaths;
     try
     {
-        // TODO: This is a bit hacky, but not sure how to delete a folder's contents and not the folder itself
-        // Check if folder exists, and if so delete it and all of its contents
         if (std::filesystem::exists(folderPath))
         {
-            // Clear folder of all files
             std::filesystem::remove_all(folderPath.c_str());
             logTrace("Cleared folder at %s of all files.", folderPath.c_str());
         }
-        // Create the folder
         std::filesystem::create_directory(folderPath);
         logInfo("Created a new folder at %s in the data directory.", folderPath.c_str());
+        for (size_t configurationIndex = 0; configurationIndex < configurations.size(); configurationIndex++)
+        {
+            folderPaths.push_back(folderPath + "/configuration_" + std::to_string(configurationIndex));
+            std::filesystem::create_directory(folderPaths.back());
+        }
     }
     catch (std::filesystem::filesystem_error &e)
     {
-        logWarning("The given folder name %s is invalid! Aborting trials... Please input a valid folder name and try again.", outFolder.c_str());
+        logWarning("The given folder name %s is invalid! Aborting sweep... Please input a valid folder name and try again.", outFolder.c_str());
+        return;
+    }
+    try
+    {
+        std::ofstream configurationFile;
+        configurationFile.exceptions(std::ofstream::badbit | std::ofstream::failbit);
+        configurationFile.open(configurationPath, std::ios::out);
+        configurationFile << "configuration";
+        for (const auto &[name, value] : baseParameters)
+        {
+            configurationFile << "," << name;
+        }
+        configurationFile << "\n";
+        for (size_t configurationIndex = 0; configurationIndex < configurations.size(); configurationIndex++)
+        {
+            configurationFile << configurationIndex;
+            for (const auto &[name, value] : configurations[configurationIndex])
+            {
+                configurationFile << "," << value;
+            }
+            configurationFile << "\n";
+        }
+        configurationFile.close();
+    }
+    catch (std::ofstream::failure &e)
+    {
+        logError("Failed to write sweep configurations at path: %s - %s", configurationPath.c_str(), e.what());
+    }
+
+    runBatchedConfigurations(width, height, numTrials, batchSize, startSeed, configurations, folderPaths);
+}
+
+void Simulation::runBatchedConfigurations(
+    uint32_t width,
+    uint32_t height,
+    uint32_t numTrials,
+    uint32_t batchSize,
+    uint32_t startSeed,
+    const std::vector<std::vector<std::pair<std::string, float>>> &configurations,
+    const std::vector<std::string> &folderPaths)
+{
+    uint32_t numConfigurations = configurations.size();
+    uint32_t numLayers = numConfigurations * numTrials;
+    batchSize = std::clamp(batchSize, (uint32_t)1, std::max(numLayers, (uint32_t)1));
+
+    BatchSimulation *batch = BatchSimulation::create(m_Model, getParameters(), dx, dt, era);
+    if (batch == nullptr)
+    {
+        logError("Failed to create the batch simulation of %s!", convertSimulationModelToString(m_Model).c_str());
         return;
     }
+    batch->maxTimesteps = maxTimesteps;
+    batch->stringCountCadence = stringCountCadence;
+    batch->initialSpectrum = initialSpectrum;
 
-    // Generate seeds
+    // The seeds and header are the same as those of `runRandomTrials`, so the ensembles of both runners can be compared directly.
+    // Every configuration uses the same seeds so that configurations are compared on the same initial fields.
     std::default_random_engine seedGenerator;
     seedGenerator.seed(startSeed);
     std::uniform_int_distribution<uint32_t> seedDistribution(0, UINT32_MAX);
-
-    auto startTime = std::chrono::high_resolution_clock::now();
-
+    uint32_t cadence = std::max(stringCountCadence, 1);
+    EnsembleHeader header;
+    header.dataType = EnsembleDataType::INT32;
+    header.numChannels = m_StringNumbers.size();
+    header.numTrials = numTrials;
+    header.numSamples = (maxTimesteps + cadence - 1) / cadence;
+    header.valuesPerSample = 1;
+    header.cadence = cadence;
+    header.maxTimesteps = maxTimesteps;
+    header.width = width;
+    header.height = height;
+    header.era = era;
+    header.dt = dt;
+    header.dx = dx;
+    header.modelName = convertSimulationModelToString(m_Model);
     for (size_t trialIndex = 0; trialIndex < numTrials; trialIndex++)
     {
-        uint32_t currentSeed = seedDistribution(seedGenerator);
-        logInfo("Beginning trial %d with seed %d", trialIndex, currentSeed);
-        randomiseFields(width, height, currentSeed);
-        runFlag = true;
+        header.seeds.push_back(seedDistribution(seedGenerator));
+    }
+    bool hasWallCounts = m_WallNumbers.size() > 0;
+
+    // Each configuration has its own ensembles and summary
+    std::vector<EnsembleFile *> stringCountFiles(numConfigurations, nullptr);
+    std::vector<EnsembleFile *> wallCountFiles(numConfigurations, nullptr);
+    std::vector<EnsembleStatistics *> stringCountStatistics(numConfigurations, nullptr);
+    std::vector<std::string> statisticsPaths(numConfigurations);
+    bool hasCreatedFiles = true;
+    for (uint32_t configurationIndex = 0; configurationIndex < numConfigurations; configurationIndex++)
+    {
+        EnsembleHeader stringHeader = header;
+        stringHeader.parameters = configurations[configurationIndex];
+        EnsembleHeader wallHeader = stringHeader;
+        wallHeader.numChannels = m_WallNumbers.size();
+        std::string stringCountPath = folderPaths[configurationIndex] + "/string_counts.ctde";
+        std::string wallCountPath = folderPaths[configurationIndex] + "/wall_counts.ctde";
+        statisticsPaths[configurationIndex] = folderPaths[configurationIndex] + "/string_count_statistics.csv";
+        stringCountFiles[configurationIndex] = EnsembleFile::create(stringCountPath.c_str(), stringHeader);
+        wallCountFiles[configurationIndex] = hasWallCounts ? EnsembleFile::create(wallCountPath.c_str(), wallHeader) : nullptr;
+        stringCountStatistics[configurationIndex] = new EnsembleStatistics(header.numChannels, header.numSamples, cadence, dt);
+        hasCreatedFiles = hasCreatedFiles && stringCountFiles[configurationIndex] != nullptr &&
+                          (!hasWallCounts || wallCountFiles[configurationIndex] != nullptr);
+    }
 
-        for (size_t timestepIndex = 0; timestepIndex < maxTimesteps; timestepIndex++)
+    auto startTime = std::chrono::steady_clock::now();
+    for (uint32_t firstLayer = 0; hasCreatedFiles && firstLayer < numLayers; firstLayer += batchSize)
+    {
+        // Layers hold the trials of each configuration in turn, so a batch can span several configurations
+        uint32_t numBatchLayers = std::min(batchSize, numLayers - firstLayer);
+        std::vector<uint32_t> seeds(numBatchLayers);
+        std::vector<std::vector<float>> layerParameters(numBatchLayers);
+        for (uint32_t batchIndex = 0; batchIndex < numBatchLayers; batchIndex++)
+        {
+            uint32_t layerIndex = firstLayer + batchIndex;
+            seeds[batchIndex] = header.seeds[layerIndex % numTrials];
+            for (const auto &[name, value] : configurations[layerIndex / numTrials])
+            {
+                layerParameters[batchIndex].push_back(value);
+            }
+        }
+        logInfo("Beginning trials %d to %d", firstLayer, firstLayer + numBatchLayers - 1);
+        batch->setTrialParameters(layerParameters);
+        batch->randomiseFields(width, height, seeds);
+        batch->runFlag = true;
+        while (batch->runFlag)
         {
-            update();
+            batch->update();
         }
 
-        std::stringstream nameStream;
-        nameStream << folderPath << "/string_count_trial" << trialIndex << ".ctdsd";
-
-        saveStringNumbers(nameStream.str().c_str());
+        // Write the samples of the batch into the ensembles of their configurations on the I/O thread, in the same order as serial
+        // trials
+        std::vector<std::vector<std::vector<int>>> stringNumbers = batch->getStringNumbers();
+        std::vector<std::vector<std::vector<int>>> wallNumbers = batch->getWallNumbers();
+        for (uint32_t batchIndex = 0; batchIndex < numBatchLayers; batchIndex++)
+        {
+            for (auto &stringCount : stringNumbers[batchIndex])
+            {
+                padSamples(stringCount, header.numSamples, header.valuesPerSample);
+            }
+            for (auto &wallCount : wallNumbers[batchIndex])
+            {
+                padSamples(wallCount, header.numSamples, header.valuesPerSample);
+            }
+        }
+        submitIO(
+            [stringCountFiles, wallCountFiles, stringCountStatistics, statisticsPaths, firstLayer, numTrials,
+             stringNumbers = std::move(stringNumbers), wallNumbers = std::move(wallNumbers)]()
+            {
+                for (uint32_t batchIndex = 0; batchIndex < stringNumbers.size(); batchIndex++)
+                {
+                    uint32_t configurationIndex = (firstLayer + batchIndex) / numTrials;
+                    uint32_t trialIndex = (firstLayer + batchIndex) % numTrials;
+                    EnsembleFile *stringCountFile = stringCountFiles[configurationIndex];
+                    for (size_t stringIndex = 0; stringIndex < stringNumbers[batchIndex].size(); stringIndex++)
+                    {
+                        stringCountFile->writeSamples(stringIndex, trialIndex, stringNumbers[batchIndex][stringIndex]);
+                        stringCountStatistics[configurationIndex]->addSamples(stringIndex, stringNumbers[batchIndex][stringIndex]);
+                    }
+                    stringCountFile->completeTrial();
+                    stringCountStatistics[configurationIndex]->completeTrial();
+                    EnsembleFile *wallCountFile = wallCountFiles[configurationIndex];
+                    if (wallCountFile != nullptr)
+                    {
+                        for (size_t wallIndex = 0; wallIndex < wallNumbers[batchIndex].size(); wallIndex++)
+                        {
+                            wallCountFile->writeSamples(wallIndex, trialIndex, wallNumbers[batchIndex][wallIndex]);
+                        }
+                        wallCountFile->completeTrial();
+                    }
+                    // The summary is rewritten once its configuration is complete
+                    if (trialIndex == numTrials - 1)
+                    {
+                        stringCountStatistics[configurationIndex]->write(statisticsPaths[configurationIndex]);
+                    }
+                }
+            });
     }
+    if (!hasCreatedFiles)
+    {
+        logWarning("Failed to create the ensemble files! Aborting trials...");
+    }
+    // Wait for the GPU and the output so that the whole campaign is timed
+    glFinish();
+    flushIO();
+    double elapsedSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
 
-    auto stopTime = std::chrono::high_resolution_clock::now();
-
-    int64_t durationHours = duration_cast<std::chrono::hours>(stopTime - startTime).count();
-    int64_t durationMinutes = duration_cast<std::chrono::minutes>(stopTime - startTime).count() % 60;
-    int64_t durationSeconds = duration_cast<std::chrono::seconds>(stopTime - startTime).count() % 60;
-
-    logInfo(
-        "Finished %d trials, taking %lld hours, %lld minutes and %lld seconds.",
-        numTrials, durationHours, durationMinutes, durationSeconds);
+    if (hasCreatedFiles)
+    {
+        logInfo("Finished %d trials of %d configurations of %s at %d x %d in batches of %d, taking %.3f ms per trial with %.1f MB of "
+                "field textures.",
+                numTrials, numConfigurations, convertSimulationModelToString(m_Model).c_str(), width, height, batchSize,
+                1000.0 * elapsedSeconds / std::max(numLayers, (uint32_t)1), batch->getFieldMemoryUsage() / 1048576.0);
+    }
+    for (uint32_t configurationIndex = 0; configurationIndex < numConfigurations; configurationIndex++)
+    {
+        delete stringCountFiles[configurationIndex];
+        delete wallCountFiles[configurationIndex];
+        delete stringCountStatistics[configurationIndex];
+    }
+    delete batch;
 }
\ No newline at end of file
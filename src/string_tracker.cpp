@@ -0,0 +1,278 @@
+// Standard libraries
+#include <algorithm>
+#include <cmath>
+
+// External libraries
+
+// Internal libraries
+#include "string_tracker.h"
+
+void StringTracker::reset(uint32_t width, uint32_t height, float dx, float searchRadius)
+{
+    m_Width = width;
+    m_Height = height;
+    m_Dx = dx;
+    setSearchRadius(searchRadius);
+    m_LastTime = 0.0f;
+    m_HasLastSample = false;
+
+    m_Tracks.clear();
+    m_Events.clear();
+    m_NextID = 0;
+    m_NumBirths = 0;
+    m_NumAnnihilations = 0;
+    m_MeanSpeed = 0.0f;
+}
+
+void StringTracker::setSearchRadius(float searchRadius)
+{
+    if (searchRadius <= 0.0f)
+    {
+        logWarning("The string search radius %f must be positive! Using a radius of one cell.", searchRadius);
+        searchRadius = 1.0f;
+    }
+    m_SearchRadius = searchRadius;
+}
+
+void StringTracker::update(int32_t timestep, float time, const uint32_t *records, uint32_t numRecords)
+{
+    // Unpack the records
+    m_NewPoints.resize(numRecords);
+    for (uint32_t recordIndex = 0; recordIndex < numRecords; recordIndex++)
+    {
+        uint32_t record = records[recordIndex];
+        m_NewPoints[recordIndex] = {(float)(record & 0x7FFF), (float)((record >> 15) & 0x7FFF), (record >> 30) & 1 ? -1 : 1};
+    }
+
+    // Continue each track with the nearest string of the same sign
+    m_TrackPoints.resize(m_Tracks.size());
+    for (size_t trackIndex = 0; trackIndex < m_Tracks.size(); trackIndex++)
+    {
+        m_TrackPoints[trackIndex] = {m_Tracks[trackIndex].x, m_Tracks[trackIndex].y, m_Tracks[trackIndex].sign};
+    }
+    matchPoints(m_NewPoints, m_TrackPoints, true, m_Matches);
+
+    m_NewToTrack.assign(numRecords, -1);
+    m_IsTrackMatched.assign(m_Tracks.size(), 0);
+    float elapsedTime = time - m_LastTime;
+    float speedSum = 0.0f;
+    for (const auto &[newIndex, trackIndex] : m_Matches)
+    {
+        m_NewToTrack[newIndex] = trackIndex;
+        m_IsTrackMatched[trackIndex] = 1;
+
+        StringTrack &track = m_Tracks[trackIndex];
+        const Point &point = m_NewPoints[newIndex];
+        if (m_HasLastSample && elapsedTime > 0.0f)
+        {
+            track.xVelocity = getPeriodicDisplacement(track.x, point.x, m_Width) * m_Dx / elapsedTime;
+            track.yVelocity = getPeriodicDisplacement(track.y, point.y, m_Height) * m_Dx / elapsedTime;
+        }
+        track.x = point.x;
+        track.y = point.y;
+        speedSum += sqrt(track.xVelocity * track.xVelocity + track.yVelocity * track.yVelocity);
+    }
+    m_MeanSpeed = m_Matches.size() > 0 ? speedSum / m_Matches.size() : 0.0f;
+
+    // Tracks that were not continued have annihilated, ideally with a nearby track of opposite sign
+    m_UnmatchedIndices.clear();
+    m_UnmatchedPoints.clear();
+    for (uint32_t trackIndex = 0; trackIndex < m_Tracks.size(); trackIndex++)
+    {
+        if (!m_IsTrackMatched[trackIndex])
+        {
+            m_UnmatchedIndices.push_back(trackIndex);
+            m_UnmatchedPoints.push_back(m_TrackPoints[trackIndex]);
+        }
+    }
+    matchPoints(m_UnmatchedPoints, m_UnmatchedPoints, false, m_Partners);
+    // Both ends of a pair point at each other
+    m_PartnerIDs.assign(m_UnmatchedIndices.size(), NO_PARTNER);
+    for (const auto &[firstIndex, secondIndex] : m_Partners)
+    {
+        m_PartnerIDs[firstIndex] = m_Tracks[m_UnmatchedIndices[secondIndex]].id;
+        m_PartnerIDs[secondIndex] = m_Tracks[m_UnmatchedIndices[firstIndex]].id;
+    }
+    for (size_t unmatchedIndex = 0; unmatchedIndex < m_UnmatchedIndices.size(); unmatchedIndex++)
+    {
+        const StringTrack &track = m_Tracks[m_UnmatchedIndices[unmatchedIndex]];
+        m_Events.push_back(
+            {StringEventType::ANNIHILATION, timestep, track.id, m_PartnerIDs[unmatchedIndex], track.birthTimestep, track.x, track.y});
+        m_NumAnnihilations++;
+    }
+
+    // Strings that do not continue a track are born, ideally with a nearby string of opposite sign. Surviving tracks keep the
+    // order of their strings so that the tracks of a sample are deterministic.
+    m_NextTracks.clear();
+    m_UnmatchedIndices.clear();
+    m_UnmatchedPoints.clear();
+    for (uint32_t newIndex = 0; newIndex < numRecords; newIndex++)
+    {
+        if (m_NewToTrack[newIndex] >= 0)
+        {
+            m_NextTracks.push_back(m_Tracks[m_NewToTrack[newIndex]]);
+        }
+        else
+        {
+            const Point &point = m_NewPoints[newIndex];
+            m_UnmatchedIndices.push_back(m_NextTracks.size());
+            m_UnmatchedPoints.push_back(point);
+            m_NextTracks.push_back({m_NextID++, point.sign, point.x, point.y, 0.0f, 0.0f, timestep});
+        }
+    }
+    matchPoints(m_UnmatchedPoints, m_UnmatchedPoints, false, m_Partners);
+    m_PartnerIDs.assign(m_UnmatchedIndices.size(), NO_PARTNER);
+    for (const auto &[firstIndex, secondIndex] : m_Partners)
+    {
+        m_PartnerIDs[firstIndex] = m_NextTracks[m_UnmatchedIndices[secondIndex]].id;
+        m_PartnerIDs[secondIndex] = m_NextTracks[m_UnmatchedIndices[firstIndex]].id;
+    }
+    for (size_t unmatchedIndex = 0; unmatchedIndex < m_UnmatchedIndices.size(); unmatchedIndex++)
+    {
+        const StringTrack &track = m_NextTracks[m_UnmatchedIndices[unmatchedIndex]];
+        m_Events.push_back({StringEventType::BIRTH, timestep, track.id, m_PartnerIDs[unmatchedIndex], timestep, track.x, track.y});
+        m_NumBirths++;
+    }
+
+    std::swap(m_Tracks, m_NextTracks);
+    m_LastTime = time;
+    m_HasLastSample = true;
+}
+
+std::vector<StringEvent> StringTracker::takeEvents()
+{
+    std::vector<StringEvent> events;
+    std::swap(events, m_Events);
+    return events;
+}
+
+void StringTracker::matchPoints(const std::vector<Point> &from, const std::vector<Point> &to, bool isSameSign,
+                                std::vector<std::pair<uint32_t, uint32_t>> &matches)
+{
+    matches.clear();
+    if (from.size() == 0 || to.size() == 0 || m_Width == 0 || m_Height == 0)
+    {
+        return;
+    }
+
+    // Cells are at least as wide as the search radius so every candidate lies in the 3 x 3 block of cells around a point
+    uint32_t cellSize = std::max((uint32_t)ceil(m_SearchRadius), (uint32_t)1);
+    uint32_t xNumCells = std::max(m_Width / cellSize, (uint32_t)1);
+    uint32_t yNumCells = std::max(m_Height / cellSize, (uint32_t)1);
+    auto getCellX = [&](float x)
+    { return std::min((uint32_t)x / cellSize, xNumCells - 1); };
+    auto getCellY = [&](float y)
+    { return std::min((uint32_t)y / cellSize, yNumCells - 1); };
+    // Cells are hashed into a power of two number of buckets that scales with the number of points rather than the grid. The
+    // hash keeps the row major order of the cells so that records, which arrive in roughly row major order, look up nearby
+    // buckets. Points from colliding cells are rejected by the distance check.
+    uint32_t numBuckets = 1;
+    while (numBuckets < 2 * to.size())
+    {
+        numBuckets *= 2;
+    }
+    auto getBucket = [&](uint32_t xCell, uint32_t yCell)
+    { return (yCell * xNumCells + xCell) & (numBuckets - 1); };
+
+    // Counting sort of the target points by bucket
+    m_CellStarts.assign(numBuckets + 1, 0);
+    for (const auto &point : to)
+    {
+        m_CellStarts[getBucket(getCellX(point.x), getCellY(point.y)) + 1]++;
+    }
+    for (size_t bucketIndex = 1; bucketIndex < m_CellStarts.size(); bucketIndex++)
+    {
+        m_CellStarts[bucketIndex] += m_CellStarts[bucketIndex - 1];
+    }
+    m_CellEntries.resize(to.size());
+    m_CellOffsets.assign(m_CellStarts.begin(), m_CellStarts.end() - 1);
+    for (uint32_t toIndex = 0; toIndex < to.size(); toIndex++)
+    {
+        const Point &point = to[toIndex];
+        m_CellEntries[m_CellOffsets[getBucket(getCellX(point.x), getCellY(point.y))]++] = toIndex;
+    }
+
+    // Collect every candidate pair within the search radius. Grids narrower than three cells visit each cell only once.
+    m_Candidates.clear();
+    float squaredRadius = m_SearchRadius * m_SearchRadius;
+    bool isSelf = &from == &to;
+    uint32_t xNumOffsets = std::min(xNumCells, (uint32_t)3);
+    uint32_t yNumOffsets = std::min(yNumCells, (uint32_t)3);
+    for (uint32_t fromIndex = 0; fromIndex < from.size(); fromIndex++)
+    {
+        const Point &point = from[fromIndex];
+        uint32_t xCell = getCellX(point.x);
+        uint32_t yCell = getCellY(point.y);
+        // Neighbouring cells wrap around the grid
+        uint32_t xCells[3] = {xCell == 0 ? xNumCells - 1 : xCell - 1, xCell, xCell + 1 == xNumCells ? 0 : xCell + 1};
+        uint32_t yCells[3] = {yCell == 0 ? yNumCells - 1 : yCell - 1, yCell, yCell + 1 == yNumCells ? 0 : yCell + 1};
+        if (xNumOffsets < 3)
+        {
+            xCells[0] = 0;
+            xCells[1] = 1;
+        }
+        if (yNumOffsets < 3)
+        {
+            yCells[0] = 0;
+            yCells[1] = 1;
+        }
+        for (uint32_t yOffset = 0; yOffset < yNumOffsets; yOffset++)
+        {
+            for (uint32_t xOffset = 0; xOffset < xNumOffsets; xOffset++)
+            {
+                uint32_t bucket = getBucket(xCells[xOffset], yCells[yOffset]);
+                for (uint32_t entry = m_CellStarts[bucket]; entry < m_CellStarts[bucket + 1]; entry++)
+                {
+                    uint32_t toIndex = m_CellEntries[entry];
+                    const Point &other = to[toIndex];
+                    // Pairs within one list are only considered once
+                    if ((isSelf && toIndex <= fromIndex) || (other.sign == point.sign) != isSameSign)
+                    {
+                        continue;
+                    }
+                    float xDisplacement = getPeriodicDisplacement(point.x, other.x, m_Width);
+                    float yDisplacement = getPeriodicDisplacement(point.y, other.y, m_Height);
+                    float squaredDistance = xDisplacement * xDisplacement + yDisplacement * yDisplacement;
+                    if (squaredDistance <= squaredRadius)
+                    {
+                        m_Candidates.push_back({squaredDistance, fromIndex, toIndex});
+                    }
+                }
+            }
+        }
+    }
+
+    // Accept the closest pairs first. Ties are broken by index so that the result is deterministic, and duplicates from
+    // colliding cells are skipped because their points have already been used.
+    std::sort(m_Candidates.begin(), m_Candidates.end());
+    m_IsFromUsed.assign(from.size(), 0);
+    std::vector<uint8_t> &isToUsed = isSelf ? m_IsFromUsed : m_IsToUsed;
+    if (!isSelf)
+    {
+        isToUsed.assign(to.size(), 0);
+    }
+    for (const auto &[squaredDistance, fromIndex, toIndex] : m_Candidates)
+    {
+        if (m_IsFromUsed[fromIndex] || isToUsed[toIndex])
+        {
+            continue;
+        }
+        m_IsFromUsed[fromIndex] = 1;
+        isToUsed[toIndex] = 1;
+        matches.push_back({fromIndex, toIndex});
+    }
+}
+
+float StringTracker::getPeriodicDisplacement(float a, float b, float length)
+{
+    float displacement = b - a;
+    if (displacement > 0.5f * length)
+    {
+        displacement -= length;
+    }
+    else if (displacement < -0.5f * length)
+    {
+        displacement += length;
+    }
+    return displacement;
+}
\ No newline at end of file
@@ -253,4 +253,45 @@ Texture2D *Texture2D::loadPNG(const char *filePath)
 
     logDebug("PNG file at path %s successfully loaded.", filePath);
     return pngTexture;
+}
+
+Texture3D::Texture3D(uint32_t width, uint32_t height, uint32_t depth, uint32_t format) : width(width), height(height), depth(depth)
+{
+    logDebug("Texture3D of size %d x %d x %d is being created...", width, height, depth);
+    glCreateTextures(GL_TEXTURE_3D, 1, &textureID);
+    glTextureStorage3D(textureID, 1, format, width, height, depth);
+    logDebug("Texture3D successfully created with ID %d.", textureID);
+}
+
+void Texture3D::release()
+{
+    if (textureID == 0)
+    {
+        return;
+    }
+    logDebug("Texture3D with ID %d is being destroyed...", textureID);
+    glDeleteTextures(1, &textureID);
+    logDebug("Texture3D with ID %d has been destroyed.", textureID);
+    textureID = 0;
+}
+
+Texture2DArray::Texture2DArray(uint32_t width, uint32_t height, uint32_t numLayers, uint32_t format)
+    : width(width), height(height), numLayers(numLayers)
+{
+    logDebug("Texture2DArray of size %d x %d with %d layers is being created...", width, height, numLayers);
+    glCreateTextures(GL_TEXTURE_2D_ARRAY, 1, &textureID);
+    glTextureStorage3D(textureID, 1, format, width, height, numLayers);
+    logDebug("Texture2DArray successfully created with ID %d.", textureID);
+}
+
+void Texture2DArray::release()
+{
+    if (textureID == 0)
+    {
+        return;
+    }
+    logDebug("Texture2DArray with ID %d is being destroyed...", textureID);
+    glDeleteTextures(1, &textureID);
+    logDebug("Texture2DArray with ID %d has been destroyed.", textureID);
+    textureID = 0;
 }
\ No newline at end of file
@@ -0,0 +1,318 @@
+// Standard libraries
+#include <algorithm>
+
+// External libraries
+#include <glad/glad.h>
+
+// Internal libraries
+#include "volume_simulation.h"
+
+// Work group size along each axis. Cubic work groups keep the neighbours of the stencils within the tiles of the 3D textures.
+constexpr uint32_t WORK_GROUP_SIZE = 4;
+
+// Defines that specialise the shaders shared with the 2D simulation to a 3D lattice at single precision, with the PRS alpha of
+// three dimensions
+static const char *VOLUME_SHADER_PREAMBLE =
+    "#define FIELD_FORMAT rgba32f\n#define LAPLACIAN_FORMAT r32f\n#define VOLUME\n"
+    "#define LATTICE_IMAGE image3D\n#define LATTICE_POSITION ivec3\n#define INVOCATION_POSITION ivec3(gl_GlobalInvocationID)\n"
+    "#define WORK_GROUP_SIZE_X 4\n#define WORK_GROUP_SIZE_Y 4\n#define WORK_GROUP_SIZE_Z 4\n#define PRS_ALPHA 3.0f\n";
+
+VolumeSimulation::VolumeSimulation(
+    uint32_t numFields,
+    ComputeShaderProgram *evolveFieldPass,
+    ComputeShaderProgram *evolveVelocityPass,
+    ComputeShaderProgram *calculateAccelerationPass,
+    ComputeShaderProgram *updateAccelerationPass,
+    ComputeShaderProgram *calculateLaplacianPass,
+    ComputeShaderProgram *detectStringsPass,
+    ComputeShaderProgram *detectWallsPass,
+    ComputeShaderProgram *randomiseFieldPass,
+    const SimulationLayout &layout)
+    : m_EvolveFieldPass(evolveFieldPass),
+      m_EvolveVelocityPass(evolveVelocityPass),
+      m_CalculateAccelerationPass(calculateAccelerationPass),
+      m_UpdateAccelerationPass(updateAccelerationPass),
+      m_CalculateLaplacianPass(calculateLaplacianPass),
+      m_DetectStringsPass(detectStringsPass),
+      m_DetectWallsPass(detectWallsPass),
+      m_RandomiseFieldPass(randomiseFieldPass),
+      m_Layout(layout),
+      m_NumFields(numFields)
+{
+    m_Fields.resize(m_NumFields);
+    m_LaplacianTextures.resize(m_NumFields);
+    // Each pair of fields has strings, and a single real field has walls of its own
+    size_t numPhases = m_NumFields / 2;
+    m_StringLengths.resize(m_DetectStringsPass != nullptr ? numPhases : 0);
+    m_WallAreas.resize(m_DetectWallsPass != nullptr ? (m_NumFields == 1 ? 1 : numPhases) : 0);
+    uint32_t numCounts = std::max((uint32_t)(m_StringLengths.size() + m_WallAreas.size()), (uint32_t)1);
+    m_DefectCountBuffer = std::make_unique<ShaderStorageBuffer>(numCounts * sizeof(uint32_t), BufferUsageType::DYNAMIC_COPY);
+}
+
+VolumeSimulation::~VolumeSimulation()
+{
+    delete m_EvolveFieldPass;
+    delete m_EvolveVelocityPass;
+    delete m_CalculateAccelerationPass;
+    delete m_UpdateAccelerationPass;
+    delete m_CalculateLaplacianPass;
+    delete m_DetectStringsPass;
+    delete m_DetectWallsPass;
+    delete m_RandomiseFieldPass;
+}
+
+VolumeSimulation *VolumeSimulation::create(
+    SimulationModel model,
+    const SimulationLayout &layout,
+    const std::vector<float> &floatUniforms,
+    const std::vector<int32_t> &intUniforms,
+    float dx,
+    float dt,
+    int era)
+{
+    const char *accelerationShaderPath = nullptr;
+    uint32_t numFields = 0;
+    bool hasStrings = false;
+    bool hasWalls = false;
+    switch (model)
+    {
+    case SimulationModel::DOMAIN_WALLS:
+        accelerationShaderPath = "shaders/domain_walls.glsl";
+        numFields = 1;
+        hasWalls = true;
+        break;
+    case SimulationModel::COSMIC_STRINGS:
+        accelerationShaderPath = "shaders/cosmic_strings.glsl";
+        numFields = 2;
+        hasStrings = true;
+        break;
+    case SimulationModel::SINGLE_AXION:
+        accelerationShaderPath = "shaders/single_axion.glsl";
+        numFields = 2;
+        hasStrings = true;
+        hasWalls = true;
+        break;
+    case SimulationModel::COMPANION_AXION:
+        accelerationShaderPath = "shaders/companion_axion.glsl";
+        numFields = 4;
+        hasStrings = true;
+        hasWalls = true;
+        break;
+    default:
+        logError("Unknown simulation model!");
+        return nullptr;
+    }
+
+    ComputeShaderProgram *evolveFieldPass =
+        ComputeShaderProgram::createFromFile("shaders/evolve_field.glsl", VOLUME_SHADER_PREAMBLE);
+    ComputeShaderProgram *evolveVelocityPass =
+        ComputeShaderProgram::createFromFile("shaders/evolve_velocity.glsl", VOLUME_SHADER_PREAMBLE);
+    ComputeShaderProgram *calculateAccelerationPass =
+        ComputeShaderProgram::createFromFile(accelerationShaderPath, VOLUME_SHADER_PREAMBLE);
+    ComputeShaderProgram *updateAccelerationPass =
+        ComputeShaderProgram::createFromFile("shaders/update_acceleration.glsl", VOLUME_SHADER_PREAMBLE);
+    ComputeShaderProgram *calculateLaplacianPass =
+        ComputeShaderProgram::createFromFile("shaders/calculate_laplacian.glsl", VOLUME_SHADER_PREAMBLE);
+    ComputeShaderProgram *detectStringsPass =
+        hasStrings ? ComputeShaderProgram::createFromFile("shaders/count_strings.glsl", VOLUME_SHADER_PREAMBLE) : nullptr;
+    ComputeShaderProgram *detectWallsPass =
+        hasWalls ? ComputeShaderProgram::createFromFile("shaders/count_walls.glsl", VOLUME_SHADER_PREAMBLE) : nullptr;
+    ComputeShaderProgram *randomiseFieldPass =
+        ComputeShaderProgram::createFromFile("shaders/randomise_field.glsl", VOLUME_SHADER_PREAMBLE);
+
+    VolumeSimulation *simulation = new VolumeSimulation(
+        numFields,
+        evolveFieldPass,
+        evolveVelocityPass,
+        calculateAccelerationPass,
+        updateAccelerationPass,
+        calculateLaplacianPass,
+        detectStringsPass,
+        detectWallsPass,
+        randomiseFieldPass,
+        layout);
+    if (evolveFieldPass == nullptr || evolveVelocityPass == nullptr || calculateAccelerationPass == nullptr ||
+        updateAccelerationPass == nullptr || calculateLaplacianPass == nullptr || (hasStrings && detectStringsPass == nullptr) ||
+        (hasWalls && detectWallsPass == nullptr) || randomiseFieldPass == nullptr)
+    {
+        logError("Failed to compile the shaders of the %s volume simulation!", convertSimulationModelToString(model).c_str());
+        delete simulation;
+        return nullptr;
+    }
+    simulation->m_FloatUniforms = floatUniforms;
+    simulation->m_IntUniforms = intUniforms;
+    simulation->m_Dx = dx;
+    simulation->m_Dt = dt;
+    simulation->m_Era = era;
+    return simulation;
+}
+
+void VolumeSimulation::randomiseFields(uint32_t width, uint32_t height, uint32_t depth, uint32_t seed)
+{
+    // Reset timestep
+    m_CurrentTimestep = 1;
+    m_XNumGroups = (width + WORK_GROUP_SIZE - 1) / WORK_GROUP_SIZE;
+    m_YNumGroups = (height + WORK_GROUP_SIZE - 1) / WORK_GROUP_SIZE;
+    m_ZNumGroups = (depth + WORK_GROUP_SIZE - 1) / WORK_GROUP_SIZE;
+
+    for (size_t fieldIndex = 0; fieldIndex < m_NumFields; fieldIndex++)
+    {
+        // Resize textures if necessary
+        Texture3D &field = m_Fields[fieldIndex];
+        if (field.width != width || field.height != height || field.depth != depth)
+        {
+            field = Texture3D(width, height, depth, GL_RGBA32F);
+            m_LaplacianTextures[fieldIndex] = Texture3D(width, height, depth, GL_R32F);
+        }
+
+        // The random values are written straight into the field, so large volumes never need a copy in memory
+        m_RandomiseFieldPass->use();
+        glUniform1ui(0, seed);
+        glUniform1ui(1, fieldIndex);
+        glBindImageTexture(0, field.textureID, 0, GL_TRUE, 0, GL_WRITE_ONLY, GL_RGBA32F);
+        glDispatchCompute(m_XNumGroups, m_YNumGroups, m_ZNumGroups);
+    }
+    glMemoryBarrier(GL_ALL_BARRIER_BITS);
+
+    for (auto &stringLength : m_StringLengths)
+    {
+        stringLength.clear();
+    }
+    for (auto &wallArea : m_WallAreas)
+    {
+        wallArea.clear();
+    }
+    calculateLaplacian();
+    sampleDefects();
+}
+
+void VolumeSimulation::update()
+{
+    // Stop running after hitting max timesteps
+    if (m_CurrentTimestep >= maxTimesteps)
+    {
+        runFlag = false;
+    }
+
+    // Do not update if not running
+    if (!runFlag)
+    {
+        return;
+    }
+
+    // Evolve field
+    for (size_t fieldIndex = 0; fieldIndex < m_Fields.size(); fieldIndex++)
+    {
+        dispatchFieldPass(m_EvolveFieldPass, fieldIndex);
+    }
+    calculateLaplacian();
+
+    // Update time
+    m_CurrentTimestep += 1;
+    sampleDefects();
+
+    // Calculate next acceleration
+    calculateAcceleration();
+
+    // Update velocity and then acceleration
+    for (size_t fieldIndex = 0; fieldIndex < m_Fields.size(); fieldIndex++)
+    {
+        dispatchFieldPass(m_EvolveVelocityPass, fieldIndex);
+    }
+    for (size_t fieldIndex = 0; fieldIndex < m_Fields.size(); fieldIndex++)
+    {
+        dispatchFieldPass(m_UpdateAccelerationPass, fieldIndex);
+    }
+}
+
+uint64_t VolumeSimulation::getFieldMemoryUsage() const
+{
+    // Four 32 bit channels per field and one per Laplacian
+    uint64_t numCells = (uint64_t)m_Fields[0].width * m_Fields[0].height * m_Fields[0].depth;
+    return numCells * (16 + 4) * m_NumFields;
+}
+
+void VolumeSimulation::calculateLaplacian()
+{
+    for (size_t fieldIndex = 0; fieldIndex < m_Fields.size(); fieldIndex++)
+    {
+        m_CalculateLaplacianPass->use();
+        glUniform1f(0, m_Dx);
+        glBindImageTexture(0, m_Fields[fieldIndex].textureID, 0, GL_TRUE, 0, GL_READ_ONLY, GL_RGBA32F);
+        glBindImageTexture(1, m_LaplacianTextures[fieldIndex].textureID, 0, GL_TRUE, 0, GL_WRITE_ONLY, GL_R32F);
+        // Dispatch and barrier
+        glDispatchCompute(m_XNumGroups, m_YNumGroups, m_ZNumGroups);
+        glMemoryBarrier(GL_ALL_BARRIER_BITS);
+    }
+}
+
+void VolumeSimulation::calculateAcceleration()
+{
+    m_CalculateAccelerationPass->use();
+    glUniform1f(0, m_CurrentTimestep * m_Dt);
+    glUniform1f(1, m_Dt);
+    glUniform1i(2, m_Era);
+    Simulation::bindUniforms(m_Layout, m_FloatUniforms, m_IntUniforms);
+    for (size_t fieldIndex = 0; fieldIndex < m_Fields.size(); fieldIndex++)
+    {
+        // Bind field and its Laplacian
+        glBindImageTexture(2 * fieldIndex, m_Fields[fieldIndex].textureID, 0, GL_TRUE, 0, GL_READ_WRITE, GL_RGBA32F);
+        glBindImageTexture(2 * fieldIndex + 1, m_LaplacianTextures[fieldIndex].textureID, 0, GL_TRUE, 0, GL_READ_ONLY, GL_R32F);
+    }
+
+    // Dispatch and barrier
+    glDispatchCompute(m_XNumGroups, m_YNumGroups, m_ZNumGroups);
+    glMemoryBarrier(GL_ALL_BARRIER_BITS);
+}
+
+void VolumeSimulation::sampleDefects()
+{
+    if ((m_CurrentTimestep - 1) % std::max(stringCountCadence, 1) != 0 || m_StringLengths.size() + m_WallAreas.size() == 0)
+    {
+        return;
+    }
+
+    m_DefectCountBuffer->clear(0, m_DefectCountBuffer->size);
+    m_DefectCountBuffer->bindBase(0);
+    for (size_t stringIndex = 0; stringIndex < m_StringLengths.size(); stringIndex++)
+    {
+        m_DetectStringsPass->use();
+        glUniform1i(0, stringIndex);
+        glBindImageTexture(0, m_Fields[2 * stringIndex].textureID, 0, GL_TRUE, 0, GL_READ_ONLY, GL_RGBA32F);
+        glBindImageTexture(1, m_Fields[2 * stringIndex + 1].textureID, 0, GL_TRUE, 0, GL_READ_ONLY, GL_RGBA32F);
+        glDispatchCompute(m_XNumGroups, m_YNumGroups, m_ZNumGroups);
+    }
+    for (size_t wallIndex = 0; wallIndex < m_WallAreas.size(); wallIndex++)
+    {
+        m_DetectWallsPass->use();
+        bool isComplex = m_Fields.size() > 1;
+        glUniform1i(0, m_StringLengths.size() + wallIndex);
+        glUniform1i(1, isComplex);
+        glBindImageTexture(0, m_Fields[isComplex ? 2 * wallIndex : 0].textureID, 0, GL_TRUE, 0, GL_READ_ONLY, GL_RGBA32F);
+        glBindImageTexture(1, m_Fields[isComplex ? 2 * wallIndex + 1 : 0].textureID, 0, GL_TRUE, 0, GL_READ_ONLY, GL_RGBA32F);
+        glDispatchCompute(m_XNumGroups, m_YNumGroups, m_ZNumGroups);
+    }
+    glMemoryBarrier(GL_ALL_BARRIER_BITS);
+
+    // Only the counts are read back
+    std::vector<uint32_t> counts(m_StringLengths.size() + m_WallAreas.size());
+    m_DefectCountBuffer->read(0, counts.size() * sizeof(uint32_t), counts.data());
+    for (size_t stringIndex = 0; stringIndex < m_StringLengths.size(); stringIndex++)
+    {
+        m_StringLengths[stringIndex].push_back(counts[stringIndex]);
+    }
+    for (size_t wallIndex = 0; wallIndex < m_WallAreas.size(); wallIndex++)
+    {
+        m_WallAreas[wallIndex].push_back(counts[m_StringLengths.size() + wallIndex]);
+    }
+}
+
+void VolumeSimulation::dispatchFieldPass(ComputeShaderProgram *pass, size_t fieldIndex)
+{
+    pass->use();
+    glUniform1f(0, m_Dt);
+    glBindImageTexture(0, m_Fields[fieldIndex].textureID, 0, GL_TRUE, 0, GL_READ_WRITE, GL_RGBA32F);
+    // Dispatch and barrier
+    glDispatchCompute(m_XNumGroups, m_YNumGroups, m_ZNumGroups);
+    glMemoryBarrier(GL_ALL_BARRIER_BITS);
+}
\ No newline at end of file